@@ -0,0 +1,66 @@
+#!/usr/bin/env node
+'use strict';
+
+//
+// Convert a JSON item bank to the binary item bank format read by catirt.loadItemBank()
+//
+//   node scripts/convert-bank.js <items.json> <out.catb> [options]
+//
+//   --model brm|grm        item model (default brm)
+//   --params <key>         item property holding the parameters (default params, e.g. p1params)
+//   --info-table           store the interpolated expected information table
+//   --interp cubic|linear  info table interpolation (default cubic)
+//   --tol <x>              info table absolute error bound (default 1e-6)
+//   --precision float32    store the bank (and table) for float32 selection
+//
+// items.json is an array of {id, <params key>: [...]} objects, as data/mocca-items.json.
+// RData banks can be exported to that form first, e.g. jsonlite::write_json(items, 'items.json', digits = NA).
+//
+const fs = require('fs');
+const catirt_load = require('../dist/catirt');
+
+function usage(message) {
+  console.error(`${message}\nusage: convert-bank.js <items.json> <out.catb> [--model brm|grm] [--params key] [--info-table] [--interp cubic|linear] [--tol x] [--precision float32]`);
+  process.exit(1);
+}
+
+const args = process.argv.slice(2);
+const files = [];
+const opts = {model: 'brm', params: 'params', info_table: false, interp: 'cubic', tol: 1e-6, precision: 'float64'};
+
+for (let i = 0; i < args.length; i++) {
+  switch (args[i]) {
+    case '--model': opts.model = args[++i]; break;
+    case '--params': opts.params = args[++i]; break;
+    case '--info-table': opts.info_table = true; break;
+    case '--interp': opts.interp = args[++i]; break;
+    case '--tol': opts.tol = Number(args[++i]); break;
+    case '--precision': opts.precision = args[++i]; break;
+    default:
+      if (args[i].startsWith('--')) {
+        usage(`unknown option ${args[i]}`);
+      }
+      files.push(args[i]);
+  }
+}
+if (files.length !== 2) {
+  usage('expected an input and an output file');
+}
+
+const source = JSON.parse(fs.readFileSync(files[0], 'utf8'));
+if (!Array.isArray(source)) {
+  usage(`${files[0]} is not an array of items`);
+}
+const items = source.map(item => ({id: item.id, params: item[opts.params]}));
+
+catirt_load().then(function(catirt) {
+  const bank = catirt.createItemBank(items, opts.model, {info_table: opts.info_table, interp: opts.interp, tol: opts.tol, precision: opts.precision});
+  if (bank.error) {
+    usage(bank.error);
+  }
+
+  const blob = bank.serialize();
+  fs.writeFileSync(files[1], blob);
+  console.log(`${files[1]}: ${bank.size()} ${opts.model} items, ${blob.length} bytes${bank.hasInfoTable() ? ' with info table' : ''}`);
+  bank.delete();
+});
@@ -2,7 +2,10 @@
 /**
  * Convert a 2D array to a Matrix object on the webasm shared buffer
  *
- * @param arr 2D JavaScript array containing numeric or NaN values
+ * The rows are flattened into a single Float64Array and copied in one call. For large
+ * inputs, build the Float64Array directly and use Module.Matrix.fromTypedArray(arr, rows, cols).
+ *
+ * @param arr 2D JavaScript array (or array of typed arrays) of finite numbers, with NaN or null for missing values
  *
  * @return Matrix object - caller frees via obj.delete()
  */
@@ -11,18 +14,26 @@ Module.MatrixFromArray = function(arr) {
     return new Module.Matrix(0, 0);
   }
 
-  let v2d = new Module.Vector2d();
-  for (let i = 0; i < arr.length; i++) {
-    let v = new Module.Vector();
-    for (let j = 0; j < arr[i].length; j++) {
-      v.push_back(arr[i][j]);
+  const rows = arr.length;
+  const cols = arr[0].length;
+  const flat = new Float64Array(rows * cols);
+  for (let i = 0; i < rows; i++) {
+    const row = arr[i];
+    if (row.length !== cols) {
+      throw new Error('All the rows must have the same size');
+    }
+    for (let j = 0; j < cols; j++) {
+      const x = row[j];
+      if (x === null) {
+        flat[i * cols + j] = NaN;
+      } else if (typeof x === 'number' && !(x === Infinity || x === -Infinity)) {
+        flat[i * cols + j] = x;
+      } else {
+        throw new Error('All the elements must be finite numbers, NaN, or null');
+      }
     }
-    v2d.push_back(v);
-    v.delete();
   }
-  const m = Module.Matrix.fromVector(v2d);
-  v2d.delete();
-  return m;
+  return Module.Matrix.fromTypedArray(flat, rows, cols);
 };
 
 /**
@@ -33,12 +44,12 @@ Module.MatrixFromArray = function(arr) {
  * @return array
  */
 Module.MatrixToArray = function(m) {
+  const rows = m.rows();
+  const cols = m.cols();
+  const flat = m.toTypedArray();
   const res = [];
-  for (let i = 0; i < m.rows(); i++) {
-    res.push([]);
-    for (let j = 0; j < m.cols(); j++) {
-      res[i].push(m.get(i, j));
-    }
+  for (let i = 0; i < rows; i++) {
+    res.push(Array.from(flat.subarray(i * cols, (i + 1) * cols)));
   }
   return res;
 };
@@ -58,16 +69,508 @@ Module.VectorToArray = function(v) {
   return res;
 };
 
+/**
+ * Nodes and prior weights of the quadrature table of the posterior-weighted selection criteria
+ *
+ * @param quad    Number of equally spaced nodes
+ * @param range   Array (2-tuple) of the first and last node
+ * @param ddist   Prior: null (standard normal), \{mean, sd\} of a normal prior, or a density function of theta
+ *
+ * @return object with "nodes" and "weights" Float64Array properties. Or a single "error" property
+ */
+function quad_table_prior(quad, range, ddist) {
+  if (!(Number.isInteger(quad) && quad >= 2 && quad <= 1000)) {
+    return {
+      error: '"quad" must be an integer from 2 to 1000'
+    };
+  }
+  if (!(Array.isArray(range) && range.length === 2 && range.every(Number.isFinite) && range[0] < range[1])) {
+    return {
+      error: '"range" must be an increasing array of 2 finite numbers'
+    };
+  }
+
+  const normal = (ddist === null ? {mean: 0, sd: 1} : ddist);
+  if (typeof normal === 'function') {
+    const table = Module.wasm_quadrature(Module.QuadType.EQUAL, quad, 0, 1, range[0], range[1]);
+    table.weights = table.nodes.map(x => normal(x));
+    if (!(table.weights.every(w => (Number.isFinite(w) && w >= 0)) && table.weights.some(w => (w > 0)))) {
+      return {
+        error: '"ddist" must return finite, non-negative densities, not all zero'
+      };
+    }
+    return table;
+  }
+  if (!(typeof normal === 'object' && Number.isFinite(normal.mean) && Number.isFinite(normal.sd) && normal.sd > 0)) {
+    return {
+      error: '"ddist" must be null, a density function, or {mean, sd}'
+    };
+  }
+  return Module.wasm_quadrature(Module.QuadType.EQUAL, quad, normal.mean, normal.sd, range[0], range[1]);
+}
+
+/**
+ * Build the quadrature table of a bank for the posterior-weighted selection criteria, unless it already has one for the same settings
+ *
+ * @param bank    ItemBank object
+ * @param spec    \{quad, range, ddist\} (see quad_table_prior)
+ *
+ * @return null, or an object with a single "error" property
+ */
+function build_quad_table(bank, spec) {
+  const built = bank.quad_spec;
+  if (bank.hasQuadTable() && built && built.quad === spec.quad && built.ddist === spec.ddist &&
+      built.range[0] === spec.range[0] && built.range[1] === spec.range[1]) {
+    return null;
+  }
+
+  const table = quad_table_prior(spec.quad, spec.range, spec.ddist);
+  if (table.error) {
+    return table;
+  }
+  Module.wasm_ItemBank_buildQuadTable(bank, table.nodes, table.weights);
+  bank.quad_spec = {quad: spec.quad, range: spec.range.slice(), ddist: spec.ddist};
+  return null;
+}
+
+/**
+ * Upload an item bank once into WASM memory for use with wleEst_*_one, FI_*_expected_one, and itChoose
+ *
+ * options defaults:
+ *  {
+ *      info_table: false,      // answer expected information from an interpolated table (see below)
+ *      precision: 'float64',   // 'float32' evaluates/tabulates expected information for selection in float (see below)
+ *      interp: 'cubic',        // table interpolation: 'cubic' or 'linear'
+ *      tol: 1e-6,              // table absolute error bound; the -5..5 step 0.05 grid is refined to meet it
+ *      phase1_params: null,    // ItemBank of phase1 items for "UW-FI-Modified" (brm only)
+ *      phase1_est_theta: null, // fixed phase1 ability estimate for "UW-FI-Modified"
+ *      quad_table: null        // \{quad: 33, range: [-4.5, 4.5], ddist: null\} (or true) to tabulate the bank for "PW-FI"/"PW-KL"
+ *  }
+ *
+ * With info_table, FI_brm_expected_one, FI_grm_expected_one, and itChoose interpolate item
+ * information from a table built once, instead of evaluating every item. With phase1_params and
+ * phase1_est_theta also set, "UW-FI-Modified" selection at that phase1 ability uses the table too.
+ *
+ * With precision 'float32', expected information (FI_*_expected_one, itChoose) is computed with
+ * float kernels (4 items per SIMD vector) and the table is stored as float, within an absolute
+ * error of 1e-5 of the double values. Ability estimates always use double. "UW-FI-Modified"
+ * uses float only when the phase1 bank is float32 too.
+ *
+ * With quad_table, the category probabilities and information of the items at the quad
+ * equally spaced nodes of range are tabulated once for the posterior-weighted selection
+ * criteria of itChoose (otherwise the table is built by the first such itChoose call).
+ *
+ * bank.serialize() returns the bank (with its precision and info table) as a Uint8Array in the
+ * binary item bank format, which loadItemBank() loads without parsing or tabulating again.
+ *
+ * @param items   Array of item objects (with id and params properties)
+ * @param model   'brm' or 'grm'
+ * @param options Options object (see description above)
+ *
+ * @return ItemBank object - caller frees via obj.delete(). Or a single "error" property
+ */
+Module.createItemBank = function(items, model, options={}) {
+  const defaults = {
+    info_table: false,
+    precision: 'float64',
+    interp: 'cubic',
+    tol: 1e-6,
+    phase1_params: null,
+    phase1_est_theta: null,
+    quad_table: null
+  };
+  options = Object.assign({}, defaults, options);
+
+  if (!(model === 'brm' || model === 'grm')) {
+    return {
+      error: `Invalid or unsupported "model" provided: "${model}"`
+    };
+  }
+  if (!(Array.isArray(items) && items.length > 0)) {
+    return {
+      error: 'items must be a non-empty array'
+    };
+  }
+  if (!items.every(item => (typeof item === 'object' && item !== null && Array.isArray(item.params)))) {
+    return {
+      error: 'items entries must be objects with params array'
+    };
+  }
+
+  if (!(options.precision === 'float64' || options.precision === 'float32')) {
+    return {
+      error: 'invalid precision option'
+    };
+  }
+  if (!(options.interp === 'cubic' || options.interp === 'linear')) {
+    return {
+      error: 'invalid interp option'
+    };
+  }
+  if (!(Number.isFinite(options.tol) && options.tol > 0)) {
+    return {
+      error: 'invalid tol option'
+    };
+  }
+  if (!(options.phase1_params === null || (options.phase1_params instanceof Module.ItemBank && options.phase1_params.size() === items.length && model === 'brm'))) {
+    return {
+      error: 'phase1_params must be null or a brm item bank of the same size'
+    };
+  }
+  if (!((options.phase1_params === null) === (options.phase1_est_theta === null) && (options.phase1_est_theta === null || Number.isFinite(options.phase1_est_theta)))) {
+    return {
+      error: 'phase1_params and phase1_est_theta must both be null or both be set'
+    };
+  }
+
+  const cols = items[0].params.length;
+  if ((model === 'brm') && !(cols === 3)) {
+    return {
+      error: 'params must have length 3 for brm model'
+    };
+  }
+  if ((model === 'grm') && !(cols > 1)) {
+    return {
+      error: 'params must have length greater than 1 for grm model'
+    };
+  }
+
+  const flat = new Float64Array(items.length * cols);
+  for (let i = 0; i < items.length; i++) {
+    if (!(items[i].params.length === cols && items[i].params.every(p => (typeof p === 'number' && Number.isFinite(p))))) {
+      return {
+        error: 'params must be finite numbers of the same length for every item'
+      };
+    }
+    flat.set(items[i].params, i * cols);
+  }
+
+  const ids = items.map(item => String(item.id === undefined ? '' : item.id));
+  const bank = new Module.ItemBank(flat, items.length, cols, (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM), ids);
+
+  if (options.precision === 'float32') {
+    bank.setPrecision(Module.Precision.FLOAT32);
+  }
+  if (options.info_table) {
+    bank.buildInfoTable(options.interp === 'cubic' ? Module.InterpType.CUBIC : Module.InterpType.LINEAR, options.tol);
+  }
+  if (options.phase1_params !== null) {
+    bank.setPhase1(options.phase1_params, options.phase1_est_theta);
+  }
+  if (options.quad_table) {
+    const spec = Object.assign({quad: 33, range: [-4.5, 4.5], ddist: null}, (options.quad_table === true ? {} : options.quad_table));
+    const error = build_quad_table(bank, spec);
+    if (error) {
+      bank.delete();
+      return error;
+    }
+  }
+
+  // keep the item objects for itChoose results
+  bank.items = items.slice();
+  return bank;
+};
+
+/**
+ * Load an item bank written by bank.serialize() (the binary item bank format) into WASM memory
+ *
+ * The blob holds the item parameters (one contiguous block), ids, model, precision, and the info
+ * table if the bank had one, so loading is a single copy into WASM memory without parsing JSON,
+ * building arrays, or evaluating any item. Convert JSON banks once with
+ * createItemBank(items, model, options).serialize(), or `node scripts/convert-bank.js`.
+ *
+ * options defaults:
+ *  {
+ *      phase1_params: null,    // ItemBank of phase1 items for "UW-FI-Modified" (brm only)
+ *      phase1_est_theta: null, // fixed phase1 ability estimate for "UW-FI-Modified"
+ *      quad_table: null        // \{quad: 33, range: [-4.5, 4.5], ddist: null\} (or true) to tabulate the bank for "PW-FI"/"PW-KL"
+ *  }
+ *
+ * The bank's items (as returned by itChoose) are \{id, params\} objects built on first use from
+ * bank.params(), so the blob is not kept or parsed again in JavaScript.
+ *
+ * @param blob    Uint8Array (e.g. a Buffer from fs.readFileSync) or ArrayBuffer from bank.serialize()
+ * @param options Options object (see description above and createItemBank)
+ *
+ * @return ItemBank object - caller frees via obj.delete(). Or a single "error" property
+ */
+Module.loadItemBank = function(blob, options={}) {
+  const defaults = {
+    phase1_params: null,
+    phase1_est_theta: null,
+    quad_table: null
+  };
+  options = Object.assign({}, defaults, options);
+
+  if (blob instanceof ArrayBuffer) {
+    blob = new Uint8Array(blob);
+  }
+  if (!(blob instanceof Uint8Array)) {
+    return {
+      error: 'blob must be a Uint8Array'
+    };
+  }
+
+  const bank = new Module.ItemBank();
+  const res = bank.deserialize(blob);
+  if (res !== null) {
+    bank.delete();
+    return res;
+  }
+
+  if (!(options.phase1_params === null || (options.phase1_params instanceof Module.ItemBank && options.phase1_params.size() === bank.size() && bank.model() === Module.ModelType.BRM))) {
+    bank.delete();
+    return {
+      error: 'phase1_params must be null or a brm item bank of the same size'
+    };
+  }
+  if (!((options.phase1_params === null) === (options.phase1_est_theta === null) && (options.phase1_est_theta === null || Number.isFinite(options.phase1_est_theta)))) {
+    bank.delete();
+    return {
+      error: 'phase1_params and phase1_est_theta must both be null or both be set'
+    };
+  }
+  if (options.phase1_params !== null) {
+    bank.setPhase1(options.phase1_params, options.phase1_est_theta);
+  }
+  if (options.quad_table) {
+    const spec = Object.assign({quad: 33, range: [-4.5, 4.5], ddist: null}, (options.quad_table === true ? {} : options.quad_table));
+    const error = build_quad_table(bank, spec);
+    if (error) {
+      bank.delete();
+      return error;
+    }
+  }
+
+  // item objects for itChoose results, read back from the bank's parameters on first use
+  let items = null;
+  Object.defineProperty(bank, 'items', {
+    get: function() {
+      if (items === null) {
+        const rows = bank.size();
+        const flat = bank.params();
+        const cols = flat.length / rows;
+        items = Array.from({length: rows}, (e, j) => ({
+          id: bank.id(j),
+          params: Array.from(flat.subarray(j * cols, (j + 1) * cols))
+        }));
+      }
+      return items;
+    }
+  });
+  return bank;
+};
+
+/**
+ * Convert an exclusion list (array of item indices) or mask (array/typed array of bank size) to a Uint8Array mask
+ *
+ * @param bank    ItemBank object
+ * @param exclude null, array of item indices, or mask with one truthy/falsy entry per bank item
+ *
+ * @return Uint8Array mask, or null if invalid
+ */
+Module.getExcludeMask = function(bank, exclude) {
+  const n = bank.size();
+  if (exclude === null || exclude === undefined) {
+    return new Uint8Array(0);
+  }
+  if (!(Array.isArray(exclude) || ArrayBuffer.isView(exclude))) {
+    return null;
+  }
+  if (exclude.length === n && (ArrayBuffer.isView(exclude) || exclude.every(e => typeof e === 'boolean'))) {
+    return Uint8Array.from(exclude, e => (e ? 1 : 0));
+  }
+
+  const mask = new Uint8Array(n);
+  for (let i = 0; i < exclude.length; i++) {
+    if (!(Number.isInteger(exclude[i]) && exclude[i] >= 0 && exclude[i] < n)) {
+      return null;
+    }
+    mask[exclude[i]] = 1;
+  }
+  return mask;
+};
+
+/**
+ * Start an incremental CAT session against an ItemBank
+ *
+ * The session keeps the administered items, responses, and last estimate, so each CAT step
+ * only adds the new response:
+ *
+ *   session.addResponse(index, value)   // null, or {error}
+ *   session.estimate()                  // {theta, info, sem}, warm-started from the last estimate
+ *   session.nextItem(n_select, numb)    // {items: Int32Array of bank indices, info: Float64Array}
+ *   session.serialize()                 // Uint8Array state, see restoreCatSession
+ *
+ * options defaults:
+ *  {
+ *      range: [-4.5, 4.5]  // range to limit computed theta within
+ *  }
+ *
+ * @param bank    ItemBank object (must not be deleted before the session)
+ * @param options Options object (see description above)
+ *
+ * @return CatSession object - caller frees via obj.delete(). Or a single "error" property
+ */
+Module.createCatSession = function(bank, options={}) {
+  const defaults = {
+    range: [-4.5, 4.5]
+  };
+  options = Object.assign({}, defaults, options);
+
+  if (!(bank instanceof Module.ItemBank)) {
+    return {
+      error: 'bank must be an ItemBank'
+    };
+  }
+  if (!(Array.isArray(options.range) && options.range.length === 2 && options.range[0] < 0 && options.range[1] > 0)) {
+    return {
+      error: 'invalid range option'
+    };
+  }
+
+  return new Module.CatSession(bank, options.range[0], options.range[1]);
+};
+
+/**
+ * Resume a CAT session from the output of session.serialize(), without replaying its history
+ *
+ * @param bank    ItemBank object the session was created with (same items and model)
+ * @param blob    Uint8Array (or ArrayBuffer) from session.serialize()
+ *
+ * @return CatSession object - caller frees via obj.delete(). Or a single "error" property
+ */
+Module.restoreCatSession = function(bank, blob) {
+  if (!(bank instanceof Module.ItemBank)) {
+    return {
+      error: 'bank must be an ItemBank'
+    };
+  }
+  if (blob instanceof ArrayBuffer) {
+    blob = new Uint8Array(blob);
+  }
+  if (!(blob instanceof Uint8Array)) {
+    return {
+      error: 'blob must be a Uint8Array'
+    };
+  }
+
+  const session = new Module.CatSession(bank, -4.5, 4.5);
+  const res = session.deserialize(blob);
+  if (res !== null) {
+    session.delete();
+    return res;
+  }
+  return session;
+};
+
+/**
+ * Check the root finder options of wleEst_brm_one and wleEst_grm_one
+ *
+ * options defaults:
+ *  {
+ *      solver: 'brent',  // 'brent' (port of R uniroot) or 'newton' (safeguarded Newton on the WLE score)
+ *      start: null       // 'newton' only: starting ability, e.g. the previous estimate of a CAT (null: Brent search)
+ *  }
+ *
+ * @param options Options object (see description above)
+ *
+ * @return object with "solver" (Module.SolverType) and "start" (number, NaN for the Brent search) properties. Or a single "error" property
+ */
+function wleEst_solver_options(options) {
+  const defaults = {
+    solver: 'brent',
+    start: null
+  };
+  options = Object.assign({}, defaults, options);
+
+  if (!(options.solver === 'brent' || options.solver === 'newton')) {
+    return {
+      error: 'invalid solver option'
+    };
+  }
+  if (!(options.start === null || Number.isFinite(options.start))) {
+    return {
+      error: 'invalid start option'
+    };
+  }
+
+  return {
+    solver: (options.solver === 'newton' ? Module.SolverType.NEWTON : Module.SolverType.BRENT),
+    start: (options.start === null ? NaN : options.start)
+  };
+}
+
+/**
+ * Compute an ability estimate of one person from responses to items of an ItemBank
+ *
+ * @param resp  Array of responses to every bank item (NaN if not administered), or to the given items
+ * @param bank  ItemBank object
+ * @param range Array (2-tuple) range to limit computed theta within
+ * @param items Array of item indices answered by resp, or null if resp covers the whole bank
+ * @param model 'brm' or 'grm' model of the calling function
+ * @param opts  Checked root finder options (see wleEst_solver_options)
+ *
+ * @return object with "theta", "info", and "sem" properties. Or a single "error" property
+ */
+function wleEst_bank_one(resp, bank, range, items, model, opts) {
+  const type = (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM);
+
+  if (bank.model() !== type) {
+    return {
+      error: `item bank model must be ${model}`
+    };
+  }
+  if (!(Array.isArray(resp) || ArrayBuffer.isView(resp))) {
+    return {
+      error: 'response must be an array'
+    };
+  }
+  if (items === null) {
+    if (!(resp.length === bank.size())) {
+      return {
+        error: 'length of response must match size of item bank'
+      };
+    }
+  }
+  else if (!(Array.isArray(items) && items.length === resp.length && items.every(j => (Number.isInteger(j) && j >= 0 && j < bank.size())))) {
+    return {
+      error: 'items must be an array of item bank indices matching the length of response'
+    };
+  }
+  for (let i = 0; i < resp.length; i++) {
+    if (!(typeof resp[i] === 'number') || (items !== null && !Number.isFinite(resp[i]))) {
+      return {
+        error: 'response has non-numeric elements'
+      };
+    }
+  }
+
+  return Module.wasm_ItemBank_wleEst(bank, resp, (items === null ? [] : items), range[0], range[1], opts.solver, opts.start);
+}
+
 /**
  * Compute an ability estimate using the binary response model
  *
- * @param resp   Array of N response values (1=correct, 0=incorrect)
- * @param params 2D array (Nx3) of item parameters
- * @param range  Array (2-tuple) range to limit computed theta within
+ * params may also be an ItemBank (see createItemBank): resp then has one entry per bank item
+ * (NaN if not administered), or one entry per index of the items argument.
+ *
+ * @param resp    Array of N response values (1=correct, 0=incorrect)
+ * @param params  2D array (Nx3) of item parameters, or ItemBank
+ * @param range   Array (2-tuple) range to limit computed theta within
+ * @param items   Array of ItemBank indices answered by resp (ItemBank only)
+ * @param options Root finder options: {solver: 'brent' or 'newton', start: null or starting theta} (see wleEst_solver_options)
  *
  * @return object with "theta", "info", and "sem" properties. Or a single "error" property
  */
-Module.wleEst_brm_one = function(resp, params, range=[-4.5, 4.5]) {
+Module.wleEst_brm_one = function(resp, params, range=[-4.5, 4.5], items=null, options={}) {
+  const opts = wleEst_solver_options(options);
+  if (opts.error) {
+    return opts;
+  }
+  if (params instanceof Module.ItemBank) {
+    return wleEst_bank_one(resp, params, range, items, 'brm', opts);
+  }
   if (!(Array.isArray(resp) && resp.length)) {
     return {
       error: 'response must be a non-empty array'
@@ -113,7 +616,9 @@ Module.wleEst_brm_one = function(resp, params, range=[-4.5, 4.5]) {
   const mResp = Module.MatrixFromArray([resp]);
   const mParams = Module.MatrixFromArray(params);
   const mRange = Module.MatrixFromArray([range]);
-  const est = Module.wasm_wleEst(mResp, mParams, mRange, Module.ModelType.BRM);
+  const est = (opts.solver === Module.SolverType.NEWTON ?
+    Module.wasm_wleEst_solver(mResp, mParams, mRange, Module.ModelType.BRM, opts.solver, [opts.start]) :
+    Module.wasm_wleEst(mResp, mParams, mRange, Module.ModelType.BRM));
 
   result.theta = est.theta.get(0);
   result.info = est.info.get(0);
@@ -133,13 +638,25 @@ Module.wleEst_brm_one = function(resp, params, range=[-4.5, 4.5]) {
 /**
  * Compute an ability estimate using a graded response model of M categories
  *
- * @param resp   Array of N response values ranging from (1 to M)
- * @param params 2D array (NxM) of item parameters
- * @param range  Array (2-tuple) range to limit computed theta within. [-4.5, 4.5] by default
+ * params may also be an ItemBank (see createItemBank): resp then has one entry per bank item
+ * (NaN if not administered), or one entry per index of the items argument.
+ *
+ * @param resp    Array of N response values ranging from (1 to M)
+ * @param params  2D array (NxM) of item parameters, or ItemBank
+ * @param range   Array (2-tuple) range to limit computed theta within. [-4.5, 4.5] by default
+ * @param items   Array of ItemBank indices answered by resp (ItemBank only)
+ * @param options Root finder options: {solver: 'brent' or 'newton', start: null or starting theta} (see wleEst_solver_options)
  *
  * @return object with "theta", "info", and "sem" properties. Or a single "error" property
  */
-Module.wleEst_grm_one = function(resp, params, range=[-4.5, 4.5]) {
+Module.wleEst_grm_one = function(resp, params, range=[-4.5, 4.5], items=null, options={}) {
+  const opts = wleEst_solver_options(options);
+  if (opts.error) {
+    return opts;
+  }
+  if (params instanceof Module.ItemBank) {
+    return wleEst_bank_one(resp, params, range, items, 'grm', opts);
+  }
   if (!(Array.isArray(resp) && resp.length)) {
     return {
       error: 'response must be a non-empty array'
@@ -167,7 +684,9 @@ Module.wleEst_grm_one = function(resp, params, range=[-4.5, 4.5]) {
   const mResp = Module.MatrixFromArray([resp]);
   const mParams = Module.MatrixFromArray(params);
   const mRange = Module.MatrixFromArray([range]);
-  const est = Module.wasm_wleEst(mResp, mParams, mRange, Module.ModelType.GRM);
+  const est = (opts.solver === Module.SolverType.NEWTON ?
+    Module.wasm_wleEst_solver(mResp, mParams, mRange, Module.ModelType.GRM, opts.solver, [opts.start]) :
+    Module.wasm_wleEst(mResp, mParams, mRange, Module.ModelType.GRM));
 
   result.theta = est.theta.get(0);
   result.info = est.info.get(0);
@@ -181,18 +700,433 @@ Module.wleEst_grm_one = function(resp, params, range=[-4.5, 4.5]) {
   est.info.delete();
   est.sem.delete();
 
-  return result;
-};
+  return result;
+};
+
+/**
+ * Check the item parameters of a batch function
+ *
+ * @param params  2D array (M x K) of item parameters, or ItemBank of M items
+ * @param model   'brm' or 'grm' model of the calling function
+ *
+ * @return null if valid, or an object with a single "error" property
+ */
+function batch_params_error(params, model) {
+  if (params instanceof Module.ItemBank) {
+    if (params.model() !== (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM)) {
+      return {
+        error: `item bank model must be ${model}`
+      };
+    }
+    return null;
+  }
+
+  if (!(Array.isArray(params) && params.length)) {
+    return {
+      error: 'params must be a non-empty array'
+    };
+  }
+  const cols = params[0].length;
+  if (!params.every(p => (Array.isArray(p) && p.length === cols && p.every(x => (typeof x === 'number' && Number.isFinite(x)))))) {
+    return {
+      error: 'params must be finite numbers of the same length for every item'
+    };
+  }
+  if ((model === 'brm' && cols !== 3) || (model === 'grm' && !(cols > 1))) {
+    return {
+      error: (model === 'brm' ? 'each params array must be of length 3' : 'each params array must be of length greater than 1')
+    };
+  }
+  return null;
+}
+
+/**
+ * Flatten the responses of a batch function to a row-major Float64Array
+ *
+ * @param resp    2D array (N x M) of responses, or row-major Float64Array of N * M responses
+ * @param cols    Number of items M
+ *
+ * @return Float64Array of N * M responses (resp itself if already flat), or an object with a single "error" property
+ */
+function batch_responses(resp, cols) {
+  let flat;
+  if (resp instanceof Float64Array) {
+    flat = resp;
+  }
+  else if (Array.isArray(resp) && resp.every(r => ((Array.isArray(r) || ArrayBuffer.isView(r)) && r.length === cols))) {
+    flat = new Float64Array(resp.length * cols);
+    for (let i = 0; i < resp.length; i++) {
+      for (let j = 0; j < cols; j++) {
+        if (typeof resp[i][j] !== 'number') {
+          return {
+            error: 'response has non-numeric elements'
+          };
+        }
+      }
+      flat.set(resp[i], i * cols);
+    }
+  }
+  else {
+    return {
+      error: 'response must be a 2D array or Float64Array with one column per item'
+    };
+  }
+  if (flat.length % cols !== 0) {
+    return {
+      error: 'length of response must be a multiple of the number of items'
+    };
+  }
+  return flat;
+}
+
+/**
+ * Compute ability estimates of many people who each answered a different subset of the items
+ *
+ * @param resp    2D array (N x M) of responses, or row-major Float64Array of N * M responses
+ * @param params  2D array (M x K) of item parameters, or ItemBank of M items
+ * @param range   Array (2-tuple) range to limit computed theta within
+ * @param model   'brm' or 'grm' model of the calling function
+ * @param options Options object (see wleEst_brm_batch)
+ *
+ * @return object with "theta", "info", and "sem" Float64Array properties. Or a single "error" property
+ */
+function wleEst_batch(resp, params, range, model, options) {
+  const defaults = {
+    mask: null,
+    solver: 'brent',
+    start: null
+  };
+  options = Object.assign({}, defaults, options);
+
+  const type = (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM);
+  const bank = (params instanceof Module.ItemBank);
+
+  if (!(options.solver === 'brent' || options.solver === 'newton')) {
+    return {
+      error: 'invalid solver option'
+    };
+  }
+  if (!(Array.isArray(range) && range.length === 2 && range[0] < 0 && range[1] > 0)) {
+    return {
+      error: 'invalid range'
+    };
+  }
+  const error = batch_params_error(params, model);
+  if (error) {
+    return error;
+  }
+
+  const cols = (bank ? params.size() : params.length);
+  const flat = batch_responses(resp, cols);
+  if (flat.error) {
+    return flat;
+  }
+
+  const rows = flat.length / cols;
+  let mask = new Uint8Array(0);
+  if (options.mask !== null) {
+    if (!((Array.isArray(options.mask) || ArrayBuffer.isView(options.mask)) && options.mask.length === rows * cols)) {
+      return {
+        error: 'mask must have one entry per response'
+      };
+    }
+    mask = Uint8Array.from(options.mask, e => (e ? 1 : 0));
+  }
+  let start = new Float64Array(0);
+  if (options.start !== null) {
+    if (!((Array.isArray(options.start) || ArrayBuffer.isView(options.start)) && options.start.length === rows)) {
+      return {
+        error: 'start must have one entry per person'
+      };
+    }
+    start = Float64Array.from(options.start);
+  }
+  const solver = (options.solver === 'newton' ? Module.SolverType.NEWTON : Module.SolverType.BRENT);
+
+  if (bank) {
+    return Module.wasm_ItemBank_wleEst_ragged(params, flat, rows, range[0], range[1], mask, solver, start);
+  }
+
+  const mParams = Module.MatrixFromArray(params);
+  const mRange = Module.MatrixFromArray([range]);
+  const result = Module.wasm_wleEst_ragged(flat, rows, mParams, mRange, type, mask, solver, start);
+
+  // cleanup wasm heap
+  mParams.delete();
+  mRange.delete();
+
+  return result;
+}
+
+/**
+ * Compute ability estimates of many people at once using the binary response model
+ *
+ * Each row holds the responses of one person to all M items, NaN for items that were not
+ * administered, so people who answered different items (e.g. after a CAT) are scored in one call.
+ *
+ * options defaults:
+ *  {
+ *      mask: null,       // N * M entries (row-major), falsy to also skip a finite response
+ *      solver: 'brent',  // 'brent' or 'newton' (see wleEst_brm_one)
+ *      start: null       // 'newton' only: N starting abilities (NaN for the Brent search)
+ *  }
+ *
+ * @param resp    2D array (N x M) of responses (1=correct, 0=incorrect, NaN), or row-major Float64Array of N * M responses
+ * @param params  2D array (Mx3) of item parameters, or ItemBank of M items
+ * @param range   Array (2-tuple) range to limit computed theta within
+ * @param options Options object (see description above)
+ *
+ * @return object with "theta", "info", and "sem" Float64Array (N) properties; theta 0 and NaN info/sem for people without responses. Or a single "error" property
+ */
+Module.wleEst_brm_batch = function(resp, params, range=[-4.5, 4.5], options={}) {
+  return wleEst_batch(resp, params, range, 'brm', options);
+};
+
+/**
+ * Compute ability estimates of many people at once using a graded response model
+ *
+ * Each row holds the responses of one person to all M items, NaN for items that were not
+ * administered (see wleEst_brm_batch for the options).
+ *
+ * @param resp    2D array (N x M) of responses (1 to K, NaN), or row-major Float64Array of N * M responses
+ * @param params  2D array (MxK) of item parameters, or ItemBank of M items
+ * @param range   Array (2-tuple) range to limit computed theta within
+ * @param options Options object (see wleEst_brm_batch)
+ *
+ * @return object with "theta", "info", and "sem" Float64Array (N) properties; theta 0 and NaN info/sem for people without responses. Or a single "error" property
+ */
+Module.wleEst_grm_batch = function(resp, params, range=[-4.5, 4.5], options={}) {
+  return wleEst_batch(resp, params, range, 'grm', options);
+};
+
+/**
+ * Compute EAP ability estimates of many people using a fixed quadrature
+ *
+ * @param resp    2D array (N x M) of responses, or row-major Float64Array of N * M responses
+ * @param params  2D array (M x K) of item parameters, or ItemBank of M items
+ * @param model   'brm' or 'grm' model of the calling function
+ * @param options Options object (see eapEst_brm_batch)
+ *
+ * @return object with "theta", "info", and "sem" Float64Array properties. Or a single "error" property
+ */
+function eapEst_batch(resp, params, model, options) {
+  const defaults = {
+    quad: 'gauss-hermite',
+    points: 41,
+    prior: {mean: 0, sd: 1},
+    range: [-6, 6]
+  };
+  options = Object.assign({}, defaults, options);
+
+  const type = (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM);
+  const bank = (params instanceof Module.ItemBank);
+  const prior = options.prior;
+
+  if (!(options.quad === 'gauss-hermite' || options.quad === 'equal')) {
+    return {
+      error: 'invalid quad option'
+    };
+  }
+  if (!(Number.isInteger(options.points) && options.points >= (options.quad === 'equal' ? 2 : 1) && options.points <= 200)) {
+    return {
+      error: 'invalid points option'
+    };
+  }
+  if (!(Array.isArray(options.range) && options.range.length === 2 && options.range[0] < options.range[1])) {
+    return {
+      error: 'invalid range option'
+    };
+  }
+
+  const error = batch_params_error(params, model);
+  if (error) {
+    return error;
+  }
+
+  const cols = (bank ? params.size() : params.length);
+  const flat = batch_responses(resp, cols);
+  if (flat.error) {
+    return flat;
+  }
+
+  // nodes and prior weights of the quadrature
+  let quad;
+  if (prior && (Array.isArray(prior.nodes) || ArrayBuffer.isView(prior.nodes))) {
+    quad = {
+      nodes: Float64Array.from(prior.nodes),
+      weights: Float64Array.from(prior.weights || [])
+    };
+    if (!(quad.nodes.length && quad.nodes.length === quad.weights.length && quad.nodes.every(Number.isFinite) &&
+          quad.weights.every(w => (Number.isFinite(w) && w >= 0)) && quad.weights.some(w => (w > 0)))) {
+      return {
+        error: 'prior nodes and weights must be finite, of the same length, and weights non-negative with a positive sum'
+      };
+    }
+  }
+  else if (typeof prior === 'function') {
+    if (options.quad !== 'equal') {
+      return {
+        error: 'a prior function needs equally spaced nodes (quad: "equal")'
+      };
+    }
+    quad = Module.wasm_quadrature(Module.QuadType.EQUAL, options.points, 0, 1, options.range[0], options.range[1]);
+    quad.weights = quad.nodes.map(x => prior(x));
+    if (!(quad.weights.every(w => (Number.isFinite(w) && w >= 0)) && quad.weights.some(w => (w > 0)))) {
+      return {
+        error: 'prior function must return finite, non-negative densities, not all zero'
+      };
+    }
+  }
+  else if (prior && Number.isFinite(prior.mean) && Number.isFinite(prior.sd) && prior.sd > 0) {
+    const quadType = (options.quad === 'equal' ? Module.QuadType.EQUAL : Module.QuadType.GAUSS_HERMITE);
+    quad = Module.wasm_quadrature(quadType, options.points, prior.mean, prior.sd, options.range[0], options.range[1]);
+  }
+  else {
+    return {
+      error: 'invalid prior option'
+    };
+  }
+
+  // responses must be categories of the model (NaN if not administered)
+  const K = (model === 'brm' ? 2 : (bank ? params.categories() : params[0].length));
+  const first = (model === 'brm' ? 0 : 1);
+  for (let i = 0; i < flat.length; i++) {
+    const u = flat[i];
+    if (!(Number.isNaN(u) || (Number.isInteger(u) && u >= first && u < first + K))) {
+      return {
+        error: (model === 'brm' ? 'responses must be 0, 1, or NaN' : `responses must be 1 to ${K}, or NaN`)
+      };
+    }
+  }
+
+  const rows = flat.length / cols;
+
+  if (bank) {
+    return Module.wasm_ItemBank_eapEst(params, flat, rows, quad.nodes, quad.weights);
+  }
+
+  const mParams = Module.MatrixFromArray(params);
+  const result = Module.wasm_eapEst(flat, rows, mParams, type, quad.nodes, quad.weights);
+
+  // cleanup wasm heap
+  mParams.delete();
+
+  return result;
+}
+
+/**
+ * Compute EAP (expected a posteriori) ability estimates of many people at once using the binary response model
+ *
+ * The posterior mean and standard deviation are computed over a fixed quadrature: the
+ * log-likelihood of every person at every node is one sum over the items of a table built once
+ * per call, so there is no iteration and the time per person is fixed. Rows hold the responses
+ * of one person to all M items, NaN for items that were not administered.
+ *
+ * options defaults:
+ *  {
+ *      quad:   'gauss-hermite',     // 'gauss-hermite' (normal prior) or 'equal' (equally spaced nodes over range)
+ *      points: 41,                  // number of quadrature nodes
+ *      prior:  {mean: 0, sd: 1},    // normal prior, {nodes, weights} of any prior, or a density function of theta ('equal' only)
+ *      range:  [-6, 6]              // 'equal' only: first and last node
+ *  }
+ *
+ * @param resp    2D array (N x M) of responses (1=correct, 0=incorrect, NaN), or row-major Float64Array of N * M responses
+ * @param params  2D array (Mx3) of item parameters, or ItemBank of M items
+ * @param options Options object (see description above)
+ *
+ * @return object with "theta" (posterior mean), "info" (posterior precision 1/sd^2), and "sem" (posterior sd) Float64Array (N) properties;
+ *         the prior mean and sd for people without responses. Or a single "error" property
+ */
+Module.eapEst_brm_batch = function(resp, params, options={}) {
+  return eapEst_batch(resp, params, 'brm', options);
+};
+
+/**
+ * Compute EAP (expected a posteriori) ability estimates of many people at once using a graded response model
+ *
+ * See eapEst_brm_batch for the quadrature and the options.
+ *
+ * @param resp    2D array (N x M) of responses (1 to K, NaN), or row-major Float64Array of N * M responses
+ * @param params  2D array (MxK) of item parameters, or ItemBank of M items
+ * @param options Options object (see eapEst_brm_batch)
+ *
+ * @return object with "theta" (posterior mean), "info" (posterior precision 1/sd^2), and "sem" (posterior sd) Float64Array (N) properties;
+ *         the prior mean and sd for people without responses. Or a single "error" property
+ */
+Module.eapEst_grm_batch = function(resp, params, options={}) {
+  return eapEst_batch(resp, params, 'grm', options);
+};
+
+/**
+ * Compute expected Fisher Information values for the items of an ItemBank
+ *
+ * @param bank    ItemBank object
+ * @param theta   a single ability estimate
+ * @param exclude null, array of item indices, or mask of bank size of items to skip
+ * @param model   'brm' or 'grm' model of the calling function
+ * @param phase1  \{bank, theta\} of phase1 for the modified expected information, or null
+ *
+ * @return object with "item" (Float64Array, NaN for excluded items), "test", and "sem" properties. Or a single "error" property
+ */
+function FI_bank_expected_one(bank, theta, exclude, model, phase1=null) {
+  const type = (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM);
+
+  if (bank.model() !== type) {
+    return {
+      error: `item bank model must be ${model}`
+    };
+  }
+  if (!Number.isFinite(theta)) {
+    return {
+      error: 'theta must be a finite number'
+    };
+  }
+
+  const mask = Module.getExcludeMask(bank, exclude);
+  if (mask === null) {
+    return {
+      error: 'exclude must be null, an array of item bank indices, or a mask of item bank size'
+    };
+  }
+
+  let item;
+  if (phase1 === null) {
+    item = Module.wasm_ItemBank_FI_expected(bank, theta, mask);
+  }
+  else {
+    item = Module.wasm_ItemBank_FI_modified_expected(bank, theta, phase1.bank, phase1.theta, mask);
+  }
+
+  let test = 0;
+  for (let i = 0; i < item.length; i++) {
+    if (!mask[i]) {
+      test += item[i];
+    }
+  }
+
+  return {
+    item: item,
+    test: test,
+    sem: Math.sqrt(1 / test)
+  };
+}
 
 /**
  * Compute expected Fisher Information values for a set of items using the binary response model
  *
- * @param params 2D array (Nx3) of item parameters
- * @param theta  a single ability estimate
+ * params may also be an ItemBank (see createItemBank): "item" is then a Float64Array with one
+ * entry per bank item (NaN for excluded items).
+ *
+ * @param params  2D array (Nx3) of item parameters, or ItemBank
+ * @param theta   a single ability estimate
+ * @param exclude Array of ItemBank indices, or mask of bank size, of items to skip (ItemBank only)
  *
  * @return object with "item", "test", and "sem" properties. Or a single "error" property
  */
-Module.FI_brm_expected_one = function(params, theta) {
+Module.FI_brm_expected_one = function(params, theta, exclude=null) {
+  if (params instanceof Module.ItemBank) {
+    return FI_bank_expected_one(params, theta, exclude, 'brm');
+  }
   if (!(Array.isArray(params) && params.length)) {
     return {
       error: 'params must be a non-empty array'
@@ -233,14 +1167,30 @@ Module.FI_brm_expected_one = function(params, theta) {
 /**
  * Compute expected Fisher Information (modified unweighted) values for a set of items using the binary response model
  *
- * @param params2 2D array (Nx3) of phase2 item parameters
+ * params2 and params1 may also be ItemBank objects of the same items (see createItemBank).
+ *
+ * @param params2 2D array (Nx3) of phase2 item parameters, or ItemBank
  * @param theta2  a single phase2 ability estimate
- * @param params1 2D array (Nx3) of phase1 item parameters
+ * @param params1 2D array (Nx3) of phase1 item parameters, or ItemBank
  * @param theta1  a single phase1 ability estimate
+ * @param exclude Array of ItemBank indices, or mask of bank size, of items to skip (ItemBank only)
  *
  * @return object with "item", "test", and "sem" properties. Or a single "error" property
  */
-Module.FI_brm_expected_one_modified = function(params2, theta2, params1, theta1) {
+Module.FI_brm_expected_one_modified = function(params2, theta2, params1, theta1, exclude=null) {
+  if (params2 instanceof Module.ItemBank) {
+    if (!(params1 instanceof Module.ItemBank && params1.size() === params2.size())) {
+      return {
+        error: 'params1 must be an item bank of the same size as params2'
+      };
+    }
+    if (!Number.isFinite(theta1)) {
+      return {
+        error: 'theta1 must be a finite number'
+      };
+    }
+    return FI_bank_expected_one(params2, theta2, exclude, 'brm', {bank: params1, theta: theta1});
+  }
   if (!(Array.isArray(params2) && params2.length)) {
     return {
       error: 'params2 must be a non-empty array'
@@ -293,12 +1243,19 @@ Module.FI_brm_expected_one_modified = function(params2, theta2, params1, theta1)
 /**
  * Compute expected Fisher Information values for a set of items using a graded response model of M categories
  *
- * @param params 2D array (NxM) of item parameters
- * @param theta  a single ability estimate
+ * params may also be an ItemBank (see createItemBank): "item" is then a Float64Array with one
+ * entry per bank item (NaN for excluded items).
+ *
+ * @param params  2D array (NxM) of item parameters, or ItemBank
+ * @param theta   a single ability estimate
+ * @param exclude Array of ItemBank indices, or mask of bank size, of items to skip (ItemBank only)
  *
  * @return object with "item", "test", and "sem" properties. Or a single "error" property
  */
-Module.FI_grm_expected_one = function(params, theta) {
+Module.FI_grm_expected_one = function(params, theta, exclude=null) {
+  if (params instanceof Module.ItemBank) {
+    return FI_bank_expected_one(params, theta, exclude, 'grm');
+  }
   if (!(Array.isArray(params) && params.length)) {
     return {
       error: 'params must be a non-empty array'
@@ -337,26 +1294,15 @@ Module.FI_grm_expected_one = function(params, theta) {
 };
 
 /**
- * Attempt to classify responses to a BRM model of 2 categories, or a GRM model of N categories using the generalized likelihood ratio
- *
- * options defaults:
- *  {
- *      range:      [-4.5, 4.5], // range of theta values to analyze
- *      bounds:     [-1, 1],     // likelihood boundaries for GRM (size N-1) (default [0] for BRM)
- *      categories: [0, 1, 2],   // category labels that will be returned (size N) (BRM only considers first 2 categories)
- *      delta:      0.1,         // defines size of indifference region
- *      alpha:      0.05,        // controls upper and lower likelihood threshold
- *      beta:       0.05         // controls upper and lower likelihood threshold
- *  }
+ * Check the arguments of termGLR_one and termGLR_batch
  *
- * @param params  2D array (NxM) of item parameters
- * @param resp    Array of N response values ranging from (1 to M)
+ * @param params  2D array (NxM) of item parameters, or ItemBank
  * @param model   'brm' or 'grm'
- * @param options Options object (see description above)
+ * @param options Options object (see termGLR_one)
  *
- * @return \{category, likratio\}, \{error\} OR NULL if unable to classify
+ * @return options with defaults filled in. Or a single "error" property
  */
-Module.termGLR_one = function(params, resp, model, options={}) {
+function termGLR_options(params, model, options) {
   const defaults = {
     range: [-4.5, 4.5],
     bounds: (model === 'brm' ? [0] : [-1, 1]),
@@ -367,10 +1313,6 @@ Module.termGLR_one = function(params, resp, model, options={}) {
   };
   options = Object.assign({}, defaults, options);
 
-  //
-  // Argument checks
-  //
-
   // validate model
   if (!(model === 'brm' || model === 'grm')) {
     return {
@@ -378,31 +1320,35 @@ Module.termGLR_one = function(params, resp, model, options={}) {
     };
   }
   // validate params
-  if (!(Array.isArray(params) && params.length && Array.isArray(params[0]))) {
-    return {
-      error: 'params must be a non-empty 2-D array'
-    };
-  }
-  if ((model === 'brm') && !(params[0].length === 3)) {
-    return {
-      error: 'params must have length 3 for brm model'
-    };
-  }
-  if ((model === 'grm') && !(params[0].length > 1)) {
-    return {
-      error: 'params must have length greater than 1 for grm model'
-    };
-  }
-  // validate resp
-  if (!(Array.isArray(resp) && resp.length === params.length)) {
-    return {
-      error: 'length of resp must match length of params'
-    };
+  let cols;
+  if (params instanceof Module.ItemBank) {
+    if (params.model() !== (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM)) {
+      return {
+        error: `item bank model must be ${model}`
+      };
+    }
+    cols = (model === 'brm' ? 3 : params.categories());
   }
-  for (let i = 0; i < resp.length; i++) {
-    if (!(typeof resp[i] === 'number')) {
+  else {
+    if (!(Array.isArray(params) && params.length && Array.isArray(params[0]))) {
       return {
-        error: 'resp has non-numeric elements'
+        error: 'params must be a non-empty 2-D array'
+      };
+    }
+    cols = params[0].length;
+    if ((model === 'brm') && !(cols === 3)) {
+      return {
+        error: 'params must have length 3 for brm model'
+      };
+    }
+    if ((model === 'grm') && !(cols > 1)) {
+      return {
+        error: 'params must have length greater than 1 for grm model'
+      };
+    }
+    if (!params.every(p => (Array.isArray(p) && p.length === cols && p.every(x => (typeof x === 'number' && Number.isFinite(x)))))) {
+      return {
+        error: 'params must be finite numbers of the same length for every item'
       };
     }
   }
@@ -412,12 +1358,7 @@ Module.termGLR_one = function(params, resp, model, options={}) {
       error: 'invalid range option'
     };
   }
-  if (model === 'brm' && !(Array.isArray(options.bounds) && options.bounds.length === 1)) {
-    return {
-      error: 'invalid bounds option'
-    };
-  }
-  if (model === 'grm' && !(Array.isArray(options.bounds) && options.bounds.length === params[0].length - 1)) {
+  if (!(Array.isArray(options.bounds) && options.bounds.length === (model === 'brm' ? 1 : cols - 1) && options.bounds.every(Number.isFinite))) {
     return {
       error: 'invalid bounds option'
     };
@@ -427,7 +1368,7 @@ Module.termGLR_one = function(params, resp, model, options={}) {
       error: 'invalid categories option for brm model'
     };
   }
-  if (model === 'grm' && !(Array.isArray(options.categories) && options.categories.length === params[0].length)) {
+  if (model === 'grm' && !(Array.isArray(options.categories) && options.categories.length === cols)) {
     return {
       error: 'invalid categories option for grm model'
     };
@@ -448,72 +1389,142 @@ Module.termGLR_one = function(params, resp, model, options={}) {
     };
   }
 
-  // filter out non-finite responses and corresponding params
-  const sel = resp.map((r) => Number.isFinite(r));
-  resp = resp.filter((_, idx) => sel[idx]);
-  params = params.filter((_, idx) => sel[idx]);
-
-  if (resp.length === 0) {
-    return {
-      category: null,
-      likratio: NaN
-    };
-  }
+  return options;
+}
 
-  const c_lower = Math.log( options.beta / (1 - options.alpha) );
-  const c_upper = Math.log( (1 - options.beta) / options.alpha );
+/**
+ * Classify the rows of a row-major response Float64Array natively (arguments already checked)
+ *
+ * @param params  2D array (NxM) of item parameters, or ItemBank
+ * @param flat    Float64Array of rows * M responses, NaN if not administered
+ * @param rows    Number of people
+ * @param model   'brm' or 'grm'
+ * @param options Checked options (see termGLR_options)
+ *
+ * @return object with "category" (Int32Array, -1 if not classified) and "likratio" (Float64Array, rows x bounds) properties
+ */
+function termGLR_flat(params, flat, rows, model, options) {
+  const o = options;
 
-  // get likVals for points surrounding the cutpoint
-  const theta = [];
-  for (let t = options.range[0]; t <= options.range[1]; t += 0.01) {
-    theta.push(t);
+  if (params instanceof Module.ItemBank) {
+    return Module.wasm_ItemBank_termGLR(params, flat, rows, o.range[0], o.range[1], o.bounds, o.delta, o.alpha, o.beta);
   }
 
-  const mResp = Module.MatrixFromArray([resp]);
   const mParams = Module.MatrixFromArray(params);
-  const mTheta = Module.MatrixFromArray([theta]);
+  const type = (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM);
+  const res = Module.wasm_termGLR(flat, rows, mParams, type, o.range[0], o.range[1], o.bounds, o.delta, o.alpha, o.beta);
 
-  let res;
-  if (model === 'grm') {
-    res = Module.wasm_logLik_grm(mResp, mTheta, mParams, Module.LogLikType.MLE);
-  }
-  else {
-    res = Module.wasm_logLik_brm(mResp, mTheta, mParams, Module.LogLikType.MLE);
-  }
-
-  const likVals = Module.VectorToArray(res);
-
-  mResp.delete();
+  // cleanup wasm heap
   mParams.delete();
-  mTheta.delete();
-  res.delete();
 
-  // find the highest point on the likelihood ratiofunction
-  const likRat = [];
-  for (let k = 0; k < options.bounds.length; k++) {
-    // Find the likelihood based on the indifference region
-    const u = Math.max(...likVals.filter((v, i) => (theta[i] > options.bounds[k] + options.delta)));
-    const l = Math.max(...likVals.filter((v, i) => (theta[i] < options.bounds[k] - options.delta)));
+  return res;
+}
 
-    // standard likelihood ratio
-    likRat[k] = u - l;
+/**
+ * Attempt to classify responses to a BRM model of 2 categories, or a GRM model of N categories using the generalized likelihood ratio
+ *
+ * The log-likelihood is maximised over the points of a 0.01 step grid of the range on each side
+ * of the indifference region of every bound, searched coarse-to-fine in WebAssembly.
+ *
+ * options defaults:
+ *  {
+ *      range:      [-4.5, 4.5], // range of theta values to analyze
+ *      bounds:     [-1, 1],     // likelihood boundaries for GRM (size N-1) (default [0] for BRM)
+ *      categories: [0, 1, 2],   // category labels that will be returned (size N) (BRM only considers first 2 categories)
+ *      delta:      0.1,         // defines size of indifference region
+ *      alpha:      0.05,        // controls upper and lower likelihood threshold
+ *      beta:       0.05         // controls upper and lower likelihood threshold
+ *  }
+ *
+ * params may also be an ItemBank (see createItemBank): resp then has one entry per bank item
+ * (NaN if not administered).
+ *
+ * @param params  2D array (NxM) of item parameters, or ItemBank
+ * @param resp    Array of N response values ranging from (1 to M)
+ * @param model   'brm' or 'grm'
+ * @param options Options object (see description above)
+ *
+ * @return \{category, likratio\}, \{error\} OR NULL if unable to classify
+ */
+Module.termGLR_one = function(params, resp, model, options={}) {
+  options = termGLR_options(params, model, options);
+  if (options.error) {
+    return options;
   }
-  likRat.unshift(c_upper + 0.000001);
-  likRat.push(c_lower - 0.000001);
 
-  // test each category
-  for (let k = 0; k < options.bounds.length + 1; k++) {
-    if ((likRat[k] >= c_upper) && (likRat[k+1] <= c_lower)) {
+  // validate resp
+  const n = (params instanceof Module.ItemBank ? params.size() : params.length);
+  if (!(Array.isArray(resp) && resp.length === n)) {
+    return {
+      error: 'length of resp must match length of params'
+    };
+  }
+  for (let i = 0; i < resp.length; i++) {
+    if (!(typeof resp[i] === 'number')) {
       return {
-        category: options.categories[k],
-        likratio: (model === 'brm' ? likRat[1] : NaN)
+        error: 'resp has non-numeric elements'
       };
     }
   }
 
+  const res = termGLR_flat(params, Float64Array.from(resp), 1, model, options);
+  const k = res.category[0];
+
+  return {
+    category: (k < 0 ? null : options.categories[k]),
+    likratio: (model === 'brm' ? res.likratio[0] : NaN)
+  };
+};
+
+/**
+ * Classify many people at once using the generalized likelihood ratio (see termGLR_one)
+ *
+ * Each row holds the responses of one person to all items, NaN for items that were not
+ * administered. The people are split across threads in the pthreads build.
+ *
+ * @param params  2D array (NxM) of item parameters, or ItemBank
+ * @param resp    2D array (P x N) of responses, or row-major Float64Array of P * N responses
+ * @param model   'brm' or 'grm'
+ * @param options Options object (see termGLR_one)
+ *
+ * @return object with "category" (array of P category labels, null if unable to classify) and
+ *         "likratio" (Float64Array of P x bounds likelihood ratios, row-major) properties. Or a single "error" property
+ */
+Module.termGLR_batch = function(params, resp, model, options={}) {
+  options = termGLR_options(params, model, options);
+  if (options.error) {
+    return options;
+  }
+
+  const cols = (params instanceof Module.ItemBank ? params.size() : params.length);
+  let flat;
+  if (resp instanceof Float64Array && resp.length % cols === 0) {
+    flat = resp;
+  }
+  else if (Array.isArray(resp) && resp.every(r => ((Array.isArray(r) || ArrayBuffer.isView(r)) && r.length === cols))) {
+    flat = new Float64Array(resp.length * cols);
+    for (let i = 0; i < resp.length; i++) {
+      for (let j = 0; j < cols; j++) {
+        if (typeof resp[i][j] !== 'number') {
+          return {
+            error: 'resp has non-numeric elements'
+          };
+        }
+      }
+      flat.set(resp[i], i * cols);
+    }
+  }
+  else {
+    return {
+      error: 'resp must be a 2D array or Float64Array with one column per item'
+    };
+  }
+
+  const res = termGLR_flat(params, flat, flat.length / cols, model, options);
+
   return {
-    category: null,
-    likratio: (model === 'brm' ? likRat[1] : NaN)
+    category: Array.from(res.category, k => (k < 0 ? null : options.categories[k])),
+    likratio: res.likratio
   };
 };
 
@@ -549,6 +1560,127 @@ if (typeof Array.prototype.shuffle === 'undefined') {
   });
 }
 
+/**
+ * Choose items by a posterior-weighted criterion (see itChoose)
+ *
+ * @param from_items Array of item objects to choose from, or ItemBank
+ * @param bank       from_items if an ItemBank, else null
+ * @param model      'brm' or 'grm'
+ * @param select     'PW-FI' or 'PW-KL'
+ * @param theta      Ability estimate of 'PW-KL'
+ * @param options    Validated itChoose options
+ *
+ * @return Object with 'items' array or 'error' string
+ */
+function itChoose_posterior(from_items, bank, model, select, theta, options) {
+  const spec = {
+    quad: (options.quad === null ? 33 : options.quad),
+    range: (options.range === null ? [-4.5, 4.5] : options.range),
+    ddist: options.ddist
+  };
+  const type = (select === 'PW-FI' ? Module.SelectType.PW_FI : Module.SelectType.PW_KL);
+  const first = (model === 'brm' ? 0 : 1);
+  let error = null;
+
+  // responses must be categories of the model (NaN if not administered)
+  const valid = function(resp, K) {
+    return Array.from(resp).every(u => (Number.isNaN(u) || (Number.isInteger(u) && u >= first && u < first + K)));
+  };
+
+  // item bank: the table is resident, only the responses are passed
+  if (bank !== null) {
+    const n = bank.size();
+    const resp = (options.cat_resp === null ? new Float64Array(n).fill(NaN) : options.cat_resp);
+    if (!((Array.isArray(resp) || ArrayBuffer.isView(resp)) && resp.length === n && valid(resp, bank.categories()))) {
+      return {
+        error: `"cat_resp" must have one response (or NaN) per item bank item`
+      };
+    }
+    const mask = Module.getExcludeMask(bank, options.exclude);
+    if (mask === null) {
+      return {
+        error: `"exclude" must be null, an array of item bank indices, or a mask of item bank size`
+      };
+    }
+    if ((error = build_quad_table(bank, spec))) {
+      return error;
+    }
+    if (options.seed !== null) {
+      bank.seed(options.seed >>> 0);
+    }
+
+    // never choose an answered item
+    const exclude = (mask.length ? mask : new Uint8Array(n));
+    for (let j = 0; j < n; j++) {
+      exclude[j] |= !Number.isNaN(resp[j]);
+    }
+
+    const chosen = Module.wasm_ItemBank_itChoose_posterior(bank, type, theta, Float64Array.from(resp), exclude, options.n_select, options.numb);
+    const selected_items = [];
+    for (let i = 0; i < chosen.items.length; i++) {
+      const index = chosen.items[i];
+      selected_items.push({
+        id: (bank.items ? bank.items[index].id : bank.id(index)),
+        params: (bank.items ? bank.items[index].params : undefined),
+        info: chosen.info[i],
+        index: index
+      });
+    }
+
+    return {
+      items: selected_items
+    };
+  }
+
+  // item arrays: tabulate a temporary bank of the candidates followed by the administered items
+  const cat_par = (options.cat_par === null ? [] : options.cat_par);
+  const cat_resp = (options.cat_resp === null ? [] : options.cat_resp);
+  const cols = from_items[0].params.length;
+  if (!(Array.isArray(cat_par) && cat_par.every(p => (Array.isArray(p) && p.length === cols)))) {
+    return {
+      error: `"cat_par" must be null or an array of params of the same length as "from_items" params`
+    };
+  }
+  if (!((Array.isArray(cat_resp) || ArrayBuffer.isView(cat_resp)) && cat_resp.length === cat_par.length && valid(cat_resp, (model === 'brm' ? 2 : cols)))) {
+    return {
+      error: `"cat_resp" must have one response per "cat_par" item`
+    };
+  }
+
+  const items = from_items.concat(cat_par.map(params => ({params: params})));
+  const temp = Module.createItemBank(items, model);
+  if (temp.error) {
+    return temp;
+  }
+
+  const resp = new Float64Array(items.length).fill(NaN);
+  resp.set(cat_resp, from_items.length);
+  const exclude = new Uint8Array(items.length).fill(1, from_items.length);
+
+  let chosen = null;
+  if (!(error = build_quad_table(temp, spec))) {
+    chosen = Module.wasm_ItemBank_itChoose_posterior(temp, type, theta, resp, exclude, from_items.length, from_items.length);
+  }
+  temp.delete();
+  if (error) {
+    return error;
+  }
+
+  // same sort and random pick as the UW-FI arrays
+  const info_sort = Array.from(chosen.items, (index, i) => ({info: chosen.info[i], index: index}));
+  const top_items = info_sort.slice(0, options.n_select).map(o => {
+    return {
+      id: from_items[o.index].id,
+      params: from_items[o.index].params,
+      info: o.info
+    };
+  });
+
+  return {
+    items: top_items.shuffle().slice(0, options.numb)
+  };
+}
+
 /**
  * Choose optimal item(s) for test administration
  *
@@ -556,12 +1688,32 @@ if (typeof Array.prototype.shuffle === 'undefined') {
  *  {
  *      numb:     1,    // number of items to randomly select from top N
  *      n_select: 1,    // top N items to consider
- *      cat_theta: null // estimated ability of respondant
+ *      cat_theta: null, // estimated ability of respondant
+ *      cat_par: null,   // "PW-FI"/"PW-KL" without an ItemBank: 2D array of the parameters of the administered items
+ *      cat_resp: null,  // "PW-FI"/"PW-KL": responses to cat_par, or to all bank items (NaN if not administered) with an ItemBank
+ *      range: null,     // "PW-FI"/"PW-KL": first and last quadrature node (default [-4.5, 4.5])
+ *      quad: null,      // "PW-FI"/"PW-KL": number of equally spaced quadrature nodes (default 33)
+ *      ddist: null,     // "PW-FI"/"PW-KL": prior, a density function of theta or {mean, sd} (default standard normal)
+ *      exclude: null,   // ItemBank only: array of item indices, or mask of bank size, of items not to choose
+ *      seed: null       // ItemBank only: reseed the bank's random generator before choosing
  *  }
  *
- * @param from_items Array of item objects to choose from (with id and params properties)
+ * from_items may also be an ItemBank (see createItemBank): items are then chosen natively from
+ * the bank items not excluded (partial top-N selection and a seedable random pick), and returned
+ * with their bank "index". For "UW-FI-Modified", "phase1_params" must then be an ItemBank of
+ * the same items.
+ *
+ * "PW-FI" (posterior-weighted Fisher information) and "PW-KL" (posterior-weighted
+ * Kullback-Leibler information at cat_theta) weight each item by the posterior of the responses
+ * so far at fixed quadrature nodes. The item probabilities and information at the nodes are
+ * tabulated once per bank (see the quad_table option of createItemBank; the table is rebuilt
+ * only when range, quad, or ddist change), so each choice costs about as much as "UW-FI". Bank
+ * items answered in cat_resp are never chosen. Without an ItemBank, a temporary bank of
+ * from_items and cat_par is tabulated on every call.
+ *
+ * @param from_items Array of item objects to choose from (with id and params properties), or ItemBank
  * @param model      'brm' or 'grm'
- * @param select     Item information function type. Currently only 'UW-FI' is supported
+ * @param select     Item selection criterion: 'UW-FI', 'UW-FI-Modified' (brm only), 'PW-FI', or 'PW-KL'
  * @param at         Item selection parameter. Currently only 'theta' is supported.
  *
  * @return Object with 'items' array or 'error' string
@@ -580,9 +1732,12 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
     phase1_est_theta: null,
     phase1_params: null,
     ddist: null,
-    quad: null
+    quad: null,
+    exclude: null,
+    seed: null
   };
   options = Object.assign({}, defaults, options);
+  const bank = (from_items instanceof Module.ItemBank) ? from_items : null;
 
   //
   // Argument checks
@@ -596,29 +1751,39 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
   }
 
   // validate from_items
-  if (!(Array.isArray(from_items) && from_items.length > 0)) {
-    return {
-      error: `"from_items" must be a non-empty array`
-    };
-  }
-  if (!(typeof from_items[0] === 'object' && Array.isArray(from_items[0].params))) {
-    return {
-      error: `"from_items" entries must be objects with params array`
-    };
-  }
-  if ((model === 'brm') && !(from_items[0].params.length === 3)) {
-    return {
-      error: `"from_items" params must have length 3 for brm model`
-    };
+  if (bank !== null) {
+    if (bank.model() !== (model === 'brm' ? Module.ModelType.BRM : Module.ModelType.GRM)) {
+      return {
+        error: `"from_items" item bank model must be ${model}`
+      };
+    }
   }
-  if ((model === 'grm') && !(from_items[0].params.length > 1)) {
-    return {
-      error: `"from_items" params must have length greater than 1 for grm model`
-    };
+  else {
+    if (!(Array.isArray(from_items) && from_items.length > 0)) {
+      return {
+        error: `"from_items" must be a non-empty array`
+      };
+    }
+    if (!(typeof from_items[0] === 'object' && Array.isArray(from_items[0].params))) {
+      return {
+        error: `"from_items" entries must be objects with params array`
+      };
+    }
+    if ((model === 'brm') && !(from_items[0].params.length === 3)) {
+      return {
+        error: `"from_items" params must have length 3 for brm model`
+      };
+    }
+    if ((model === 'grm') && !(from_items[0].params.length > 1)) {
+      return {
+        error: `"from_items" params must have length greater than 1 for grm model`
+      };
+    }
   }
 
   // validate select
-  if (!(select === 'UW-FI' || select === 'UW-FI-Modified')) {
+  const posterior = (select === 'PW-FI' || select === 'PW-KL');
+  if (!(select === 'UW-FI' || select === 'UW-FI-Modified' || posterior)) {
     return {
       error: `Invalid or unsupported "select" provided: "${select}"`
     };
@@ -647,12 +1812,12 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
       error: `"n_select" must be be an integer greater than 0`
     };
   }
-  if (!(options.cat_par === null)) {
+  if (!(options.cat_par === null || (posterior && bank === null))) {
     return {
       error: `non-null "cat_par" not used`
     };
   }
-  if (!(options.cat_resp === null)) {
+  if (!(options.cat_resp === null || posterior)) {
     return {
       error: `non-null "cat_resp" not used`
     };
@@ -662,7 +1827,7 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
       error: `"cat_theta" must be finite or null`
     };
   }
-  if (!(options.range === null)) {
+  if (!(options.range === null || posterior)) {
     return {
       error: `"range" not used`
     };
@@ -687,7 +1852,14 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
       error: `"phase1_est_theta" must be finite or null`
     };
   }
-  if (!(options.phase1_params === null || (Array.isArray(options.phase1_params) && options.phase1_params.length === from_items.length))) {
+  if (bank !== null) {
+    if (!(options.phase1_params === null || (options.phase1_params instanceof Module.ItemBank && options.phase1_params.size() === bank.size()))) {
+      return {
+        error: `"phase1_params" must be null or item bank of size matching "from_items"`
+      };
+    }
+  }
+  else if (!(options.phase1_params === null || (Array.isArray(options.phase1_params) && options.phase1_params.length === from_items.length))) {
     return {
       error: `"phase1_params" must be null or array of length matching "from_items"`
     };
@@ -697,16 +1869,26 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
       error: `"phase1_est_theta" and "phase1_params" required for "${select}" select mode`
     };
   }
-  if (!(options.ddist === null)) {
+  if (!(options.ddist === null || posterior)) {
     return {
       error: `non-null "ddist" not used`
     };
   }
-  if (!(options.quad === null)) {
+  if (!(options.quad === null || posterior)) {
     return {
       error: `non-null "quad" not used`
     };
   }
+  if (!(options.exclude === null || bank !== null)) {
+    return {
+      error: `"exclude" is only supported with an item bank`
+    };
+  }
+  if (!(options.seed === null || (bank !== null && Number.isInteger(options.seed) && options.seed >= 0))) {
+    return {
+      error: `"seed" must be null or a non-negative integer, and is only supported with an item bank`
+    };
+  }
 
   //
   // Calculate item info
@@ -715,6 +1897,46 @@ Module.itChoose = function(from_items, model, select, at, options={}) {
   const theta = (options.cat_theta || 0);
   let item_info = [];
 
+  if (posterior) {
+    return itChoose_posterior(from_items, bank, model, select, theta, options);
+  }
+
+  // item bank: information, exclusion, top-N selection and random pick all run natively
+  if (bank !== null) {
+    const mask = Module.getExcludeMask(bank, options.exclude);
+    if (mask === null) {
+      return {
+        error: `"exclude" must be null, an array of item bank indices, or a mask of item bank size`
+      };
+    }
+    if (options.seed !== null) {
+      bank.seed(options.seed >>> 0);
+    }
+
+    let chosen;
+    if (select === 'UW-FI') {
+      chosen = Module.wasm_ItemBank_itChoose(bank, theta, mask, options.n_select, options.numb);
+    }
+    else {
+      chosen = Module.wasm_ItemBank_itChoose_modified(bank, theta, options.phase1_params, options.phase1_est_theta, mask, options.n_select, options.numb);
+    }
+
+    const selected_items = [];
+    for (let i = 0; i < chosen.items.length; i++) {
+      const index = chosen.items[i];
+      selected_items.push({
+        id: (bank.items ? bank.items[index].id : bank.id(index)),
+        params: (bank.items ? bank.items[index].params : undefined),
+        info: chosen.info[i],
+        index: index
+      });
+    }
+
+    return {
+      items: selected_items
+    };
+  }
+
   if (select === 'UW-FI') {
     if (model === 'brm') {
       item_info = Module.FI_brm_expected_one(from_items.map(item => item.params), theta)['item'];
@@ -0,0 +1,308 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "itembank.h"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CATIRT_MMAP 1
+#endif
+
+// the parameter and table blocks are copied as is: little-endian hosts only (x86, ARM, wasm)
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "the binary item bank format requires a little-endian host"
+#endif
+
+static const int TABLE_HEADER = 40;   // info table section header
+
+/**MDJAVADOC_SKIP
+ * Little-endian fields of the binary bank format, in place
+ */
+static void set_u32(uint8_t *p, uint32_t v)
+{
+  for (int k = 0; k < 4; k++) {
+    p[k] = (uint8_t)(v >> (8 * k));
+  }
+}
+
+static void set_u64(uint8_t *p, uint64_t v)
+{
+  for (int k = 0; k < 8; k++) {
+    p[k] = (uint8_t)(v >> (8 * k));
+  }
+}
+
+static void set_f64(uint8_t *p, double x)
+{
+  uint64_t v;
+  memcpy(&v, &x, sizeof(v));
+  set_u64(p, v);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+  return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static double get_f64(const uint8_t *p)
+{
+  uint64_t v = get_u64(p);
+  double x;
+  memcpy(&x, &v, sizeof(x));
+  return x;
+}
+
+static size_t pad8(size_t n)
+{
+  return (n + 7) & ~(size_t)7;
+}
+
+/**MDJAVADOC_SKIP
+ * Write the bank in the binary item bank format
+ *
+ * Layout (little-endian, every section 8-byte aligned so the blocks can be used in place):
+ *   header (BINARY_HEADER bytes): magic (u32), version (u8), model (u8: 0 BRM, 1 GRM),
+ *     precision (u8: 0 float64, 1 float32), reserved (u8), M (u32), K (u32), total size (u64),
+ *     ids offset and size (u64 each), info table offset and size (u64 each, 0 if absent), reserved (u64)
+ *   parameters: M x K doubles, column-major (each parameter of consecutive items contiguous)
+ *   ids: M + 1 string offsets (u32) then the UTF-8 bytes of the ids, padded to 8 bytes
+ *   info table: interp (u8: 0 linear, 1 cubic), reserved (3 bytes), intervals (u32), lower, upper,
+ *     max error, tol (f64 each), then the (intervals + 3) x M row-major nodes as double or float
+ *     by precision, padded to 8 bytes
+ *
+ * @return blob of the bank
+ */
+std::vector<uint8_t> ItemBank::serialize() const
+{
+  const size_t M = size();
+  const size_t K = params_.cols();
+  const size_t params_bytes = M * K * sizeof(double);
+  size_t ids_bytes = 0;
+  size_t table_bytes = 0;
+
+  if (!ids_.empty()) {
+    size_t chars = 0;
+    for (const std::string& id : ids_) {
+      chars += id.size();
+    }
+    if (chars > UINT32_MAX) {
+      throw "ItemBank serialize item ids too long";
+    }
+    ids_bytes = pad8(4 * (M + 1) + chars);
+  }
+  if (table_) {
+    table_bytes = pad8(TABLE_HEADER + table_->bytes());
+  }
+
+  const size_t ids_at = BINARY_HEADER + params_bytes;
+  const size_t table_at = ids_at + ids_bytes;
+  std::vector<uint8_t> out(table_at + table_bytes, 0);
+  uint8_t *p = out.data();
+
+  set_u32(p, BINARY_MAGIC);
+  p[4] = BINARY_VERSION;
+  p[5] = (model_ == ModelType::BRM ? 0 : 1);
+  p[6] = (precision_ == Precision::FLOAT32 ? 1 : 0);
+  set_u32(p + 8, M);
+  set_u32(p + 12, K);
+  set_u64(p + 16, out.size());
+  set_u64(p + 24, ids_bytes ? ids_at : 0);
+  set_u64(p + 32, ids_bytes);
+  set_u64(p + 40, table_bytes ? table_at : 0);
+  set_u64(p + 48, table_bytes);
+
+  memcpy(p + BINARY_HEADER, params_.data(), params_bytes);
+
+  if (ids_bytes) {
+    uint8_t *chars = p + ids_at + 4 * (M + 1);
+    uint32_t offset = 0;
+    for (size_t j = 0; j < M; j++) {
+      set_u32(p + ids_at + 4 * j, offset);
+      memcpy(chars + offset, ids_[j].data(), ids_[j].size());
+      offset += ids_[j].size();
+    }
+    set_u32(p + ids_at + 4 * M, offset);
+  }
+
+  if (table_bytes) {
+    uint8_t *t = p + table_at;
+    t[0] = (table_->interp() == InterpType::CUBIC ? 1 : 0);
+    set_u32(t + 4, table_->intervals());
+    set_f64(t + 8, table_->lower());
+    set_f64(t + 16, table_->upper());
+    set_f64(t + 24, table_->max_error());
+    set_f64(t + 32, table_tol_);
+    memcpy(t + TABLE_HEADER, table_->node_bytes(), table_->bytes());
+  }
+
+  return out;
+}
+
+/**MDJAVADOC_SKIP
+ * Replace the bank with one in the binary item bank format, leaving it unchanged on error
+ *
+ * The parameters are used in place when data is 8-byte aligned (e.g. a mapped file or a
+ * malloc'd buffer), so each block is copied once, into the bank.
+ *
+ * @param data        Output of serialize()
+ * @param size        Number of bytes of data
+ *
+ * @return error message, or nullptr if the bank was loaded
+ */
+const char *ItemBank::tryDeserialize(const uint8_t *data, size_t size)
+{
+  if (size < (size_t)BINARY_HEADER || get_u32(data) != BINARY_MAGIC) {
+    return "ItemBank deserialize not a binary item bank";
+  }
+  if (data[4] != BINARY_VERSION) {
+    return "ItemBank deserialize unsupported version";
+  }
+  if (data[5] > 1 || data[6] > 1) {
+    return "ItemBank deserialize unsupported model or precision";
+  }
+
+  const uint64_t M = get_u32(data + 8);
+  const uint64_t K = get_u32(data + 12);
+  const uint64_t ids_at = get_u64(data + 24), ids_bytes = get_u64(data + 32);
+  const uint64_t table_at = get_u64(data + 40), table_bytes = get_u64(data + 48);
+  const ModelType model = (data[5] == 0 ? ModelType::BRM : ModelType::GRM);
+  const Precision precision = (data[6] == 0 ? Precision::FLOAT64 : Precision::FLOAT32);
+
+  if (get_u64(data + 16) != size || M * K > (size - BINARY_HEADER) / sizeof(double)) {
+    return "ItemBank deserialize length mismatch";
+  }
+
+  // optional sections lie after the parameters, within the blob
+  const uint64_t params_end = BINARY_HEADER + M * K * sizeof(double);
+  auto section = [&](uint64_t at, uint64_t bytes) {
+    return bytes == 0 || (at % 8 == 0 && at >= params_end && at <= size && bytes <= size - at);
+  };
+  if (!section(ids_at, ids_bytes) || !section(table_at, table_bytes)) {
+    return "ItemBank deserialize length mismatch";
+  }
+
+  std::vector<std::string> ids;
+  if (ids_bytes) {
+    const uint8_t *offsets = data + ids_at;
+    const char *chars = reinterpret_cast<const char *>(offsets + 4 * (M + 1));
+
+    if (4 * (M + 1) > ids_bytes || get_u32(offsets + 4 * M) > ids_bytes - 4 * (M + 1)) {
+      return "ItemBank deserialize invalid ids";
+    }
+    ids.reserve(M);
+    for (uint64_t j = 0; j < M; j++) {
+      uint32_t begin = get_u32(offsets + 4 * j);
+      uint32_t end = get_u32(offsets + 4 * (j + 1));
+      if (begin > end) {
+        return "ItemBank deserialize invalid ids";
+      }
+      ids.emplace_back(chars + begin, end - begin);
+    }
+  }
+
+  const uint8_t *block = data + BINARY_HEADER;
+  ArrayXXd aligned;
+  if (reinterpret_cast<uintptr_t>(block) % alignof(double) != 0) {
+    aligned.resize(M, K);
+    memcpy(aligned.data(), block, aligned.size() * sizeof(double));
+    block = reinterpret_cast<const uint8_t *>(aligned.data());
+  }
+
+  ItemBank restored;
+  try {
+    restored = ItemBank(Eigen::Map<const ArrayXXd>(reinterpret_cast<const double *>(block), M, K), model, ids);
+  } catch (const char *error) {
+    return error;
+  }
+
+  if (precision == Precision::FLOAT32) {
+    restored.precision_ = precision;
+    restored.params_f_ = restored.params_.cast<float>();
+  }
+
+  if (table_bytes) {
+    const uint8_t *t = data + table_at;
+    const uint64_t n_int = (table_bytes >= TABLE_HEADER ? get_u32(t + 4) : 0);
+    const size_t value = (precision == Precision::FLOAT32 ? sizeof(float) : sizeof(double));
+
+    if (n_int == 0 || t[0] > 1 || (n_int + 3) * M > (table_bytes - TABLE_HEADER) / value) {
+      return "ItemBank deserialize invalid info table";
+    }
+    try {
+      restored.table_ = std::make_shared<const InfoTable>(restored.params_, model, (t[0] ? InterpType::CUBIC : InterpType::LINEAR), precision,
+                                                          get_f64(t + 8), get_f64(t + 16), (int)n_int, get_f64(t + 24), t + TABLE_HEADER);
+    } catch (const char *error) {
+      return error;
+    }
+    restored.table_tol_ = get_f64(t + 32);
+  }
+
+  *this = std::move(restored);
+  return nullptr;
+}
+
+/**MDJAVADOC_SKIP
+ * Replace the bank with one in the binary item bank format
+ *
+ * @param data        Output of serialize()
+ * @param size        Number of bytes of data
+ */
+void ItemBank::deserialize(const uint8_t *data, size_t size)
+{
+  const char *error = tryDeserialize(data, size);
+
+  if (error) {
+    throw error;
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Replace the bank with a binary item bank file, memory-mapped where supported (read otherwise)
+ *
+ * @param path        File written from serialize()
+ */
+void ItemBank::deserializeFile(const std::string& path)
+{
+  const char *error;
+
+#ifdef CATIRT_MMAP
+  int fd = open(path.c_str(), O_RDONLY);
+  struct stat st;
+
+  if (fd < 0) {
+    throw "ItemBank deserializeFile cannot open file";
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < BINARY_HEADER) {
+    close(fd);
+    throw "ItemBank deserialize not a binary item bank";
+  }
+
+  void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    throw "ItemBank deserializeFile cannot map file";
+  }
+  error = tryDeserialize(static_cast<const uint8_t *>(map), st.st_size);
+  munmap(map, st.st_size);
+#else
+  std::ifstream in(path, std::ios::binary);
+
+  if (!in) {
+    throw "ItemBank deserializeFile cannot open file";
+  }
+  const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  error = tryDeserialize(data.data(), data.size());
+#endif
+
+  if (error) {
+    throw error;
+  }
+}
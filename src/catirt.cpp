@@ -1,394 +1,310 @@
-#include <Eigen/Core>
 #include <emscripten/bind.h>
-#include <cfloat>
-#include <cmath>
+#include <emscripten/heap.h>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "catirt.h"
+#include "itembank.h"
+#include "catsession.h"
+#include "catirt_stats.h"
 
-enum class LderType {
-    MLE,
-    WLE
-};
+using namespace emscripten;
 
-enum class FIType {
-    EXPECTED,
-    OBSERVED
-};
+using Vector = std::vector<double>;
 
-enum class LogLikType {
-    MLE,
-    BME
-};
+#if CATIRT_ENABLE_STATS
+// count the heap allocations of the module (Stat::ALLOCS, Stat::BYTES_ALLOCATED); operator new,
+// the embind vectors, and Eigen's temporaries all come through these. The C library's own entry
+// points do not call each other through malloc, so each one is replaced
+static void count_alloc(size_t size)
+{
+    stat_add(Stat::ALLOCS, 1);
+    stat_add(Stat::BYTES_ALLOCATED, size);
+}
 
-enum class ModelType {
-    BRM,
-    GRM
-};
+extern "C" void *malloc(size_t size)
+{
+    count_alloc(size);
+    return emscripten_builtin_malloc(size);
+}
 
-using namespace emscripten;
+extern "C" void *calloc(size_t n, size_t size)
+{
+    count_alloc(n * size);
+    return emscripten_builtin_calloc(n, size);
+}
 
-using Vector = std::vector<double>;
-using ArrayXd = Eigen::ArrayXd;
-using ArrayXXd = Eigen::ArrayXXd;
-using ArrayX3d = Eigen::ArrayX3d;
-using RowVector2d = Eigen::RowVector2d;
+// counted as a new allocation of the full size, whether or not the block moves
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    count_alloc(size);
+    return emscripten_builtin_realloc(ptr, size);
+}
 
-/**MDJAVADOC_SKIP
- * Generate the BRM item probability matrix for person(s) with given ability estimates
- *
- * Port of: p.brm.R
+extern "C" void *aligned_alloc(size_t alignment, size_t size)
+{
+    count_alloc(size);
+    return emscripten_builtin_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    count_alloc(size);
+    *ptr = emscripten_builtin_memalign(alignment, size);
+    return (*ptr || size == 0) ? 0 : ENOMEM;
+}
+#endif
+
+/*******************************************
  *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x 3 matrix)
+ * Begin JavaScript Bridge
  *
- * @return person/item probability matrix (N x M) for N people and M items
- */
-const ArrayXXd p_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params)
+ *******************************************/
+
+const Vector VectorFromMatrix( const Eigen::Ref<const ArrayXXd>& m )
+{
+    assert((m.rows() <= 1 || m.cols() <= 1) && "Matrix must be 0 or 1 dimensional");
+    Vector res;
+    CATIRT_STAT_ADD(Stat::BYTES_OUT, m.size() * sizeof(double));
+    for (int i = 0; i < m.rows(); i++) {
+        for (int j = 0; j < m.cols(); j++) {
+            res.push_back(m(i, j));
+        }
+    }
+    return res;
+}
+
+// copy of a JS array or typed array of numbers
+template <typename T>
+std::vector<T> VectorFromJS( const val &v )
 {
-  int n_ppl, n_it;   // for person and item counts
-  int i, j;          // for the loop iteration
-  double p_exp;      // for the exponent of the dimension probability
-  ArrayXXd P;        // for probability results
+    std::vector<T> res = convertJSArrayToNumberVector<T>(v);
+    CATIRT_STAT_ADD(Stat::BYTES_IN, res.size() * sizeof(T));
+    return res;
+}
 
-  // get dimensions of theta and params
-  n_ppl = theta.rows();
-  n_it  = params.rows();
+// copy of n numbers to a new typed array (Float64Array for double)
+template <typename T>
+val TypedArrayFromData( const T *data, size_t n )
+{
+    CATIRT_STAT_ADD(Stat::BYTES_OUT, n * sizeof(T));
+    return val(typed_memory_view(n, data)).call<val>("slice");
+}
 
-  // resize results
-  P.resize(n_ppl, n_it);
+// wrapper class for Eigen::Array to JS binding
+class JSMatrix {
+    using Mat = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vector = std::vector<double>;
+    using Vector2d = std::vector<std::vector<double>>;
 
-  // calculate probability of within categories
-  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
-  for ( i = 0; i < n_ppl; i++ ) {
-    for ( j = 0; j < n_it; j++ ) {
-      // calculating the probability of response for one person
-      p_exp = exp( -params(j, 0) * ( theta(i) - params(j, 1) ) );
+public:
+    Mat data;
 
-      P(i, j) = params(j, 2) + ( 1 - params(j, 2) ) / ( 1 + p_exp );
+    JSMatrix()
+    {
+        data = Mat();
     }
-  }
 
-  return P;
+    JSMatrix(int m, int n)
+    {
+        data = Mat::Zero(m, n);
+    }
+
+    JSMatrix(const Mat &_data) : data(_data)
+    {
+    }
+
+    JSMatrix(const JSMatrix &B) : data(B.copy())
+    {
+    }
+
+    Mat copy() const
+    {
+        return data;
+    }
+
+    const Mat &toEigen() const
+    {
+        return data;
+    }
+
+    int rows() const
+    {
+        return (int)data.rows();
+    }
+
+    int cols() const
+    {
+        return (int)data.cols();
+    }
+
+    double get(int i, int j) const
+    {
+        return data(i, j);
+    }
+
+    void set(int i, int j, const double &s)
+    {
+        data(i, j) = s;
+    }
+
+    static JSMatrix fromVector(const Vector2d &v)
+    {
+        const size_t m = v.size();
+        const size_t n = m > 0 ? v[0].size() : 0;
+        Mat mat(m, n);
+        CATIRT_STAT_ADD(Stat::BYTES_IN, m * n * sizeof(double));
+        for (size_t i = 0; i < m; i++) {
+            assert(v[i].size() == n && "All the rows must have the same size");
+            for (size_t j = 0; j < n; j++) {
+                mat(i, j) = v[i][j];
+            }
+        }
+        return mat;
+    }
+
+    // bulk copy of a row-major (m x n) Float64Array or array: no per-element crossing
+    static JSMatrix fromTypedArray(const val &v, int m, int n)
+    {
+        assert(m >= 0 && n >= 0 && v["length"].as<size_t>() == (size_t)m * n && "Length must be rows * cols");
+
+        // the column-major (n x m) storage of the transpose has the row-major layout of v
+        Mat t(n, m);
+        CATIRT_STAT_ADD(Stat::BYTES_IN, t.size() * sizeof(double));
+        val(typed_memory_view(t.size(), t.data())).call<void>("set", v);
+        return Mat(t.transpose());
+    }
+
+    // copy of a row-major (m x n) block of doubles already on the wasm heap (e.g. from Module._malloc)
+    static JSMatrix fromPointer(uintptr_t ptr, int m, int n)
+    {
+        CATIRT_STAT_ADD(Stat::BYTES_IN, (size_t)m * n * sizeof(double));
+        return Mat(Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(reinterpret_cast<const double *>(ptr), m, n));
+    }
+
+    // row-major copy to a new Float64Array
+    val toTypedArray() const
+    {
+        const Mat t = data.transpose();
+        return TypedArrayFromData(t.data(), t.size());
+    }
+};
+
+/**
+ * Generate the BRM item probability matrix for person(s) with given ability estimates
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x 3 matrix)
+ *
+ * @return person/item probability matrix (N x M) for N people and M items
+ */
+const JSMatrix wasm_p_brm(const JSMatrix *theta, const JSMatrix *params)
+{
+  return JSMatrix(p_brm(theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * Generate the item GRM probability matrix for person(s) with given ability estimates
  *
- * Port of: p.grm.R
- *
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x K matrix) where K is number of categories
  *
  * @return person/item probability matrix ((N*K) x M) for N people, K categories, and M items
  */
-const ArrayXXd p_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params)
-{
-  int n_ppl, n_it, n_cat;   // for person, item, and category counts
-  int i, j, k;              // for the loop iteration
-  double p_exp;             // for the exponent of the dimension probability
-  double p;                 // for the GRM probability of correct
-  ArrayXXd P;               // for the probability results
-
-  // get dimensions of theta and params
-  n_ppl = theta.rows();
-  n_it  = params.rows();
-  n_cat = params.cols();
-
-  // resize results
-  P.resize(n_ppl * n_cat, n_it);
-
-  // calculate probability of within categories
-  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
-  for ( i = 0; i < n_ppl; i++ ) {
-    for ( j = 0; j < n_it; j++ ) {
-      P((i * n_cat + 0), j) = 1;
-
-      for ( k = 0; k < n_cat - 1; k++ ) {
-        p_exp = exp( -params(j, 0) * (theta(i) - params(j, k + 1)) );
-        p     = 1 / ( 1 + p_exp );
-
-        P((i * n_cat + k + 1), j) = p;
-        P((i * n_cat + k), j)    -= p;
-      }
-    }
-  }
-
-  return P;
+const JSMatrix wasm_p_grm(const JSMatrix *theta, const JSMatrix *params)
+{
+  return JSMatrix(p_grm(theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * Derivative of the BRM item probability matrix for person(s) with given ability estimates
  *
- * Port of: pder1.brm.R
- *
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x 3 matrix)
  *
  * @return person/item derivative probability matrix (N x M) for N people and M items
  */
-const ArrayXXd pder1_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params)
-{
-  int n_ppl, n_it;   // for person and item counts
-  int i, j;          // for the loop iteration
-  double p_exp;      // for the exponent of the dimension probability
-  double p;          // for the 2PL probability of correct
-  ArrayXXd Pd1;      // for probability derivative results
-
-  // get dimensions of theta and params
-  n_ppl = theta.rows();
-  n_it  = params.rows();
-
-  // resize results
-  Pd1.resize(n_ppl, n_it);
-
-  // calculate derivative of probability of within categories
-  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
-  for ( i = 0; i < n_ppl; i++ ) {
-    for ( j = 0; j < n_it; j++ ) {
-      // calculating the derivative of the probability of response for one person
-      p_exp = exp( -params(j, 0) * ( theta(i) - params(j, 1) ) );
-      p     = 1 / ( 1 + p_exp );
-
-      Pd1(i, j) = ( 1 - params(j, 2) ) * params(j, 0) * p * ( 1 - p );
-    }
-  }
-
-  return Pd1;
+const JSMatrix wasm_pder1_brm(const JSMatrix *theta, const JSMatrix *params)
+{
+  return JSMatrix(pder1_brm(theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * Derivative of the GRM item probability matrix for person(s) with given ability estimates
  *
- * Port of: pder1.grm.R
- *
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x K matrix) where K is number of categories
  *
  * @return person/item derivative probability matrix ((N*K) x M) for N people, K categories, and M items
  */
-const ArrayXXd pder1_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params)
-{
-  int n_ppl, n_it, n_cat;   // for person, item, and category counts
-  int i, j, k;              // for the loop iteration
-  double p_exp;             // for the exponent of the dimension probability
-  double p, p_der1;         // for the GRM probability of correct
-  ArrayXXd Pd1;             // for probability derivative results
-
-  // get dimensions of theta and params
-  n_ppl = theta.rows();
-  n_it  = params.rows();
-  n_cat = params.cols();
-
-  // resize results
-  Pd1.resize((n_ppl * n_cat), n_it);
-
-  // calculate derivative of probability of within categories
-  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
-  for ( i = 0; i < n_ppl; i++ ) {
-    for ( j = 0; j < n_it; j++ ) {
-      Pd1((i * n_cat + 0), j) = 0;
-
-      for ( k = 0; k < n_cat - 1; k++ ) {
-        p_exp  = exp( -params(j, 0) * (theta(i) - params(j, k + 1)) );
-        p      = 1 / ( 1 + p_exp );
-        p_der1 = params(j, 0) * p * ( 1 - p );
-
-        Pd1((i * n_cat + k + 1), j) = p_der1;
-        Pd1((i * n_cat + k), j)    -= p_der1;
-      }
-    }
-  }
-
-  return Pd1;
+const JSMatrix wasm_pder1_grm(const JSMatrix *theta, const JSMatrix *params)
+{
+  return JSMatrix(pder1_grm(theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * 2nd derivative of the BRM item probability matrix for person(s) with given ability estimates
  *
- * Port of: pder2.brm.R
- *
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x 3 matrix)
  *
  * @return person/item 2nd derivative probability matrix (N x M) for N people and M items
  */
-const ArrayXXd pder2_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params)
-{
-  int n_ppl, n_it;   // for person and item counts
-  int i, j;          // for the loop iteration
-  double p_exp;      // for the exponent of the dimension probability
-  double p;          // for the 2PL probability of correct
-  double p_der1;     // for the 1st derivative probability correct
-  ArrayXXd Pd2;      // for probability derivative results
-
-  // get dimensions of theta and params
-  n_ppl = theta.rows();
-  n_it  = params.rows();
-
-  // allocate memory for results
-  Pd2.resize(n_ppl, n_it);
-
-  // calculate 2nd derivative of probability of within categories
-  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
-  for ( i = 0; i < n_ppl; i++ ) {
-    for ( j = 0; j < n_it; j++ ) {
-      // calculating the 2nd derivative of the probability of response for one person
-      p_exp  = exp( params(j, 0) * ( theta(i) - params(j, 1) ) );
-      p      = p_exp / ( 1 + p_exp );
-      p_der1 = ( 1 - params(j, 2) ) * params(j, 0) * p * ( 1 - p );
-
-      Pd2(i, j) = params(j, 0) * ( 1 - p_exp ) * ( 1 - p ) * p_der1;
-    }
-  }
-
-  return Pd2;
+const JSMatrix wasm_pder2_brm(const JSMatrix *theta, const JSMatrix *params)
+{
+  return JSMatrix(pder2_brm(theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * 2nd derivative of the GRM item probability matrix for person(s) with given ability estimates
  *
- * Port of: pder2.grm.R
- *
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x K matrix) where K is number of categories
  *
  * @return person/item 2nd derivative probability matrix ((N*K) x M) for N people, K categories, and M items
  */
-const ArrayXXd pder2_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params)
-{
-  int n_ppl, n_it, n_cat;   // for person, item, and category counts
-  int i, j, k;              // for the loop iteration
-  double p_exp;             // for the exponent of the dimension probability
-  double p, p_der1, p_der2; // for the GRM probability of correct
-  ArrayXXd Pd2;             // for probability derivative results
-
-  // get dimensions of theta and params
-  n_ppl = theta.rows();
-  n_it  = params.rows();
-  n_cat = params.cols();
-
-  // resize results
-  Pd2.resize((n_ppl * n_cat), n_it);
-
-  // calculate 2nd derivative of probability of within categories
-  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
-  for ( i = 0; i < n_ppl; i++ ) {
-    for ( j = 0; j < n_it; j++ ) {
-      Pd2((i * n_cat + 0), j) = 0;
-
-      for ( k = 0; k < n_cat - 1; k++ ) {
-        p_exp  = exp( params(j, 0) * (theta(i) - params(j, k + 1)) );
-        p      = p_exp / ( 1 + p_exp );
-        p_der1 = params(j, 0) * p * ( 1 - p );
-        p_der2 = params(j, 0) * (1 - p_exp) * (1 - p) * p_der1;
-
-        Pd2((i * n_cat + k + 1), j) = p_der2;
-        Pd2((i * n_cat + k), j)    -= p_der2;
-      }
-    }
-  }
-
-  return Pd2;
+const JSMatrix wasm_pder2_grm(const JSMatrix *theta, const JSMatrix *params)
+{
+  return JSMatrix(pder2_grm(theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * Derivative of log-likelihoods of reponses to items at given ability estimates
  *
- * Port of: lder1.brm.R
- *
  * @param u           Item responses (N people x M responses)
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x 3 matrix)
- * @param ltype       LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ * @param type        LderType.WLE (weighted likelihood) or LderType.MLE (maximum likelihood)
  *
  * @return derivative of log-likelihood for each person - vector (N x 1)
  */
-const ArrayXd lder1_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype )
+const Vector wasm_lder1_brm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LderType type)
 {
-  // u is the response, theta is ability, and params are the parameters.
-  int N = theta.rows();
-  int M = params.rows();
-
-  // Calculating the probability of response:
-  ArrayXXd p = p_brm(theta, params);
-  ArrayXXd q = (1 - p);
-  ArrayXXd pq = (p * q);
-
-  // Calculating the first and second derivatives:
-  ArrayXXd pder1 = pder1_brm(theta, params);
-  ArrayXXd pder2 = pder2_brm(theta, params);
-
-  // Calculating lder1 for normal/Warm:
-  ArrayXXd lder1 = ( u - p ) * pder1 / pq;
-
-  // Apply Warm correction:
-  if ( ltype == LderType::WLE ) {
-    ArrayXd I = ( pder1.square() / pq ).rowwise().sum();
-    ArrayXXd H = ( pder1 * pder2 ) / pq;
-
-    // R equivalent: H = (H / ( 2 * I ))
-    for (int j = 0; j < M; j++) {
-      H.col(j) /= (2 * I);
-    }
-
-    lder1 += H;
-  }
-
-  // Return Vector of logLik's
-  return lder1.rowwise().sum();
+  return VectorFromMatrix(lder1_brm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
 }
 
-/**MDJAVADOC_SKIP
- * Select item/category likelihoods
- *
- * Port of: sel.prm in ExtractOperators.R
+/**
+ * Derivative of log-likelihoods of reponses to items at given ability estimates
  *
- * @param p ((M*K) x J) likelihood values for all categories / various thetas
- * @param u Item responses (N people x J responses)
- * @param K number of categories
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param type        LderType.WLE (weighted likelihood) or LderType.MLE (maximum likelihood)
  *
- * @return (T x J) matrix - item likelihoods where T = {N, for N>1; M, for N=1}
+ * @return derivative of log-likelihood for each person/category - vector (N x 1)
  */
-const ArrayXXd sel_prm( const Eigen::Ref<const ArrayXXd>& p, const Eigen::Ref<const ArrayXXd>& u, int K ) {
-  int N = u.rows();
-  int J = p.cols();
-  int M, T;
-  int i, cat;
-  ArrayXXd lik;
-
-  if (K < 2) {
-    throw "sel_prm invalid value for K";
-  }
-
-  M = p.rows() / K;
-  T = (N == 1 ? M : N);
-  lik.resize(M, J);
-
-  if ((N == 0) || (J == 0) || (M == 0)) {
-    throw "sel_prm 0-value for N, J, or M";
-  }
-
-  if ((u.cols() != p.cols()) || (p.rows() % K > 0) || (p.rows() % N > 0)) {
-    throw "sel_prm dimension mismatch between p, u, and K";
-  }
-
-  for (int t = 0; t < T; t++) {   // t: row index of result, start of block row in value matrix p
-    i = t % N;                    // i: row index into response matrix u
-    for (int j = 0; j < J; j++) { // j: col (item) index
-      if (isnan(u(i, j))) {
-        cat = -1;
-      } else {
-        cat = static_cast<int>(u(i, j));
-      }
-      if (cat > 0 && cat <= K) {
-        lik(t, j) = p.block(t * K, 0, K, J)(cat - 1, j);
-      } else {
-        lik(t, j) = nan("");
-      }
-    }
-  }
-  return lik;
+const Vector wasm_lder1_grm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LderType type)
+{
+  return VectorFromMatrix(lder1_grm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * BRM model log-likelihoods of reponses to items at given ability estimates
  *
  * Port of: lokLik.brm.R
@@ -396,179 +312,96 @@ const ArrayXXd sel_prm( const Eigen::Ref<const ArrayXXd>& p, const Eigen::Ref<co
  * @param u           Item responses (N people x M responses)
  * @param theta       Ability estimates for N people (or T thetas if N is 1)
  * @param params      Parameters for M items (M x 3 matrix)
- * @param type        LogLikType::MLE or LogLikType::BME (not yet supported)
+ * @param type        LogLikType.MLE or LogLikType.BME (not yet supported)
+ *
+ * Items with a NaN (missing) response are skipped.
  *
  * @return log-likelihood for each person - vector (N x 1), or for each theta - vector (T x 1)
  */
-const ArrayXd logLik_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params, LogLikType type=LogLikType::MLE )
+const Vector wasm_logLik_brm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LogLikType type)
 {
-  ArrayXXd p = p_brm(theta, params);
-  ArrayXXd logLik;
-
-  if (type == LogLikType::BME) {
-    throw "logLik_brm unsupported LogLikType::BME";
-  }
-
-  if (u.rows() == 1 && theta.size() > 1) {
-    logLik = ( p.log().rowwise() * u.row(0) ) + ( (1 - p).log().rowwise() * (1 - u.row(0)));
-  }
-  else {
-    logLik = (u * p.log()) + ((1 - u) * (1 - p).log());
-  }
-
-  // return scalar vector of logLik's
-  return logLik.rowwise().sum();
+  return VectorFromMatrix(logLik_brm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * GRM model log-likelihoods of reponses to items at given ability estimates
  *
- * Port of: lokLik.grm.R
- *
  * @param u           Item responses (N people x M responses)
  * @param theta       Ability estimates for N people (or T thetas if N is 1)
  * @param params      Parameters for M items (M x K matrix) where K is number of categories
- * @param type        LogLikType::MLE or LogLikType::BME (not yet supported)
+ * @param type        LogLikType.MLE or LogLikType.BME (not yet supported)
+ *
+ * Items with a NaN (missing) response are skipped.
  *
  * @return log-likelihood for each person - vector (N x 1), or for each theta - vector (T x 1)
  */
-const ArrayXd logLik_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LogLikType type=LogLikType::MLE )
+const Vector wasm_logLik_grm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LogLikType type)
 {
-  ArrayXXd p = p_grm(theta, params);
-  ArrayXXd logLik;
-
-  if (type == LogLikType::BME) {
-    throw "logLik_grm unsupported LogLikType::BME";
-  }
-
-  logLik = sel_prm(p, u, params.cols()).log();
-
-  // return scalar vector of logLik's
-  return logLik.rowwise().sum();
+  return VectorFromMatrix(logLik_grm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
 }
 
-/**MDJAVADOC_SKIP
- * Derivative of log-likelihoods of reponses to items at given ability estimates
- *
- * Port of: lder1.grm.R
+/**
+ * Select item/category likelihoods
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
- * @param ltype       LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ * @param p ((M*K) x J) likelihood values for all categories / various thetas
+ * @param u Item responses (N people x J responses)
+ * @param K number of categories
  *
- * @return derivative of log-likelihood for each person/category - vector (N x 1)
+ * @return (T x J) matrix - item likelihoods where T = {N, for N>1; M, for N=1}
  */
-const ArrayXd lder1_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype )
-{
-  // u is the response, theta is ability, and params are the parameters.
-  int N = theta.rows();
-  int J = params.rows();
-  int K = params.cols();
-
-  // Calculating the probability of response:
-  ArrayXXd p = p_grm(theta, params);
-
-  // Calculating the first and second derivatives:
-  ArrayXXd pder1 = pder1_grm(theta, params);
-  ArrayXXd pder2 = pder2_grm(theta, params);
-
-  // Calculating lder1 for normal/Warm:
-  ArrayXXd lder1 = sel_prm(pder1 / p, u, K);
-
-  // Apply Warm correction:
-  if ( ltype == LderType::WLE ) {
-    ArrayXXd Itmp = pder1.square() / p;
-    ArrayXXd Htmp = ( pder1 * pder2 ) / p;
-    ArrayXd I(N);
-    ArrayXd H(N);
-
-    // sum all values for each person
-    for (int i = 0; i < N; i++) {
-        I(i) = Itmp.block(i * K, 0, K, J).sum();
-        H(i) = Htmp.block(i * K, 0, K, J).sum();
-    }
+const JSMatrix wasm_sel_prm(const JSMatrix *p, const JSMatrix *u, int K)
+{
+  return JSMatrix(sel_prm(p->toEigen(), u->toEigen(), K));
+}
 
-    lder1.colwise() += (H / (2 * I) / J);
-  }
-
-  // Return Vector of logLik's
-  return lder1.rowwise().sum();
-}
-
-/**MDJAVADOC_SKIP
+/**
  * 2nd derivative of log-likelihoods of reponses to items at given ability estimates
  *
- * Port of: lder2.brm.R
- *
  * @param u           Item responses (N people x M responses)
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x 3 matrix)
  *
  * @return 2nd derivative of log-likelihood for each person - vector (N x M)
  */
-const ArrayXXd lder2_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params )
+const JSMatrix wasm_lder2_brm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params)
 {
-  // Calculating the probability of response:
-  ArrayXXd p = p_brm(theta, params);
-  ArrayXXd q = (1 - p);
-
-  // Calculating the first and second derivatives:
-  ArrayXXd pder1 = pder1_brm(theta, params);
-  ArrayXXd pder2 = pder2_brm(theta, params);
-
-  // Calculating two parts of second derivative:
-  ArrayXXd lder2_1 = ( -pder1.square() / p.square() ) + ( pder2 / p );
-  ArrayXXd lder2_2 = ( pder1.square() / q.square() ) + ( pder2 / q );
-
-  return ((u * lder2_1) - ((1 - u) * lder2_2));
+  return JSMatrix(lder2_brm(u->toEigen(), theta->toEigen(), params->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * 2nd derivative of log-likelihoods of reponses to items at given ability estimates
  *
- * Port of: lder2.grm.R
- *
  * @param u           Item responses (N people x M responses)
  * @param theta       Ability estimates for N people
  * @param params      Parameters for M items (M x K matrix) where K is number of categories
  *
  * @return 2nd derivative of log-likelihood for each person - vector (N x M)
  */
-const ArrayXXd lder2_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params )
+const JSMatrix wasm_lder2_grm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params)
 {
-  int K = params.cols();
-
-  // Calculating the probability of response:
-  ArrayXXd p = p_grm(theta, params);
-
-  // Calculating the first and second derivatives:
-  ArrayXXd pder1 = pder1_grm(theta, params);
-  ArrayXXd pder2 = pder2_grm(theta, params);
-
-  // Calculating two parts of second derivative:
-  ArrayXXd lder2 = ( -1 * pder1.square() / p.square() ) + ( pder2 / p );
-
-  return sel_prm(lder2, u, K);
+  return JSMatrix(lder2_grm(u->toEigen(), theta->toEigen(), params->toEigen()));
 }
 
-struct FI_Result
+// wraps FI_Result Array properties into JSMatrix
+struct JSFI_Result
 {
-    ArrayXXd item;
-    ArrayXd test;
-    ArrayXd sem;
+    JSMatrix item;
+    Vector test;
+    Vector sem;
     FIType type;
 
-    FI_Result() {}
+    JSFI_Result() {}
 
-    FI_Result(FIType type)
+    JSFI_Result(const FI_Result &r)
     {
-        this->type = type;
+        item = JSMatrix(r.item);
+        test = VectorFromMatrix(r.test);
+        sem = VectorFromMatrix(r.sem);
+        type = r.type;
     }
 
-    FI_Result(const FI_Result &r)
+    JSFI_Result(const JSFI_Result &r)
     {
-        // allows Eigen optimizations not available with default copy constructor
         item = r.item;
         test = r.test;
         sem = r.sem;
@@ -576,63 +409,22 @@ struct FI_Result
     }
 };
 
-/**MDJAVADOC_SKIP
+/**
  * Fisher Information of BRM items for given ability estimates and optional responses (for OBSERVED info)
  *
- * Port of: FI.brm.R
- *
  * @param params      Parameters for M items (M x 3 matrix)
  * @param theta       Ability estimates for N people
- * @param type        FIType::EXPECTED or FIType::OBSERVED
- * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
+ * @param type        FIType.EXPECTED or FIType.OBSERVED
+ * @param resp        Item responses (N people x M responses) should be size 0 for FIType.EXPECTED
  *
  * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
  */
-const FI_Result FI_brm( const Eigen::Ref<const ArrayX3d>& params, const Eigen::Ref<const ArrayXd>& theta, FIType type, const Eigen::Ref<const ArrayXXd>& resp )
+JSFI_Result wasm_FI_brm(const JSMatrix *params, const JSMatrix *theta, FIType type, const JSMatrix *resp)
 {
-  // check supported types
-  if ( type != FIType::OBSERVED && type != FIType::EXPECTED ) {
-    throw "FI_brm unexpected type";
-  }
-
-  // Make sure that resp is NULL if type is "expected"
-  if ( type == FIType::EXPECTED && resp.size() > 0 ) {
-    throw "FI_brm type EXPECTED with non-zero responses";
-  }
-
-  // Make sure that resp exists if we are calculating "observed" information
-  if ( type == FIType::OBSERVED && resp.size() == 0 ) {
-    throw "FI_brm need response scalar/vector to calculate observed information";
-  }
-
-  ArrayXXd p;
-  ArrayXXd q;
-  ArrayXXd pder1;
-  FI_Result result = FI_Result(type);
-
-  // Expected Fisher Information: p'^2/(p*q)
-  if ( type == FIType::EXPECTED ) {
-    // Calculating the probability of response:
-    p = p_brm(theta, params);
-    q = (1 - p);
-
-    // Calculating the first derivative:
-    pder1 = pder1_brm(theta, params);
-
-    result.item = pder1.square() / ( p * q );
-  }
-  // Observed Fisher Information
-  else {
-    result.item = -1 * lder2_brm(resp, theta, params);
-  }
-
-  result.test = result.item.rowwise().sum();
-  result.sem = sqrt( 1 / result.test );
-
-  return result;
+  return JSFI_Result(FI_brm(params->toEigen(), theta->toEigen(), type, resp->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
+/**
  * Expected Fisher Information (modified unweighted) of BRM items for given phase 1 and phase 2 ability estimates
  *
  * @param p2_params      Phase 2 parameters for M items (M x 3 matrix)
@@ -642,765 +434,741 @@ const FI_Result FI_brm( const Eigen::Ref<const ArrayX3d>& params, const Eigen::R
  *
  * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
  */
-const FI_Result FI_brm_modified_expected( const Eigen::Ref<const ArrayX3d>& p2_params, const Eigen::Ref<const ArrayXd>& p2_theta, const Eigen::Ref<const ArrayX3d>& p1_params, const Eigen::Ref<const ArrayXd>& p1_theta )
+JSFI_Result wasm_FI_brm_modified_expected(const JSMatrix *p2_params, const JSMatrix *p2_theta, const JSMatrix *p1_params, const JSMatrix *p1_theta)
 {
-  // Make sure that item parameters have matching dimensions
-  if ( (p1_params.rows() != p2_params.rows()) || (p1_params.cols() != p2_params.cols()) ) {
-    throw "FI_brm_modified_expected phase1 and phase2 item parameters dimension mismatch";
-  }
-
-  // Make sure that theta estimates have matching dimensions
-  if ( p1_theta.size() != p2_theta.size() ) {
-    throw "FI_brm_modified_expected phase1 and phase2 theta size mismatch";
-  }
-
-  ArrayXXd p;
-  ArrayXXd q;
-  ArrayXXd pder1;
-  FI_Result result = FI_Result(FIType::EXPECTED);
-
-  // Expected Fisher Information: p'^2/(p*q)
-  // Calculating the probability of response:
-  p = p_brm(p2_theta, p2_params);
-  q = (1 - p);
-
-  // Calculating the first derivative:
-  pder1 = pder1_brm(p2_theta, p2_params);
-
-  // modified: apply phase1 adjustments
-  result.item = (1 - p_brm(p1_theta, p1_params)) * (pder1.square() / ( p * q ));
-
-  result.test = result.item.rowwise().sum();
-  result.sem = sqrt( 1 / result.test );
-
-  return result;
+  return JSFI_Result(FI_brm_modified_expected(p2_params->toEigen(), p2_theta->toEigen(), p1_params->toEigen(), p1_theta->toEigen()));
 }
 
-/**MDJAVADOC_SKIP
- * Expected Fisher Information of GRM items for given ability estimates and optional responses (for OBSERVED info)
- *
- * Port of: FI.grm.R
+/**
+ * Fisher Information of GRM items for given ability estimates and optional responses (for OBSERVED info)
  *
  * @param params      Parameters for M items (M x K matrix) where K is number of categories
  * @param theta       Ability estimates for N people
- * @param type        FIType::EXPECTED or FIType::OBSERVED
- * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
+ * @param type        FIType.EXPECTED or FIType.OBSERVED
+ * @param resp        Item responses (N people x M responses) should be size 0 for FIType.EXPECTED
  *
  * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
  */
-const FI_Result FI_grm( const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const ArrayXd>& theta, FIType type, const Eigen::Ref<const ArrayXXd>& resp )
+JSFI_Result wasm_FI_grm(const JSMatrix *params, const JSMatrix *theta, FIType type, const JSMatrix *resp)
 {
-  // check supported types
-  if ( type != FIType::OBSERVED && type != FIType::EXPECTED ) {
-    throw "FI_grm unexpected type";
-  }
-
-  // Make sure that resp is NULL if type is "expected"
-  if ( type == FIType::EXPECTED && resp.size() > 0 ) {
-    throw "FI_grm type EXPECTED with non-zero responses";
-  }
-
-  // Make sure that resp exists if we are calculating "observed" information
-  if ( type == FIType::OBSERVED && resp.size() == 0 ) {
-    throw "FI_grm need response scalar/vector to calculate observed information";
-  }
-
-  int N = theta.size();  // number of people
-  int M = params.rows(); // number of items
-  int K = params.cols(); // number of categories
-  ArrayXXd p;
-  ArrayXXd pder1;
-  FI_Result result = FI_Result(type);
-  result.item.resize(N, M);
-
-  // Expected Fisher Information: sum[P'^2/P]
-  if ( type == FIType::EXPECTED ) {
-    // Calculating the probability of response:
-    p = p_grm(theta, params);
-
-    // Calculating the first derivative:
-    pder1 = pder1_grm(theta, params);
-
-    ArrayXXd tmp = pder1.square() / p;
-
-    // sum columns of each person's block and add as row to result.item
-    for (int i = 0; i < N; i++) {
-        result.item.row(i) = tmp.block(i * K, 0, K, M).colwise().sum();
-    }
-  }
-  // Observed Fisher Information
-  else {
-    result.item = -1 * lder2_grm(resp, theta, params);
-  }
-
-  result.test = result.item.rowwise().sum();
-  result.sem = sqrt( 1 / result.test );
-
-  return result;
+  return JSFI_Result(FI_grm(params->toEigen(), theta->toEigen(), type, resp->toEigen()));
 }
 
-struct Uniroot_Result
-{
-    double root;
-    double f_root;
-    int iter;
-    double estim_prec;
-};
-
-/**MDJAVADOC_SKIP
- * Search the range interval for a root of the specificed lder1 function with respect to theta
- *
- * Combined port of: uniroot and R_zeroin2, Copyright (C) 1999-2016  The R Core Team
- *   https://github.com/SurajGupta/r-source/blob/a28e609e72ed7c47f6ddfbb86c85279a0750f0b7/src/library/stats/R/nlm.R#L55
- *   https://github.com/SurajGupta/r-source/blob/a28e609e72ed7c47f6ddfbb86c85279a0750f0b7/src/library/stats/src/zeroin.c
+/**
+ * Search the range interval for a root of the specificed BRM or GRM lder1 function with respect to theta
  *
- * @param lderFP      Pointer to lder1_brm or lder1_grm functions
  * @param range       Interval to search: should be [-X,+X] for some positive X
  * @param resp        Item responses for a single person (1 x M)
  * @param params      Parameters for M items (M x K matrix)
- * @param type        LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
- * @param maxit       Maximum number of iterations for search (default: 1000)
- * @param tol         Acceptable tolerance level (default: EPSILON^0.25)
+ * @param type        LderType.WLE (weighted likelihood) or LderType.MLE (maximum likelihood)
+ * @param model       ModelType.BRM or ModelType.GRM
  *
  * @return Uniroot_Result with iter=-1 if a root did not converge within max iterations
  */
-Uniroot_Result uniroot_lder1(
-    const ArrayXd (*lderFP)(const Eigen::Ref<const ArrayXXd>&, const Eigen::Ref<const ArrayXd>&, const Eigen::Ref<const ArrayXXd>&, LderType),
-    const Eigen::Ref<const RowVector2d>& range,
-    const Eigen::Ref<const ArrayXXd>& resp,
-    const Eigen::Ref<const ArrayXXd>& params,
-    LderType type,
-    int maxit = 1000,
-    double tol = 0.0
-)
-{
-    double lower = range(0); // ax
-    double upper = range(1); // bx
-    double a, b, c;          // Abscissae, descr. see above
-    double fa, fb, fc;       // f(a), f(b), f(c)
-    Eigen::Array<double, 1, 1> tmpTheta;
-    Eigen::Array<double, 1, 1> lderResult;
-    Uniroot_Result result{0};
-
-    // NOTE: removed code to extend interval if lower * upper > 0
-
-    // Set default tolerance
-    if (tol <= 0) {
-        tol = pow(DBL_EPSILON, 0.25);
-    }
-
-    // First test if we have found a root at an endpoint
-    a = lower;
-    b = upper;
-
-    tmpTheta(0) = a;
-    lderResult = (*lderFP)(resp, tmpTheta, params, type);
-    fa = lderResult(0);
-    if (fa == 0.0) {
-        result.root = a;
-        result.f_root = fa;
-        result.iter = 0;
-        result.estim_prec = 0.0;
-        return result;
-    }
-
-    tmpTheta(0) = b;
-    lderResult = (*lderFP)(resp, tmpTheta, params, type);
-    fb = lderResult(0);
-    if (fb ==  0.0) {
-        result.root = b;
-        result.f_root = fb;
-        result.iter = 0;
-        result.estim_prec = 0.0;
-        return result;
-    }
-
-    // Now search the range for a root
-    c = a;
-    fc = fa;
-
-    for (int it = 0; it < (maxit + 1); it++) {
-        double prev_step = b - a; // Distance from the last but one to the last approximation
-        double tol_act;           // Actual tolerance
-
-        // Interpolation step is calculated in the form p/q; division operations is delayed until the last moment
-        double p;
-        double q;
-
-        double new_step; // Step at this iteration
-
-        if (fabs(fc) < fabs(fb)) {
-            // Swap data for b to be the best approximation
-            a = b;  b = c;  c = a;
-            fa=fb;  fb=fc;  fc=fa;
-        }
-        tol_act = 2 * DBL_EPSILON * fabs(b) + tol / 2;
-        new_step = (c - b) / 2;
-
-        if (fabs(new_step) <= tol_act || fb == 0.0) {
-            // Acceptable approx. is found
-            result.root = b;
-            result.f_root = fb;
-            result.iter = it;
-            result.estim_prec = fabs(c - b);
-            return result;
-        }
-
-        // Try interpolation
-        if (fabs(prev_step) >= tol_act	// If prev_step was large enough
-            && fabs(fa) > fabs(fb)) {	// and was in true direction
-            double t1,cb,t2;
-            cb = c-b;
-            if (a == c) {
-                // If we have only two distinct points linear interpolation can only be applied
-                t1 = fb / fa;
-                p = cb * t1;
-                q = 1.0 - t1;
-            }
-            else {
-                // Quadric inverse interpolation
-                q = fa / fc;  t1 = fb / fc;	 t2 = fb / fa;
-                p = t2 * (cb * q * (q - t1) - (b - a) * (t1 - 1.0));
-                q = (q - 1.0) * (t1 - 1.0) * (t2 - 1.0);
-            }
-
-            // p was calculated with the opposite sign; make p positiv and assign possible minus to q
-            if( p > 0.0 ) {
-                q = -q;
-            } else {
-                p = -p;
-            }
-
-            if (p < (0.75 * cb * q - fabs(tol_act * q) / 2) // If b+p/q falls in [b,c]
-                && p < fabs(prev_step * q / 2)) {	        // and isn't too large
-                // it is accepted
-                new_step = p/q;
-            }
-            // Otherwise, if p/q is too large then the bisection procedure can reduce [b,c] range to more extent
-        }
-
-        if (fabs(new_step) < tol_act) {
-            // Adjust the step to be not less than tolerance
-            if (new_step > 0.0) {
-                new_step = tol_act;
-            } else {
-                new_step = -tol_act;
-            }
-        }
-
-        // Save the previous approx.
-        a = b;
-        fa = fb;
-
-        // Do step to a new approxim.
-        b += new_step;
-        tmpTheta(0) = b;
-        lderResult = (*lderFP)(resp, tmpTheta, params, type);
-        fb = lderResult(0);
+Uniroot_Result wasm_uniroot_lder1(const JSMatrix *range, const JSMatrix *resp, const JSMatrix *params, LderType type, ModelType model)
+{
+    const ArrayXd (*lderFP)(const Eigen::Ref<const ArrayXXd>&, const Eigen::Ref<const ArrayXd>&, const Eigen::Ref<const ArrayXXd>&, LderType);
 
-        // Adjust c for it to have a sign opposite to that of b
-        if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
-            c = a;
-            fc = fa;
-        }
+    if (model == ModelType::BRM) {
+        lderFP = &lder1_brm;
+    } else {
+        lderFP = &lder1_grm;
     }
 
-    // failed!
-    result.root = b;
-    result.f_root = fb;
-    result.iter = -1;
-    result.estim_prec = fabs(c - b);
-    return result;
+    return uniroot_lder1(lderFP, RowVector2d(range->toEigen()), resp->toEigen(), params->toEigen(), type);
 }
 
-struct Est_Result
+// wraps Est_Result Array properties into Vectors
+struct JSEst_Result
 {
-    ArrayXd theta;
-    ArrayXd info;
-    ArrayXd sem;
+    Vector theta;
+    Vector info;
+    Vector sem;
 
-    Est_Result() {}
+    JSEst_Result() {}
 
-    Est_Result(const Est_Result &r)
+    JSEst_Result(const Est_Result &r)
     {
-        // allows Eigen optimizations not available with default copy constructor
-        theta = r.theta;
-        info = r.info;
-        sem = r.sem;
+        theta = VectorFromMatrix(r.theta);
+        info = VectorFromMatrix(r.info);
+        sem = VectorFromMatrix(r.sem);
     }
 };
 
-/**MDJAVADOC_SKIP
+/**
  * Estimate ability from one or more sets of item responses
  *
- * Port of: wleEst.R
- *
  * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
  * @param params      Parameters for M items (M x K matrix)
  * @param range       Range of abilities to explore (2 x 1)
- * @param type        ModelType::BRM or ModelType::GRM
+ * @param type        ModelType.BRM or ModelType.GRM
  *
  * @return Est_Result with theta (Nx1), info (Nx1), and sem (Nx1) info
  */
-const Est_Result wleEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type )
+JSEst_Result wasm_wleEst(const JSMatrix *resp, const JSMatrix *params, const JSMatrix *range, ModelType type)
 {
-  //
-  // Check arguments
-  //
-
-  // Make sure all responses are numeric
-  if (!resp.isFinite().all()) {
-      throw "wleEst infinite or non-numeric responses provided";
-  }
+  return JSEst_Result(wleEst(resp->toEigen(), params->toEigen(), range->toEigen(), type));
+}
 
-  // Make sure all item parameters are numeric
-  if (!params.isFinite().all()) {
-      throw "wleEst infinite or non-numeric item parameters provided";
-  }
+/**
+ * Estimate ability from one or more sets of item responses with the given root finder
+ *
+ * @param resp        Item responses (N people x M responses)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param type        ModelType.BRM or ModelType.GRM
+ * @param solver      SolverType.BRENT (as wasm_wleEst) or SolverType.NEWTON
+ * @param start       Array of N starting ability estimates (NaN for the Brent search) for SolverType.NEWTON, or an empty array
+ *
+ * @return Est_Result with theta (Nx1), info (Nx1), and sem (Nx1) info
+ */
+JSEst_Result wasm_wleEst_solver(const JSMatrix *resp, const JSMatrix *params, const JSMatrix *range, ModelType type, SolverType solver, val start)
+{
+  const Vector s = VectorFromJS<double>(start);
 
-  // Make sure dimensions of resp and params are compatible
-  if (resp.cols() != params.rows()) {
-      throw "wleEst dimension mismatch between responses and parameters";
-  }
+  return JSEst_Result(wleEst(resp->toEigen(), params->toEigen(), range->toEigen(), type, solver, Eigen::Map<const ArrayXd>(s.data(), s.size())));
+}
 
-  // Make sure range is from negative to positive
-  if (!(range(0) < 0 && range(1) > 0)) {
-      throw "wleEst unsupported range provided";
-  }
+/**
+ * Copy an Eigen vector to a new JS Float64Array
+ */
+val Float64ArrayFromVector( const Eigen::Ref<const ArrayXd>& v )
+{
+    return TypedArrayFromData(v.data(), v.size());
+}
 
-  ArrayXd est(resp.rows()); // vector of estimates
-  ArrayXd d(resp.rows());   // vector of corrections
-  Uniroot_Result ur_result;
-  FI_Result fi_result;
-  Est_Result result;
-  const ArrayXd(*lderFunc)(const Eigen::Ref<const ArrayXXd>&, const Eigen::Ref<const ArrayXd>&, const Eigen::Ref<const ArrayXXd>&, LderType);
-
-  if (type == ModelType::GRM) {
-      lderFunc = &lder1_grm;
-  } else {
-      lderFunc = &lder1_brm;
-  }
+/**
+ * Convert an Est_Result to a JS object with theta, info, and sem Float64Arrays
+ */
+val EstResultToObject( const Est_Result &r )
+{
+    val result = val::object();
+    result.set("theta", Float64ArrayFromVector(r.theta));
+    result.set("info", Float64ArrayFromVector(r.info));
+    result.set("sem", Float64ArrayFromVector(r.sem));
+    return result;
+}
 
-  for (int i = 0; i < resp.rows(); i++) {
-      ur_result = uniroot_lder1(lderFunc, range, resp.row(i), params, LderType::WLE);
-      est(i) = ur_result.root;
-      d(i) = ((*lderFunc)(resp.row(i), est.row(i), params, LderType::WLE) - (*lderFunc)(resp.row(i), est.row(i), params, LderType::MLE))(0);
-  }
+using RowArrayXXd = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 
-  // ensure results are capped to range
-  est = est.min(range(1)).max(range(0));
+/**
+ * Estimate ability of many people who each answered a different subset of the items
+ *
+ * @param resp        Responses, row-major (N x M) array or Float64Array, NaN if not administered
+ * @param rows        Number of people N
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param type        ModelType.BRM or ModelType.GRM
+ * @param mask        Administered items, row-major (N x M) Uint8Array (zero to skip), or an empty array
+ * @param solver      SolverType.BRENT or SolverType.NEWTON
+ * @param start       Array of N starting ability estimates for SolverType.NEWTON, or an empty array
+ *
+ * @return object with theta, info, and sem Float64Arrays (N); theta 0 and NaN info/sem for rows without responses
+ */
+val wasm_wleEst_ragged(val resp, int rows, const JSMatrix *params, const JSMatrix *range, ModelType type, val mask, SolverType solver, val start)
+{
+  const Vector r = VectorFromJS<double>(resp);
+  const Vector s = VectorFromJS<double>(start);
+  const std::vector<uint8_t> m = VectorFromJS<uint8_t>(mask);
+  const int cols = params->rows();
 
-  if (type == ModelType::BRM) {
-      fi_result = FI_brm(params, est, FIType::OBSERVED, resp);
-  } else {
-      fi_result = FI_grm(params, est, FIType::OBSERVED, resp);
+  if (rows < 0 || r.size() != (size_t)rows * cols) {
+    throw "wleEst_ragged resp length must match rows * items";
+  }
+  if (!m.empty() && m.size() != r.size()) {
+    throw "wleEst_ragged mask length must match resp";
+  }
+  if (!s.empty() && s.size() != (size_t)rows) {
+    throw "wleEst_ragged start length must match rows";
   }
 
-  result.theta = est;
-  result.info = fi_result.test;
-  result.sem = ((result.info + d.square()) / result.info.square()).sqrt();
-
-  return result;
+  return EstResultToObject(wleEst_ragged(Eigen::Map<const RowArrayXXd>(r.data(), rows, cols), params->toEigen(), range->toEigen(), type,
+                                         m, solver, Eigen::Map<const ArrayXd>(s.data(), s.size())));
 }
 
-/*******************************************
- *
- * Begin JavaScript Bridge
- *
- *******************************************/
-
-const Vector VectorFromMatrix( const Eigen::Ref<const ArrayXXd>& m )
+/**
+ * Convert a GLR_Result to a JS object with category (Int32Array) and likratio (row-major Float64Array)
+ */
+val GLRResultToObject( const GLR_Result &r )
 {
-    assert((m.rows() <= 1 || m.cols() <= 1) && "Matrix must be 0 or 1 dimensional");
-    Vector res;
-    for (int i = 0; i < m.rows(); i++) {
-        for (int j = 0; j < m.cols(); j++) {
-            res.push_back(m(i, j));
-        }
-    }
-    return res;
+    const RowArrayXXd likratio = r.likratio;
+    val result = val::object();
+    result.set("category", TypedArrayFromData(r.category.data(), r.category.size()));
+    result.set("likratio", TypedArrayFromData(likratio.data(), likratio.size()));
+    return result;
 }
 
-// wrapper class for Eigen::Array to JS binding
-class JSMatrix {
-    using Mat = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>;
-    using Vector = std::vector<double>;
-    using Vector2d = std::vector<std::vector<double>>;
-
-public:
-    Mat data;
-
-    JSMatrix()
-    {
-        data = Mat();
-    }
+/**
+ * Classify many people by the generalized likelihood ratio at one or more ability bounds
+ *
+ * @param resp        Responses, row-major (N x M) array or Float64Array, NaN if not administered
+ * @param rows        Number of people N
+ * @param params      Parameters for M items (M x K matrix)
+ * @param type        ModelType.BRM or ModelType.GRM
+ * @param lower       Lower end of the range of abilities to search
+ * @param upper       Upper end of the range of abilities to search
+ * @param bounds      Array of B classification bounds
+ * @param delta       Half width of the indifference region around each bound
+ * @param alpha       Type I error rate
+ * @param beta        Type II error rate
+ *
+ * @return object with category (Int32Array (N), -1 if not classified) and likratio (Float64Array (N x B) row-major)
+ */
+val wasm_termGLR(val resp, int rows, const JSMatrix *params, ModelType type, double lower, double upper, val bounds, double delta, double alpha, double beta)
+{
+  const Vector r = VectorFromJS<double>(resp);
+  const Vector b = VectorFromJS<double>(bounds);
 
-    JSMatrix(int m, int n)
-    {
-        data = Mat::Zero(m, n);
-    }
+  if (rows < 0 || r.size() != (size_t)rows * params->rows()) {
+    throw "termGLR resp length must match rows * items";
+  }
 
-    JSMatrix(const Mat &_data) : data(_data)
-    {
-    }
+  return GLRResultToObject(termGLR(Eigen::Map<const RowArrayXXd>(r.data(), rows, params->rows()), params->toEigen(), type, RowVector2d(lower, upper),
+                                   Eigen::Map<const ArrayXd>(b.data(), b.size()), delta, alpha, beta));
+}
 
-    JSMatrix(const JSMatrix &B) : data(B.copy())
-    {
-    }
+/**
+ * Nodes and weights of a normal prior for EAP scoring
+ *
+ * @param type        QuadType.GAUSS_HERMITE or QuadType.EQUAL
+ * @param n           Number of nodes
+ * @param mean        Prior mean
+ * @param sd          Prior standard deviation
+ * @param lower       First node of QuadType.EQUAL
+ * @param upper       Last node of QuadType.EQUAL
+ *
+ * @return object with nodes and weights Float64Arrays (n), weights summing to 1
+ */
+val wasm_quadrature(QuadType type, int n, double mean, double sd, double lower, double upper)
+{
+  const Quadrature quad = quadrature(type, n, mean, sd, RowVector2d(lower, upper));
+  val result = val::object();
+  result.set("nodes", Float64ArrayFromVector(quad.nodes));
+  result.set("weights", Float64ArrayFromVector(quad.weights));
+  return result;
+}
 
-    Mat copy() const
-    {
-        return data;
-    }
+/**
+ * Estimate ability of many people by EAP (posterior mean) over a fixed quadrature
+ *
+ * @param resp        Responses, row-major (N x M) array or Float64Array, NaN if not administered
+ * @param rows        Number of people N
+ * @param params      Parameters for M items (M x K matrix)
+ * @param type        ModelType.BRM or ModelType.GRM
+ * @param nodes       Array of Q ability nodes
+ * @param prior       Array of Q prior weights (normalized here)
+ *
+ * @return object with theta (posterior mean), info (posterior precision), and sem (posterior sd) Float64Arrays (N)
+ */
+val wasm_eapEst(val resp, int rows, const JSMatrix *params, ModelType type, val nodes, val prior)
+{
+  const Vector r = VectorFromJS<double>(resp);
+  const Vector x = VectorFromJS<double>(nodes);
+  const Vector w = VectorFromJS<double>(prior);
 
-    const Mat &toEigen() const
-    {
-        return data;
-    }
+  if (rows < 0 || r.size() != (size_t)rows * params->rows()) {
+    throw "eapEst resp length must match rows * items";
+  }
 
-    int rows() const
-    {
-        return (int)data.rows();
-    }
+  return EstResultToObject(eapEst(Eigen::Map<const RowArrayXXd>(r.data(), rows, params->rows()), params->toEigen(), type,
+                                  quadrature(Eigen::Map<const ArrayXd>(x.data(), x.size()), Eigen::Map<const ArrayXd>(w.data(), w.size()))));
+}
 
-    int cols() const
-    {
-        return (int)data.cols();
-    }
+/**
+ * Set the number of threads used to split people (rows) across in wasm_wleEst and the FI functions
+ *
+ * Only the threaded build (dist/catirt-threads.js) uses more than one thread; use the
+ * catirt_load({threads: n}) option rather than calling this directly.
+ *
+ * @param n           Number of threads (at most the pthread pool size); 0 for all hardware threads
+ */
+void wasm_setNumThreads(int n)
+{
+  setNumThreads(n);
+}
 
-    double get(int i, int j) const
-    {
-        return data(i, j);
-    }
+/**
+ * Number of threads used to split people (rows) across in wasm_wleEst and the FI functions
+ *
+ * @return Thread count (1 for the single-threaded builds)
+ */
+int wasm_getNumThreads()
+{
+  return getNumThreads();
+}
 
-    void set(int i, int j, const double &s)
-    {
-        data(i, j) = s;
-    }
+/**
+ * Read the performance counters
+ *
+ * Counters are kept by builds compiled with CATIRT_ENABLE_STATS (all dist builds): calls of
+ * each kernel group, iterations of the Brent and Newton root finders and how often they hit
+ * maxit (iter = -1), bytes copied between JavaScript and the module, and heap allocations and
+ * the bytes they requested. The time (ns) of each kernel group is kept only by builds also
+ * compiled with CATIRT_ENABLE_STAT_TIMERS (timers is true), and reads 0 otherwise. Counts are
+ * since the module was loaded or the last wasm_resetStats().
+ *
+ * @return object with enabled, timers, heap_bytes (current WebAssembly heap size), and one
+ *         number per counter: prob_calls, prob_ns, loglik_calls, loglik_ns, fi_calls, fi_ns,
+ *         wle_calls, wle_ns, glr_calls, glr_ns, select_calls, select_ns, uniroot_calls,
+ *         uniroot_iterations, uniroot_maxit, newton_calls, newton_iterations, newton_fallbacks,
+ *         bytes_in, bytes_out, allocs, bytes_allocated
+ */
+val wasm_getStats()
+{
+  val result = val::object();
 
-    static JSMatrix fromVector(const Vector2d &v)
-    {
-        const size_t m = v.size();
-        const size_t n = m > 0 ? v[0].size() : 0;
-        Mat mat(m, n);
-        for (size_t i = 0; i < m; i++) {
-            assert(v[i].size() == n && "All the rows must have the same size");
-            for (size_t j = 0; j < n; j++) {
-                mat(i, j) = v[i][j];
-            }
-        }
-        return mat;
-    }
-};
+  result.set("enabled", statsEnabled());
+  result.set("timers", statTimersEnabled());
+  result.set("heap_bytes", (double)emscripten_get_heap_size());
+  for (int s = 0; s < (int)Stat::COUNT; s++) {
+    result.set(statName((Stat)s), (double)getStat((Stat)s));
+  }
+  return result;
+}
 
 /**
- * Generate the BRM item probability matrix for person(s) with given ability estimates
- *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x 3 matrix)
- *
- * @return person/item probability matrix (N x M) for N people and M items
+ * Set all performance counters to 0
  */
-const JSMatrix wasm_p_brm(const JSMatrix *theta, const JSMatrix *params)
+void wasm_resetStats()
 {
-  return JSMatrix(p_brm(theta->toEigen(), params->toEigen()));
+  resetStats();
 }
 
 /**
- * Generate the item GRM probability matrix for person(s) with given ability estimates
+ * Create a resident item bank
  *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param params      Item parameters, row-major (M x K) array or Float64Array
+ * @param rows        Number of items M
+ * @param cols        Number of parameters K per item
+ * @param type        ModelType.BRM or ModelType.GRM
+ * @param ids         Array of M item id strings (or empty array)
  *
- * @return person/item probability matrix ((N*K) x M) for N people, K categories, and M items
+ * @return ItemBank - caller frees via obj.delete()
  */
-const JSMatrix wasm_p_grm(const JSMatrix *theta, const JSMatrix *params)
+ItemBank *wasm_ItemBank_create(val params, int rows, int cols, ModelType type, val ids)
 {
-  return JSMatrix(p_grm(theta->toEigen(), params->toEigen()));
+  const Vector flat = VectorFromJS<double>(params);
+
+  if (rows < 0 || cols < 0 || flat.size() != (size_t)rows * cols) {
+    throw "ItemBank params length must match rows * cols";
+  }
+
+  return new ItemBank(Eigen::Map<const RowArrayXXd>(flat.data(), rows, cols),
+                      type, vecFromJSArray<std::string>(ids));
 }
 
 /**
- * Derivative of the BRM item probability matrix for person(s) with given ability estimates
+ * Estimate ability of one person from responses to items of a bank
  *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x 3 matrix)
+ * @param bank        ItemBank
+ * @param resp        Responses to all M items (NaN if not administered), or to the given items
+ * @param items       Indices of the answered items (same length as resp), or an empty array if resp is full-length
+ * @param lower       Lower end of the range of abilities to explore
+ * @param upper       Upper end of the range of abilities to explore
+ * @param solver      SolverType.BRENT or SolverType.NEWTON
+ * @param start       Starting ability estimate for SolverType.NEWTON (NaN for the Brent search)
  *
- * @return person/item derivative probability matrix (N x M) for N people and M items
+ * @return object with theta, info, and sem numbers
  */
-const JSMatrix wasm_pder1_brm(const JSMatrix *theta, const JSMatrix *params)
+val wasm_ItemBank_wleEst(const ItemBank &bank, val resp, val items, double lower, double upper, SolverType solver, double start)
 {
-  return JSMatrix(pder1_brm(theta->toEigen(), params->toEigen()));
+  const Vector r = VectorFromJS<double>(resp);
+  const std::vector<int> idx = VectorFromJS<int>(items);
+  const Eigen::Map<const ArrayXd> answers(r.data(), r.size());
+  const RowVector2d range(lower, upper);
+  Est_Result est;
+  val result = val::object();
+
+  est = idx.empty() ? bank.wleEst(answers, range, solver, start) : bank.wleEst(idx, answers, range, solver, start);
+
+  result.set("theta", est.theta(0));
+  result.set("info", est.info(0));
+  result.set("sem", est.sem(0));
+  return result;
 }
 
 /**
- * Derivative of the GRM item probability matrix for person(s) with given ability estimates
- *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
- *
- * @return person/item derivative probability matrix ((N*K) x M) for N people, K categories, and M items
+ * Estimate ability of many people who each answered a different subset of the items of a bank
+ *
+ * @param bank        ItemBank
+ * @param resp        Responses to all M items, row-major (N x M) array or Float64Array, NaN if not administered
+ * @param rows        Number of people N
+ * @param lower       Lower end of the range of abilities to explore
+ * @param upper       Upper end of the range of abilities to explore
+ * @param mask        Administered items, row-major (N x M) Uint8Array (zero to skip), or an empty array
+ * @param solver      SolverType.BRENT or SolverType.NEWTON
+ * @param start       Array of N starting ability estimates for SolverType.NEWTON, or an empty array
+ *
+ * @return object with theta, info, and sem Float64Arrays (N); theta 0 and NaN info/sem for rows without responses
  */
-const JSMatrix wasm_pder1_grm(const JSMatrix *theta, const JSMatrix *params)
+val wasm_ItemBank_wleEst_ragged(const ItemBank &bank, val resp, int rows, double lower, double upper, val mask, SolverType solver, val start)
 {
-  return JSMatrix(pder1_grm(theta->toEigen(), params->toEigen()));
+  const Vector r = VectorFromJS<double>(resp);
+  const Vector s = VectorFromJS<double>(start);
+  const std::vector<uint8_t> m = VectorFromJS<uint8_t>(mask);
+
+  if (rows < 0 || r.size() != (size_t)rows * bank.size()) {
+    throw "ItemBank wleEst_ragged resp length must match rows * items";
+  }
+  if (!m.empty() && m.size() != r.size()) {
+    throw "ItemBank wleEst_ragged mask length must match resp";
+  }
+  if (!s.empty() && s.size() != (size_t)rows) {
+    throw "ItemBank wleEst_ragged start length must match rows";
+  }
+
+  return EstResultToObject(bank.wleEst_ragged(Eigen::Map<const RowArrayXXd>(r.data(), rows, bank.size()), RowVector2d(lower, upper),
+                                              m, solver, Eigen::Map<const ArrayXd>(s.data(), s.size())));
 }
 
 /**
- * 2nd derivative of the BRM item probability matrix for person(s) with given ability estimates
+ * Estimate ability of many people by EAP over a fixed quadrature, from responses to the items of a bank
  *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x 3 matrix)
+ * @param bank        ItemBank
+ * @param resp        Responses to all M items, row-major (N x M) array or Float64Array, NaN if not administered
+ * @param rows        Number of people N
+ * @param nodes       Array of Q ability nodes
+ * @param prior       Array of Q prior weights (normalized here)
  *
- * @return person/item 2nd derivative probability matrix (N x M) for N people and M items
+ * @return object with theta (posterior mean), info (posterior precision), and sem (posterior sd) Float64Arrays (N)
  */
-const JSMatrix wasm_pder2_brm(const JSMatrix *theta, const JSMatrix *params)
+val wasm_ItemBank_eapEst(const ItemBank &bank, val resp, int rows, val nodes, val prior)
 {
-  return JSMatrix(pder2_brm(theta->toEigen(), params->toEigen()));
+  const Vector r = VectorFromJS<double>(resp);
+  const Vector x = VectorFromJS<double>(nodes);
+  const Vector w = VectorFromJS<double>(prior);
+
+  if (rows < 0 || r.size() != (size_t)rows * bank.size()) {
+    throw "ItemBank eapEst resp length must match rows * items";
+  }
+
+  return EstResultToObject(eapEst(Eigen::Map<const RowArrayXXd>(r.data(), rows, bank.size()), bank.params(), bank.model(),
+                                  quadrature(Eigen::Map<const ArrayXd>(x.data(), x.size()), Eigen::Map<const ArrayXd>(w.data(), w.size()))));
 }
 
 /**
- * 2nd derivative of the GRM item probability matrix for person(s) with given ability estimates
+ * Classify many people by the generalized likelihood ratio, from responses to the items of a bank
+ *
+ * @param bank        ItemBank
+ * @param resp        Responses to all M items, row-major (N x M) array or Float64Array, NaN if not administered
+ * @param rows        Number of people N
+ * @param lower       Lower end of the range of abilities to search
+ * @param upper       Upper end of the range of abilities to search
+ * @param bounds      Array of B classification bounds
+ * @param delta       Half width of the indifference region around each bound
+ * @param alpha       Type I error rate
+ * @param beta        Type II error rate
+ *
+ * @return object with category (Int32Array (N), -1 if not classified) and likratio (Float64Array (N x B) row-major)
+ */
+val wasm_ItemBank_termGLR(const ItemBank &bank, val resp, int rows, double lower, double upper, val bounds, double delta, double alpha, double beta)
+{
+  const Vector r = VectorFromJS<double>(resp);
+  const Vector b = VectorFromJS<double>(bounds);
+
+  if (rows < 0 || r.size() != (size_t)rows * bank.size()) {
+    throw "ItemBank termGLR resp length must match rows * items";
+  }
+
+  return GLRResultToObject(termGLR(Eigen::Map<const RowArrayXXd>(r.data(), rows, bank.size()), bank.params(), bank.model(), RowVector2d(lower, upper),
+                                   Eigen::Map<const ArrayXd>(b.data(), b.size()), delta, alpha, beta));
+}
+
+/**
+ * Expected Fisher Information of the items of a bank for one ability estimate
  *
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param bank        ItemBank
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (M entries, non-zero to skip an item), or an empty array
  *
- * @return person/item 2nd derivative probability matrix ((N*K) x M) for N people, K categories, and M items
+ * @return Float64Array of M item information values, NaN for excluded items
  */
-const JSMatrix wasm_pder2_grm(const JSMatrix *theta, const JSMatrix *params)
+val wasm_ItemBank_FI_expected(const ItemBank &bank, double theta, val exclude)
 {
-  return JSMatrix(pder2_grm(theta->toEigen(), params->toEigen()));
+  return Float64ArrayFromVector(bank.FI_expected(theta, VectorFromJS<uint8_t>(exclude)));
 }
 
 /**
- * Derivative of log-likelihoods of reponses to items at given ability estimates
+ * Expected Fisher Information (modified unweighted) of the items of a BRM bank for given phase 1 and phase 2 ability estimates
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x 3 matrix)
- * @param type        LderType.WLE (weighted likelihood) or LderType.MLE (maximum likelihood)
+ * @param bank          Phase 2 ItemBank
+ * @param theta         Phase 2 ability estimate
+ * @param phase1        Phase 1 ItemBank (same items)
+ * @param phase1_theta  Phase 1 ability estimate
+ * @param exclude       Exclusion mask (M entries, non-zero to skip an item), or an empty array
  *
- * @return derivative of log-likelihood for each person - vector (N x 1)
+ * @return Float64Array of M item information values, NaN for excluded items
  */
-const Vector wasm_lder1_brm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LderType type)
+val wasm_ItemBank_FI_modified_expected(const ItemBank &bank, double theta, const ItemBank &phase1, double phase1_theta, val exclude)
 {
-  return VectorFromMatrix(lder1_brm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
+  return Float64ArrayFromVector(bank.FI_modified_expected(theta, phase1, phase1_theta, VectorFromJS<uint8_t>(exclude)));
 }
 
 /**
- * Derivative of log-likelihoods of reponses to items at given ability estimates
+ * Convert a Choose_Result to a JS object with items (Int32Array of bank indices) and info (Float64Array)
+ */
+val ChooseResultToObject( const Choose_Result &r )
+{
+    val result = val::object();
+    result.set("items", TypedArrayFromData(r.items.data(), r.items.size()));
+    result.set("info", TypedArrayFromData(r.info.data(), r.info.size()));
+    return result;
+}
+
+/**
+ * Choose items of a bank by expected information (UW-FI)
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
- * @param type        LderType.WLE (weighted likelihood) or LderType.MLE (maximum likelihood)
+ * @param bank        ItemBank
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (M entries, non-zero for administered items), or an empty array
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to randomly choose from the top n_select
  *
- * @return derivative of log-likelihood for each person/category - vector (N x 1)
+ * @return object with items (Int32Array of bank indices) and info (Float64Array)
  */
-const Vector wasm_lder1_grm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LderType type)
+val wasm_ItemBank_itChoose(ItemBank &bank, double theta, val exclude, int n_select, int numb)
 {
-  return VectorFromMatrix(lder1_grm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
+  return ChooseResultToObject(bank.itChoose(theta, VectorFromJS<uint8_t>(exclude), n_select, numb));
 }
 
 /**
- * BRM model log-likelihoods of reponses to items at given ability estimates
- *
- * Port of: lokLik.brm.R
+ * Choose items of a BRM bank by modified expected information (UW-FI-Modified)
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people (or T thetas if N is 1)
- * @param params      Parameters for M items (M x 3 matrix)
- * @param type        LogLikType.MLE or LogLikType.BME (not yet supported)
+ * @param bank          Phase 2 ItemBank
+ * @param theta         Phase 2 ability estimate
+ * @param phase1        Phase 1 ItemBank (same items)
+ * @param phase1_theta  Phase 1 ability estimate
+ * @param exclude       Exclusion mask (M entries, non-zero for administered items), or an empty array
+ * @param n_select      Number of most informative items to choose from
+ * @param numb          Number of items to randomly choose from the top n_select
  *
- * @return log-likelihood for each person - vector (N x 1), or for each theta - vector (T x 1)
+ * @return object with items (Int32Array of bank indices) and info (Float64Array)
  */
-const Vector wasm_logLik_brm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LogLikType type)
+val wasm_ItemBank_itChoose_modified(ItemBank &bank, double theta, const ItemBank &phase1, double phase1_theta, val exclude, int n_select, int numb)
 {
-  return VectorFromMatrix(logLik_brm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
+  return ChooseResultToObject(bank.itChoose_modified(theta, phase1, phase1_theta, VectorFromJS<uint8_t>(exclude), n_select, numb));
 }
 
 /**
- * GRM model log-likelihoods of reponses to items at given ability estimates
+ * Tabulate the bank at the nodes of a quadrature for the posterior-weighted selection criteria
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people (or T thetas if N is 1)
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
- * @param type        LogLikType.MLE or LogLikType.BME (not yet supported)
- *
- * @return log-likelihood for each person - vector (N x 1), or for each theta - vector (T x 1)
+ * @param bank        ItemBank
+ * @param nodes       Array of Q ability nodes
+ * @param prior       Array of Q prior weights (normalized here)
  */
-const Vector wasm_logLik_grm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params, LogLikType type)
+void wasm_ItemBank_buildQuadTable(ItemBank &bank, val nodes, val prior)
 {
-  return VectorFromMatrix(logLik_grm(u->toEigen(), theta->toEigen(), params->toEigen(), type));
+  const Vector x = VectorFromJS<double>(nodes);
+  const Vector w = VectorFromJS<double>(prior);
+
+  bank.buildQuadTable(quadrature(Eigen::Map<const ArrayXd>(x.data(), x.size()), Eigen::Map<const ArrayXd>(w.data(), w.size())));
 }
 
 /**
- * Select item/category likelihoods
+ * Choose items of a bank by a posterior-weighted criterion (PW-FI or PW-KL), see wasm_ItemBank_buildQuadTable
  *
- * @param p ((M*K) x J) likelihood values for all categories / various thetas
- * @param u Item responses (N people x J responses)
- * @param K number of categories
+ * @param bank        ItemBank with a quadrature table
+ * @param select      SelectType.PW_FI or SelectType.PW_KL
+ * @param theta       Ability estimate (PW_KL)
+ * @param resp        Responses to all M items so far, NaN if not administered
+ * @param exclude     Exclusion mask (M entries, non-zero for administered items), or an empty array
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to randomly choose from the top n_select
  *
- * @return (T x J) matrix - item likelihoods where T = {N, for N>1; M, for N=1}
+ * @return object with items (Int32Array of bank indices) and info (Float64Array of the criterion)
  */
-const JSMatrix wasm_sel_prm(const JSMatrix *p, const JSMatrix *u, int K)
+val wasm_ItemBank_itChoose_posterior(ItemBank &bank, SelectType select, double theta, val resp, val exclude, int n_select, int numb)
 {
-  return JSMatrix(sel_prm(p->toEigen(), u->toEigen(), K));
+  const Vector r = VectorFromJS<double>(resp);
+
+  return ChooseResultToObject(bank.itChoose_posterior(select, theta, Eigen::Map<const ArrayXd>(r.data(), r.size()), VectorFromJS<uint8_t>(exclude),
+                                                      n_select, numb));
 }
 
 /**
- * 2nd derivative of log-likelihoods of reponses to items at given ability estimates
+ * Parameters of an item bank
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x 3 matrix)
+ * @param bank        ItemBank
  *
- * @return 2nd derivative of log-likelihood for each person - vector (N x M)
+ * @return Float64Array of the M x K parameters, row-major (the K parameters of item j at j * K)
  */
-const JSMatrix wasm_lder2_brm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params)
+val wasm_ItemBank_params(const ItemBank &bank)
 {
-  return JSMatrix(lder2_brm(u->toEigen(), theta->toEigen(), params->toEigen()));
+  const ArrayXXd t = bank.params().transpose();
+  return TypedArrayFromData(t.data(), t.size());
 }
 
 /**
- * 2nd derivative of log-likelihoods of reponses to items at given ability estimates
+ * Write an item bank in the binary item bank format (parameters, ids, precision, and info table)
  *
- * @param u           Item responses (N people x M responses)
- * @param theta       Ability estimates for N people
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param bank        ItemBank
  *
- * @return 2nd derivative of log-likelihood for each person - vector (N x M)
+ * @return Uint8Array, see loadItemBank
  */
-const JSMatrix wasm_lder2_grm(const JSMatrix *u, const JSMatrix *theta, const JSMatrix *params)
+val wasm_ItemBank_serialize(const ItemBank &bank)
 {
-  return JSMatrix(lder2_grm(u->toEigen(), theta->toEigen(), params->toEigen()));
+  const std::vector<uint8_t> blob = bank.serialize();
+  return TypedArrayFromData(blob.data(), blob.size());
 }
 
-// wraps FI_Result Array properties into JSMatrix
-struct JSFI_Result
+/**
+ * Replace an item bank with one in the binary item bank format
+ *
+ * @param bank        ItemBank (unchanged on error)
+ * @param blob        Uint8Array from serialize(), copied once into an uninitialized WASM heap
+ *                    buffer and parsed there in place
+ *
+ * @return null, or an object with an error property if blob is not a valid binary item bank
+ */
+val wasm_ItemBank_deserialize(ItemBank &bank, val blob)
 {
-    JSMatrix item;
-    Vector test;
-    Vector sem;
-    FIType type;
+  const size_t size = blob["length"].as<size_t>();
+  std::unique_ptr<uint8_t, decltype(&free)> data(static_cast<uint8_t *>(malloc(size > 0 ? size : 1)), &free);
+  val result = val::null();
 
-    JSFI_Result() {}
+  if (!data) {
+    result = val::object();
+    result.set("error", std::string("ItemBank deserialize out of memory"));
+    return result;
+  }
+  CATIRT_STAT_ADD(Stat::BYTES_IN, size);
+  val(typed_memory_view(size, data.get())).call<void>("set", blob);
 
-    JSFI_Result(const FI_Result &r)
-    {
-        item = JSMatrix(r.item);
-        test = VectorFromMatrix(r.test);
-        sem = VectorFromMatrix(r.sem);
-        type = r.type;
-    }
+  const char *error = bank.tryDeserialize(data.get(), size);
 
-    JSFI_Result(const JSFI_Result &r)
-    {
-        item = r.item;
-        test = r.test;
-        sem = r.sem;
-        type = r.type;
-    }
-};
+  if (error) {
+    result = val::object();
+    result.set("error", std::string(error));
+  }
+  return result;
+}
 
 /**
- * Fisher Information of BRM items for given ability estimates and optional responses (for OBSERVED info)
+ * Start a CAT session against an item bank
  *
- * @param params      Parameters for M items (M x 3 matrix)
- * @param theta       Ability estimates for N people
- * @param type        FIType.EXPECTED or FIType.OBSERVED
- * @param resp        Item responses (N people x M responses) should be size 0 for FIType.EXPECTED
+ * @param bank        ItemBank of the session (must not be deleted before the session)
+ * @param lower       Lower end of the range of abilities to explore (negative)
+ * @param upper       Upper end of the range of abilities to explore (positive)
  *
- * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
+ * @return CatSession - caller frees via obj.delete()
  */
-JSFI_Result wasm_FI_brm(const JSMatrix *params, const JSMatrix *theta, FIType type, const JSMatrix *resp)
+CatSession *wasm_CatSession_create(ItemBank &bank, double lower, double upper)
 {
-  return JSFI_Result(FI_brm(params->toEigen(), theta->toEigen(), type, resp->toEigen()));
+  return new CatSession(bank, RowVector2d(lower, upper));
 }
 
 /**
- * Expected Fisher Information (modified unweighted) of BRM items for given phase 1 and phase 2 ability estimates
+ * Record the response to one administered item
  *
- * @param p2_params      Phase 2 parameters for M items (M x 3 matrix)
- * @param p2_theta       Phase 2 ability estimates for N people
- * @param p1_params      Phase 1 parameters for M items (M x 3 matrix)
- * @param p1_theta       Phase 1 ability estimates for N people
+ * @param session     CatSession
+ * @param item        Bank index of the administered item
+ * @param value       Response: 0 or 1 (BRM), or category 1 to K (GRM)
  *
- * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
+ * @return null, or an object with an error property if the response was not added
  */
-JSFI_Result wasm_FI_brm_modified_expected(const JSMatrix *p2_params, const JSMatrix *p2_theta, const JSMatrix *p1_params, const JSMatrix *p1_theta)
+val wasm_CatSession_addResponse(CatSession &session, int item, double value)
 {
-  return JSFI_Result(FI_brm_modified_expected(p2_params->toEigen(), p2_theta->toEigen(), p1_params->toEigen(), p1_theta->toEigen()));
+  const char *error = session.checkResponse(item, value);
+  val result = val::null();
+
+  if (error) {
+    result = val::object();
+    result.set("error", std::string(error));
+    return result;
+  }
+
+  session.addResponse(item, value);
+  return result;
 }
 
 /**
- * Fisher Information of GRM items for given ability estimates and optional responses (for OBSERVED info)
+ * Ability estimate of the responses so far
  *
- * @param params      Parameters for M items (M x K matrix) where K is number of categories
- * @param theta       Ability estimates for N people
- * @param type        FIType.EXPECTED or FIType.OBSERVED
- * @param resp        Item responses (N people x M responses) should be size 0 for FIType.EXPECTED
+ * @param session     CatSession
  *
- * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
+ * @return object with theta, info, and sem numbers
  */
-JSFI_Result wasm_FI_grm(const JSMatrix *params, const JSMatrix *theta, FIType type, const JSMatrix *resp)
+val wasm_CatSession_estimate(CatSession &session)
 {
-  return JSFI_Result(FI_grm(params->toEigen(), theta->toEigen(), type, resp->toEigen()));
+  const Est_Result& est = session.estimate();
+  val result = val::object();
+
+  result.set("theta", est.theta(0));
+  result.set("info", est.info(0));
+  result.set("sem", est.sem(0));
+  return result;
 }
 
 /**
- * Search the range interval for a root of the specificed BRM or GRM lder1 function with respect to theta
+ * Choose the next item(s) of a session by expected information (UW-FI)
  *
- * @param range       Interval to search: should be [-X,+X] for some positive X
- * @param resp        Item responses for a single person (1 x M)
- * @param params      Parameters for M items (M x K matrix)
- * @param type        LderType.WLE (weighted likelihood) or LderType.MLE (maximum likelihood)
- * @param model       ModelType.BRM or ModelType.GRM
+ * @param session     CatSession
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to randomly choose from the top n_select
  *
- * @return Uniroot_Result with iter=-1 if a root did not converge within max iterations
+ * @return object with items (Int32Array of bank indices) and info (Float64Array), or with an error property
  */
-Uniroot_Result wasm_uniroot_lder1(const JSMatrix *range, const JSMatrix *resp, const JSMatrix *params, LderType type, ModelType model)
+val wasm_CatSession_nextItem(CatSession &session, int n_select, int numb)
 {
-    const ArrayXd (*lderFP)(const Eigen::Ref<const ArrayXXd>&, const Eigen::Ref<const ArrayXd>&, const Eigen::Ref<const ArrayXXd>&, LderType);
+  if (n_select < 1 || numb < 1) {
+    val result = val::object();
+    result.set("error", std::string("n_select and numb must be positive"));
+    return result;
+  }
 
-    if (model == ModelType::BRM) {
-        lderFP = &lder1_brm;
-    } else {
-        lderFP = &lder1_grm;
-    }
+  return ChooseResultToObject(session.nextItem(n_select, numb));
+}
 
-    return uniroot_lder1(lderFP, RowVector2d(range->toEigen()), resp->toEigen(), params->toEigen(), type);
+/**
+ * Bank indices of the administered items of a session
+ *
+ * @param session     CatSession
+ *
+ * @return Int32Array of item indices, in order of administration
+ */
+val wasm_CatSession_items(const CatSession &session)
+{
+  return TypedArrayFromData(session.items().data(), session.items().size());
 }
 
-// wraps Est_Result Array properties into Vectors
-struct JSEst_Result
+/**
+ * Pack the state of a session into a compact binary blob
+ *
+ * @param session     CatSession
+ *
+ * @return Uint8Array, or an object with an error property if the bank is too large to serialize
+ */
+val wasm_CatSession_serialize(const CatSession &session)
 {
-    Vector theta;
-    Vector info;
-    Vector sem;
+  val result = val::object();
 
-    JSEst_Result() {}
+  if (session.bank().size() > 65536) {
+    result.set("error", std::string("CatSession serialize supports item banks of at most 65536 items"));
+    return result;
+  }
 
-    JSEst_Result(const Est_Result &r)
-    {
-        theta = VectorFromMatrix(r.theta);
-        info = VectorFromMatrix(r.info);
-        sem = VectorFromMatrix(r.sem);
-    }
-};
+  const std::vector<uint8_t> blob = session.serialize();
+  return TypedArrayFromData(blob.data(), blob.size());
+}
 
 /**
- * Estimate ability from one or more sets of item responses
+ * Restore the state of a serialized session of the same bank
  *
- * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
- * @param params      Parameters for M items (M x K matrix)
- * @param range       Range of abilities to explore (2 x 1)
- * @param type        ModelType.BRM or ModelType.GRM
+ * @param session     CatSession (unchanged on error)
+ * @param blob        Uint8Array from serialize()
  *
- * @return Est_Result with theta (Nx1), info (Nx1), and sem (Nx1) info
+ * @return null, or an object with an error property if the blob does not match the bank
  */
-JSEst_Result wasm_wleEst(const JSMatrix *resp, const JSMatrix *params, const JSMatrix *range, ModelType type)
+val wasm_CatSession_deserialize(CatSession &session, val blob)
 {
-  return JSEst_Result(wleEst(resp->toEigen(), params->toEigen(), range->toEigen(), type));
+  const char *error = session.tryDeserialize(VectorFromJS<uint8_t>(blob));
+  val result = val::null();
+
+  if (error) {
+    result = val::object();
+    result.set("error", std::string(error));
+  }
+  return result;
 }
 
 EMSCRIPTEN_BINDINGS(Module)
@@ -1428,6 +1196,31 @@ EMSCRIPTEN_BINDINGS(Module)
         .value("GRM", ModelType::GRM)
         ;
 
+    enum_<SolverType>("SolverType")
+        .value("BRENT", SolverType::BRENT)
+        .value("NEWTON", SolverType::NEWTON)
+        ;
+
+    enum_<InterpType>("InterpType")
+        .value("LINEAR", InterpType::LINEAR)
+        .value("CUBIC", InterpType::CUBIC)
+        ;
+
+    enum_<Precision>("Precision")
+        .value("FLOAT64", Precision::FLOAT64)
+        .value("FLOAT32", Precision::FLOAT32)
+        ;
+
+    enum_<SelectType>("SelectType")
+        .value("PW_FI", SelectType::PW_FI)
+        .value("PW_KL", SelectType::PW_KL)
+        ;
+
+    enum_<QuadType>("QuadType")
+        .value("GAUSS_HERMITE", QuadType::GAUSS_HERMITE)
+        .value("EQUAL", QuadType::EQUAL)
+        ;
+
     value_object<JSFI_Result>("FI_Result")
         .field("item", &JSFI_Result::item)
         .field("test", &JSFI_Result::test)
@@ -1452,10 +1245,13 @@ EMSCRIPTEN_BINDINGS(Module)
         .constructor<int, int>()
         .constructor<const JSMatrix&>()
         .class_function("fromVector", &JSMatrix::fromVector)
+        .class_function("fromTypedArray", &JSMatrix::fromTypedArray)
+        .class_function("fromPointer", &JSMatrix::fromPointer)
         .function("rows", &JSMatrix::rows)
         .function("cols", &JSMatrix::cols)
         .function("get", &JSMatrix::get)
         .function("set", &JSMatrix::set)
+        .function("toTypedArray", &JSMatrix::toTypedArray)
         ;
 
     function("wasm_p_brm", &wasm_p_brm, allow_raw_pointers());
@@ -1476,6 +1272,60 @@ EMSCRIPTEN_BINDINGS(Module)
     function("wasm_FI_grm", &wasm_FI_grm, allow_raw_pointers());
     function("wasm_uniroot_lder1", &wasm_uniroot_lder1, allow_raw_pointers());
     function("wasm_wleEst", &wasm_wleEst, allow_raw_pointers());
+    function("wasm_wleEst_solver", &wasm_wleEst_solver, allow_raw_pointers());
+    function("wasm_wleEst_ragged", &wasm_wleEst_ragged, allow_raw_pointers());
+    function("wasm_termGLR", &wasm_termGLR, allow_raw_pointers());
+    function("wasm_quadrature", &wasm_quadrature);
+    function("wasm_eapEst", &wasm_eapEst, allow_raw_pointers());
+    function("wasm_setNumThreads", &wasm_setNumThreads);
+    function("wasm_getNumThreads", &wasm_getNumThreads);
+    function("wasm_getStats", &wasm_getStats);
+    function("wasm_resetStats", &wasm_resetStats);
+
+    class_<ItemBank>("ItemBank")
+        .constructor(&wasm_ItemBank_create, allow_raw_pointers())
+        .constructor<>()
+        .function("size", &ItemBank::size)
+        .function("categories", &ItemBank::categories)
+        .function("model", &ItemBank::model)
+        .function("id", &ItemBank::id)
+        .function("params", &wasm_ItemBank_params)
+        .function("buildInfoTable", &ItemBank::buildInfoTable)
+        .function("hasInfoTable", &ItemBank::hasInfoTable)
+        .function("infoTableError", &ItemBank::infoTableError)
+        .function("setPhase1", &ItemBank::setPhase1)
+        .function("setPrecision", &ItemBank::setPrecision)
+        .function("precision", &ItemBank::precision)
+        .function("seed", &ItemBank::seed)
+        .function("hasQuadTable", &ItemBank::hasQuadTable)
+        .function("serialize", &wasm_ItemBank_serialize)
+        .function("deserialize", &wasm_ItemBank_deserialize)
+        ;
+
+    function("wasm_ItemBank_wleEst", &wasm_ItemBank_wleEst);
+    function("wasm_ItemBank_wleEst_ragged", &wasm_ItemBank_wleEst_ragged);
+    function("wasm_ItemBank_eapEst", &wasm_ItemBank_eapEst);
+    function("wasm_ItemBank_termGLR", &wasm_ItemBank_termGLR);
+    function("wasm_ItemBank_FI_expected", &wasm_ItemBank_FI_expected);
+    function("wasm_ItemBank_FI_modified_expected", &wasm_ItemBank_FI_modified_expected);
+    function("wasm_ItemBank_itChoose", &wasm_ItemBank_itChoose);
+    function("wasm_ItemBank_itChoose_modified", &wasm_ItemBank_itChoose_modified);
+    function("wasm_ItemBank_buildQuadTable", &wasm_ItemBank_buildQuadTable);
+    function("wasm_ItemBank_itChoose_posterior", &wasm_ItemBank_itChoose_posterior);
+
+    class_<CatSession>("CatSession")
+        .constructor(&wasm_CatSession_create, allow_raw_pointers())
+        .function("size", &CatSession::size)
+        .function("theta", &CatSession::theta)
+        .function("info", &CatSession::info)
+        .function("sem", &CatSession::sem)
+        .function("items", &wasm_CatSession_items)
+        .function("addResponse", &wasm_CatSession_addResponse)
+        .function("estimate", &wasm_CatSession_estimate)
+        .function("nextItem", &wasm_CatSession_nextItem)
+        .function("serialize", &wasm_CatSession_serialize)
+        .function("deserialize", &wasm_CatSession_deserialize)
+        ;
 }
 
 /*******************************************
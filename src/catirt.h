@@ -0,0 +1,240 @@
+#ifndef CATIRT_H
+#define CATIRT_H
+
+#include <Eigen/Core>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+enum class LderType {
+    MLE,
+    WLE
+};
+
+enum class FIType {
+    EXPECTED,
+    OBSERVED
+};
+
+enum class LogLikType {
+    MLE,
+    BME
+};
+
+enum class ModelType {
+    BRM,
+    GRM
+};
+
+enum class SolverType {
+    BRENT,
+    NEWTON
+};
+
+// quadrature of the EAP prior
+enum class QuadType {
+    GAUSS_HERMITE,  // Gauss-Hermite nodes and weights of a normal prior
+    EQUAL           // equally spaced nodes over a range, weighted by the prior density
+};
+
+// precision of item selection and information tables (scoring is always FLOAT64)
+enum class Precision {
+    FLOAT64,
+    FLOAT32
+};
+
+// performance counters (read with getStat; 0 unless built with CATIRT_ENABLE_STATS, *_NS also
+// 0 unless built with CATIRT_ENABLE_STAT_TIMERS)
+enum class Stat {
+    PROB_CALLS,         // p_*, pder1_*, pder2_*, sel_prm
+    PROB_NS,            // time in them (nanoseconds)
+    LOGLIK_CALLS,       // logLik_*, lder1_*, lder2_*
+    LOGLIK_NS,
+    FI_CALLS,           // FI_* and ItemBank expected information
+    FI_NS,
+    WLE_CALLS,          // wleEst, wleEst_ragged, eapEst, ItemBank::wleEst, CatSession::estimate
+    WLE_NS,
+    GLR_CALLS,          // termGLR
+    GLR_NS,
+    SELECT_CALLS,       // ItemBank::itChoose, ItemBank::itChoose_modified
+    SELECT_NS,
+    UNIROOT_CALLS,      // Brent searches (uniroot_lder1 and the Brent WLE solver)
+    UNIROOT_ITERATIONS, // iterations of them
+    UNIROOT_MAXIT,      // searches that hit maxit (iter = -1)
+    NEWTON_CALLS,       // newton_wle searches
+    NEWTON_ITERATIONS,
+    NEWTON_FALLBACKS,   // searches answered by the Brent solver (3PL/GRM items, uncertified root, or iter = -1)
+    BYTES_IN,           // bytes copied from JavaScript into the module (wasm build)
+    BYTES_OUT,          // bytes copied from the module to JavaScript (wasm build)
+    ALLOCS,             // heap allocations (malloc, calloc, realloc, aligned) made in the module (wasm build)
+    BYTES_ALLOCATED,    // bytes requested by them
+    COUNT
+};
+
+using ArrayXd = Eigen::ArrayXd;
+using ArrayXXd = Eigen::ArrayXXd;
+using ArrayX3d = Eigen::ArrayX3d;
+using ArrayXXf = Eigen::ArrayXXf;
+using ArrayXi = Eigen::ArrayXi;
+using RowVector2d = Eigen::RowVector2d;
+
+struct FI_Result
+{
+    ArrayXXd item;
+    ArrayXd test;
+    ArrayXd sem;
+    FIType type;
+
+    FI_Result() {}
+
+    FI_Result(FIType type)
+    {
+        this->type = type;
+    }
+
+    FI_Result(const FI_Result &r)
+    {
+        // allows Eigen optimizations not available with default copy constructor
+        item = r.item;
+        test = r.test;
+        sem = r.sem;
+        type = r.type;
+    }
+};
+
+struct Uniroot_Result
+{
+    double root;
+    double f_root;
+    int iter;
+    double estim_prec;
+};
+
+struct WLE_Root
+{
+    double root;
+    double f_root;
+    int iter;
+    double info;    // observed test information at root
+    double corr;    // Warm correction at root
+};
+
+struct Est_Result
+{
+    ArrayXd theta;
+    ArrayXd info;
+    ArrayXd sem;
+
+    Est_Result() {}
+
+    Est_Result(const Est_Result &r)
+    {
+        // allows Eigen optimizations not available with default copy constructor
+        theta = r.theta;
+        info = r.info;
+        sem = r.sem;
+    }
+};
+
+struct Quadrature
+{
+    ArrayXd nodes;      // ability points (Q)
+    ArrayXd weights;    // prior weights at the nodes (Q), summing to 1
+};
+
+struct GLR_Result
+{
+    ArrayXi category;   // index of the classified category (N), -1 if not classified
+    ArrayXXd likratio;  // log-likelihood ratio at each bound (N x B), NaN for people without responses
+};
+
+/*
+ * Threads used by the row-parallel batch functions (1 unless built with CATIRT_THREADS)
+ */
+void setNumThreads(int n);
+int getNumThreads();
+
+/*
+ * Performance counters (see catirt_stats.h)
+ */
+bool statsEnabled();
+bool statTimersEnabled();
+uint64_t getStat(Stat s);
+const char *statName(Stat s);
+void resetStats();
+
+/*
+ * Item response probabilities and derivatives (see catirt_core.cpp for full documentation)
+ */
+const ArrayXXd p_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params);
+const ArrayXXd p_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params);
+const ArrayXXd pder1_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params);
+const ArrayXXd pder1_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params);
+const ArrayXXd pder2_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params);
+const ArrayXXd pder2_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params);
+const ArrayXXd sel_prm( const Eigen::Ref<const ArrayXXd>& p, const Eigen::Ref<const ArrayXXd>& u, int K );
+
+/*
+ * Log-likelihoods and their derivatives
+ */
+const ArrayXd logLik_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params, LogLikType type=LogLikType::MLE );
+const ArrayXd logLik_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LogLikType type=LogLikType::MLE );
+const ArrayXd lder1_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype );
+const ArrayXd lder1_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype );
+const ArrayXXd lder2_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params );
+const ArrayXXd lder2_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params );
+
+/*
+ * Fisher information
+ */
+const FI_Result FI_brm( const Eigen::Ref<const ArrayX3d>& params, const Eigen::Ref<const ArrayXd>& theta, FIType type, const Eigen::Ref<const ArrayXXd>& resp );
+const FI_Result FI_brm_modified_expected( const Eigen::Ref<const ArrayX3d>& p2_params, const Eigen::Ref<const ArrayXd>& p2_theta, const Eigen::Ref<const ArrayX3d>& p1_params, const Eigen::Ref<const ArrayXd>& p1_theta );
+const FI_Result FI_grm( const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const ArrayXd>& theta, FIType type, const Eigen::Ref<const ArrayXXd>& resp );
+
+/*
+ * Ability estimation
+ */
+Uniroot_Result uniroot_lder1(
+    const ArrayXd (*lderFP)(const Eigen::Ref<const ArrayXXd>&, const Eigen::Ref<const ArrayXd>&, const Eigen::Ref<const ArrayXXd>&, LderType),
+    const Eigen::Ref<const RowVector2d>& range,
+    const Eigen::Ref<const ArrayXXd>& resp,
+    const Eigen::Ref<const ArrayXXd>& params,
+    LderType type,
+    int maxit = 1000,
+    double tol = 0.0
+);
+WLE_Root newton_wle(
+    const Eigen::Ref<const ArrayXXd>& resp,
+    const Eigen::Ref<const ArrayXXd>& params,
+    const Eigen::Ref<const RowVector2d>& range,
+    ModelType type,
+    double start = NAN,
+    int maxit = 100,
+    double tol = 0.0
+);
+WLE_Root wle_root(
+    const Eigen::Ref<const ArrayXXd>& resp,
+    const Eigen::Ref<const ArrayXXd>& params,
+    const Eigen::Ref<const RowVector2d>& range,
+    ModelType type,
+    SolverType solver = SolverType::BRENT,
+    double start = NAN
+);
+const Est_Result wleEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type );
+const Est_Result wleEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type,
+                         SolverType solver, const Eigen::Ref<const ArrayXd>& start );
+const Est_Result wleEst_ragged( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type,
+                                const std::vector<uint8_t>& mask, SolverType solver = SolverType::BRENT, const Eigen::Ref<const ArrayXd>& start = ArrayXd() );
+
+Quadrature quadrature( QuadType type, int n, double mean = 0, double sd = 1, const Eigen::Ref<const RowVector2d>& range = RowVector2d(-6, 6) );
+Quadrature quadrature( const Eigen::Ref<const ArrayXd>& nodes, const Eigen::Ref<const ArrayXd>& prior );
+const Est_Result eapEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, ModelType type, const Quadrature& quad );
+
+/*
+ * Classification
+ */
+const GLR_Result termGLR( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, ModelType type, const Eigen::Ref<const RowVector2d>& range,
+                          const Eigen::Ref<const ArrayXd>& bounds, double delta, double alpha, double beta );
+
+#endif // CATIRT_H
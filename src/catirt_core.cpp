@@ -0,0 +1,1907 @@
+#include <algorithm>
+#include <atomic>
+#include "catirt.h"
+#include "catirt_kernels.h"
+#include "catirt_parallel.h"
+#include "catirt_stats.h"
+#include "workspace.h"
+
+#if CATIRT_THREADS
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+static std::atomic<int> num_threads(std::max(1, (int)std::thread::hardware_concurrency()));
+
+//
+// Worker threads of parallel_run. A job is published under mu_ with a new generation; the
+// workers and the calling thread claim its chunks under mu_ and run them unlocked. The caller
+// returns once every chunk has finished, so no worker touches a job after its caller returns.
+//
+class ThreadPool
+{
+public:
+    ~ThreadPool()
+    {
+        std::lock_guard<std::mutex> busy(busy_);
+        resize(0);
+    }
+
+    bool run(int n_chunks, void (*job)(void *, int), void *ctx)
+    {
+        if (in_parallel) {
+            return false;
+        }
+        std::unique_lock<std::mutex> busy(busy_, std::try_to_lock);
+        if (!busy) {
+            return false;
+        }
+        if ((int)threads_.size() != num_threads - 1) {
+            resize(num_threads - 1);
+        }
+
+        std::unique_lock<std::mutex> lock(mu_);
+        job_ = job;
+        ctx_ = ctx;
+        n_chunks_ = n_chunks;
+        next_ = 0;
+        remaining_ = n_chunks;
+        error_ = nullptr;
+        const uint64_t generation = ++generation_;
+        start_.notify_all();
+
+        in_parallel = true;
+        drain(lock, generation);
+        in_parallel = false;
+        done_.wait(lock, [this] { return remaining_ == 0; });
+
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        lock.unlock();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return true;
+    }
+
+    // lower the number of workers to n (joining the others) once no job is running
+    void shrink(int n)
+    {
+        if (in_parallel) {
+            return;
+        }
+        std::lock_guard<std::mutex> busy(busy_);
+        if ((int)threads_.size() > n) {
+            resize(n);
+        }
+    }
+
+private:
+    // start or join workers so that n run (busy_ held)
+    void resize(int n)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            size_ = n;
+        }
+        start_.notify_all();
+        while ((int)threads_.size() > n) {
+            threads_.back().join();
+            threads_.pop_back();
+        }
+        try {
+            while ((int)threads_.size() < n) {
+                threads_.emplace_back(&ThreadPool::work, this, (int)threads_.size());
+            }
+        } catch (const std::system_error&) {
+            // keep the workers that did start; the caller runs the remaining chunks
+            std::lock_guard<std::mutex> lock(mu_);
+            size_ = threads_.size();
+        }
+    }
+
+    void work(int index)
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mu_);
+
+        in_parallel = true;
+        for (;;) {
+            start_.wait(lock, [&] { return index >= size_ || generation_ != seen; });
+            if (index >= size_) {
+                return;
+            }
+            seen = generation_;
+            drain(lock, seen);
+        }
+    }
+
+    // run chunks of the current job until none are left to claim (mu_ held on entry and exit)
+    void drain(std::unique_lock<std::mutex>& lock, uint64_t generation)
+    {
+        while (generation_ == generation && next_ < n_chunks_) {
+            const int c = next_++;
+            std::exception_ptr error;
+
+            lock.unlock();
+            try {
+                job_(ctx_, c);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (--remaining_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+
+    static thread_local bool in_parallel;
+
+    std::mutex busy_;                   // held by the thread running a job, and while resizing
+    std::mutex mu_;                     // guards the fields below
+    std::condition_variable start_, done_;
+    std::vector<std::thread> threads_;
+    int size_ = 0;                      // workers with index >= size_ exit
+    uint64_t generation_ = 0;
+    void (*job_)(void *, int) = nullptr;
+    void *ctx_ = nullptr;
+    int n_chunks_ = 0;
+    int next_ = 0;                      // next chunk to claim
+    int remaining_ = 0;                 // chunks not yet finished
+    std::exception_ptr error_;
+};
+
+thread_local bool ThreadPool::in_parallel = false;
+
+static ThreadPool& thread_pool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+bool parallel_run(int n_chunks, void (*job)(void *, int), void *ctx)
+{
+  return thread_pool().run(n_chunks, job, ctx);
+}
+#endif
+
+/**MDJAVADOC_SKIP
+ * Set the number of threads used by the row-parallel batch functions
+ *
+ * Ignored unless built with CATIRT_THREADS. The workers of the thread pool are started by the
+ * first batch call that splits rows, and kept for later calls; lowering the count joins the
+ * surplus workers. The emscripten -pthread build should not use more threads than its
+ * PTHREAD_POOL_SIZE.
+ *
+ * @param n           Number of threads; values below 1 select the number of hardware threads
+ */
+void setNumThreads(int n)
+{
+#if CATIRT_THREADS
+  num_threads = (n < 1) ? std::max(1, (int)std::thread::hardware_concurrency()) : n;
+  thread_pool().shrink(num_threads - 1);
+#else
+  (void)n;
+#endif
+}
+
+/**MDJAVADOC_SKIP
+ * Number of threads used by the row-parallel batch functions
+ *
+ * @return Thread count (always 1 unless built with CATIRT_THREADS)
+ */
+int getNumThreads()
+{
+#if CATIRT_THREADS
+  return num_threads;
+#else
+  return 1;
+#endif
+}
+
+#if CATIRT_ENABLE_STATS
+std::atomic<uint64_t> stat_counters[(int)Stat::COUNT];
+#endif
+
+/**MDJAVADOC_SKIP
+ * Whether the performance counters are compiled in (CATIRT_ENABLE_STATS)
+ */
+bool statsEnabled()
+{
+  return CATIRT_ENABLE_STATS;
+}
+
+/**MDJAVADOC_SKIP
+ * Whether the kernel timers (the *_NS counters) are compiled in (CATIRT_ENABLE_STAT_TIMERS)
+ */
+bool statTimersEnabled()
+{
+  return CATIRT_ENABLE_STAT_TIMERS;
+}
+
+/**MDJAVADOC_SKIP
+ * Value of a performance counter since the start or the last resetStats()
+ *
+ * @param s           Counter (Stat::COUNT is not a counter)
+ *
+ * @return counter value (0 when built without CATIRT_ENABLE_STATS)
+ */
+uint64_t getStat(Stat s)
+{
+#if CATIRT_ENABLE_STATS
+  if ((int)s >= 0 && s < Stat::COUNT) {
+    return stat_counters[(int)s].load(std::memory_order_relaxed);
+  }
+#else
+  (void)s;
+#endif
+  return 0;
+}
+
+/**MDJAVADOC_SKIP
+ * Name of a performance counter (lower case Stat name, e.g. "uniroot_maxit")
+ */
+const char *statName(Stat s)
+{
+  static const char *const names[(int)Stat::COUNT] = {
+    "prob_calls", "prob_ns", "loglik_calls", "loglik_ns", "fi_calls", "fi_ns", "wle_calls", "wle_ns",
+    "glr_calls", "glr_ns", "select_calls", "select_ns", "uniroot_calls", "uniroot_iterations", "uniroot_maxit",
+    "newton_calls", "newton_iterations", "newton_fallbacks", "bytes_in", "bytes_out", "allocs", "bytes_allocated"
+  };
+
+  return ((int)s >= 0 && s < Stat::COUNT) ? names[(int)s] : "";
+}
+
+/**MDJAVADOC_SKIP
+ * Set all performance counters to 0
+ */
+void resetStats()
+{
+#if CATIRT_ENABLE_STATS
+  for (auto &c : stat_counters) {
+    c.store(0, std::memory_order_relaxed);
+  }
+#endif
+}
+
+/**MDJAVADOC_SKIP
+ * Generate the BRM item probability matrix for person(s) with given ability estimates
+ *
+ * Port of: p.brm.R
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x 3 matrix)
+ *
+ * @return person/item probability matrix (N x M) for N people and M items
+ */
+const ArrayXXd p_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params)
+{
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int n_ppl, n_it;   // for person and item counts
+  int i;             // for the loop iteration
+  ArrayXXd P;        // for probability results
+
+  // get dimensions of theta and params
+  n_ppl = theta.rows();
+  n_it  = params.rows();
+
+  // resize results
+  P.resize(n_ppl, n_it);
+
+  // calculate probability of within categories
+  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
+  for ( i = 0; i < n_ppl; i++ ) {
+    // calculating the probability of response for one person (SIMD lanes of items)
+    simd_for(n_it, [&](int j, auto lane) {
+      cat_store_row(P, i, j, brm_item<decltype(lane)>(theta(i), params, j).p);
+    });
+  }
+
+  return P;
+}
+
+/**MDJAVADOC_SKIP
+ * Generate the item GRM probability matrix for person(s) with given ability estimates
+ *
+ * Port of: p.grm.R
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ *
+ * @return person/item probability matrix ((N*K) x M) for N people, K categories, and M items
+ */
+const ArrayXXd p_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params)
+{
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int n_ppl, n_it;   // for person and item counts
+  ArrayXXd P;        // for the probability results
+
+  // get dimensions of theta and params
+  n_ppl = theta.rows();
+  n_it  = params.rows();
+
+  // resize results
+  P.resize(n_ppl * params.cols(), n_it);
+
+  // the category loop is unrolled for K = 2 .. GRM_MAX_FIXED_K
+  grm_dispatch(params.cols(), [&](auto k_const) {
+    const int n_cat = grm_categories<decltype(k_const)::value>(params);
+
+    // calculate probability of within categories
+    // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
+    for ( int i = 0; i < n_ppl; i++ ) {
+      // SIMD lanes of items: boundary k of items j, j+1, ... is contiguous in params
+      simd_for(n_it, [&](int j, auto lane) {
+        using T = decltype(lane);
+        T th = cat_broadcast<T>(theta(i));
+        T a  = cat_load<T>(params, j, 0);
+        T p;  // for the GRM probability of correct
+
+        cat_store_row(P, (i * n_cat + 0), j, cat_broadcast<T>(1.0));
+
+        for ( int k = 0; k < n_cat - 1; k++ ) {
+          p = grm_boundary(th, a, cat_load<T>(params, j, k + 1)).p;
+
+          cat_store_row(P, (i * n_cat + k + 1), j, p);
+          cat_store_row(P, (i * n_cat + k), j, cat_row(P, (i * n_cat + k), j, lane) - p);
+        }
+      });
+    }
+  });
+
+  return P;
+}
+
+/**MDJAVADOC_SKIP
+ * Derivative of the BRM item probability matrix for person(s) with given ability estimates
+ *
+ * Port of: pder1.brm.R
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x 3 matrix)
+ *
+ * @return person/item derivative probability matrix (N x M) for N people and M items
+ */
+const ArrayXXd pder1_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params)
+{
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int n_ppl, n_it;   // for person and item counts
+  int i;             // for the loop iteration
+  ArrayXXd Pd1;      // for probability derivative results
+
+  // get dimensions of theta and params
+  n_ppl = theta.rows();
+  n_it  = params.rows();
+
+  // resize results
+  Pd1.resize(n_ppl, n_it);
+
+  // calculate derivative of probability of within categories
+  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
+  for ( i = 0; i < n_ppl; i++ ) {
+    // calculating the derivative of the probability of response for one person (SIMD lanes of items)
+    simd_for(n_it, [&](int j, auto lane) {
+      cat_store_row(Pd1, i, j, brm_item<decltype(lane)>(theta(i), params, j).pder1);
+    });
+  }
+
+  return Pd1;
+}
+
+/**MDJAVADOC_SKIP
+ * Derivative of the GRM item probability matrix for person(s) with given ability estimates
+ *
+ * Port of: pder1.grm.R
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ *
+ * @return person/item derivative probability matrix ((N*K) x M) for N people, K categories, and M items
+ */
+const ArrayXXd pder1_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params)
+{
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int n_ppl, n_it;   // for person and item counts
+  ArrayXXd Pd1;      // for probability derivative results
+
+  // get dimensions of theta and params
+  n_ppl = theta.rows();
+  n_it  = params.rows();
+
+  // resize results
+  Pd1.resize((n_ppl * params.cols()), n_it);
+
+  // the category loop is unrolled for K = 2 .. GRM_MAX_FIXED_K
+  grm_dispatch(params.cols(), [&](auto k_const) {
+    constexpr int K = decltype(k_const)::value;
+    const int n_cat = grm_categories<K>(params);
+    double p_exp;             // for the exponent of the dimension probability
+    double p, p_der1;         // for the GRM probability of correct
+
+    // calculate derivative of probability of within categories
+    // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
+    for ( int i = 0; i < n_ppl; i++ ) {
+      for ( int j = 0; j < n_it; j++ ) {
+        const auto row = grm_row<K>(params, j);
+
+        Pd1((i * n_cat + 0), j) = 0;
+
+        for ( int k = 0; k < n_cat - 1; k++ ) {
+          p_exp  = exp( -row(0) * (theta(i) - row(k + 1)) );
+          p      = 1 / ( 1 + p_exp );
+          p_der1 = row(0) * p * ( 1 - p );
+
+          Pd1((i * n_cat + k + 1), j) = p_der1;
+          Pd1((i * n_cat + k), j)    -= p_der1;
+        }
+      }
+    }
+  });
+
+  return Pd1;
+}
+
+/**MDJAVADOC_SKIP
+ * 2nd derivative of the BRM item probability matrix for person(s) with given ability estimates
+ *
+ * Port of: pder2.brm.R
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x 3 matrix)
+ *
+ * @return person/item 2nd derivative probability matrix (N x M) for N people and M items
+ */
+const ArrayXXd pder2_brm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params)
+{
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int n_ppl, n_it;   // for person and item counts
+  int i;             // for the loop iteration
+  ArrayXXd Pd2;      // for probability derivative results
+
+  // get dimensions of theta and params
+  n_ppl = theta.rows();
+  n_it  = params.rows();
+
+  // allocate memory for results
+  Pd2.resize(n_ppl, n_it);
+
+  // calculate 2nd derivative of probability of within categories
+  // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
+  for ( i = 0; i < n_ppl; i++ ) {
+    // calculating the 2nd derivative of the probability of response for one person (SIMD lanes of items)
+    simd_for(n_it, [&](int j, auto lane) {
+      cat_store_row(Pd2, i, j, brm_item<decltype(lane)>(theta(i), params, j).pder2);
+    });
+  }
+
+  return Pd2;
+}
+
+/**MDJAVADOC_SKIP
+ * 2nd derivative of the GRM item probability matrix for person(s) with given ability estimates
+ *
+ * Port of: pder2.grm.R
+ *
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ *
+ * @return person/item 2nd derivative probability matrix ((N*K) x M) for N people, K categories, and M items
+ */
+const ArrayXXd pder2_grm(const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params)
+{
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int n_ppl, n_it;   // for person and item counts
+  ArrayXXd Pd2;      // for probability derivative results
+
+  // get dimensions of theta and params
+  n_ppl = theta.rows();
+  n_it  = params.rows();
+
+  // resize results
+  Pd2.resize((n_ppl * params.cols()), n_it);
+
+  // the category loop is unrolled for K = 2 .. GRM_MAX_FIXED_K
+  grm_dispatch(params.cols(), [&](auto k_const) {
+    constexpr int K = decltype(k_const)::value;
+    const int n_cat = grm_categories<K>(params);
+    double p_exp;             // for the exponent of the dimension probability
+    double p, p_der1, p_der2; // for the GRM probability of correct
+
+    // calculate 2nd derivative of probability of within categories
+    // Note (IMPORTANT) - it fills in by COLUMNS, just like the default in R:
+    for ( int i = 0; i < n_ppl; i++ ) {
+      for ( int j = 0; j < n_it; j++ ) {
+        const auto row = grm_row<K>(params, j);
+
+        Pd2((i * n_cat + 0), j) = 0;
+
+        for ( int k = 0; k < n_cat - 1; k++ ) {
+          p_exp  = exp( row(0) * (theta(i) - row(k + 1)) );
+          p      = p_exp / ( 1 + p_exp );
+          p_der1 = row(0) * p * ( 1 - p );
+          p_der2 = row(0) * (1 - p_exp) * (1 - p) * p_der1;
+
+          Pd2((i * n_cat + k + 1), j) = p_der2;
+          Pd2((i * n_cat + k), j)    -= p_der2;
+        }
+      }
+    }
+  });
+
+  return Pd2;
+}
+
+/**MDJAVADOC_SKIP
+ * Derivative of the BRM log-likelihood of one person at one ability estimate (no allocations)
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param r           Response row of the person
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x 3 matrix)
+ * @param ltype       LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ *
+ * @return derivative of the log-likelihood
+ */
+static double lder1_brm_one( const Eigen::Ref<const ArrayXXd>& u, int r, double theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype )
+{
+  double lder1 = 0;  // for the running log-likelihood derivative
+  double I = 0;      // for the running Warm correction sums
+  double H = 0;
+
+  // accumulate lder1 for normal/Warm in a single pass over items (SIMD lanes of items)
+  simd_for(params.rows(), [&](int j, auto lane) {
+    auto pt = brm_item<decltype(lane)>(theta, params, j);
+    auto pq = pt.p * pt.q;
+
+    lder1 += cat_hsum(( cat_row(u, r, j, lane) - pt.p ) * pt.pder1 / pq);
+
+    if ( ltype == LderType::WLE ) {
+      I += cat_hsum(pt.info);
+      H += cat_hsum(( pt.pder1 * pt.pder2 ) / pq);
+    }
+  });
+
+  // Apply Warm correction - R equivalent: sum(H / ( 2 * I ))
+  if ( ltype == LderType::WLE ) {
+    lder1 += H / ( 2 * I );
+  }
+
+  return lder1;
+}
+
+/**MDJAVADOC_SKIP
+ * Derivative of log-likelihoods of reponses to items at given ability estimates
+ *
+ * Port of: lder1.brm.R
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x 3 matrix)
+ * @param ltype       LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ *
+ * @return derivative of log-likelihood for each person - vector (N x 1)
+ */
+const ArrayXd lder1_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype )
+{
+  CATIRT_STAT_TIMER(Stat::LOGLIK_CALLS);
+  // u is the response, theta is ability, and params are the parameters.
+  int N = theta.rows();
+  ArrayXd result(N);
+
+  for (int i = 0; i < N; i++) {
+    result(i) = lder1_brm_one(u, i, theta(i), params, ltype);
+  }
+
+  // Return Vector of logLik's
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Select item/category likelihoods
+ *
+ * Port of: sel.prm in ExtractOperators.R
+ *
+ * @param p ((M*K) x J) likelihood values for all categories / various thetas
+ * @param u Item responses (N people x J responses)
+ * @param K number of categories
+ *
+ * @return (T x J) matrix - item likelihoods where T = {N, for N>1; M, for N=1}
+ */
+const ArrayXXd sel_prm( const Eigen::Ref<const ArrayXXd>& p, const Eigen::Ref<const ArrayXXd>& u, int K ) {
+  CATIRT_STAT_TIMER(Stat::PROB_CALLS);
+  int N = u.rows();
+  int J = p.cols();
+  int M, T;
+  int i, cat;
+  ArrayXXd lik;
+
+  if (K < 2) {
+    throw "sel_prm invalid value for K";
+  }
+
+  M = p.rows() / K;
+  T = (N == 1 ? M : N);
+  lik.resize(M, J);
+
+  if ((N == 0) || (J == 0) || (M == 0)) {
+    throw "sel_prm 0-value for N, J, or M";
+  }
+
+  if ((u.cols() != p.cols()) || (p.rows() % K > 0) || (p.rows() % N > 0)) {
+    throw "sel_prm dimension mismatch between p, u, and K";
+  }
+
+  // K x J block per result row: fixed-size for K = 2 .. GRM_MAX_FIXED_K
+  grm_dispatch(K, [&](auto k_const) {
+    constexpr int KF = decltype(k_const)::value;
+    const int n_cat = (KF == Eigen::Dynamic ? K : KF);
+
+    for (int t = 0; t < T; t++) {   // t: row index of result, start of block row in value matrix p
+      i = t % N;                    // i: row index into response matrix u
+      auto block = p.template block<KF, Eigen::Dynamic>(t * n_cat, 0, n_cat, J);
+
+      for (int j = 0; j < J; j++) { // j: col (item) index
+        if (std::isnan(u(i, j))) {
+          cat = -1;
+        } else {
+          cat = static_cast<int>(u(i, j));
+        }
+        if (cat > 0 && cat <= n_cat) {
+          lik(t, j) = block(cat - 1, j);
+        } else {
+          lik(t, j) = nan("");
+        }
+      }
+    }
+  });
+  return lik;
+}
+
+/**MDJAVADOC_SKIP
+ * BRM model log-likelihoods of reponses to items at given ability estimates
+ *
+ * Port of: lokLik.brm.R
+ *
+ * Accumulated per theta over the items (see brm_loglik_item), without person/item matrices;
+ * items with a non-finite (missing) response are skipped.
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people (or T thetas if N is 1)
+ * @param params      Parameters for M items (M x 3 matrix)
+ * @param type        LogLikType::MLE or LogLikType::BME (not yet supported)
+ *
+ * @return log-likelihood for each person - vector (N x 1), or for each theta - vector (T x 1)
+ */
+const ArrayXd logLik_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params, LogLikType type )
+{
+  CATIRT_STAT_TIMER(Stat::LOGLIK_CALLS);
+  int N = theta.rows();
+  int M = params.rows();
+  int r;             // for the response row of each theta
+  double logLik;     // for the running log-likelihood of one theta
+  ArrayXd result(N);
+
+  if (type == LogLikType::BME) {
+    throw "logLik_brm unsupported LogLikType::BME";
+  }
+  if ((u.cols() != M) || (u.rows() != 1 && u.rows() != N)) {
+    throw "logLik_brm dimension mismatch between u, theta, and params";
+  }
+
+  for (int i = 0; i < N; i++) {
+    r = (u.rows() == 1 ? 0 : i);
+    logLik = 0;
+
+    for (int j = 0; j < M; j++) {
+      if (std::isfinite(u(r, j))) {
+        logLik += brm_loglik_item(theta(i), params(j, 0), params(j, 1), params(j, 2), u(r, j));
+      }
+    }
+
+    result(i) = logLik;
+  }
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * GRM model log-likelihoods of reponses to items at given ability estimates
+ *
+ * Port of: lokLik.grm.R
+ *
+ * Accumulated per theta over the items from the boundaries of the responded categories only
+ * (see grm_loglik_item), without person/category/item matrices; items with a non-finite
+ * (missing) response are skipped.
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people (or T thetas if N is 1)
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param type        LogLikType::MLE or LogLikType::BME (not yet supported)
+ *
+ * @return log-likelihood for each person - vector (N x 1), or for each theta - vector (T x 1)
+ */
+const ArrayXd logLik_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LogLikType type )
+{
+  CATIRT_STAT_TIMER(Stat::LOGLIK_CALLS);
+  int N = theta.rows();
+  int M = params.rows();
+  int r;             // for the response row of each theta
+  double logLik;     // for the running log-likelihood of one theta
+  ArrayXd result(N);
+
+  if (type == LogLikType::BME) {
+    throw "logLik_grm unsupported LogLikType::BME";
+  }
+  if ((u.cols() != M) || (u.rows() != 1 && u.rows() != N)) {
+    throw "logLik_grm dimension mismatch between u, theta, and params";
+  }
+
+  for (int i = 0; i < N; i++) {
+    r = (u.rows() == 1 ? 0 : i);
+    logLik = 0;
+
+    for (int j = 0; j < M; j++) {
+      if (std::isfinite(u(r, j))) {
+        logLik += grm_loglik_item(theta(i), params, j, grm_category(u(r, j)));
+      }
+    }
+
+    result(i) = logLik;
+  }
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Derivative of the GRM log-likelihood of one person at one ability estimate (no allocations)
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param r           Response row of the person
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param ltype       LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ *
+ * @return derivative of the log-likelihood
+ */
+static double lder1_grm_one( const Eigen::Ref<const ArrayXXd>& u, int r, double theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype )
+{
+  double lder1 = 0;  // for the running log-likelihood derivative
+  double I = 0;      // for the running Warm correction sums
+  double H = 0;
+  double info, h;    // for the information sums of one item
+  GRM_Point sel;     // for the terms of the responded category of one item
+
+  grm_dispatch(params.cols(), [&](auto k_const) {
+    for (int j = 0; j < params.rows(); j++) {
+      if ( ltype == LderType::WLE ) {
+        // Warm correction needs all categories: visit each boundary once
+        grm_item_sums<decltype(k_const)::value>(theta, params, j, grm_category(u(r, j)), sel, info, h);
+        I += info;
+        H += h;
+      } else {
+        sel = grm_point(theta, params, j, grm_category(u(r, j)));
+      }
+
+      // Calculating lder1 for normal/Warm:
+      lder1 += sel.pder1 / sel.p;
+    }
+  });
+
+  // Apply Warm correction:
+  if ( ltype == LderType::WLE ) {
+    lder1 += H / ( 2 * I );
+  }
+
+  return lder1;
+}
+
+/**MDJAVADOC_SKIP
+ * Derivative of log-likelihoods of reponses to items at given ability estimates
+ *
+ * Port of: lder1.grm.R
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param ltype       LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ *
+ * @return derivative of log-likelihood for each person/category - vector (N x 1)
+ */
+const ArrayXd lder1_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params, LderType ltype )
+{
+  CATIRT_STAT_TIMER(Stat::LOGLIK_CALLS);
+  // u is the response, theta is ability, and params are the parameters.
+  int N = theta.rows();
+  int J = params.rows();
+  ArrayXd result(N);
+
+  if ((u.cols() != J) || (u.rows() != 1 && u.rows() != N)) {
+    throw "lder1_grm dimension mismatch between u, theta, and params";
+  }
+
+  for (int i = 0; i < N; i++) {
+    result(i) = lder1_grm_one(u, (u.rows() == 1 ? 0 : i), theta(i), params, ltype);
+  }
+
+  // Return Vector of logLik's
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * 2nd derivative of log-likelihoods of reponses to items at given ability estimates
+ *
+ * Port of: lder2.brm.R
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x 3 matrix)
+ *
+ * @return 2nd derivative of log-likelihood for each person - vector (N x M)
+ */
+const ArrayXXd lder2_brm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayX3d>& params )
+{
+  CATIRT_STAT_TIMER(Stat::LOGLIK_CALLS);
+  int N = theta.rows();
+  int M = params.rows();
+  ArrayXXd lder2(N, M);
+
+  parallel_for(N, row_grain(M), [&](int begin, int end) {
+    double lder2_1, lder2_2;  // for the two parts of the second derivative
+    BRM_Point pt;             // for the fused probability/derivative terms of one item
+
+    for (int i = begin; i < end; i++) {
+      for (int j = 0; j < M; j++) {
+        pt = brm_point(theta(i), params(j, 0), params(j, 1), params(j, 2));
+
+        // Calculating two parts of second derivative:
+        lder2_1 = ( -pt.pder1 * pt.pder1 / ( pt.p * pt.p ) ) + ( pt.pder2 / pt.p );
+        lder2_2 = (  pt.pder1 * pt.pder1 / ( pt.q * pt.q ) ) + ( pt.pder2 / pt.q );
+
+        lder2(i, j) = ( u(i, j) * lder2_1 ) - ( ( 1 - u(i, j) ) * lder2_2 );
+      }
+    }
+  });
+
+  return lder2;
+}
+
+/**MDJAVADOC_SKIP
+ * 2nd derivative of log-likelihoods of reponses to items at given ability estimates
+ *
+ * Port of: lder2.grm.R
+ *
+ * @param u           Item responses (N people x M responses)
+ * @param theta       Ability estimates for N people
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ *
+ * @return 2nd derivative of log-likelihood for each person - vector (N x M)
+ */
+const ArrayXXd lder2_grm( const Eigen::Ref<const ArrayXXd>& u, const Eigen::Ref<const ArrayXd>& theta, const Eigen::Ref<const ArrayXXd>& params )
+{
+  CATIRT_STAT_TIMER(Stat::LOGLIK_CALLS);
+  int N = theta.rows();
+  int J = params.rows();
+  ArrayXXd lder2(N, J);
+
+  if ((u.cols() != J) || (u.rows() != 1 && u.rows() != N)) {
+    throw "lder2_grm dimension mismatch between u, theta, and params";
+  }
+
+  parallel_for(N, row_grain(J), [&](int begin, int end) {
+    int r;             // for the response row of each person
+    GRM_Point sel;     // for the terms of the responded category of one item
+
+    for (int i = begin; i < end; i++) {
+      r = (u.rows() == 1 ? 0 : i);
+
+      for (int j = 0; j < J; j++) {
+        sel = grm_point(theta(i), params, j, grm_category(u(r, j)));
+
+        // Calculating second derivative of the responded category:
+        lder2(i, j) = ( -1 * sel.pder1 * sel.pder1 / ( sel.p * sel.p ) ) + ( sel.pder2 / sel.p );
+      }
+    }
+  });
+
+  return lder2;
+}
+
+/**MDJAVADOC_SKIP
+ * Fisher Information of BRM items for given ability estimates and optional responses (for OBSERVED info)
+ *
+ * Port of: FI.brm.R
+ *
+ * @param params      Parameters for M items (M x 3 matrix)
+ * @param theta       Ability estimates for N people
+ * @param type        FIType::EXPECTED or FIType::OBSERVED
+ * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
+ *
+ * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
+ */
+const FI_Result FI_brm( const Eigen::Ref<const ArrayX3d>& params, const Eigen::Ref<const ArrayXd>& theta, FIType type, const Eigen::Ref<const ArrayXXd>& resp )
+{
+  CATIRT_STAT_TIMER(Stat::FI_CALLS);
+  // check supported types
+  if ( type != FIType::OBSERVED && type != FIType::EXPECTED ) {
+    throw "FI_brm unexpected type";
+  }
+
+  // Make sure that resp is NULL if type is "expected"
+  if ( type == FIType::EXPECTED && resp.size() > 0 ) {
+    throw "FI_brm type EXPECTED with non-zero responses";
+  }
+
+  // Make sure that resp exists if we are calculating "observed" information
+  if ( type == FIType::OBSERVED && resp.size() == 0 ) {
+    throw "FI_brm need response scalar/vector to calculate observed information";
+  }
+
+  int N = theta.size();  // number of people
+  int M = params.rows(); // number of items
+  FI_Result result = FI_Result(type);
+
+  // Expected Fisher Information: p'^2/(p*q)
+  if ( type == FIType::EXPECTED ) {
+    result.item.resize(N, M);
+
+    parallel_for(N, row_grain(M), [&](int begin, int end) {
+      for (int i = begin; i < end; i++) {
+        simd_for(M, [&](int j, auto lane) {
+          cat_store_row(result.item, i, j, brm_item<decltype(lane)>(theta(i), params, j).info);
+        });
+      }
+    });
+  }
+  // Observed Fisher Information
+  else {
+    result.item = -1 * lder2_brm(resp, theta, params);
+  }
+
+  result.test = result.item.rowwise().sum();
+  result.sem = sqrt( 1 / result.test );
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Expected Fisher Information (modified unweighted) of BRM items for given phase 1 and phase 2 ability estimates
+ *
+ * @param p2_params      Phase 2 parameters for M items (M x 3 matrix)
+ * @param p2_theta       Phase 2 ability estimates for N people
+ * @param p1_params      Phase 1 parameters for M items (M x 3 matrix)
+ * @param p1_theta       Phase 1 ability estimates for N people
+ *
+ * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
+ */
+const FI_Result FI_brm_modified_expected( const Eigen::Ref<const ArrayX3d>& p2_params, const Eigen::Ref<const ArrayXd>& p2_theta, const Eigen::Ref<const ArrayX3d>& p1_params, const Eigen::Ref<const ArrayXd>& p1_theta )
+{
+  CATIRT_STAT_TIMER(Stat::FI_CALLS);
+  // Make sure that item parameters have matching dimensions
+  if ( (p1_params.rows() != p2_params.rows()) || (p1_params.cols() != p2_params.cols()) ) {
+    throw "FI_brm_modified_expected phase1 and phase2 item parameters dimension mismatch";
+  }
+
+  // Make sure that theta estimates have matching dimensions
+  if ( p1_theta.size() != p2_theta.size() ) {
+    throw "FI_brm_modified_expected phase1 and phase2 theta size mismatch";
+  }
+
+  int N = p2_theta.size();   // number of people
+  int M = p2_params.rows();  // number of items
+  FI_Result result = FI_Result(FIType::EXPECTED);
+  result.item.resize(N, M);
+
+  parallel_for(N, row_grain(M), [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      simd_for(M, [&](int j, auto lane) {
+        using T = decltype(lane);
+
+        // modified: apply phase1 adjustments to the phase2 expected information p'^2/(p*q)
+        T p1_q = brm_item<T>(p1_theta(i), p1_params, j).q;
+
+        cat_store_row(result.item, i, j, p1_q * brm_item<T>(p2_theta(i), p2_params, j).info);
+      });
+    }
+  });
+
+  result.test = result.item.rowwise().sum();
+  result.sem = sqrt( 1 / result.test );
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Expected Fisher Information of GRM items for given ability estimates and optional responses (for OBSERVED info)
+ *
+ * Port of: FI.grm.R
+ *
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param theta       Ability estimates for N people
+ * @param type        FIType::EXPECTED or FIType::OBSERVED
+ * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
+ *
+ * @return FI_Result with item (NxM), test (Nx1), sem (Nx1), and type info
+ */
+const FI_Result FI_grm( const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const ArrayXd>& theta, FIType type, const Eigen::Ref<const ArrayXXd>& resp )
+{
+  CATIRT_STAT_TIMER(Stat::FI_CALLS);
+  // check supported types
+  if ( type != FIType::OBSERVED && type != FIType::EXPECTED ) {
+    throw "FI_grm unexpected type";
+  }
+
+  // Make sure that resp is NULL if type is "expected"
+  if ( type == FIType::EXPECTED && resp.size() > 0 ) {
+    throw "FI_grm type EXPECTED with non-zero responses";
+  }
+
+  // Make sure that resp exists if we are calculating "observed" information
+  if ( type == FIType::OBSERVED && resp.size() == 0 ) {
+    throw "FI_grm need response scalar/vector to calculate observed information";
+  }
+
+  int N = theta.size();  // number of people
+  int M = params.rows(); // number of items
+  FI_Result result = FI_Result(type);
+  result.item.resize(N, M);
+
+  // Expected Fisher Information: sum[P'^2/P]
+  if ( type == FIType::EXPECTED ) {
+    // sum over the categories of each item in one pass over its boundaries (SIMD lanes of items)
+    grm_dispatch(params.cols(), [&](auto k_const) {
+      parallel_for(N, row_grain(M), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+          simd_for(M, [&](int j, auto lane) {
+            using T = decltype(lane);
+            T info, h;          // for the information sums of the lane
+            GRM_Terms<T> sel;   // unused terms of the responded category
+
+            grm_item_sums<decltype(k_const)::value>(cat_broadcast<T>(theta(i)), params, j, -1, sel, info, h);
+            cat_store_row(result.item, i, j, info);
+          });
+        }
+      });
+    });
+  }
+  // Observed Fisher Information
+  else {
+    result.item = -1 * lder2_grm(resp, theta, params);
+  }
+
+  result.test = result.item.rowwise().sum();
+  result.sem = sqrt( 1 / result.test );
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Search the range interval for a root of f
+ *
+ * Combined port of: uniroot and R_zeroin2, Copyright (C) 1999-2016  The R Core Team
+ *   https://github.com/SurajGupta/r-source/blob/a28e609e72ed7c47f6ddfbb86c85279a0750f0b7/src/library/stats/R/nlm.R#L55
+ *   https://github.com/SurajGupta/r-source/blob/a28e609e72ed7c47f6ddfbb86c85279a0750f0b7/src/library/stats/src/zeroin.c
+ *
+ * @param f           Callable double(double theta)
+ * @param range       Interval to search: should be [-X,+X] for some positive X
+ * @param maxit       Maximum number of iterations for search
+ * @param tol         Acceptable tolerance level (EPSILON^0.25 if not positive)
+ *
+ * @return Uniroot_Result with iter=-1 if a root did not converge within max iterations
+ */
+template <typename F>
+static Uniroot_Result zeroin(F &&f, const Eigen::Ref<const RowVector2d>& range, int maxit, double tol)
+{
+    double lower = range(0); // ax
+    double upper = range(1); // bx
+    double a, b, c;          // Abscissae, descr. see above
+    double fa, fb, fc;       // f(a), f(b), f(c)
+    Uniroot_Result result{};
+
+    // NOTE: removed code to extend interval if lower * upper > 0
+    CATIRT_STAT_ADD(Stat::UNIROOT_CALLS, 1);
+
+    // Set default tolerance
+    if (tol <= 0) {
+        tol = pow(DBL_EPSILON, 0.25);
+    }
+
+    // First test if we have found a root at an endpoint
+    a = lower;
+    b = upper;
+
+    fa = f(a);
+    if (fa == 0.0) {
+        result.root = a;
+        result.f_root = fa;
+        result.iter = 0;
+        result.estim_prec = 0.0;
+        return result;
+    }
+
+    fb = f(b);
+    if (fb ==  0.0) {
+        result.root = b;
+        result.f_root = fb;
+        result.iter = 0;
+        result.estim_prec = 0.0;
+        return result;
+    }
+
+    // Now search the range for a root
+    c = a;
+    fc = fa;
+
+    for (int it = 0; it < (maxit + 1); it++) {
+        double prev_step = b - a; // Distance from the last but one to the last approximation
+        double tol_act;           // Actual tolerance
+
+        // Interpolation step is calculated in the form p/q; division operations is delayed until the last moment
+        double p;
+        double q;
+
+        double new_step; // Step at this iteration
+
+        CATIRT_STAT_ADD(Stat::UNIROOT_ITERATIONS, 1);
+        if (fabs(fc) < fabs(fb)) {
+            // Swap data for b to be the best approximation
+            a = b;  b = c;  c = a;
+            fa=fb;  fb=fc;  fc=fa;
+        }
+        tol_act = 2 * DBL_EPSILON * fabs(b) + tol / 2;
+        new_step = (c - b) / 2;
+
+        if (fabs(new_step) <= tol_act || fb == 0.0) {
+            // Acceptable approx. is found
+            result.root = b;
+            result.f_root = fb;
+            result.iter = it;
+            result.estim_prec = fabs(c - b);
+            return result;
+        }
+
+        // Try interpolation
+        if (fabs(prev_step) >= tol_act	// If prev_step was large enough
+            && fabs(fa) > fabs(fb)) {	// and was in true direction
+            double t1,cb,t2;
+            cb = c-b;
+            if (a == c) {
+                // If we have only two distinct points linear interpolation can only be applied
+                t1 = fb / fa;
+                p = cb * t1;
+                q = 1.0 - t1;
+            }
+            else {
+                // Quadric inverse interpolation
+                q = fa / fc;  t1 = fb / fc;	 t2 = fb / fa;
+                p = t2 * (cb * q * (q - t1) - (b - a) * (t1 - 1.0));
+                q = (q - 1.0) * (t1 - 1.0) * (t2 - 1.0);
+            }
+
+            // p was calculated with the opposite sign; make p positiv and assign possible minus to q
+            if( p > 0.0 ) {
+                q = -q;
+            } else {
+                p = -p;
+            }
+
+            if (p < (0.75 * cb * q - fabs(tol_act * q) / 2) // If b+p/q falls in [b,c]
+                && p < fabs(prev_step * q / 2)) {	        // and isn't too large
+                // it is accepted
+                new_step = p/q;
+            }
+            // Otherwise, if p/q is too large then the bisection procedure can reduce [b,c] range to more extent
+        }
+
+        if (fabs(new_step) < tol_act) {
+            // Adjust the step to be not less than tolerance
+            if (new_step > 0.0) {
+                new_step = tol_act;
+            } else {
+                new_step = -tol_act;
+            }
+        }
+
+        // Save the previous approx.
+        a = b;
+        fa = fb;
+
+        // Do step to a new approxim.
+        b += new_step;
+        fb = f(b);
+
+        // Adjust c for it to have a sign opposite to that of b
+        if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+            c = a;
+            fc = fa;
+        }
+    }
+
+    // failed!
+    CATIRT_STAT_ADD(Stat::UNIROOT_MAXIT, 1);
+    result.root = b;
+    result.f_root = fb;
+    result.iter = -1;
+    result.estim_prec = fabs(c - b);
+    return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Search the range interval for a root of the specificed lder1 function with respect to theta
+ *
+ * @param lderFP      Pointer to lder1_brm or lder1_grm functions
+ * @param range       Interval to search: should be [-X,+X] for some positive X
+ * @param resp        Item responses for a single person (1 x M)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param type        LderType::WLE (weighted likelihood) or LderType::MLE (maximum likelihood)
+ * @param maxit       Maximum number of iterations for search (default: 1000)
+ * @param tol         Acceptable tolerance level (default: EPSILON^0.25)
+ *
+ * @return Uniroot_Result with iter=-1 if a root did not converge within max iterations
+ */
+Uniroot_Result uniroot_lder1(
+    const ArrayXd (*lderFP)(const Eigen::Ref<const ArrayXXd>&, const Eigen::Ref<const ArrayXd>&, const Eigen::Ref<const ArrayXXd>&, LderType),
+    const Eigen::Ref<const RowVector2d>& range,
+    const Eigen::Ref<const ArrayXXd>& resp,
+    const Eigen::Ref<const ArrayXXd>& params,
+    LderType type,
+    int maxit,
+    double tol
+)
+{
+    Eigen::Array<double, 1, 1> tmpTheta;
+
+    if (resp.cols() != params.rows()) {
+        throw "uniroot_lder1 dimension mismatch between responses and parameters";
+    }
+
+    // the built-in lder1 functions are evaluated at one theta without allocating a result vector
+    if (lderFP == &lder1_brm || lderFP == &lder1_grm) {
+        auto lder1_one = (lderFP == &lder1_brm ? &lder1_brm_one : &lder1_grm_one);
+        return zeroin([&](double theta) { return lder1_one(resp, 0, theta, params, type); }, range, maxit, tol);
+    }
+
+    return zeroin([&](double theta) {
+        tmpTheta(0) = theta;
+        return (*lderFP)(resp, tmpTheta, params, type)(0);
+    }, range, maxit, tol);
+}
+
+/**MDJAVADOC_SKIP
+ * Sum the WLE score terms of one person over all items at one ability estimate
+ *
+ * @param resp        Item responses for a single person (1 x M)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param theta       Ability estimate
+ *
+ * @return WLE_Point with the sums over items
+ */
+static WLE_Point wle_sums(const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, ModelType type, double theta)
+{
+  WLE_Point sum = {0, 0, 0, 0, 0, 0};
+  WLE_Point wt;
+
+  if (type == ModelType::BRM) {
+    simd_for(params.rows(), [&](int j, auto lane) {
+      auto lt = brm_wle_item(theta, params, j, cat_row(resp, 0, j, lane));
+
+      sum.lder1   += cat_hsum(lt.lder1);
+      sum.lder2   += cat_hsum(lt.lder2);
+      sum.info    += cat_hsum(lt.info);
+      sum.h       += cat_hsum(lt.h);
+      sum.info_d1 += cat_hsum(lt.info_d1);
+      sum.h_d1    += cat_hsum(lt.h_d1);
+    });
+  } else {
+    grm_dispatch(params.cols(), [&](auto k_const) {
+      for (int j = 0; j < params.rows(); j++) {
+        wt = grm_wle_item<decltype(k_const)::value>(theta, params, j, grm_category(resp(0, j)));
+
+        sum.lder1   += wt.lder1;
+        sum.lder2   += wt.lder2;
+        sum.info    += wt.info;
+        sum.h       += wt.h;
+        sum.info_d1 += wt.info_d1;
+        sum.h_d1    += wt.h_d1;
+      }
+    });
+  }
+
+  return sum;
+}
+
+/**MDJAVADOC_SKIP
+ * Find the weighted likelihood (Warm) estimate of one person with uniroot_lder1 over the whole
+ * range (port of wleEst.R), then one more pass over the items for the observed information and
+ * Warm correction at the root
+ *
+ * @param resp        Item responses for a single person (1 x M)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Interval to search: should be [-X,+X] for some positive X
+ * @param type        ModelType::BRM or ModelType::GRM
+ *
+ * @return WLE_Root capped to range, with the observed information and Warm correction at root
+ */
+static WLE_Root brent_wle(const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type)
+{
+  auto lder1_one = (type == ModelType::GRM ? &lder1_grm_one : &lder1_brm_one);
+  Uniroot_Result ur_result;
+  WLE_Point sum;
+  WLE_Root result;
+
+  ur_result = zeroin([&](double x) { return lder1_one(resp, 0, x, params, LderType::WLE); }, range, 1000, 0.0);
+  result.root = std::min(std::max(ur_result.root, range(0)), range(1));
+  sum = wle_sums(resp, params, type, result.root);
+
+  result.f_root = ur_result.f_root;
+  result.iter = ur_result.iter;
+  result.info = -sum.lder2;
+  result.corr = sum.h / (2 * sum.info);
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Whether the WLE score of 2PL items (BRM with c = 0) has no root in range other than one at root
+ *
+ * With c = 0, lder1 decreases with slope -I and the Warm term W = I' / (2 * I) has |W| <= a_max / 2
+ * and W' <= a_max^2 / 2, so every root lies where |lder1| <= a_max / 2 and the score decreases
+ * wherever I > a_max^2 / 2. If I exceeds that (with a margin) on [root - d, root + d] for
+ * d = 2 / a_max, lder1 changes by more than a_max on either side, so all roots lie in this window
+ * and the score crosses 0 once there: the root is the one of the Brent search. PQ of each item
+ * is unimodal in theta, so its minimum over the window is at one of the ends, and the bound takes
+ * one pass over the items.
+ *
+ * @param params      Parameters for M items (M x 3 matrix, c = 0)
+ * @param range       Interval of the search
+ * @param root        Root of the score found by the Newton search
+ *
+ * @return true if root is certified to be the only root in range
+ */
+static bool brm_single_root(const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, double root)
+{
+  const double a_max = params.col(0).abs().maxCoeff();
+  const double lower = std::max(root - 2 / a_max, range(0));
+  const double upper = std::min(root + 2 / a_max, range(1));
+  double info_min = 0;
+
+  for (int j = 0; j < params.rows(); j++) {
+    double a = params(j, 0), b = params(j, 1);
+    double e0 = exp(-a * (lower - b)), e1 = exp(-a * (upper - b));
+    double pq0 = e0 / ((1 + e0) * (1 + e0)), pq1 = e1 / ((1 + e1) * (1 + e1));
+    info_min += a * a * std::min(pq0, pq1);
+  }
+  return info_min > 0.55 * a_max * a_max;
+}
+
+/**MDJAVADOC_SKIP
+ * Find the weighted likelihood (Warm) estimate of one person with a safeguarded Newton search
+ *
+ * A warm-start solver: the search begins at start, e.g. the previous estimate of a CAT, where a
+ * few Newton steps reach the root. The WLE score lder1 + H / (2 * I) and its analytic derivative
+ * are evaluated together at each step, so an iteration is one pass over the items, and the
+ * information and Warm correction come from the last evaluation, within tol of the root.
+ *
+ * The score can have several roots (with 3PL items often, with 2PL and GRM items of a short or
+ * widely spread test too), and Newton finds the one nearest the start, so its result is only
+ * kept where it is certainly the root of the Brent search (wleEst.R): for 2PL items (BRM with
+ * c = 0), one more pass over the items checks that the root is the only one in range
+ * (brm_single_root). Otherwise the Brent search is used, so the results match SolverType::BRENT:
+ * without a start, for 3PL and GRM items (at the same cost, with iter its iteration count),
+ * for an uncertified root, and when the score rises at an iterate (iter is then Brent's count),
+ * or when no root is found within maxit (iter = -1).
+ *
+ * The score decreases through the root, and the bracket shrinks from range with every
+ * evaluation. A Newton step leaving the bracket tries the range end once (the root may lie
+ * outside range) and then bisects.
+ *
+ * @param resp        Item responses for a single person (1 x M)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Interval to search: should be [-X,+X] for some positive X
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param start       Starting ability estimate, or NaN for the Brent search
+ * @param maxit       Maximum number of Newton iterations (default: 100)
+ * @param tol         Acceptable tolerance level of the root (default: EPSILON^0.25)
+ *
+ * @return WLE_Root with the observed information and Warm correction at root, the root of the
+ *         Brent search
+ */
+WLE_Root newton_wle(
+    const Eigen::Ref<const ArrayXXd>& resp,
+    const Eigen::Ref<const ArrayXXd>& params,
+    const Eigen::Ref<const RowVector2d>& range,
+    ModelType type,
+    double start,
+    int maxit,
+    double tol
+)
+{
+    double lower = range(0);
+    double upper = range(1);
+    double theta, f, fder1, step, next;
+    bool lower_tried = false;      // the range ends are each tried once when Newton overshoots
+    bool upper_tried = false;
+    WLE_Point sum;
+    WLE_Root result{};
+
+    // Set default tolerance (as uniroot_lder1)
+    if (tol <= 0) {
+        tol = pow(DBL_EPSILON, 0.25);
+    }
+
+    if (!std::isfinite(start)) {
+        return brent_wle(resp, params, range, type);
+    }
+
+    CATIRT_STAT_ADD(Stat::NEWTON_CALLS, 1);
+
+    // the root of 3PL and GRM scores is not certified: only the Brent search finds its one
+    if (type != ModelType::BRM || (params.col(2) != 0).any()) {
+        CATIRT_STAT_ADD(Stat::NEWTON_FALLBACKS, 1);
+        return brent_wle(resp, params, range, type);
+    }
+
+    // the Newton root, if it is the only one in range (else the Brent search)
+    auto certified = [&](const WLE_Root& found) {
+        if (found.root > range(0) && found.root < range(1) && brm_single_root(params, range, found.root)) {
+            return found;
+        }
+        CATIRT_STAT_ADD(Stat::NEWTON_FALLBACKS, 1);
+        return brent_wle(resp, params, range, type);
+    };
+
+    theta = std::min(std::max(start, lower), upper);
+
+    for (int it = 0; it < (maxit + 1); it++) {
+        CATIRT_STAT_ADD(Stat::NEWTON_ITERATIONS, 1);
+        sum = wle_sums(resp, params, type, theta);
+        f = sum.lder1 + sum.h / (2 * sum.info);
+        fder1 = sum.lder2 + (sum.h_d1 * sum.info - sum.h * sum.info_d1) / (2 * sum.info * sum.info);
+
+        result.root = theta;
+        result.f_root = f;
+        result.iter = it;
+        result.info = -sum.lder2;
+        result.corr = sum.h / (2 * sum.info);
+
+        // a score rising at theta may cross 0 more than once: leave the choice of root to Brent
+        if (fder1 >= 0 && std::isfinite(f)) {
+            CATIRT_STAT_ADD(Stat::NEWTON_FALLBACKS, 1);
+            return brent_wle(resp, params, range, type);
+        }
+        if (!std::isfinite(f) || !std::isfinite(fder1)) {
+            break;
+        }
+        if (f == 0.0) {
+            return certified(result);
+        }
+        // the score decreases through the root, so the root is above theta where it is positive
+        if (f > 0) {
+            lower = theta;
+        } else {
+            upper = theta;
+        }
+        if (upper - lower <= tol) {
+            return certified(result);
+        }
+
+        step = -f / fder1;
+        next = theta + step;
+
+        if (next > lower && next < upper) {
+            if (fabs(step) <= tol) {
+                // Acceptable approx. is found: take the last step, which squares the error
+                result.root = next;
+                return certified(result);
+            }
+        } else if (f > 0 && !upper_tried && upper == range(1)) {
+            next = upper;
+            upper_tried = true;
+        } else if (f < 0 && !lower_tried && lower == range(0)) {
+            next = lower;
+            lower_tried = true;
+        } else {
+            next = (lower + upper) / 2;
+        }
+
+        theta = next;
+    }
+
+    // failed: fall back to the full Brent search
+    CATIRT_STAT_ADD(Stat::NEWTON_FALLBACKS, 1);
+    result = brent_wle(resp, params, range, type);
+    result.iter = -1;
+    return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Find the weighted likelihood (Warm) estimate of one person with the given root finder
+ *
+ * SolverType::BRENT searches the whole range with uniroot_lder1 (port of wleEst.R), then one
+ * more pass over the items gives the observed information and Warm correction at the root.
+ * SolverType::NEWTON is newton_wle, which gives the root of the Brent search too (using it
+ * without a start, for 3PL and GRM items, and where the Newton root is not certified). No heap
+ * allocations are made.
+ *
+ * @param resp        Item responses for a single person (1 x M)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Interval to search: should be [-X,+X] for some positive X
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimate for SolverType::NEWTON, or NaN for the Brent search
+ *
+ * @return WLE_Root capped to range, with the observed information and Warm correction at root
+ */
+WLE_Root wle_root(
+    const Eigen::Ref<const ArrayXXd>& resp,
+    const Eigen::Ref<const ArrayXXd>& params,
+    const Eigen::Ref<const RowVector2d>& range,
+    ModelType type,
+    SolverType solver,
+    double start
+)
+{
+    if (solver == SolverType::NEWTON) {
+        return newton_wle(resp, params, range, type, start);
+    }
+    return brent_wle(resp, params, range, type);
+}
+
+/**MDJAVADOC_SKIP
+ * Estimate ability from one or more sets of item responses
+ *
+ * Port of: wleEst.R
+ *
+ * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param type        ModelType::BRM or ModelType::GRM
+ *
+ * @return Est_Result with theta (Nx1), info (Nx1), and sem (Nx1) info
+ */
+const Est_Result wleEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type )
+{
+  return wleEst(resp, params, range, type, SolverType::BRENT, ArrayXd());
+}
+
+/**MDJAVADOC_SKIP
+ * Estimate ability from one or more sets of item responses with the given root finder
+ *
+ * SolverType::BRENT is the port of wleEst.R (uniroot_lder1 over the whole range).
+ * SolverType::NEWTON uses newton_wle from start, and takes the information and Warm correction
+ * from its final evaluation; people without a start are estimated by the Brent search.
+ *
+ * @param resp        Item responses (N people x M responses) should be size 0 for FIType::EXPECTED
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimates (N x 1, NaN for the Brent search) for SolverType::NEWTON, or size 0
+ *
+ * @return Est_Result with theta (Nx1), info (Nx1), and sem (Nx1) info
+ */
+const Est_Result wleEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type,
+                         SolverType solver, const Eigen::Ref<const ArrayXd>& start )
+{
+  CATIRT_STAT_TIMER(Stat::WLE_CALLS);
+  //
+  // Check arguments
+  //
+
+  // Make sure all responses are numeric
+  if (!resp.isFinite().all()) {
+      throw "wleEst infinite or non-numeric responses provided";
+  }
+
+  // Make sure all item parameters are numeric
+  if (!params.isFinite().all()) {
+      throw "wleEst infinite or non-numeric item parameters provided";
+  }
+
+  // Make sure dimensions of resp and params are compatible
+  if (resp.cols() != params.rows()) {
+      throw "wleEst dimension mismatch between responses and parameters";
+  }
+
+  // Make sure range is from negative to positive
+  if (!(range(0) < 0 && range(1) > 0)) {
+      throw "wleEst unsupported range provided";
+  }
+
+  // Make sure there is one starting estimate per person (if any)
+  if (start.size() != 0 && start.size() != resp.rows()) {
+      throw "wleEst number of starting estimates must match number of people";
+  }
+
+  ArrayXd est(resp.rows());  // vector of estimates
+  ArrayXd info(resp.rows()); // vector of observed information
+  ArrayXd d(resp.rows());    // vector of corrections
+  Est_Result result;
+
+  // each person is estimated independently: split people across threads
+  parallel_for(resp.rows(), std::max(1, row_grain(params.rows()) / 16), [&](int begin, int end) {
+      // a row of column-major resp is strided: gather it, so wle_root binds it without a copy
+      auto row = Workspace::local().matrix(Scratch::RESP, 1, resp.cols());
+      WLE_Root root;
+
+      for (int i = begin; i < end; i++) {
+          row = resp.row(i);
+          root = wle_root(row, params, range, type, solver, (start.size() != 0 ? start(i) : NAN));
+          est(i) = root.root;
+          info(i) = root.info;
+          d(i) = root.corr;
+      }
+  });
+
+  result.theta = est;
+  result.info = info;
+  result.sem = ((result.info + d.square()) / result.info.square()).sqrt();
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Estimate ability of many people who each answered a different subset of the items
+ *
+ * Every row is scored from its administered items only, exactly as wleEst of that row with the
+ * other items removed (the one-person JS functions filter non-finite responses the same way).
+ *
+ * @param resp        Item responses (N people x M items), non-finite if not administered
+ * @param params      Parameters for M items (M x K matrix)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param mask        Administered items (N x M row-major, zero to skip an item of a row), or empty
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimates (N x 1, NaN for the Brent search) for SolverType::NEWTON, or size 0
+ *
+ * @return Est_Result with theta (Nx1), info (Nx1), and sem (Nx1) info; theta 0 and NaN info/sem for rows without responses
+ */
+const Est_Result wleEst_ragged( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range, ModelType type,
+                                const std::vector<uint8_t>& mask, SolverType solver, const Eigen::Ref<const ArrayXd>& start )
+{
+  CATIRT_STAT_TIMER(Stat::WLE_CALLS);
+  int N = resp.rows();
+  int M = params.rows();
+  Est_Result result;
+
+  if (resp.cols() != M) {
+      throw "wleEst_ragged dimension mismatch between responses and parameters";
+  }
+  if (!mask.empty() && mask.size() != (size_t)N * M) {
+      throw "wleEst_ragged mask size must match responses";
+  }
+  if (start.size() != 0 && start.size() != N) {
+      throw "wleEst_ragged number of starting estimates must match number of people";
+  }
+  if (!params.isFinite().all()) {
+      throw "wleEst_ragged infinite or non-numeric item parameters provided";
+  }
+  if (!(range(0) < 0 && range(1) > 0)) {
+      throw "wleEst_ragged unsupported range provided";
+  }
+
+  result.theta.resize(N);
+  result.info.resize(N);
+  result.sem.resize(N);
+
+  parallel_for(N, std::max(1, row_grain(M) / 16), [&](int begin, int end) {
+      Workspace& ws = Workspace::local();
+      auto sub_resp = ws.matrix(Scratch::RESP, 1, M);                 // administered responses of one row
+      auto sub_params = ws.matrix(Scratch::PARAMS, M, params.cols()); // parameters of the administered items
+      WLE_Root root;
+      int n;
+
+      for (int i = begin; i < end; i++) {
+          n = 0;
+          for (int j = 0; j < M; j++) {
+              if (std::isfinite(resp(i, j)) && (mask.empty() || mask[(size_t)i * M + j])) {
+                  sub_resp(0, n) = resp(i, j);
+                  sub_params.row(n) = params.row(j);
+                  n++;
+              }
+          }
+
+          if (n == 0) {
+              result.theta(i) = 0;
+              result.info(i) = NAN;
+              result.sem(i) = NAN;
+              continue;
+          }
+
+          root = wle_root(sub_resp.leftCols(n), sub_params.topRows(n), range, type, solver,
+                          (start.size() != 0 ? start(i) : NAN));
+          result.theta(i) = root.root;
+          result.info(i) = root.info;
+          result.sem(i) = sqrt((root.info + root.corr * root.corr) / (root.info * root.info));
+      }
+  });
+
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Log-likelihood of the administered responses of one person at one ability
+ *
+ * @param resp        Item responses (N people x M items)
+ * @param i           Row of the person in resp
+ * @param items       Administered items of the row (finite responses)
+ * @param params      Parameters for M items (M x K matrix)
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param theta       Ability
+ *
+ * @return log-likelihood, as logLik_brm or logLik_grm of the administered items
+ */
+static double glr_loglik( const Eigen::Ref<const ArrayXXd>& resp, int i, const std::vector<int>& items, const Eigen::Ref<const ArrayXXd>& params,
+                          ModelType type, double theta )
+{
+  double ll = 0;
+  double u;
+
+  for (int j : items) {
+    u = resp(i, j);
+    if (type == ModelType::BRM) {
+      ll += brm_loglik_item(theta, params(j, 0), params(j, 1), params(j, 2), u);
+    } else {
+      ll += grm_loglik_item(theta, params, j, grm_category(u));
+    }
+  }
+
+  return ll;
+}
+
+/**MDJAVADOC_SKIP
+ * Classify people by the generalized likelihood ratio (SPRT/GLR) at one or more ability bounds
+ *
+ * Port of the termGLR_one JS function: the log-likelihood is maximised over the points of the
+ * grid range(0), range(0) + 0.01, ... (accumulated as in JS) above bound + delta and below
+ * bound - delta, and the category is the first one whose lower ratio is at least
+ * log((1 - beta) / alpha) and whose upper ratio is at most log(beta / (1 - alpha)).
+ *
+ * Rather than evaluating every grid point, each side is searched coarse-to-fine: every
+ * GLR_STRIDE-th point (and the side ends) first, then a discrete bisection on the slope within
+ * one stride of the best coarse point. This finds the dense grid maximum whenever the
+ * log-likelihood has a single peak around the best coarse point, with about 10 evaluations per
+ * side on top of one in GLR_STRIDE grid points, instead of all 901 points of the default range.
+ * Evaluations are shared between the sides of all bounds.
+ *
+ * @param resp        Item responses (N people x M items), non-finite if not administered
+ * @param params      Parameters for M items (M x K matrix)
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param range       Range of abilities to search (2 x 1)
+ * @param bounds      Classification bounds (B x 1), for B + 1 categories
+ * @param delta       Half width of the indifference region around each bound
+ * @param alpha       Type I error rate
+ * @param beta        Type II error rate
+ *
+ * @return GLR_Result with category (Nx1) and likratio (N x B); category -1 and NaN ratios for rows without responses
+ */
+const GLR_Result termGLR( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, ModelType type, const Eigen::Ref<const RowVector2d>& range,
+                          const Eigen::Ref<const ArrayXd>& bounds, double delta, double alpha, double beta )
+{
+  CATIRT_STAT_TIMER(Stat::GLR_CALLS);
+  const int GLR_STRIDE = 10;
+  int N = resp.rows();
+  int M = params.rows();
+  int B = bounds.size();
+  double c_lower = log(beta / (1 - alpha));
+  double c_upper = log((1 - beta) / alpha);
+  std::vector<double> grid;
+  std::vector<int> side_lo(2 * B), side_hi(2 * B);
+  GLR_Result result;
+
+  if (resp.cols() != M) {
+    throw "termGLR dimension mismatch between responses and parameters";
+  }
+  if (!params.isFinite().all()) {
+    throw "termGLR infinite or non-numeric item parameters provided";
+  }
+  if (type == ModelType::BRM && params.cols() != 3) {
+    throw "termGLR BRM parameters must have 3 columns";
+  }
+  if (!(range(0) < range(1)) || B < 1 || !(delta > 0 && alpha > 0 && beta > 0)) {
+    throw "termGLR unsupported range, bounds, delta, alpha, or beta provided";
+  }
+
+  // the JS grid, including its accumulated rounding
+  for (double t = range(0); t <= range(1); t += 0.01) {
+    grid.push_back(t);
+  }
+  int G = grid.size();
+
+  // grid index range [lo, hi] of the upper (2k) and lower (2k + 1) side of each bound, empty if lo > hi
+  for (int k = 0; k < B; k++) {
+    side_lo[2 * k] = std::upper_bound(grid.begin(), grid.end(), bounds(k) + delta) - grid.begin();
+    side_hi[2 * k] = G - 1;
+    side_lo[2 * k + 1] = 0;
+    side_hi[2 * k + 1] = (int)(std::lower_bound(grid.begin(), grid.end(), bounds(k) - delta) - grid.begin()) - 1;
+  }
+
+  result.category.resize(N);
+  result.likratio.resize(N, B);
+
+  parallel_for(N, std::max(1, row_grain(M) / 16), [&](int begin, int end) {
+    Workspace& ws = Workspace::local();
+    std::vector<int>& items = ws.indices(Scratch::ITEMS, M);  // administered items of the row
+    auto ll = ws.vector(Scratch::LOGLIK, G);                  // log-likelihood at the grid points, NaN until evaluated
+    double side_max[2];
+
+    for (int i = begin; i < end; i++) {
+      items.clear();
+      for (int j = 0; j < M; j++) {
+        if (std::isfinite(resp(i, j))) {
+          items.push_back(j);
+        }
+      }
+
+      if (items.empty()) {
+        result.category(i) = -1;
+        result.likratio.row(i).setConstant(NAN);
+        continue;
+      }
+
+      ll.setConstant(NAN);
+      auto f = [&](int g) {
+        if (std::isnan(ll(g))) {
+          ll(g) = glr_loglik(resp, i, items, params, type, grid[g]);
+        }
+        return ll(g);
+      };
+
+      for (int k = 0; k < B; k++) {
+        for (int s = 0; s < 2; s++) {
+          int lo = side_lo[2 * k + s];
+          int hi = side_hi[2 * k + s];
+          int best;
+
+          if (lo > hi) {
+            side_max[s] = -INFINITY;   // as Math.max() of no values
+            continue;
+          }
+
+          // coarse: the side ends and every GLR_STRIDE-th grid point between them
+          best = (f(hi) > f(lo) ? hi : lo);
+          for (int g = (lo / GLR_STRIDE + 1) * GLR_STRIDE; g < hi; g += GLR_STRIDE) {
+            if (f(g) > f(best)) {
+              best = g;
+            }
+          }
+
+          // fine: bisect on the sign of the slope within one stride of the best coarse point
+          int a = std::max(lo, best - GLR_STRIDE);
+          int b = std::min(hi, best + GLR_STRIDE);
+          while (b - a > 1) {
+            int m = (a + b) / 2;
+            if (f(m) < f(m + 1)) {
+              a = m + 1;
+            } else {
+              b = m;
+            }
+          }
+          side_max[s] = std::max(f(a), f(b));
+        }
+
+        result.likratio(i, k) = side_max[0] - side_max[1];
+      }
+
+      // first category with its lower ratio above c_upper and its upper ratio below c_lower
+      result.category(i) = -1;
+      for (int k = 0; k <= B; k++) {
+        double lr_lower = (k == 0 ? c_upper + 0.000001 : result.likratio(i, k - 1));
+        double lr_upper = (k == B ? c_lower - 0.000001 : result.likratio(i, k));
+        if (lr_lower >= c_upper && lr_upper <= c_lower) {
+          result.category(i) = k;
+          break;
+        }
+      }
+    }
+  });
+
+  return result;
+}
@@ -0,0 +1,472 @@
+#ifndef CATIRT_KERNELS_H
+#define CATIRT_KERNELS_H
+
+#include <algorithm>
+#include <type_traits>
+#include "catirt.h"
+#include "catirt_simd.h"
+
+/**MDJAVADOC_SKIP
+ * Fused BRM response terms for one person/item pair (or one lane of item pairs)
+ */
+template <typename T>
+struct BRM_Terms
+{
+    T p;       // probability of correct response
+    T q;       // probability of incorrect response (1 - p)
+    T pder1;   // 1st derivative of p with respect to theta
+    T pder2;   // 2nd derivative of p with respect to theta
+    T info;    // expected Fisher information term: pder1^2 / (p * q)
+};
+
+using BRM_Point = BRM_Terms<double>;
+
+/**MDJAVADOC_SKIP
+ * Evaluate the BRM probability, its 1st and 2nd derivatives, and the expected information term
+ * for one person/item pair from a single exponential
+ *
+ * Fused form of: p.brm.R, pder1.brm.R, pder2.brm.R
+ *
+ * @param theta       Ability estimate (double, or one SIMD lane type for all arguments)
+ * @param a           Item discrimination
+ * @param b           Item difficulty
+ * @param c           Item guessing (lower asymptote)
+ *
+ * @return BRM_Terms with p, q, pder1, pder2, and info terms
+ */
+template <typename T>
+inline BRM_Terms<T> brm_point(T theta, T a, T b, T c)
+{
+  BRM_Terms<T> pt;
+  T p_exp;   // for the exponent of the dimension probability
+  T p_2pl;   // for the 2PL probability of correct
+  T q_2pl;   // for the 2PL probability of incorrect
+
+  p_exp = cat_exp( -a * ( theta - b ) );
+  p_2pl = 1.0 / ( 1.0 + p_exp );
+
+  // 1 - p_2pl without cancellation, so q stays accurate (and non-zero in float) as p approaches 1
+  q_2pl = p_exp * p_2pl;
+
+  pt.p     = c + ( 1.0 - c ) * p_2pl;
+  pt.q     = ( 1.0 - c ) * q_2pl;
+  pt.pder1 = ( 1.0 - c ) * a * p_2pl * q_2pl;
+
+  // equivalent to pder2.brm.R: a * (1 - exp(a(theta-b))) * (1 - p_2pl) * pder1
+  pt.pder2 = a * ( 1.0 - 2.0 * p_2pl ) * pt.pder1;
+  pt.info  = pt.pder1 * pt.pder1 / ( pt.p * pt.q );
+
+  return pt;
+}
+
+/**MDJAVADOC_SKIP
+ * GRM response terms for one person/item/category (or one category boundary)
+ */
+template <typename T>
+struct GRM_Terms
+{
+    T p;       // probability
+    T pder1;   // 1st derivative of p with respect to theta
+    T pder2;   // 2nd derivative of p with respect to theta
+};
+
+using GRM_Point = GRM_Terms<double>;
+
+/**MDJAVADOC_SKIP
+ * Evaluate the cumulative GRM boundary probability P(X >= k) and its 1st and 2nd derivatives
+ * from a single exponential
+ *
+ * @param theta       Ability estimate (double, or one SIMD lane type for all arguments)
+ * @param a           Item discrimination
+ * @param b           Boundary location of category k
+ *
+ * @return GRM_Terms with p, pder1, and pder2 of the boundary
+ */
+template <typename T>
+inline GRM_Terms<T> grm_boundary(T theta, T a, T b)
+{
+  GRM_Terms<T> bd;
+  T p_exp;   // for the exponent of the dimension probability
+
+  p_exp = cat_exp( -a * ( theta - b ) );
+
+  bd.p     = 1.0 / ( 1.0 + p_exp );
+  bd.pder1 = a * bd.p * ( 1.0 - bd.p );
+
+  // equivalent to pder2.grm.R: a * (1 - exp(a(theta-b))) * (1 - p) * pder1
+  bd.pder2 = a * ( 1.0 - 2.0 * bd.p ) * bd.pder1;
+
+  return bd;
+}
+
+// GRM category counts whose category loops get a fixed-K instantiation (see grm_dispatch)
+const int GRM_MAX_FIXED_K = 6;
+
+/**MDJAVADOC_SKIP
+ * Number of GRM categories: the template argument K, or params.cols() for K = Eigen::Dynamic
+ */
+template <int K, typename Params>
+inline int grm_categories(const Params& params)
+{
+  return (K == Eigen::Dynamic) ? (int)params.cols() : K;
+}
+
+/**MDJAVADOC_SKIP
+ * Call f with the GRM category count as a compile-time constant, so the category loops of the
+ * kernels unroll and their index math is constant-folded
+ *
+ * K = 2 .. GRM_MAX_FIXED_K are passed as std::integral_constant<int, K>; other counts fall back
+ * to Eigen::Dynamic (the runtime params.cols()). Dispatch once per call, outside the item loops.
+ *
+ * @param K           Number of categories (params.cols())
+ * @param f           Generic callable taking (auto k), with decltype(k)::value the constant K
+ *
+ * @return result of f
+ */
+template <typename F>
+inline decltype(auto) grm_dispatch(int K, F &&f)
+{
+  static_assert(GRM_MAX_FIXED_K == 6, "grm_dispatch cases must cover 2 .. GRM_MAX_FIXED_K");
+
+  switch (K) {
+    case 2: return f(std::integral_constant<int, 2>());
+    case 3: return f(std::integral_constant<int, 3>());
+    case 4: return f(std::integral_constant<int, 4>());
+    case 5: return f(std::integral_constant<int, 5>());
+    case 6: return f(std::integral_constant<int, 6>());
+    default: return f(std::integral_constant<int, Eigen::Dynamic>());
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Parameters of one GRM item: a fixed-size row copy (a, b_1 .. b_{K-1}) for a fixed K, or a view
+ * of the params row for Eigen::Dynamic
+ */
+template <int K, typename Params>
+inline auto grm_row(const Params& params, int j)
+{
+  if constexpr (K == Eigen::Dynamic) {
+    return params.row(j);
+  } else {
+    return Eigen::Array<double, 1, K>(params.row(j));
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Convert a GRM response value to a category number
+ *
+ * @param u           Item response
+ *
+ * @return category (1 to K for valid responses), or -1 if the response is missing
+ */
+inline int grm_category(double u)
+{
+  return std::isfinite(u) ? static_cast<int>(u) : -1;
+}
+
+/**MDJAVADOC_SKIP
+ * Evaluate only the GRM terms of the responded category of one item: at most two boundary
+ * exponentials are computed, rather than the full category block of p_grm, pder1_grm, and pder2_grm
+ *
+ * Fused, category-selective form of: sel.prm(p.grm.R), sel.prm(pder1.grm.R), sel.prm(pder2.grm.R)
+ *
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param j           Item row in params
+ * @param cat         Responded category (1 to K)
+ *
+ * @return GRM_Point with p, pder1, pder2 of the category - all NaN if cat is outside 1 to K
+ */
+inline GRM_Point grm_point(double theta, const Eigen::Ref<const ArrayXXd>& params, int j, int cat)
+{
+  int K = params.cols();
+  GRM_Point upper = {1, 0, 0};  // P(X >= cat)
+  GRM_Point lower = {0, 0, 0};  // P(X >= cat + 1)
+  GRM_Point pt;
+
+  if (cat <= 0 || cat > K) {
+    pt.p = pt.pder1 = pt.pder2 = nan("");
+    return pt;
+  }
+
+  if (cat > 1) {
+    upper = grm_boundary(theta, params(j, 0), params(j, cat - 1));
+  }
+  if (cat < K) {
+    lower = grm_boundary(theta, params(j, 0), params(j, cat));
+  }
+
+  pt.p     = upper.p     - lower.p;
+  pt.pder1 = upper.pder1 - lower.pder1;
+  pt.pder2 = upper.pder2 - lower.pder2;
+
+  return pt;
+}
+
+/**MDJAVADOC_SKIP
+ * Sum the GRM information terms over all categories of one item in a single pass over its
+ * K-1 boundaries, optionally capturing the terms of the responded category on the way
+ *
+ * @param theta       Ability estimate (double, or one SIMD lane type covering items j, j+1, ...)
+ * @param params      Parameters for M items (M x K matrix of double, or float for float lanes)
+ * @param j           Item row in params
+ * @param cat         Responded category (1 to K), or -1 if not needed (always -1 for SIMD lanes)
+ * @param sel         Output: terms of the responded category (all NaN if cat is outside 1 to K)
+ * @param info        Output: sum over categories of pder1^2 / p
+ * @param h           Output: sum over categories of pder1 * pder2 / p
+ *
+ * K is the fixed category count of grm_dispatch, or Eigen::Dynamic for params.cols().
+ */
+template <int K = Eigen::Dynamic, typename T, typename Params>
+inline void grm_item_sums(T theta, const Params& params, int j, int cat, GRM_Terms<T>& sel, T& info, T& h)
+{
+  const T zero = cat_broadcast<T>(0.0);
+  const T nan_ = cat_broadcast<T>(nan(""));
+  const int n_cat = grm_categories<K>(params);
+  T a = cat_load<T>(params, j, 0);
+  GRM_Terms<T> upper = {cat_broadcast<T>(1.0), zero, zero};  // P(X >= k)
+  GRM_Terms<T> lower;                                         // P(X >= k + 1)
+  GRM_Terms<T> pt;
+
+  sel = {nan_, nan_, nan_};
+  info = zero;
+  h = zero;
+
+  for (int k = 1; k <= n_cat; k++) {
+    if (k < n_cat) {
+      lower = grm_boundary(theta, a, cat_load<T>(params, j, k));
+    } else {
+      lower = {zero, zero, zero};
+    }
+
+    pt.p     = upper.p     - lower.p;
+    pt.pder1 = upper.pder1 - lower.pder1;
+    pt.pder2 = upper.pder2 - lower.pder2;
+
+    // categories with p rounded to 0 (far tails, mostly in float) contribute nothing
+    info += cat_ratio(pt.pder1 * pt.pder1, pt.p);
+    h    += cat_ratio(pt.pder1 * pt.pder2, pt.p);
+
+    if (k == cat) {
+      sel = pt;
+    }
+
+    upper = lower;
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Evaluate the fused BRM terms of items j, j+1, ... (one SIMD lane, or one item for T = double)
+ *
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x 3 matrix of double, or float for float lanes)
+ * @param j           First item row in params
+ *
+ * @return BRM_Terms of the lane
+ */
+template <typename T, typename Params>
+inline BRM_Terms<T> brm_item(double theta, const Params& params, int j)
+{
+  return brm_point(cat_broadcast<T>(theta), cat_load<T>(params, j, 0), cat_load<T>(params, j, 1), cat_load<T>(params, j, 2));
+}
+
+/**MDJAVADOC_SKIP
+ * Weighted likelihood (Warm) score terms of one person/item pair, and their derivatives with
+ * respect to theta, for the Newton WLE solver
+ *
+ * Summed over items, the WLE score is lder1 + h / (2 * info) and its derivative is
+ * lder2 + (h_d1 * info - h * info_d1) / (2 * info^2).
+ */
+template <typename T>
+struct WLE_Terms
+{
+    T lder1;     // 1st derivative of the log-likelihood
+    T lder2;     // 2nd derivative of the log-likelihood (negative observed information)
+    T info;      // expected information: pder1^2 / (p * q), summed over categories
+    T h;         // Warm correction numerator: pder1 * pder2 / (p * q), summed over categories
+    T info_d1;   // derivative of info with respect to theta
+    T h_d1;      // derivative of h with respect to theta
+};
+
+using WLE_Point = WLE_Terms<double>;
+
+/**MDJAVADOC_SKIP
+ * Evaluate the WLE score terms of BRM items j, j+1, ... (one SIMD lane, or one item for T = double)
+ *
+ * Uses the 3rd derivative of p: a * ( (1 - 2 * p_2pl) * pder2 - 2 * a * p_2pl * (1 - p_2pl) * pder1 )
+ *
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x 3 matrix)
+ * @param j           First item row in params
+ * @param u           Responses of the lane (1 = correct, 0 = incorrect)
+ *
+ * @return WLE_Terms of the lane
+ */
+template <typename T, typename Params>
+inline WLE_Terms<T> brm_wle_item(double theta, const Params& params, int j, T u)
+{
+  WLE_Terms<T> wt;
+  T a = cat_load<T>(params, j, 0);
+  T b = cat_load<T>(params, j, 1);
+  T c = cat_load<T>(params, j, 2);
+  T p_exp, p_2pl, p, q, pq, pder1, pder2, pder3, dpq;
+
+  p_exp = cat_exp( -a * ( cat_broadcast<T>(theta) - b ) );
+  p_2pl = 1.0 / ( 1.0 + p_exp );
+
+  p     = c + ( 1.0 - c ) * p_2pl;
+  q     = 1.0 - p;
+  pq    = p * q;
+  pder1 = ( 1.0 - c ) * a * p_2pl * ( 1.0 - p_2pl );
+  pder2 = a * ( 1.0 - 2.0 * p_2pl ) * pder1;
+  pder3 = a * ( ( 1.0 - 2.0 * p_2pl ) * pder2 - 2.0 * a * p_2pl * ( 1.0 - p_2pl ) * pder1 );
+  dpq   = pder1 * ( 1.0 - 2.0 * p );  // derivative of p * q
+
+  wt.lder1   = ( u - p ) * pder1 / pq;
+  wt.lder2   = u * ( pder2 / p - pder1 * pder1 / ( p * p ) ) - ( 1.0 - u ) * ( pder2 / q + pder1 * pder1 / ( q * q ) );
+  wt.info    = pder1 * pder1 / pq;
+  wt.h       = pder1 * pder2 / pq;
+  wt.info_d1 = ( 2.0 * pder1 * pder2 - wt.info * dpq ) / pq;
+  wt.h_d1    = ( pder2 * pder2 + pder1 * pder3 - wt.h * dpq ) / pq;
+
+  return wt;
+}
+
+/**MDJAVADOC_SKIP
+ * Evaluate the WLE score terms of one GRM item in a single pass over its K-1 boundaries
+ *
+ * Each boundary has pder3 = a * (1 - 2 * P) * pder2 - 2 * a * pder1^2, and each category the
+ * differences of its two boundaries.
+ *
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param j           Item row in params
+ * @param cat         Responded category (1 to K)
+ *
+ * @return WLE_Point of the item - lder1 and lder2 are NaN if cat is outside 1 to K
+ *
+ * K is the fixed category count of grm_dispatch, or Eigen::Dynamic for params.cols().
+ */
+template <int K = Eigen::Dynamic>
+inline WLE_Point grm_wle_item(double theta, const Eigen::Ref<const ArrayXXd>& params, int j, int cat)
+{
+  const int n_cat = grm_categories<K>(params);
+  const auto row = grm_row<K>(params, j);
+  double a = row(0);
+  double upper[4] = {1, 0, 0, 0};  // P(X >= k) and its 3 derivatives
+  double lower[4];                 // P(X >= k + 1) and its 3 derivatives
+  double pt[4];                    // category probability and its 3 derivatives
+  WLE_Point wt = {nan(""), nan(""), 0, 0, 0, 0};
+
+  for (int k = 1; k <= n_cat; k++) {
+    if (k < n_cat) {
+      GRM_Point bd = grm_boundary(theta, a, row(k));
+      lower[0] = bd.p;
+      lower[1] = bd.pder1;
+      lower[2] = bd.pder2;
+      lower[3] = a * ( 1.0 - 2.0 * bd.p ) * bd.pder2 - 2.0 * a * bd.pder1 * bd.pder1;
+    } else {
+      lower[0] = lower[1] = lower[2] = lower[3] = 0;
+    }
+
+    for (int d = 0; d < 4; d++) {
+      pt[d] = upper[d] - lower[d];
+    }
+
+    wt.info    += pt[1] * pt[1] / pt[0];
+    wt.h       += pt[1] * pt[2] / pt[0];
+    wt.info_d1 += ( 2.0 * pt[1] * pt[2] - pt[1] * pt[1] * pt[1] / pt[0] ) / pt[0];
+    wt.h_d1    += ( pt[2] * pt[2] + pt[1] * pt[3] - pt[1] * pt[1] * pt[2] / pt[0] ) / pt[0];
+
+    if (k == cat) {
+      wt.lder1 = pt[1] / pt[0];
+      wt.lder2 = pt[2] / pt[0] - pt[1] * pt[1] / ( pt[0] * pt[0] );
+    }
+
+    for (int d = 0; d < 4; d++) {
+      upper[d] = lower[d];
+    }
+  }
+
+  return wt;
+}
+
+/**MDJAVADOC_SKIP
+ * Log-likelihood of one BRM response, from a single exponential and a single logarithm
+ *
+ * With z = a * (theta - b) and e = exp(-|z|), p and q are both formed as ratios over (1 + e),
+ * so q is not the cancelling 1 - p, and the exp(-z) factor of q for z >= 0 stays in the log
+ * domain (softplus). Only the terms with a non-zero weight are evaluated.
+ *
+ * @param theta       Ability estimate
+ * @param a           Item discrimination
+ * @param b           Item difficulty
+ * @param c           Item guessing (lower asymptote)
+ * @param u           Response (1 = correct, 0 = incorrect)
+ *
+ * @return u * log(p) + (1 - u) * log(q)
+ */
+inline double brm_loglik_item(double theta, double a, double b, double c, double u)
+{
+  double z = a * ( theta - b );
+  double e = cat_exp( -fabs(z) );  // in (0, 1], no overflow
+  double ll = 0;
+
+  if ( u != 0 ) {
+    // p = (1 + c e) / (1 + e) for z >= 0, (c + e) / (1 + e) otherwise
+    ll += u * ( z >= 0 ? log( ( 1.0 + c * e ) / ( 1.0 + e ) ) : log( ( c + e ) / ( 1.0 + e ) ) );
+  }
+  if ( u != 1 ) {
+    // q = (1 - c) e / (1 + e) for z >= 0, (1 - c) / (1 + e) otherwise
+    ll += ( 1.0 - u ) * ( log( ( 1.0 - c ) / ( 1.0 + e ) ) - std::max(z, 0.0) );
+  }
+
+  return ll;
+}
+
+/**MDJAVADOC_SKIP
+ * Log-likelihood of one GRM response: only the boundaries of the responded category are evaluated
+ *
+ * The category probability is the difference of two boundary logistics, taken between their
+ * complements above both boundaries so it does not cancel to 0 when both are near 1.
+ *
+ * @param theta       Ability estimate
+ * @param params      Parameters for M items (M x K matrix) where K is number of categories
+ * @param j           Item row in params
+ * @param cat         Responded category (1 to K)
+ *
+ * @return log of the category probability - NaN if cat is outside 1 to K or the probability is negative (disordered boundaries)
+ */
+inline double grm_loglik_item(double theta, const Eigen::Ref<const ArrayXXd>& params, int j, int cat)
+{
+  int K = params.cols();
+  double a = params(j, 0);
+  double z_hi, z_lo;   // boundary logits of P(X >= cat) and P(X >= cat + 1)
+  double e;
+
+  if (cat <= 0 || cat > K) {
+    return nan("");
+  }
+  if (cat == 1) {
+    // log(1 - P(X >= 2))
+    z_lo = a * ( theta - params(j, 1) );
+    e = cat_exp( -fabs(z_lo) );
+    return -log1p(e) - std::max(z_lo, 0.0);
+  }
+  if (cat == K) {
+    // log(P(X >= K))
+    z_hi = a * ( theta - params(j, K - 1) );
+    e = cat_exp( -fabs(z_hi) );
+    return -log1p(e) - std::max(-z_hi, 0.0);
+  }
+
+  z_hi = a * ( theta - params(j, cat - 1) );
+  z_lo = a * ( theta - params(j, cat) );
+  if (z_lo >= 0) {
+    // (1 - P(X >= cat + 1)) - (1 - P(X >= cat))
+    return log( 1.0 / ( 1.0 + cat_exp(z_lo) ) - 1.0 / ( 1.0 + cat_exp(z_hi) ) );
+  }
+  return log( 1.0 / ( 1.0 + cat_exp(-z_hi) ) - 1.0 / ( 1.0 + cat_exp(-z_lo) ) );
+}
+
+#endif // CATIRT_KERNELS_H
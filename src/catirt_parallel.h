@@ -0,0 +1,85 @@
+#ifndef CATIRT_PARALLEL_H
+#define CATIRT_PARALLEL_H
+
+#include <algorithm>
+#include "catirt.h"
+
+//
+// Row-parallel loops over people (examinees) for the batch functions.
+//
+// Enabled automatically for emcc -pthread builds, or natively by defining CATIRT_THREADS=1
+// (see CMakeLists.txt). Rows are split into contiguous chunks and every row is computed
+// exactly as in the serial loop, so results do not depend on the number of threads.
+//
+
+#if !defined(CATIRT_THREADS) && defined(__EMSCRIPTEN_PTHREADS__)
+#define CATIRT_THREADS 1
+#endif
+
+#if !defined(CATIRT_THREADS)
+#define CATIRT_THREADS 0
+#endif
+
+#if CATIRT_THREADS
+/**MDJAVADOC_SKIP
+ * Run job(ctx, c) for the chunks c = 0..n_chunks-1 on the calling thread and the thread pool
+ *
+ * The pool holds getNumThreads() - 1 worker threads, started on first use and kept until
+ * setNumThreads() lowers the count, so each worker keeps its Workspace across calls. Chunks
+ * are claimed in any order; the first exception thrown by a chunk is rethrown once all finish.
+ *
+ * @param n_chunks    Number of chunks
+ * @param job         Function running one chunk
+ * @param ctx         First argument of job
+ *
+ * @return false, running nothing, if called from within a chunk or while another thread uses the pool
+ */
+bool parallel_run(int n_chunks, void (*job)(void *, int), void *ctx);
+#endif
+
+/**MDJAVADOC_SKIP
+ * Run f(begin, end) over row chunks covering 0..n-1, using up to getNumThreads() threads
+ *
+ * The calling thread runs chunks alongside the pool workers. Chunks hold at least grain rows,
+ * so small batches (e.g. the single person of itChoose) stay on the calling thread. Nested
+ * calls, and calls made while another thread uses the pool, run serially. The first exception
+ * thrown by any chunk is rethrown after all chunks finish.
+ *
+ * @param n           Number of rows
+ * @param grain       Minimum number of rows per chunk
+ * @param f           Callable taking (int begin, int end)
+ */
+template <typename F>
+void parallel_for(int n, int grain, F &&f)
+{
+#if CATIRT_THREADS
+  int n_chunks = std::min(getNumThreads(), n / std::max(grain, 1));
+
+  if (n_chunks > 1) {
+    int chunk = (n + n_chunks - 1) / n_chunks;
+    auto run = [&](int c) {
+      f(c * chunk, std::min(n, (c + 1) * chunk));
+    };
+    auto job = [](void *ctx, int c) {
+      (*static_cast<decltype(run) *>(ctx))(c);
+    };
+
+    if (parallel_run(n_chunks, job, &run)) {
+      return;
+    }
+  }
+#endif
+
+  f(0, n);
+}
+
+/**MDJAVADOC_SKIP
+ * Minimum rows per chunk for row loops over M items, so that a thread gets enough
+ * item evaluations to pay for its start-up
+ */
+inline int row_grain(int M)
+{
+  return std::max(1, 4096 / std::max(M, 1));
+}
+
+#endif // CATIRT_PARALLEL_H
@@ -0,0 +1,274 @@
+#ifndef CATIRT_SIMD_H
+#define CATIRT_SIMD_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//
+// Portable 2 x double (and 4 x float) vector kernels for the item loops of the BRM/GRM kernels.
+//
+// Uses GCC/Clang vector extensions, which lower to WebAssembly SIMD128 when compiled
+// with emcc -msimd128, and to SSE2/AVX natively. Enabled automatically for -msimd128
+// builds, or natively by defining CATIRT_SIMD=1 (see CMakeLists.txt).
+//
+// Every kernel is written once as a template over its lane type T (double or f64x2):
+// simd_for() runs the f64x2 instantiation over pairs of items and finishes the odd item
+// with the scalar instantiation, which still uses std::exp.
+//
+// The float32 selection mode (Precision::FLOAT32) instantiates the same kernels with float
+// or f32x4 lanes over float parameters: simd_for<float>() covers 4 items per vector.
+//
+
+#if !defined(CATIRT_SIMD) && defined(__wasm_simd128__)
+#define CATIRT_SIMD 1
+#endif
+
+#if !defined(CATIRT_SIMD)
+#define CATIRT_SIMD 0
+#endif
+
+/**MDJAVADOC_SKIP
+ * Exponential used by the kernels (scalar lanes), clamped like the vector lanes so it stays finite
+ */
+inline double cat_exp(double x)
+{
+  return exp(x < 709.0 ? x : 709.0);
+}
+
+inline float cat_exp(float x)
+{
+  return expf(x < 88.3f ? x : 88.3f);
+}
+
+// num / den, or 0 where den is 0
+inline double cat_ratio(double num, double den) { return den != 0 ? num / den : 0.0; }
+inline float cat_ratio(float num, float den) { return den != 0 ? num / den : 0.0f; }
+
+template <typename T> inline T cat_load(const double *p);
+template <> inline double cat_load<double>(const double *p) { return *p; }
+template <typename T> inline T cat_load(const float *p);
+template <> inline float cat_load<float>(const float *p) { return *p; }
+
+// load item j (and j+1 for vector lanes) of column k of a column-major matrix
+template <typename T, typename M> inline T cat_load(const M& m, int j, int k)
+{
+  return cat_load<T>(m.data() + j + k * m.outerStride());
+}
+
+template <typename T> inline T cat_broadcast(double x);
+template <> inline double cat_broadcast<double>(double x) { return x; }
+template <> inline float cat_broadcast<float>(double x) { return (float)x; }
+
+inline double cat_lane(double v, int) { return v; }
+inline double cat_hsum(double v) { return v; }
+inline double cat_lane(float v, int) { return v; }
+
+// element type of a lane type
+template <typename T> struct cat_scalar { using type = T; };
+
+// gather/scatter a lane along row i of a column-major matrix
+template <typename M> inline double cat_row(const M& m, int i, int j, double) { return m(i, j); }
+template <typename M> inline void cat_store_row(M& m, int i, int j, double v) { m(i, j) = v; }
+template <typename M> inline void cat_store_row(M& m, int i, int j, float v) { m(i, j) = v; }
+
+#if CATIRT_SIMD
+
+typedef double f64x2 __attribute__((vector_size(16)));
+typedef int64_t i64x2 __attribute__((vector_size(16)));
+
+/**MDJAVADOC_SKIP
+ * Exponential of 2 doubles per lane
+ *
+ * Range reduction exp(x) = 2^n * exp(r), |r| <= ln(2)/2, with the Cephes exp() Pade
+ * approximant for exp(r) (max relative error ~2e-16). Inputs are clamped to [-708, 709]
+ * so 2^n stays a normal double; the kernels only use exp() inside 1 / (1 + exp(x)).
+ *
+ * @param x           2 exponents
+ *
+ * @return 2 exponentials
+ */
+inline f64x2 cat_exp(f64x2 x)
+{
+  const double LOG2E  = 1.4426950408889634073599;
+  const double LN2_HI = 6.93145751953125E-1;
+  const double LN2_LO = 1.42860682030941723212E-6;
+  const double ROUND  = 6755399441055744.0;  // 1.5 * 2^52: adding it rounds to an integer
+  const f64x2 lo = {-708.0, -708.0};
+  const f64x2 hi = {709.0, 709.0};
+  const f64x2 round2 = {ROUND, ROUND};
+  f64x2 t, n, r, rr, px, qx, e;
+  i64x2 bits, mask;
+
+  // clamp via bitwise select (comparisons yield all-ones/all-zeros lanes)
+  mask = (x < lo);
+  x = (f64x2)(((i64x2)lo & mask) | ((i64x2)x & ~mask));
+  mask = (x > hi);
+  x = (f64x2)(((i64x2)hi & mask) | ((i64x2)x & ~mask));
+
+  // n = round(x / ln(2)), r = x - n * ln(2)
+  t = x * LOG2E + ROUND;
+  n = t - ROUND;
+  r = x - n * LN2_HI - n * LN2_LO;
+
+  // exp(r) = 1 + 2 * P(r) / (Q(r^2) - P(r))
+  rr = r * r;
+  px = r * ((1.26177193074810590878E-4 * rr + 3.02994407707441961300E-2) * rr + 9.99999999999999999910E-1);
+  qx = ((3.00198505138664455042E-6 * rr + 2.52448340349684104192E-3) * rr + 2.27265548208155028766E-1) * rr + 2.00000000000000000009E0;
+  e  = 1.0 + 2.0 * px / (qx - px);
+
+  // scale by 2^n: the low mantissa bits of t hold n
+  bits = (i64x2)t - (i64x2)round2;
+  bits = (bits + 1023) << 52;
+
+  return e * (f64x2)bits;
+}
+
+template <> inline f64x2 cat_load<f64x2>(const double *p)
+{
+  f64x2 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+template <> inline f64x2 cat_broadcast<f64x2>(double x)
+{
+  return (f64x2){x, x};
+}
+
+inline double cat_lane(f64x2 v, int k) { return v[k]; }
+inline double cat_hsum(f64x2 v) { return v[0] + v[1]; }
+
+template <typename M> inline f64x2 cat_row(const M& m, int i, int j, f64x2)
+{
+  f64x2 v = {m(i, j), m(i, j + 1)};
+  return v;
+}
+
+template <typename M> inline void cat_store_row(M& m, int i, int j, f64x2 v)
+{
+  m(i, j) = v[0];
+  m(i, j + 1) = v[1];
+}
+
+inline f64x2 cat_ratio(f64x2 num, f64x2 den)
+{
+  const f64x2 zero = {0.0, 0.0};
+  return (f64x2)((i64x2)(num / den) & (den != zero));
+}
+
+template <> struct cat_scalar<f64x2> { using type = double; };
+
+typedef float f32x4 __attribute__((vector_size(16)));
+typedef int32_t i32x4 __attribute__((vector_size(16)));
+
+/**MDJAVADOC_SKIP
+ * Exponential of 4 floats per lane
+ *
+ * Same range reduction as the f64x2 exp() with the Cephes expf() polynomial for exp(r)
+ * (max relative error ~2e-7). Inputs are clamped to [-87.3, 88.3] so 2^n stays a normal float.
+ *
+ * @param x           4 exponents
+ *
+ * @return 4 exponentials
+ */
+inline f32x4 cat_exp(f32x4 x)
+{
+  const float LOG2E = 1.44269504088896341f;
+  const float LN2_HI = 0.693359375f;
+  const float LN2_LO = -2.12194440e-4f;
+  const float ROUND = 12582912.0f;  // 1.5 * 2^23: adding it rounds to an integer
+  const f32x4 lo = {-87.3f, -87.3f, -87.3f, -87.3f};
+  const f32x4 hi = {88.3f, 88.3f, 88.3f, 88.3f};
+  const f32x4 round4 = {ROUND, ROUND, ROUND, ROUND};
+  f32x4 t, n, r, px, e;
+  i32x4 bits, mask;
+
+  mask = (x < lo);
+  x = (f32x4)(((i32x4)lo & mask) | ((i32x4)x & ~mask));
+  mask = (x > hi);
+  x = (f32x4)(((i32x4)hi & mask) | ((i32x4)x & ~mask));
+
+  // n = round(x / ln(2)), r = x - n * ln(2)
+  t = x * LOG2E + ROUND;
+  n = t - ROUND;
+  r = x - n * LN2_HI - n * LN2_LO;
+
+  // exp(r) = 1 + r + r^2 * P(r)
+  px = ((((1.9875691500E-4f * r + 1.3981999507E-3f) * r + 8.3334519073E-3f) * r + 4.1665795894E-2f) * r + 1.6666665459E-1f) * r + 5.0000001201E-1f;
+  e = px * r * r + r + 1.0f;
+
+  // scale by 2^n: the low mantissa bits of t hold n
+  bits = (i32x4)t - (i32x4)round4;
+  bits = (bits + 127) << 23;
+
+  return e * (f32x4)bits;
+}
+
+template <> inline f32x4 cat_load<f32x4>(const float *p)
+{
+  f32x4 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+template <> inline f32x4 cat_broadcast<f32x4>(double x)
+{
+  float f = (float)x;
+  return (f32x4){f, f, f, f};
+}
+
+inline double cat_lane(f32x4 v, int k) { return v[k]; }
+
+template <typename M> inline void cat_store_row(M& m, int i, int j, f32x4 v)
+{
+  for (int k = 0; k < 4; k++) {
+    m(i, j + k) = v[k];
+  }
+}
+
+inline f32x4 cat_ratio(f32x4 num, f32x4 den)
+{
+  const f32x4 zero = {0.0f, 0.0f, 0.0f, 0.0f};
+  return (f32x4)((i32x4)(num / den) & (den != zero));
+}
+
+template <> struct cat_scalar<f32x4> { using type = float; };
+
+#endif // CATIRT_SIMD
+
+/**MDJAVADOC_SKIP
+ * Run f(j, T()) over items 0..n-1: two items at a time with T = f64x2 (four with T = f32x4
+ * for S = float) when SIMD is enabled, and one at a time with T = S for the remainder
+ *
+ * @param n           Number of items
+ * @param f           Generic callable taking (int j, T lane_tag)
+ */
+template <typename S = double, typename F>
+inline void simd_for(int n, F &&f)
+{
+  int j = 0;
+
+#if CATIRT_SIMD
+  if constexpr (sizeof(S) == sizeof(double)) {
+    for (; j + 2 <= n; j += 2) {
+      f(j, f64x2());
+    }
+  } else {
+    for (; j + 4 <= n; j += 4) {
+      f(j, f32x4());
+    }
+  }
+#endif
+
+  for (; j < n; j++) {
+    f(j, S());
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Number of items covered by one lane of type T
+ */
+template <typename T> constexpr int cat_width() { return sizeof(T) / sizeof(typename cat_scalar<T>::type); }
+
+#endif // CATIRT_SIMD_H
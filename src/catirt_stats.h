@@ -0,0 +1,93 @@
+#ifndef CATIRT_STATS_H
+#define CATIRT_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "catirt.h"
+
+//
+// Performance counters of the core (see Stat in catirt.h, getStat() and resetStats()).
+//
+// Compiled in only with CATIRT_ENABLE_STATS=1 (the emscripten builds, or the CATIRT_STATS
+// CMake option); otherwise the macros below expand to nothing and every counter reads 0.
+// Counters are relaxed atomics, so worker threads of parallel_for can add to them. Kernel
+// timers are placed on the public entry points and count calls; they also read the clock for
+// the *_NS counters only with CATIRT_ENABLE_STAT_TIMERS=1 (the CATIRT_STAT_TIMERS CMake
+// option), since two clock reads cost more than many of the kernels they would time.
+//
+
+#if !defined(CATIRT_ENABLE_STATS)
+#define CATIRT_ENABLE_STATS 0
+#endif
+
+#if !defined(CATIRT_ENABLE_STAT_TIMERS) || !CATIRT_ENABLE_STATS
+#undef CATIRT_ENABLE_STAT_TIMERS
+#define CATIRT_ENABLE_STAT_TIMERS 0
+#endif
+
+#if CATIRT_ENABLE_STATS
+
+extern std::atomic<uint64_t> stat_counters[(int)Stat::COUNT];
+
+inline void stat_add(Stat s, uint64_t n)
+{
+  stat_counters[(int)s].fetch_add(n, std::memory_order_relaxed);
+}
+
+/**MDJAVADOC_SKIP
+ * Count one call of a kernel group and, with CATIRT_ENABLE_STAT_TIMERS, add its wall time
+ * (in ns) to the following counter
+ *
+ * Only the outermost timer of a thread counts, so a kernel called by another one (e.g. the
+ * lder2 of observed FI) is part of its caller's time rather than a call of its own.
+ */
+class StatTimer
+{
+public:
+  explicit StatTimer(Stat calls) : calls_(calls), outer_(depth()++ == 0)
+  {
+#if CATIRT_ENABLE_STAT_TIMERS
+    if (outer_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+#endif
+  }
+
+  ~StatTimer()
+  {
+    depth()--;
+    if (outer_) {
+      stat_add(calls_, 1);
+#if CATIRT_ENABLE_STAT_TIMERS
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+      stat_add((Stat)((int)calls_ + 1), (uint64_t)ns);
+#endif
+    }
+  }
+
+private:
+  static int& depth()
+  {
+    static thread_local int d = 0;
+    return d;
+  }
+
+  Stat calls_;
+  bool outer_;
+#if CATIRT_ENABLE_STAT_TIMERS
+  std::chrono::steady_clock::time_point start_;
+#endif
+};
+
+#define CATIRT_STAT_ADD(s, n) stat_add((s), (uint64_t)(n))
+#define CATIRT_STAT_TIMER(calls) StatTimer stat_timer_(calls)
+
+#else
+
+#define CATIRT_STAT_ADD(s, n) ((void)0)
+#define CATIRT_STAT_TIMER(calls) ((void)0)
+
+#endif
+
+#endif // CATIRT_STATS_H
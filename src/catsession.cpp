@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cstring>
+#include "catsession.h"
+#include "catirt_stats.h"
+
+/**MDJAVADOC_SKIP
+ * Little-endian packing of the serialized session fields
+ */
+static void put_u32(std::vector<uint8_t>& out, uint32_t v)
+{
+  for (int k = 0; k < 4; k++) {
+    out.push_back((uint8_t)(v >> (8 * k)));
+  }
+}
+
+static void put_f64(std::vector<uint8_t>& out, double x)
+{
+  uint64_t v;
+  memcpy(&v, &x, sizeof(v));
+  for (int k = 0; k < 8; k++) {
+    out.push_back((uint8_t)(v >> (8 * k)));
+  }
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v)
+{
+  for (int k = 0; k < 8; k++) {
+    out.push_back((uint8_t)(v >> (8 * k)));
+  }
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+  uint64_t v = 0;
+  for (int k = 0; k < 8; k++) {
+    v |= (uint64_t)p[k] << (8 * k);
+  }
+  return v;
+}
+
+static double get_f64(const uint8_t *p)
+{
+  uint64_t v = get_u64(p);
+  double x;
+  memcpy(&x, &v, sizeof(x));
+  return x;
+}
+
+/**MDJAVADOC_SKIP
+ * Start a CAT session against an item bank
+ *
+ * @param bank        ItemBank of the session (not owned, must outlive the session)
+ * @param range       Range of abilities to explore (2 x 1), from negative to positive
+ */
+CatSession::CatSession(ItemBank& bank, const Eigen::Ref<const RowVector2d>& range)
+  : bank_(&bank), range_(range), mask_(bank.size(), 0), resp_(1, 0), params_(0, bank.params().cols())
+{
+  est_.theta.resize(1);
+  est_.info.resize(1);
+  est_.sem.resize(1);
+
+  if (!(range_(0) < 0 && range_(1) > 0)) {
+    throw "CatSession unsupported range provided";
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Check one response before adding it
+ *
+ * @param item        Bank index of the administered item
+ * @param value       Response: 0 or 1 (BRM), or category 1 to K (GRM)
+ *
+ * @return error message, or nullptr if the response can be added
+ */
+const char *CatSession::checkResponse(int item, double value) const
+{
+  if (item < 0 || item >= bank_->size()) {
+    return "CatSession item index out of range";
+  }
+  if (mask_[item]) {
+    return "CatSession item already administered";
+  }
+  if (bank_->model() == ModelType::BRM && !(value == 0 || value == 1)) {
+    return "CatSession BRM response must be 0 or 1";
+  }
+  if (bank_->model() == ModelType::GRM && !(value >= 1 && value <= bank_->categories() && value == std::floor(value))) {
+    return "CatSession GRM response must be a category from 1 to K";
+  }
+  return nullptr;
+}
+
+/**MDJAVADOC_SKIP
+ * Append one response and the parameters of its item (storage grows geometrically)
+ */
+void CatSession::append(int item, double value)
+{
+  if (n_ == params_.rows()) {
+    int capacity = std::max(8, 2 * n_);
+    params_.conservativeResize(capacity, Eigen::NoChange);
+    resp_.conservativeResize(Eigen::NoChange, capacity);
+  }
+
+  params_.row(n_) = bank_->params().row(item);
+  resp_(0, n_) = value;
+  items_.push_back(item);
+  mask_[item] = 1;
+  n_++;
+  current_ = false;
+}
+
+/**MDJAVADOC_SKIP
+ * Record the response to one administered item
+ *
+ * @param item        Bank index of the administered item
+ * @param value       Response: 0 or 1 (BRM), or category 1 to K (GRM)
+ */
+void CatSession::addResponse(int item, double value)
+{
+  const char *error = checkResponse(item, value);
+
+  if (error) {
+    throw error;
+  }
+  append(item, value);
+}
+
+/**MDJAVADOC_SKIP
+ * Weighted likelihood ability estimate of the responses so far
+ *
+ * Solved with newton_wle, from the previous estimate when there is one; nothing is recomputed
+ * if no response was added since the last call. Each Newton step is one pass over all the
+ * administered items (the information sums change with theta), so the cost of an estimate
+ * grows with test length; the warm start keeps it to a few passes. newton_wle hands 3PL banks
+ * and uncertified roots to the Brent solver, so the estimate is the one wleEst gives for the
+ * same items and responses.
+ *
+ * @return Est_Result of size 1 (valid until the next call); theta 0 and NaN info/sem if no item was administered
+ */
+const Est_Result& CatSession::estimate()
+{
+  if (!current_ && n_ > 0) {
+    CATIRT_STAT_TIMER(Stat::WLE_CALLS);
+    WLE_Root root = newton_wle(resp_.leftCols(n_), params_.topRows(n_), range_, bank_->model(), (estimated_ ? theta_ : NAN));
+
+    theta_ = root.root;
+    info_ = root.info;
+    sem_ = sqrt((root.info + root.corr * root.corr) / (root.info * root.info));
+    estimated_ = true;
+  }
+  current_ = true;
+
+  est_.theta(0) = theta_;
+  est_.info(0) = info_;
+  est_.sem(0) = sem_;
+  return est_;
+}
+
+/**MDJAVADOC_SKIP
+ * Choose the next item(s) by expected information at the current estimate (UW-FI)
+ *
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ *
+ * @return Choose_Result with up to numb items not administered yet (valid until the next call)
+ */
+const Choose_Result& CatSession::nextItem(int n_select, int numb)
+{
+  estimate();
+  bank_->itChoose(theta_, mask_, n_select, numb, choice_);
+  return choice_;
+}
+
+/**MDJAVADOC_SKIP
+ * Pack the session state into a little-endian blob
+ *
+ * Layout: magic (u32), version (u8), model (u8), flags (u8: 1 estimated, 2 current), reserved (u8),
+ * bank size (u32), n (u32), range lower, range upper, theta, info, sem (f64 each), bank
+ * fingerprint (u64, ItemBank::fingerprint()), then n entries of item index (u16) and response (u8).
+ *
+ * @return blob of SERIAL_HEADER + 3 * n bytes
+ */
+std::vector<uint8_t> CatSession::serialize() const
+{
+  std::vector<uint8_t> out;
+
+  if (bank_->size() > 65536) {
+    throw "CatSession serialize supports item banks of at most 65536 items";
+  }
+
+  out.reserve(SERIAL_HEADER + 3 * n_);
+  put_u32(out, SERIAL_MAGIC);
+  out.push_back(SERIAL_VERSION);
+  out.push_back(bank_->model() == ModelType::BRM ? 0 : 1);
+  out.push_back((estimated_ ? 1 : 0) | (current_ ? 2 : 0));
+  out.push_back(0);
+  put_u32(out, bank_->size());
+  put_u32(out, n_);
+  put_f64(out, range_(0));
+  put_f64(out, range_(1));
+  put_f64(out, theta_);
+  put_f64(out, info_);
+  put_f64(out, sem_);
+  put_u64(out, bank_->fingerprint());
+
+  for (int i = 0; i < n_; i++) {
+    out.push_back((uint8_t)(items_[i] & 0xff));
+    out.push_back((uint8_t)(items_[i] >> 8));
+    out.push_back((uint8_t)resp_(0, i));
+  }
+
+  return out;
+}
+
+/**MDJAVADOC_SKIP
+ * Restore the state of a serialized session of the same bank, leaving this session unchanged on error
+ *
+ * The bank must have the model, size, and fingerprint (parameters) of the serialized session's bank.
+ *
+ * @param blob        Output of serialize()
+ *
+ * @return error message, or nullptr if the state was restored
+ */
+const char *CatSession::tryDeserialize(const std::vector<uint8_t>& blob)
+{
+  const uint8_t *p = blob.data();
+
+  if (blob.size() < (size_t)SERIAL_HEADER || get_u32(p) != SERIAL_MAGIC) {
+    return "CatSession deserialize not a serialized session";
+  }
+  if (p[4] != SERIAL_VERSION) {
+    return "CatSession deserialize unsupported version";
+  }
+  if (p[5] != (bank_->model() == ModelType::BRM ? 0 : 1) || get_u32(p + 8) != (uint32_t)bank_->size() ||
+      get_u64(p + 56) != bank_->fingerprint()) {
+    return "CatSession deserialize item bank mismatch";
+  }
+
+  uint32_t n = get_u32(p + 12);
+  RowVector2d range(get_f64(p + 16), get_f64(p + 24));
+
+  if (blob.size() != SERIAL_HEADER + 3 * (size_t)n) {
+    return "CatSession deserialize length mismatch";
+  }
+  if (!(range(0) < 0 && range(1) > 0)) {
+    return "CatSession deserialize unsupported range";
+  }
+
+  CatSession restored(*bank_, range);
+  const char *error;
+
+  for (uint32_t i = 0; i < n; i++) {
+    const uint8_t *e = p + SERIAL_HEADER + 3 * i;
+    int item = e[0] | (e[1] << 8);
+
+    if ((error = restored.checkResponse(item, e[2]))) {
+      return error;
+    }
+    restored.append(item, e[2]);
+  }
+
+  restored.estimated_ = (p[6] & 1) != 0;
+  restored.current_ = (p[6] & 2) != 0;
+  restored.theta_ = get_f64(p + 32);
+  restored.info_ = get_f64(p + 40);
+  restored.sem_ = get_f64(p + 48);
+
+  *this = restored;
+  return nullptr;
+}
+
+/**MDJAVADOC_SKIP
+ * Restore the state of a serialized session of the same bank
+ *
+ * @param blob        Output of serialize()
+ */
+void CatSession::deserialize(const std::vector<uint8_t>& blob)
+{
+  const char *error = tryDeserialize(blob);
+
+  if (error) {
+    throw error;
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef CATIRT_CATSESSION_H
+#define CATIRT_CATSESSION_H
+
+#include <cstdint>
+#include <vector>
+#include "catirt.h"
+#include "itembank.h"
+
+/*
+ * One examinee's CAT against a resident ItemBank: the administered items, their responses and
+ * parameters, the exclusion mask for selection, and the last estimate are kept between steps.
+ *
+ * addResponse() appends one item (no re-filtering or re-gathering of the history), estimate()
+ * re-solves the WLE only after new responses, starting the Newton search from the last
+ * estimate, and nextItem() selects from the items not administered yet. Each Newton step of
+ * estimate() evaluates all administered items: the information sums depend on theta, so they
+ * cannot be carried from one estimate to the next, and the warm start keeps this to a few
+ * passes over the n items.
+ *
+ * serialize() packs the state into a small little-endian blob (SERIAL_MAGIC, 64 byte header
+ * plus 3 bytes per administered item), so a session can be resumed with deserialize() against
+ * the same bank (checked by ItemBank::fingerprint()) without replaying its history.
+ *
+ * Once the storage has grown to the test length, a step (addResponse, estimate, nextItem) makes
+ * no heap allocations: estimate() and nextItem() return references to results owned by the session.
+ *
+ * The bank is not owned and must outlive the session.
+ */
+class CatSession
+{
+public:
+    CatSession(ItemBank& bank, const Eigen::Ref<const RowVector2d>& range = RowVector2d(-4.5, 4.5));
+
+    const ItemBank& bank() const { return *bank_; }
+    int size() const { return n_; }
+    const std::vector<int>& items() const { return items_; }
+    ArrayXd responses() const { return resp_.row(0).head(n_).transpose(); }
+    double theta() const { return theta_; }
+    double info() const { return info_; }
+    double sem() const { return sem_; }
+
+    /*
+     * CAT steps
+     */
+    const char *checkResponse(int item, double value) const;
+    void addResponse(int item, double value);
+    const Est_Result& estimate();
+    const Choose_Result& nextItem(int n_select = 1, int numb = 1);
+
+    /*
+     * Compact state
+     */
+    std::vector<uint8_t> serialize() const;
+    const char *tryDeserialize(const std::vector<uint8_t>& blob);
+    void deserialize(const std::vector<uint8_t>& blob);
+
+    static constexpr uint32_t SERIAL_MAGIC = 0x53544143;  // "CATS"
+    static constexpr uint8_t SERIAL_VERSION = 2;
+    static constexpr int SERIAL_HEADER = 64;
+
+private:
+    void append(int item, double value);
+
+    ItemBank *bank_;
+    RowVector2d range_;
+    int n_ = 0;                     // number of administered items
+    std::vector<int> items_;        // bank indices of the administered items
+    std::vector<uint8_t> mask_;     // administered items of the bank (selection exclusion mask)
+    ArrayXXd resp_;                 // responses (1 x capacity), first n_ used
+    ArrayXXd params_;               // parameters of the administered items (capacity x K), first n_ rows used
+    bool current_ = true;           // estimate is up to date with the responses
+    bool estimated_ = false;        // theta_ holds an estimate (warm start of the next one)
+    double theta_ = 0;              // last ability estimate
+    double info_ = NAN;             // observed test information at theta_
+    double sem_ = NAN;              // standard error of theta_
+    Est_Result est_;                // result of estimate() (size 1)
+    Choose_Result choice_;          // result of nextItem()
+};
+
+#endif // CATIRT_CATSESSION_H
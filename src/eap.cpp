@@ -0,0 +1,175 @@
+#include <vector>
+#include <Eigen/Eigenvalues>
+#include "catirt.h"
+#include "catirt_parallel.h"
+#include "catirt_stats.h"
+#include "quadtable.h"
+#include "workspace.h"
+
+/**MDJAVADOC_SKIP
+ * Quadrature of a normal prior or of a normal density on equally spaced nodes
+ *
+ * QuadType::GAUSS_HERMITE: the n Gauss-Hermite nodes and weights of the normal(mean, sd) prior
+ * (Golub-Welsch: eigenvalues of the probabilists' Hermite Jacobi matrix); exact for polynomial
+ * integrands of degree up to 2n - 1, and range is not used.
+ * QuadType::EQUAL: n equally spaced nodes from range(0) to range(1), weighted by the
+ * normal(mean, sd) density (as the quad points of catIrt's eapEst).
+ *
+ * @param type        QuadType::GAUSS_HERMITE or QuadType::EQUAL
+ * @param n           Number of nodes (1 to 200 for GAUSS_HERMITE, at least 2 for EQUAL)
+ * @param mean        Prior mean
+ * @param sd          Prior standard deviation
+ * @param range       Interval of the EQUAL nodes
+ *
+ * @return Quadrature with nodes and weights summing to 1
+ */
+Quadrature quadrature( QuadType type, int n, double mean, double sd, const Eigen::Ref<const RowVector2d>& range )
+{
+  Quadrature quad;
+
+  if (!(std::isfinite(mean) && std::isfinite(sd) && sd > 0)) {
+    throw "quadrature prior mean and sd must be finite with sd > 0";
+  }
+
+  if (type == QuadType::GAUSS_HERMITE) {
+    if (n < 1 || n > 200) {
+      throw "quadrature number of Gauss-Hermite nodes must be 1 to 200";
+    }
+    Eigen::MatrixXd jacobi = Eigen::MatrixXd::Zero(n, n);
+    for (int k = 1; k < n; k++) {
+      jacobi(k, k - 1) = jacobi(k - 1, k) = sqrt((double)k);
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(jacobi);
+
+    quad.nodes = mean + sd * eig.eigenvalues().array();
+    quad.weights = eig.eigenvectors().row(0).transpose().array().square();
+  } else {
+    if (n < 2 || !(range(0) < range(1))) {
+      throw "quadrature equally spaced nodes need n >= 2 and range(0) < range(1)";
+    }
+    quad.nodes = ArrayXd::LinSpaced(n, range(0), range(1));
+    quad.weights = (-0.5 * ((quad.nodes - mean) / sd).square()).exp();
+  }
+
+  quad.weights /= quad.weights.sum();
+  return quad;
+}
+
+/**MDJAVADOC_SKIP
+ * Quadrature of a user-supplied prior
+ *
+ * @param nodes       Ability points (Q)
+ * @param prior       Prior density or weights at the nodes (Q), non-negative with a positive sum
+ *
+ * @return Quadrature with the nodes and the normalized weights
+ */
+Quadrature quadrature( const Eigen::Ref<const ArrayXd>& nodes, const Eigen::Ref<const ArrayXd>& prior )
+{
+  Quadrature quad;
+
+  if (nodes.size() == 0 || nodes.size() != prior.size()) {
+    throw "quadrature nodes and prior must be non-empty and of the same length";
+  }
+  if (!nodes.isFinite().all() || !prior.isFinite().all() || (prior < 0).any() || !(prior.sum() > 0)) {
+    throw "quadrature nodes must be finite and prior weights finite, non-negative, with a positive sum";
+  }
+
+  quad.nodes = nodes;
+  quad.weights = prior / prior.sum();
+  return quad;
+}
+
+/**MDJAVADOC_SKIP
+ * Expected a posteriori (EAP) ability estimates from one or more sets of item responses
+ *
+ * The log-probabilities of the item categories are tabulated once at the Q quadrature nodes;
+ * each person's log-likelihood at every node is then the sum of the table columns of their
+ * responses (one vectorized reduction over items, no iteration), and the posterior mean and
+ * standard deviation follow from the likelihood times the prior weights. The cost per person is
+ * fixed: M x Q additions plus Q exponentials.
+ *
+ * @param resp        Item responses (N people x M items): 0/1 (BRM) or 1 to K (GRM), NaN if not administered
+ * @param params      Parameters for M items (M x 3 for BRM, M x K for GRM)
+ * @param type        ModelType::BRM or ModelType::GRM
+ * @param quad        Prior quadrature (see quadrature())
+ *
+ * @return Est_Result with theta (posterior mean), sem (posterior sd), and info (posterior precision 1 / sd^2), each Nx1;
+ *         people without responses get the prior mean and sd, and people who answered an item with
+ *         disordered GRM boundaries NaN
+ */
+const Est_Result eapEst( const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, ModelType type, const Quadrature& quad )
+{
+  CATIRT_STAT_TIMER(Stat::WLE_CALLS);
+  const int N = resp.rows();
+  const int M = params.rows();
+  const int Q = quad.nodes.size();
+  const int K = (type == ModelType::BRM ? 2 : params.cols());
+  const int first = (type == ModelType::BRM ? 0 : 1);   // response of category 0
+  Est_Result result;
+
+  //
+  // Check arguments
+  //
+  if (!params.isFinite().all()) {
+    throw "eapEst infinite or non-numeric item parameters provided";
+  }
+  if (resp.cols() != M) {
+    throw "eapEst dimension mismatch between responses and parameters";
+  }
+  if ((type == ModelType::BRM && params.cols() != 3) || (type == ModelType::GRM && params.cols() < 2)) {
+    throw "eapEst params must have 3 columns (BRM) or at least 2 (GRM)";
+  }
+  if (Q == 0 || quad.weights.size() != Q || !quad.nodes.isFinite().all() || !quad.weights.isFinite().all()) {
+    throw "eapEst quadrature nodes and weights must be finite and of the same length";
+  }
+
+  // only the categories given by someone are tabulated (e.g. the items of one CAT out of a large bank)
+  std::vector<uint8_t> used(K * M, 0);
+  for (int j = 0; j < M; j++) {
+    for (int i = 0; i < N; i++) {
+      double u = resp(i, j);
+      if (std::isnan(u)) {
+        continue;
+      }
+      if (!(u >= first && u < first + K && u == floor(u))) {
+        throw "eapEst responses must be 0 or 1 (BRM) or categories 1 to K (GRM)";
+      }
+      used[((int)u - first) * M + j] = 1;
+    }
+  }
+
+  const ArrayXXd table = loglik_table(params, type, quad.nodes, used);
+
+  result.theta.resize(N);
+  result.info.resize(N);
+  result.sem.resize(N);
+
+  // each person is a reduction over the shared table: split people across threads
+  parallel_for(N, row_grain(M), [&](int begin, int end) {
+    Workspace& ws = Workspace::local();
+    auto ll = ws.vector(Scratch::LOGLIK, Q);       // log-likelihood at the nodes
+    auto post = ws.vector(Scratch::POSTERIOR, Q);  // unnormalized posterior at the nodes
+
+    for (int i = begin; i < end; i++) {
+      ll.setZero();
+      for (int j = 0; j < M; j++) {
+        double u = resp(i, j);
+        if (std::isnan(u)) {
+          continue;
+        }
+        ll += table.col(((int)u - first) * M + j);
+      }
+
+      post = (ll - ll.maxCoeff()).exp() * quad.weights;
+      double total = post.sum();
+      double mean = (post * quad.nodes).sum() / total;
+      double var = (post * (quad.nodes - mean).square()).sum() / total;
+
+      result.theta(i) = mean;
+      result.sem(i) = sqrt(var);
+      result.info(i) = 1 / var;
+    }
+  });
+
+  return result;
+}
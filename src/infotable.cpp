@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cstring>
+#include "infotable.h"
+
+/**MDJAVADOC_SKIP
+ * Tabulate the expected information of M items
+ *
+ * @param params      Parameters for M items (M x 3 matrix for BRM, M x K matrix for GRM)
+ * @param model       ModelType::BRM or ModelType::GRM
+ * @param interp      InterpType::LINEAR or InterpType::CUBIC
+ * @param tol         Absolute interpolation error bound (checked at 3 points of every interval)
+ * @param lower       Lowest ability of the grid
+ * @param upper       Highest ability of the grid
+ * @param step        Initial grid step, halved up to MAX_REFINE times to meet tol
+ * @param precision   Precision::FLOAT64, or Precision::FLOAT32 to store the nodes as float
+ */
+InfoTable::InfoTable(const Eigen::Ref<const ArrayXXd>& params, ModelType model, InterpType interp, double tol,
+                     double lower, double upper, double step, Precision precision)
+  : params_(params), model_(model), interp_(interp), precision_(precision), lower_(lower), upper_(upper)
+{
+  if (!(lower < upper) || !(step > 0) || !(tol > 0)) {
+    throw "InfoTable unsupported grid or error bound provided";
+  }
+
+  for (int r = 0; r <= MAX_REFINE; r++) {
+    build(step);
+
+    if (max_error_ <= tol) {
+      break;
+    }
+    step /= 2;
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Restore a table from its stored nodes (see ItemBank::deserialize), without evaluating any item
+ *
+ * @param params      Parameters for M items (M x 3 matrix for BRM, M x K matrix for GRM)
+ * @param model       ModelType::BRM or ModelType::GRM
+ * @param interp      InterpType::LINEAR or InterpType::CUBIC
+ * @param precision   Precision of the stored nodes
+ * @param lower       Lowest ability of the grid
+ * @param upper       Highest ability of the grid
+ * @param n_int       Number of grid intervals
+ * @param max_error   Measured interpolation error of the stored table
+ * @param node_bytes  (n_int + 3) x M row-major nodes, double or float by precision (need not be aligned)
+ */
+InfoTable::InfoTable(const Eigen::Ref<const ArrayXXd>& params, ModelType model, InterpType interp, Precision precision,
+                     double lower, double upper, int n_int, double max_error, const uint8_t *node_bytes)
+  : params_(params), model_(model), interp_(interp), precision_(precision), lower_(lower), upper_(upper),
+    n_int_(n_int), max_error_(max_error)
+{
+  const int M = params.rows();
+
+  if (!(lower < upper) || n_int < 1) {
+    throw "InfoTable unsupported grid provided";
+  }
+  step_ = (upper_ - lower_) / n_int_;
+
+  if (precision_ == Precision::FLOAT32) {
+    nodes_f_.resize(n_int_ + 3, M);
+    memcpy(nodes_f_.data(), node_bytes, nodes_f_.size() * sizeof(float));
+  } else {
+    nodes_.resize(n_int_ + 3, M);
+    memcpy(nodes_.data(), node_bytes, nodes_.size() * sizeof(double));
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Stored nodes as bytes (bytes() of them)
+ */
+const uint8_t *InfoTable::node_bytes() const
+{
+  if (precision_ == Precision::FLOAT32) {
+    return reinterpret_cast<const uint8_t *>(nodes_f_.data());
+  }
+  return reinterpret_cast<const uint8_t *>(nodes_.data());
+}
+
+/**MDJAVADOC_SKIP
+ * Exact expected information of every item for each theta (size N) - row-major (N x M)
+ */
+ArrayXd InfoTable::exact(const Eigen::Ref<const ArrayXd>& theta) const
+{
+  ArrayXXd none(0, 0);
+  ArrayXXd item;
+
+  if (model_ == ModelType::BRM) {
+    item = FI_brm(params_, theta, FIType::EXPECTED, none).item;
+  } else {
+    item = FI_grm(params_, theta, FIType::EXPECTED, none).item;
+  }
+
+  // flatten row-major so each theta is contiguous
+  TableXXd rows = item;
+  return Eigen::Map<const ArrayXd>(rows.data(), rows.size());
+}
+
+/**MDJAVADOC_SKIP
+ * Fill the nodes for the given step and measure the interpolation error at 3 points of every interval
+ */
+void InfoTable::build(double step)
+{
+  const int M = params_.rows();
+
+  n_int_ = std::max(1, (int)std::ceil((upper_ - lower_) / step - 1e-9));
+  step_ = (upper_ - lower_) / n_int_;
+
+  // node k is at lower + (k - 1) * step, k = 0 .. n_int + 2
+  ArrayXd theta = ArrayXd::LinSpaced(n_int_ + 3, lower_ - step_, upper_ + step_);
+  theta(1) = lower_;
+  theta(n_int_ + 1) = upper_;
+  nodes_ = Eigen::Map<const TableXXd>(exact(theta).data(), n_int_ + 3, M);
+
+  // float nodes: the rounding is part of the measured error below
+  if (precision_ == Precision::FLOAT32) {
+    nodes_f_ = nodes_.cast<float>();
+    nodes_.resize(0, 0);
+  }
+
+  // check points within every interval (the cubic error peaks away from the midpoint)
+  const double at[] = {0.25, 0.5, 0.75};
+  const int n_at = 3;
+  ArrayXd check(n_int_ * n_at);
+  for (int i = 0; i < n_int_; i++) {
+    for (int k = 0; k < n_at; k++) {
+      check(i * n_at + k) = lower_ + (i + at[k]) * step_;
+    }
+  }
+  ArrayXd truth = exact(check);
+  ArrayXd approx(M);
+
+  max_error_ = 0;
+  for (int i = 0; i < check.size(); i++) {
+    lookup(check(i), approx.data());
+    max_error_ = std::max(max_error_, (approx - truth.segment((Eigen::Index)i * M, M)).abs().maxCoeff());
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Weighted sum of 4 consecutive node rows (M items each), accumulated in double
+ */
+template <typename S>
+static void interpolate(const S *n0, int M, const double w[4], double *out)
+{
+  const S *n1 = n0 + M;
+  const S *n2 = n1 + M;
+  const S *n3 = n2 + M;
+
+  for (int j = 0; j < M; j++) {
+    out[j] = w[0] * n0[j] + w[1] * n1[j] + w[2] * n2[j] + w[3] * n3[j];
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Interpolate the information of all items at theta (within the grid range)
+ */
+void InfoTable::lookup(double theta, double *out) const
+{
+  const int M = size();
+  double x = (theta - lower_) / step_;
+  int i = std::min(std::max((int)std::floor(x), 0), n_int_ - 1);  // interval index
+  double t = x - i;                                                // position within interval
+  double w[4];                                                     // weights of nodes i .. i + 3
+
+  if (interp_ == InterpType::LINEAR) {
+    w[0] = 0;
+    w[1] = 1 - t;
+    w[2] = t;
+    w[3] = 0;
+  } else {
+    // Catmull-Rom spline through nodes i .. i + 3 (node i + 1 is the start of the interval)
+    w[0] = 0.5 * t * (-1 + t * (2 - t));
+    w[1] = 0.5 * (2 + t * t * (-5 + 3 * t));
+    w[2] = 0.5 * t * (1 + t * (4 - 3 * t));
+    w[3] = 0.5 * t * t * (t - 1);
+  }
+
+  if (precision_ == Precision::FLOAT32) {
+    interpolate(&nodes_f_(i, 0), M, w, out);
+  } else {
+    interpolate(&nodes_(i, 0), M, w, out);
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Expected information of the tabulated items at one ability estimate
+ *
+ * @param theta       Ability estimate (evaluated exactly outside the grid range)
+ * @param exclude     Exclusion mask (size M, non-zero to skip an item), or empty
+ * @param scale       Per-item information multipliers (size M), or empty
+ *
+ * @return item information (size M), NaN for excluded items
+ */
+ArrayXd InfoTable::info(double theta, const std::vector<uint8_t>& exclude, const Eigen::Ref<const ArrayXd>& scale) const
+{
+  ArrayXd result(size());
+
+  info(theta, exclude, scale, result);
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Expected information of the tabulated items into a caller buffer (no allocations within the grid range)
+ *
+ * @param theta       Ability estimate (evaluated exactly outside the grid range)
+ * @param exclude     Exclusion mask (size M, non-zero to skip an item), or empty
+ * @param scale       Per-item information multipliers (size M), or empty
+ * @param out         Output: item information (size M), NaN for excluded items
+ */
+void InfoTable::info(double theta, const std::vector<uint8_t>& exclude, const Eigen::Ref<const ArrayXd>& scale, Eigen::Ref<ArrayXd> out) const
+{
+  const int M = size();
+
+  if (!exclude.empty() && (int)exclude.size() != M) {
+    throw "InfoTable exclusion mask length must match number of items";
+  }
+  if (scale.size() != 0 && scale.size() != M) {
+    throw "InfoTable scale length must match number of items";
+  }
+  if (out.size() != M) {
+    throw "InfoTable output length must match number of items";
+  }
+
+  if (theta >= lower_ && theta <= upper_) {
+    lookup(theta, out.data());
+  } else {
+    out = exact(ArrayXd::Constant(1, theta));
+  }
+
+  if (scale.size() != 0) {
+    out *= scale;
+  }
+
+  for (size_t j = 0; j < exclude.size(); j++) {
+    if (exclude[j]) {
+      out(j) = NAN;
+    }
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef CATIRT_INFOTABLE_H
+#define CATIRT_INFOTABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "catirt.h"
+
+enum class InterpType {
+    LINEAR,
+    CUBIC
+};
+
+/*
+ * Expected item information of a bank tabulated on a uniform theta grid (default -5..5 step 0.05),
+ * answered by linear or cubic (Catmull-Rom) interpolation.
+ *
+ * The grid is halved until the interpolation error at the quarter points of every interval
+ * is within the requested absolute bound (or the finest grid is reached, see max_error()).
+ * Abilities outside the grid are evaluated exactly.
+ *
+ * With Precision::FLOAT32 the nodes are stored as float, halving the table; the nodes are still
+ * computed in double, and the float rounding is included in max_error().
+ */
+class InfoTable
+{
+public:
+    InfoTable() {}
+    InfoTable(const Eigen::Ref<const ArrayXXd>& params, ModelType model, InterpType interp = InterpType::CUBIC, double tol = 1e-6,
+              double lower = -5.0, double upper = 5.0, double step = 0.05, Precision precision = Precision::FLOAT64);
+    InfoTable(const Eigen::Ref<const ArrayXXd>& params, ModelType model, InterpType interp, Precision precision,
+              double lower, double upper, int n_int, double max_error, const uint8_t *node_bytes);
+
+    int size() const { return (int)params_.rows(); }
+    InterpType interp() const { return interp_; }
+    Precision precision() const { return precision_; }
+    size_t bytes() const { return nodes_.size() * sizeof(double) + nodes_f_.size() * sizeof(float); }
+    double step() const { return step_; }
+    double max_error() const { return max_error_; }
+
+    // stored nodes ((intervals() + 3) x M row-major, double or float by precision()), see ItemBank::serialize()
+    int intervals() const { return n_int_; }
+    double lower() const { return lower_; }
+    double upper() const { return upper_; }
+    const uint8_t *node_bytes() const;
+
+    // item information at theta (size M), NaN for excluded items; scale (size M, or empty) multiplies each item
+    ArrayXd info(double theta, const std::vector<uint8_t>& exclude, const Eigen::Ref<const ArrayXd>& scale) const;
+    void info(double theta, const std::vector<uint8_t>& exclude, const Eigen::Ref<const ArrayXd>& scale, Eigen::Ref<ArrayXd> out) const;
+
+    // maximum number of grid halvings to meet the error bound
+    static const int MAX_REFINE = 6;
+
+private:
+    using TableXXd = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using TableXXf = Eigen::Array<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    void build(double step);
+    ArrayXd exact(const Eigen::Ref<const ArrayXd>& theta_row) const;
+    void lookup(double theta, double *out) const;
+
+    ArrayXXd params_;              // item parameters (M x K), for exact evaluation outside the grid
+    ModelType model_ = ModelType::BRM;
+    InterpType interp_ = InterpType::CUBIC;
+    Precision precision_ = Precision::FLOAT64;
+    double lower_ = 0, upper_ = 0; // grid range
+    double step_ = 0;              // grid step
+    int n_int_ = 0;                // number of grid intervals
+    double max_error_ = 0;         // max abs interpolation error at the check points
+    TableXXd nodes_;               // information at the nodes (n_int + 3 x M), one padding node at each end
+    TableXXf nodes_f_;             // nodes_ as float for Precision::FLOAT32 (nodes_ is then empty)
+};
+
+#endif // CATIRT_INFOTABLE_H
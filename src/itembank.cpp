@@ -0,0 +1,717 @@
+#include <algorithm>
+#include "itembank.h"
+#include "catirt_kernels.h"
+#include "catirt_stats.h"
+#include "workspace.h"
+
+/**MDJAVADOC_SKIP
+ * Create a resident item bank
+ *
+ * @param params      Parameters for M items (M x 3 matrix for BRM, M x K matrix for GRM)
+ * @param model       ModelType::BRM or ModelType::GRM
+ * @param ids         Item ids (size M), or empty
+ */
+ItemBank::ItemBank(const Eigen::Ref<const ArrayXXd>& params, ModelType model, const std::vector<std::string>& ids)
+  : params_(params), model_(model), ids_(ids)
+{
+  if (params_.rows() == 0) {
+    throw "ItemBank params must be non-empty";
+  }
+  if (!params_.isFinite().all()) {
+    throw "ItemBank infinite or non-numeric item parameters provided";
+  }
+  if (model_ == ModelType::BRM && params_.cols() != 3) {
+    throw "ItemBank params must have 3 columns for the BRM model";
+  }
+  if (model_ == ModelType::GRM && params_.cols() < 2) {
+    throw "ItemBank params must have at least 2 columns for the GRM model";
+  }
+  if (!ids_.empty() && (int)ids_.size() != size()) {
+    throw "ItemBank number of ids must match number of items";
+  }
+
+  n_cat_ = (model_ == ModelType::BRM) ? 2 : (int)params_.cols();
+
+  // FNV-1a over the model, the dimensions, and the bytes of the parameter block
+  const uint64_t dims[3] = {(uint64_t)model_, (uint64_t)params_.rows(), (uint64_t)params_.cols()};
+  const uint8_t *blocks[2] = {reinterpret_cast<const uint8_t *>(dims), reinterpret_cast<const uint8_t *>(params_.data())};
+  const size_t lengths[2] = {sizeof(dims), params_.size() * sizeof(double)};
+
+  fingerprint_ = 0xcbf29ce484222325ULL;
+  for (int b = 0; b < 2; b++) {
+    for (size_t k = 0; k < lengths[b]; k++) {
+      fingerprint_ = (fingerprint_ ^ blocks[b][k]) * 0x100000001b3ULL;
+    }
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Id of one item
+ *
+ * @param j           Item index
+ *
+ * @return item id, or an empty string if the bank has no ids
+ */
+const std::string& ItemBank::id(int j) const
+{
+  static const std::string none;
+
+  if (j < 0 || j >= size()) {
+    throw "ItemBank item index out of range";
+  }
+  return ids_.empty() ? none : ids_[j];
+}
+
+/**MDJAVADOC_SKIP
+ * Indices of the administered items of a full-length response vector
+ *
+ * @param resp        Responses to all M items of the bank, NaN (non-finite) if not administered
+ *
+ * @return indices of items with a finite response
+ */
+std::vector<int> ItemBank::administered(const Eigen::Ref<const ArrayXd>& resp) const
+{
+  std::vector<int> items;
+
+  if (resp.size() != size()) {
+    throw "ItemBank response length must match number of items";
+  }
+
+  for (int j = 0; j < size(); j++) {
+    if (std::isfinite(resp(j))) {
+      items.push_back(j);
+    }
+  }
+
+  return items;
+}
+
+/**MDJAVADOC_SKIP
+ * Parameters of a subset of items
+ *
+ * @param items       Item indices
+ *
+ * @return parameters of the given items, in order (size(items) x K)
+ */
+ArrayXXd ItemBank::gather(const std::vector<int>& items) const
+{
+  ArrayXXd sub(items.size(), params_.cols());
+
+  for (size_t i = 0; i < items.size(); i++) {
+    if (items[i] < 0 || items[i] >= size()) {
+      throw "ItemBank item index out of range";
+    }
+    sub.row(i) = params_.row(items[i]);
+  }
+
+  return sub;
+}
+
+/**MDJAVADOC_SKIP
+ * Estimate ability of one person from a full-length response vector
+ *
+ * @param resp        Responses to all M items of the bank, NaN (non-finite) if not administered
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimate for SolverType::NEWTON (NaN for the Brent search)
+ *
+ * @return Est_Result of size 1; theta 0 and NaN info/sem if no item was administered
+ */
+Est_Result ItemBank::wleEst(const Eigen::Ref<const ArrayXd>& resp, const Eigen::Ref<const RowVector2d>& range, SolverType solver, double start) const
+{
+  Workspace& ws = Workspace::local();
+  auto sub_resp = ws.matrix(Scratch::RESP, 1, size());
+  auto sub_params = ws.matrix(Scratch::PARAMS, size(), params_.cols());
+  int n = 0;
+
+  if (resp.size() != size()) {
+    throw "ItemBank response length must match number of items";
+  }
+
+  for (int j = 0; j < size(); j++) {
+    if (std::isfinite(resp(j))) {
+      sub_resp(0, n) = resp(j);
+      sub_params.row(n) = params_.row(j);
+      n++;
+    }
+  }
+
+  return solve(sub_resp.leftCols(n), sub_params.topRows(n), range, solver, start);
+}
+
+/**MDJAVADOC_SKIP
+ * Estimate ability of one person from the answers to a subset of items
+ *
+ * @param items       Indices of the administered items
+ * @param answers     Responses to the administered items (same order as items)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimate for SolverType::NEWTON (NaN for the Brent search)
+ *
+ * @return Est_Result of size 1; theta 0 and NaN info/sem if no item was administered
+ */
+Est_Result ItemBank::wleEst(const std::vector<int>& items, const Eigen::Ref<const ArrayXd>& answers, const Eigen::Ref<const RowVector2d>& range,
+                            SolverType solver, double start) const
+{
+  Workspace& ws = Workspace::local();
+  auto sub_resp = ws.matrix(Scratch::RESP, 1, items.size());
+  auto sub_params = ws.matrix(Scratch::PARAMS, items.size(), params_.cols());
+
+  if ((int)items.size() != answers.size()) {
+    throw "ItemBank number of answers must match number of items";
+  }
+
+  for (size_t i = 0; i < items.size(); i++) {
+    if (items[i] < 0 || items[i] >= size()) {
+      throw "ItemBank item index out of range";
+    }
+    sub_resp(0, i) = answers(i);
+    sub_params.row(i) = params_.row(items[i]);
+  }
+
+  return solve(sub_resp, sub_params, range, solver, start);
+}
+
+/**MDJAVADOC_SKIP
+ * Weighted likelihood estimate of one person from the administered responses and their parameters
+ *
+ * Same estimate as wleEst() of a single row, without its validation or temporaries: the
+ * parameters come from the (validated) bank and the responses from its callers.
+ *
+ * @param resp        Administered responses (1 x n)
+ * @param params      Parameters of the administered items (n x K)
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimate for SolverType::NEWTON (NaN for the Brent search)
+ *
+ * @return Est_Result of size 1; theta 0 and NaN info/sem if no item was administered
+ */
+Est_Result ItemBank::solve(const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range,
+                           SolverType solver, double start) const
+{
+  CATIRT_STAT_TIMER(Stat::WLE_CALLS);
+  Est_Result result;
+  WLE_Root root;
+
+  if (resp.cols() == 0) {
+    result.theta = ArrayXd::Zero(1);
+    result.info = ArrayXd::Constant(1, NAN);
+    result.sem = ArrayXd::Constant(1, NAN);
+    return result;
+  }
+  if (!resp.isFinite().all()) {
+    throw "wleEst infinite or non-numeric responses provided";
+  }
+  if (!(range(0) < 0 && range(1) > 0)) {
+    throw "wleEst unsupported range provided";
+  }
+
+  root = wle_root(resp, params, range, model_, solver, start);
+  result.theta = ArrayXd::Constant(1, root.root);
+  result.info = ArrayXd::Constant(1, root.info);
+  result.sem = ArrayXd::Constant(1, sqrt((root.info + root.corr * root.corr) / (root.info * root.info)));
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Estimate ability of many people who each answered a different subset of the bank items
+ *
+ * @param resp        Responses to all M items (N people x M items), non-finite if not administered
+ * @param range       Range of abilities to explore (2 x 1)
+ * @param mask        Administered items (N x M row-major, zero to skip an item of a row), or empty
+ * @param solver      SolverType::BRENT or SolverType::NEWTON
+ * @param start       Starting ability estimates (N x 1, NaN for the Brent search) for SolverType::NEWTON, or size 0
+ *
+ * @return Est_Result of size N; theta 0 and NaN info/sem for rows without responses
+ */
+Est_Result ItemBank::wleEst_ragged(const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const RowVector2d>& range, const std::vector<uint8_t>& mask,
+                                   SolverType solver, const Eigen::Ref<const ArrayXd>& start) const
+{
+  if (resp.cols() != size()) {
+    throw "ItemBank response length must match number of items";
+  }
+
+  return ::wleEst_ragged(resp, params_, range, model_, mask, solver, start);
+}
+
+/**MDJAVADOC_SKIP
+ * Check that an exclusion mask is empty or has one entry per item
+ */
+void ItemBank::check_mask(const std::vector<uint8_t>& exclude, const char *msg) const
+{
+  if (!exclude.empty() && (int)exclude.size() != size()) {
+    throw msg;
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Expected Fisher Information of the bank items for one ability estimate
+ *
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (size M, non-zero to skip an item), or empty
+ *
+ * @return item information (size M), NaN for excluded items
+ */
+ArrayXd ItemBank::FI_expected(double theta, const std::vector<uint8_t>& exclude) const
+{
+  CATIRT_STAT_TIMER(Stat::FI_CALLS);
+  ArrayXd info(size());
+
+  expected_info(theta, exclude, info);
+  return info;
+}
+
+/**MDJAVADOC_SKIP
+ * Expected information of every item at one ability with lanes of scalar type S (double or float)
+ *
+ * Same item kernels as FI_brm/FI_grm EXPECTED; params holds double or float parameters to match S.
+ */
+template <typename S, typename Params>
+static void item_info(double theta, ModelType model, const Params& params, Eigen::Ref<ArrayXd> info)
+{
+  Eigen::Map<ArrayXXd> row(info.data(), 1, info.size());
+
+  if (model == ModelType::BRM) {
+    simd_for<S>(info.size(), [&](int j, auto lane) {
+      using T = decltype(lane);
+      cat_store_row(row, 0, j, brm_item<T>(theta, params, j).info);
+    });
+  } else {
+    grm_dispatch(params.cols(), [&](auto k_const) {
+      simd_for<S>(info.size(), [&](int j, auto lane) {
+        using T = decltype(lane);
+        T item_info, h;     // for the information sums of the lane
+        GRM_Terms<T> sel;   // unused terms of the responded category
+
+        grm_item_sums<decltype(k_const)::value>(cat_broadcast<T>(theta), params, j, -1, sel, item_info, h);
+        cat_store_row(row, 0, j, item_info);
+      });
+    });
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Modified expected information of every BRM item with lanes of scalar type S (see item_info)
+ *
+ * Same item kernels as FI_brm_modified_expected.
+ */
+template <typename S, typename Params>
+static void modified_item_info(double theta, const Params& params, double phase1_theta, const Params& phase1_params, Eigen::Ref<ArrayXd> info)
+{
+  Eigen::Map<ArrayXXd> row(info.data(), 1, info.size());
+
+  simd_for<S>(info.size(), [&](int j, auto lane) {
+    using T = decltype(lane);
+    T p1_q = brm_item<T>(phase1_theta, phase1_params, j).q;
+
+    cat_store_row(row, 0, j, p1_q * brm_item<T>(theta, params, j).info);
+  });
+}
+
+/**MDJAVADOC_SKIP
+ * Expected Fisher Information of the bank items into a caller buffer (see FI_expected)
+ *
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (size M, non-zero to skip an item), or empty
+ * @param info        Output: item information (size M), NaN for excluded items
+ */
+void ItemBank::expected_info(double theta, const std::vector<uint8_t>& exclude, Eigen::Ref<ArrayXd> info) const
+{
+  check_mask(exclude, "ItemBank FI_expected exclusion mask length must match number of items");
+
+  if (table_) {
+    table_->info(theta, exclude, ArrayXd(), info);
+    return;
+  }
+
+  if (precision_ == Precision::FLOAT32) {
+    item_info<float>(theta, model_, params_f_, info);
+  } else {
+    item_info<double>(theta, model_, params_, info);
+  }
+
+  for (size_t j = 0; j < exclude.size(); j++) {
+    if (exclude[j]) {
+      info(j) = NAN;
+    }
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Expected Fisher Information (modified unweighted) of the bank items for given phase 1 and phase 2 ability estimates
+ *
+ * @param theta           Phase 2 ability estimate
+ * @param phase1          Phase 1 item bank (same items, BRM)
+ * @param phase1_theta    Phase 1 ability estimate
+ * @param exclude         Exclusion mask (size M, non-zero to skip an item), or empty
+ *
+ * @return item information (size M), NaN for excluded items
+ */
+ArrayXd ItemBank::FI_modified_expected(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude) const
+{
+  CATIRT_STAT_TIMER(Stat::FI_CALLS);
+  ArrayXd info(size());
+
+  modified_info(theta, phase1, phase1_theta, exclude, info);
+  return info;
+}
+
+/**MDJAVADOC_SKIP
+ * Modified expected Fisher Information of the bank items into a caller buffer (see FI_modified_expected)
+ *
+ * @param theta           Phase 2 ability estimate
+ * @param phase1          Phase 1 item bank (same items, BRM)
+ * @param phase1_theta    Phase 1 ability estimate
+ * @param exclude         Exclusion mask (size M, non-zero to skip an item), or empty
+ * @param info            Output: item information (size M), NaN for excluded items
+ */
+void ItemBank::modified_info(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, Eigen::Ref<ArrayXd> info) const
+{
+  check_mask(exclude, "ItemBank FI_modified_expected exclusion mask length must match number of items");
+
+  if (model_ != ModelType::BRM || phase1.model_ != ModelType::BRM) {
+    throw "ItemBank FI_modified_expected is only supported with the BRM model";
+  }
+  if (phase1.size() != size()) {
+    throw "ItemBank FI_modified_expected phase1 and phase2 banks size mismatch";
+  }
+
+  // the phase 1 factor is fixed by setPhase1(): scale the expected information table
+  if (table_ && phase1_scale_.size() != 0 && phase1_theta == phase1_theta_ && (phase1.params_ == phase1_params_).all()) {
+    table_->info(theta, exclude, phase1_scale_, info);
+    return;
+  }
+
+  // float lanes need the float parameters of both banks
+  if (precision_ == Precision::FLOAT32 && phase1.precision_ == Precision::FLOAT32) {
+    modified_item_info<float>(theta, params_f_, phase1_theta, phase1.params_f_, info);
+  } else {
+    modified_item_info<double>(theta, params_, phase1_theta, phase1.params_, info);
+  }
+
+  for (size_t j = 0; j < exclude.size(); j++) {
+    if (exclude[j]) {
+      info(j) = NAN;
+    }
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Tabulate the expected information of the bank items, see InfoTable
+ *
+ * @param interp      InterpType::LINEAR or InterpType::CUBIC
+ * @param tol         Absolute interpolation error bound
+ */
+void ItemBank::buildInfoTable(InterpType interp, double tol)
+{
+  table_ = std::make_shared<const InfoTable>(params_, model_, interp, tol, -5.0, 5.0, 0.05, precision_);
+  table_tol_ = tol;
+}
+
+/**MDJAVADOC_SKIP
+ * Set the precision of expected information and item selection (scoring always uses double)
+ *
+ * Precision::FLOAT32 keeps a float copy of the parameters for the selection kernels (4 items
+ * per SIMD vector instead of 2) and stores the information table as float, rebuilding an
+ * existing table. Item information then has an absolute error of at most FLOAT32_INFO_ERROR
+ * (see itembank.h), so items closer than that in information may be ranked differently.
+ *
+ * @param precision   Precision::FLOAT64 or Precision::FLOAT32
+ */
+void ItemBank::setPrecision(Precision precision)
+{
+  if (precision == precision_) {
+    return;
+  }
+
+  precision_ = precision;
+  params_f_ = (precision_ == Precision::FLOAT32 ? ArrayXXf(params_.cast<float>()) : ArrayXXf());
+
+  if (table_) {
+    buildInfoTable(table_->interp(), table_tol_);
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Fix the phase 1 bank and ability estimate of the modified expected information
+ *
+ * @param phase1          Phase 1 item bank (same items, BRM)
+ * @param phase1_theta    Phase 1 ability estimate
+ */
+void ItemBank::setPhase1(const ItemBank& phase1, double phase1_theta)
+{
+  if (model_ != ModelType::BRM || phase1.model_ != ModelType::BRM) {
+    throw "ItemBank setPhase1 is only supported with the BRM model";
+  }
+  if (phase1.size() != size()) {
+    throw "ItemBank setPhase1 phase1 and phase2 banks size mismatch";
+  }
+  if (!std::isfinite(phase1_theta)) {
+    throw "ItemBank setPhase1 phase1 theta must be finite";
+  }
+
+  phase1_params_ = phase1.params_;
+  phase1_theta_ = phase1_theta;
+  phase1_scale_ = 1 - p_brm(ArrayXd::Constant(1, phase1_theta), phase1_params_).row(0).transpose();
+}
+
+/**MDJAVADOC_SKIP
+ * Tabulate the category log-probabilities and expected information of the bank items at the
+ * nodes of a quadrature, see QuadTable
+ *
+ * @param quad        Nodes and prior weights (see quadrature())
+ */
+void ItemBank::buildQuadTable(const Quadrature& quad)
+{
+  quad_table_ = std::make_shared<const QuadTable>(params_, model_, quad);
+}
+
+/**MDJAVADOC_SKIP
+ * Posterior weights at the quadrature table nodes
+ *
+ * @param resp        Responses to all M items: 0/1 (BRM) or 1 to K (GRM), NaN if not administered
+ *
+ * @return posterior weights (size Q) summing to 1
+ */
+ArrayXd ItemBank::posterior(const Eigen::Ref<const ArrayXd>& resp) const
+{
+  if (!quad_table_) {
+    throw "ItemBank posterior needs a quadrature table (buildQuadTable)";
+  }
+
+  ArrayXd weights(quad_table_->nodes());
+  quad_table_->posterior(resp, weights);
+  return weights;
+}
+
+/**MDJAVADOC_SKIP
+ * Pick numb items at random from the n_select most informative items
+ *
+ * Same selection as the JS itChoose(): the top n_select items are found with a partial
+ * selection (nth_element) rather than a full sort, and ordered by information (ties by lowest
+ * index) before the random pick so that results only depend on the generator state.
+ *
+ * @param info        Item information (size M), NaN for excluded items
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ * @param rng         Generator of the random pick
+ * @param result      Output: up to numb items in random order (its storage is reused)
+ */
+void ItemBank::choose(const Eigen::Ref<const ArrayXd>& info, int n_select, int numb, std::mt19937_64& rng, Choose_Result& result)
+{
+  if (n_select < 1 || numb < 1) {
+    throw "ItemBank itChoose n_select and numb must be positive";
+  }
+
+  std::vector<int>& candidates = Workspace::local().indices(Scratch::CANDIDATES, info.size());
+  for (int j = 0; j < info.size(); j++) {
+    if (!std::isnan(info(j))) {
+      candidates.push_back(j);
+    }
+  }
+
+  auto better = [&info](int x, int y) {
+    return (info(x) > info(y)) || (info(x) == info(y) && x < y);
+  };
+  int k = std::min<int>(n_select, candidates.size());
+
+  if (k < (int)candidates.size()) {
+    std::nth_element(candidates.begin(), candidates.begin() + k, candidates.end(), better);
+  }
+  std::sort(candidates.begin(), candidates.begin() + k, better);
+
+  // randomesque: partial Fisher-Yates shuffle of the top k
+  int n = std::min(numb, k);
+  for (int i = 0; i < n && k > 1; i++) {
+    std::uniform_int_distribution<int> pick(i, k - 1);
+    std::swap(candidates[i], candidates[pick(rng)]);
+  }
+
+  result.items.assign(candidates.begin(), candidates.begin() + n);
+  result.info.clear();
+  for (int j : result.items) {
+    result.info.push_back(info(j));
+  }
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by expected information at one ability estimate (UW-FI)
+ *
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ *
+ * @return Choose_Result with up to numb items
+ */
+Choose_Result ItemBank::itChoose(double theta, const std::vector<uint8_t>& exclude, int n_select, int numb)
+{
+  Choose_Result result;
+
+  itChoose(theta, exclude, n_select, numb, result);
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by expected information into a reused Choose_Result (no allocations once warm)
+ *
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ * @param result      Output: up to numb items
+ */
+void ItemBank::itChoose(double theta, const std::vector<uint8_t>& exclude, int n_select, int numb, Choose_Result& result)
+{
+  itChoose(theta, exclude, n_select, numb, rng_, result);
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by expected information with the caller's generator (thread-safe: the bank is not modified)
+ *
+ * @param theta       Ability estimate
+ * @param exclude     Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ * @param rng         Generator of the random pick
+ * @param result      Output: up to numb items
+ */
+void ItemBank::itChoose(double theta, const std::vector<uint8_t>& exclude, int n_select, int numb, std::mt19937_64& rng, Choose_Result& result) const
+{
+  CATIRT_STAT_TIMER(Stat::SELECT_CALLS);
+  auto info = Workspace::local().vector(Scratch::INFO, size());
+
+  expected_info(theta, exclude, info);
+  choose(info, n_select, numb, rng, result);
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by modified expected information (UW-FI-Modified)
+ *
+ * @param theta           Phase 2 ability estimate
+ * @param phase1          Phase 1 item bank (same items, BRM)
+ * @param phase1_theta    Phase 1 ability estimate
+ * @param exclude         Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select        Number of most informative items to choose from
+ * @param numb            Number of items to choose
+ *
+ * @return Choose_Result with up to numb items
+ */
+Choose_Result ItemBank::itChoose_modified(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, int n_select, int numb)
+{
+  Choose_Result result;
+
+  itChoose_modified(theta, phase1, phase1_theta, exclude, n_select, numb, result);
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by modified expected information into a reused Choose_Result (no allocations once warm)
+ *
+ * @param theta           Phase 2 ability estimate
+ * @param phase1          Phase 1 item bank (same items, BRM)
+ * @param phase1_theta    Phase 1 ability estimate
+ * @param exclude         Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select        Number of most informative items to choose from
+ * @param numb            Number of items to choose
+ * @param result          Output: up to numb items
+ */
+void ItemBank::itChoose_modified(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, int n_select, int numb,
+                                 Choose_Result& result)
+{
+  itChoose_modified(theta, phase1, phase1_theta, exclude, n_select, numb, rng_, result);
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by modified expected information with the caller's generator (thread-safe)
+ *
+ * @param theta           Phase 2 ability estimate
+ * @param phase1          Phase 1 item bank (same items, BRM)
+ * @param phase1_theta    Phase 1 ability estimate
+ * @param exclude         Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select        Number of most informative items to choose from
+ * @param numb            Number of items to choose
+ * @param rng             Generator of the random pick
+ * @param result          Output: up to numb items
+ */
+void ItemBank::itChoose_modified(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, int n_select, int numb,
+                                 std::mt19937_64& rng, Choose_Result& result) const
+{
+  CATIRT_STAT_TIMER(Stat::SELECT_CALLS);
+  auto info = Workspace::local().vector(Scratch::INFO, size());
+
+  modified_info(theta, phase1, phase1_theta, exclude, info);
+  choose(info, n_select, numb, rng, result);
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by a posterior-weighted criterion (PW-FI or PW-KL)
+ *
+ * @param select      SelectType::PW_FI or SelectType::PW_KL
+ * @param theta       Ability estimate (PW_KL only)
+ * @param resp        Responses to all M items so far, NaN if not administered
+ * @param exclude     Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ *
+ * @return Choose_Result with up to numb items, and their criterion as info
+ */
+Choose_Result ItemBank::itChoose_posterior(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& resp, const std::vector<uint8_t>& exclude,
+                                           int n_select, int numb)
+{
+  Choose_Result result;
+
+  itChoose_posterior(select, theta, resp, exclude, n_select, numb, result);
+  return result;
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by a posterior-weighted criterion into a reused Choose_Result (no allocations once warm)
+ *
+ * @param select      SelectType::PW_FI or SelectType::PW_KL
+ * @param theta       Ability estimate (PW_KL only)
+ * @param resp        Responses to all M items so far, NaN if not administered
+ * @param exclude     Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ * @param result      Output: up to numb items
+ */
+void ItemBank::itChoose_posterior(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& resp, const std::vector<uint8_t>& exclude,
+                                  int n_select, int numb, Choose_Result& result)
+{
+  itChoose_posterior(select, theta, resp, exclude, n_select, numb, rng_, result);
+}
+
+/**MDJAVADOC_SKIP
+ * Choose items by a posterior-weighted criterion with the caller's generator (thread-safe)
+ *
+ * The posterior at the table nodes is one sum of table columns over the answered items, and
+ * the criterion of every item one matrix-vector product with it (see QuadTable).
+ *
+ * @param select      SelectType::PW_FI or SelectType::PW_KL
+ * @param theta       Ability estimate (PW_KL only)
+ * @param resp        Responses to all M items so far, NaN if not administered
+ * @param exclude     Exclusion mask (size M, non-zero for administered/unavailable items), or empty
+ * @param n_select    Number of most informative items to choose from
+ * @param numb        Number of items to choose
+ * @param rng         Generator of the random pick
+ * @param result      Output: up to numb items
+ */
+void ItemBank::itChoose_posterior(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& resp, const std::vector<uint8_t>& exclude,
+                                  int n_select, int numb, std::mt19937_64& rng, Choose_Result& result) const
+{
+  CATIRT_STAT_TIMER(Stat::SELECT_CALLS);
+  Workspace& ws = Workspace::local();
+
+  if (!quad_table_) {
+    throw "ItemBank itChoose_posterior needs a quadrature table (buildQuadTable)";
+  }
+  check_mask(exclude, "ItemBank itChoose_posterior exclusion mask length must match number of items");
+
+  auto weights = ws.vector(Scratch::POSTERIOR, quad_table_->nodes());
+  auto info = ws.vector(Scratch::INFO, size());
+
+  quad_table_->posterior(resp, weights);
+  quad_table_->criterion(select, theta, weights, exclude, info);
+  choose(info, n_select, numb, rng, result);
+}
@@ -0,0 +1,160 @@
+#ifndef CATIRT_ITEMBANK_H
+#define CATIRT_ITEMBANK_H
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "catirt.h"
+#include "infotable.h"
+#include "quadtable.h"
+
+struct Choose_Result
+{
+    std::vector<int> items;     // chosen item indices
+    std::vector<double> info;   // information of the chosen items
+};
+
+/*
+ * Resident item bank: parameters and ids are validated and stored once, so scoring and
+ * selection calls only pass responses, item indices, or exclusion masks.
+ *
+ * Parameters are stored column-major (M x K), so each parameter of consecutive items is
+ * contiguous for the vectorized item kernels.
+ *
+ * After buildInfoTable(), expected information is answered from an interpolated InfoTable
+ * instead of evaluating every item. setPhase1() fixes the phase 1 bank and ability of the
+ * modified (UW-FI-Modified) information, whose phase 1 factor is then a per-item constant.
+ *
+ * setPrecision(Precision::FLOAT32) evaluates expected information (and stores the table) in
+ * float, within FLOAT32_INFO_ERROR of the double values; ability estimates are unaffected.
+ *
+ * After buildQuadTable(), items can also be chosen by posterior-weighted criteria (PW-FI,
+ * PW-KL) from a QuadTable of the bank at fixed quadrature nodes (always double).
+ *
+ * serialize() writes the bank in a versioned little-endian binary format (BINARY_MAGIC, see
+ * bankfile.cpp): the parameters, ids, precision, and info table are restored by deserialize()
+ * from memory, or by deserializeFile() from a memory-mapped file, with one copy of each block
+ * and no item evaluations.
+ */
+class ItemBank
+{
+public:
+    ItemBank() : model_(ModelType::BRM) {}
+    ItemBank(const Eigen::Ref<const ArrayXXd>& params, ModelType model, const std::vector<std::string>& ids = {});
+
+    int size() const { return (int)params_.rows(); }
+    int categories() const { return n_cat_; }
+    ModelType model() const { return model_; }
+    const ArrayXXd& params() const { return params_; }
+    uint64_t fingerprint() const { return fingerprint_; }
+    const std::string& id(int j) const;
+    Precision precision() const { return precision_; }
+
+    /*
+     * Subsets of the bank
+     */
+    std::vector<int> administered(const Eigen::Ref<const ArrayXd>& resp) const;
+    ArrayXXd gather(const std::vector<int>& items) const;
+
+    /*
+     * Scoring and selection
+     */
+    Est_Result wleEst(const Eigen::Ref<const ArrayXd>& resp, const Eigen::Ref<const RowVector2d>& range,
+                      SolverType solver = SolverType::BRENT, double start = NAN) const;
+    Est_Result wleEst(const std::vector<int>& items, const Eigen::Ref<const ArrayXd>& answers, const Eigen::Ref<const RowVector2d>& range,
+                      SolverType solver = SolverType::BRENT, double start = NAN) const;
+    Est_Result wleEst_ragged(const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const RowVector2d>& range, const std::vector<uint8_t>& mask,
+                             SolverType solver = SolverType::BRENT, const Eigen::Ref<const ArrayXd>& start = ArrayXd()) const;
+    ArrayXd FI_expected(double theta, const std::vector<uint8_t>& exclude) const;
+    ArrayXd FI_modified_expected(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude) const;
+
+    /*
+     * Interpolated information tables
+     */
+    void buildInfoTable(InterpType interp = InterpType::CUBIC, double tol = 1e-6);
+    bool hasInfoTable() const { return (bool)table_; }
+    double infoTableError() const { return table_ ? table_->max_error() : NAN; }
+    void setPhase1(const ItemBank& phase1, double phase1_theta);
+
+    /*
+     * Quadrature tables of the posterior-weighted selection criteria
+     */
+    void buildQuadTable(const Quadrature& quad);
+    bool hasQuadTable() const { return (bool)quad_table_; }
+    ArrayXd posterior(const Eigen::Ref<const ArrayXd>& resp) const;
+
+    /*
+     * Binary bank format: the phase 1 bank and the quadrature table are not stored
+     */
+    std::vector<uint8_t> serialize() const;
+    const char *tryDeserialize(const uint8_t *data, size_t size);
+    void deserialize(const uint8_t *data, size_t size);
+    void deserializeFile(const std::string& path);
+
+    static constexpr uint32_t BINARY_MAGIC = 0x42544143;  // "CATB"
+    static constexpr uint8_t BINARY_VERSION = 1;
+    static constexpr int BINARY_HEADER = 64;
+
+    /*
+     * Float32 selection: absolute error budget of item information against Precision::FLOAT64
+     */
+    void setPrecision(Precision precision);
+    static constexpr double FLOAT32_INFO_ERROR = 1e-5;
+
+    /*
+     * Item selection: top n_select items by information (ties by lowest index), numb of them
+     * picked at random with the bank's seedable generator
+     */
+    void seed(uint32_t s) { rng_.seed(s); }
+    Choose_Result itChoose(double theta, const std::vector<uint8_t>& exclude, int n_select, int numb);
+    Choose_Result itChoose_modified(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, int n_select, int numb);
+
+    // same selections into a reused result: no heap allocations once result and the workspace have grown
+    void itChoose(double theta, const std::vector<uint8_t>& exclude, int n_select, int numb, Choose_Result& result);
+    void itChoose_modified(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, int n_select, int numb,
+                           Choose_Result& result);
+
+    // same selections with the caller's generator: const, so threads can share the bank (e.g. simulateCat)
+    void itChoose(double theta, const std::vector<uint8_t>& exclude, int n_select, int numb, std::mt19937_64& rng, Choose_Result& result) const;
+    void itChoose_modified(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, int n_select, int numb,
+                           std::mt19937_64& rng, Choose_Result& result) const;
+
+    // posterior-weighted selections from the quadrature table, given the full-length responses so far
+    Choose_Result itChoose_posterior(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& resp, const std::vector<uint8_t>& exclude,
+                                     int n_select, int numb);
+    void itChoose_posterior(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& resp, const std::vector<uint8_t>& exclude,
+                            int n_select, int numb, Choose_Result& result);
+    void itChoose_posterior(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& resp, const std::vector<uint8_t>& exclude,
+                            int n_select, int numb, std::mt19937_64& rng, Choose_Result& result) const;
+
+private:
+    void check_mask(const std::vector<uint8_t>& exclude, const char *msg) const;
+    void expected_info(double theta, const std::vector<uint8_t>& exclude, Eigen::Ref<ArrayXd> info) const;
+    void modified_info(double theta, const ItemBank& phase1, double phase1_theta, const std::vector<uint8_t>& exclude, Eigen::Ref<ArrayXd> info) const;
+    Est_Result solve(const Eigen::Ref<const ArrayXXd>& resp, const Eigen::Ref<const ArrayXXd>& params, const Eigen::Ref<const RowVector2d>& range,
+                     SolverType solver, double start) const;
+    static void choose(const Eigen::Ref<const ArrayXd>& info, int n_select, int numb, std::mt19937_64& rng, Choose_Result& result);
+
+    ArrayXXd params_;               // item parameters (M x K)
+    ModelType model_;
+    int n_cat_ = 0;                 // number of response categories (2 for BRM)
+    std::vector<std::string> ids_;  // item ids (empty if not provided)
+    uint64_t fingerprint_ = 0;      // FNV-1a hash of the model and parameters (see CatSession serialize)
+
+    Precision precision_ = Precision::FLOAT64;
+    ArrayXXf params_f_;             // params_ as float for Precision::FLOAT32 (else empty)
+
+    std::shared_ptr<const InfoTable> table_;  // expected information table (or null)
+    double table_tol_ = 0;                    // error bound of table_ (to rebuild it)
+    ArrayXXd phase1_params_;                  // phase 1 parameters of setPhase1()
+    double phase1_theta_ = NAN;               // phase 1 ability of setPhase1()
+    ArrayXd phase1_scale_;                    // phase 1 factor (1 - P) of each item at phase1_theta
+
+    std::shared_ptr<const QuadTable> quad_table_;  // posterior-weighted selection table (or null)
+
+    std::mt19937_64 rng_{std::random_device{}()};  // randomesque selection
+};
+
+#endif // CATIRT_ITEMBANK_H
@@ -0,0 +1,192 @@
+'use strict';
+
+//
+// catIrt-js entry point (copied to dist/catirt.js by `npm run build`)
+//
+// Three builds of the same sources are shipped: dist/catirt-simd.{js,wasm}, compiled with
+// -msimd128 so the item loops run 2 items per lane, dist/catirt-scalar.{js,wasm} for
+// runtimes without WebAssembly SIMD, and dist/catirt-threads.{js,wasm} (SIMD + pthreads),
+// which splits the people of batch wleEst/FI calls across a pool of worker threads.
+// The loader picks one at load time.
+//
+
+// smallest module using a SIMD128 instruction (i8x16.splat + i8x16.popcnt)
+const SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+]);
+
+/**
+ * Test whether the running WebAssembly engine supports SIMD128
+ *
+ * @return {boolean} true if SIMD128 modules can be compiled
+ */
+function simdSupported() {
+  try {
+    return typeof WebAssembly === 'object' && WebAssembly.validate(SIMD_PROBE);
+  } catch (e) {
+    return false;
+  }
+}
+
+/**
+ * Number of hardware threads of the host
+ *
+ * @return {number} thread count (at least 1)
+ */
+function hardwareThreads() {
+  try {
+    const os = require('os');
+    return Math.max(1, os.availableParallelism ? os.availableParallelism() : os.cpus().length);
+  } catch (e) {
+    return Math.max(1, (typeof navigator === 'object' && navigator.hardwareConcurrency) || 1);
+  }
+}
+
+// compiled WebAssembly.Module promises of this process by .wasm path, so repeated loads compile once
+const compiled = {};
+
+/**
+ * Pick the build for the loader options
+ *
+ * @param {boolean|string} simd - see catirt_load
+ * @param {number} nThreads - number of threads (0 for a single-threaded build)
+ *
+ * @return {Object} name of the build, whether it uses SIMD, and a function requiring its module factory
+ */
+function selectBuild(simd, nThreads) {
+  if (nThreads > 0) {
+    return {name: 'catirt-threads', simd: true, factory: () => require('./catirt-threads.js')};
+  }
+  if ((simd === 'auto') ? simdSupported() : Boolean(simd)) {
+    return {name: 'catirt-simd', simd: true, factory: () => require('./catirt-simd.js')};
+  }
+  return {name: 'catirt-scalar', simd: false, factory: () => require('./catirt-scalar.js')};
+}
+
+/**
+ * Compile the .wasm file of a build once per process
+ *
+ * @param {string} name - build name
+ * @param {Function} [locateFile] - Emscripten locateFile option, if given
+ *
+ * @return {Promise} resolves to the WebAssembly.Module, or null where the file cannot be read
+ *   directly (no fs module, e.g. a browser bundle): the Emscripten factory then fetches and compiles it
+ */
+function compileBuild(name, locateFile) {
+  let file;
+  let bytes;
+  try {
+    file = locateFile ? locateFile(name + '.wasm', __dirname + '/') : require('path').join(__dirname, name + '.wasm');
+    if (!compiled[file]) {
+      bytes = require('fs').readFileSync(file);
+    }
+  } catch (e) {
+    return Promise.resolve(null);
+  }
+
+  if (!compiled[file]) {
+    compiled[file] = WebAssembly.compile(bytes).catch(function(e) {
+      delete compiled[file];
+      throw e;
+    });
+  }
+  return compiled[file];
+}
+
+/**
+ * Load the catIrt-js WebAssembly module
+ *
+ * Each build is compiled once per process and the compiled WebAssembly.Module is exposed as
+ * `module.wasmModule`. A WebAssembly.Module can be posted to worker threads (or passed in
+ * workerData), where `catirt_load({wasmModule})` with the same simd/threads options only
+ * instantiates it: N workers compile once instead of N times.
+ *
+ * @param {Object} [options] - loader options; any other keys are passed to the Emscripten module factory
+ * @param {boolean|string} [options.simd='auto'] - true to require the SIMD build, false for the scalar build, 'auto' to detect
+ * @param {boolean|number} [options.threads=0] - number of threads for the threaded build (requires SharedArrayBuffer); true for one per hardware thread, 0 or false for a single-threaded build
+ * @param {WebAssembly.Module} [options.wasmModule] - module compiled from the same build (`module.wasmModule` or catirt_load.compile()), instantiated without compiling
+ *
+ * @return {Promise} resolves to the module; `module.simd` and `module.threads` tell which build was loaded, `module.wasmModule` is its compiled WebAssembly.Module (or null)
+ */
+function catirt_load(options = {}) {
+  const {simd = 'auto', threads = 0, wasmModule = null, ...moduleArgs} = options;
+  const nThreads = (threads === true) ? hardwareThreads() : Math.max(0, Math.floor(Number(threads) || 0));
+
+  if (nThreads > 0 && typeof SharedArrayBuffer === 'undefined') {
+    return Promise.reject(new Error('catirt_load threads option requires SharedArrayBuffer support'));
+  }
+  if (wasmModule !== null && !(wasmModule instanceof WebAssembly.Module)) {
+    return Promise.reject(new Error('catirt_load wasmModule option must be a WebAssembly.Module'));
+  }
+
+  const build = selectBuild(simd, nThreads);
+  let compiledModule = null;
+  const compiling = (wasmModule !== null) ? Promise.resolve(wasmModule) : compileBuild(build.name, moduleArgs.locateFile);
+
+  return compiling.then(function(mod) {
+    compiledModule = mod;
+
+    // the threaded build imports its shared memory, the others define their own
+    if (mod !== null && WebAssembly.Module.imports(mod).some(i => i.kind === 'memory') !== (nThreads > 0)) {
+      throw new Error('catirt_load wasmModule was not compiled from the ' + build.name + ' build');
+    }
+
+    // the pthread pool is created at startup with one worker per thread (see build:threads)
+    const args = Object.assign((nThreads > 0) ? {catirtThreads: nThreads} : {}, moduleArgs);
+    if (mod !== null) {
+      return new Promise(function(resolve, reject) {
+        args.instantiateWasm = function(imports, receiveInstance) {
+          WebAssembly.instantiate(mod, imports).then(instance => receiveInstance(instance, mod), reject);
+          return {};
+        };
+        build.factory()(args).then(resolve, reject);
+      });
+    }
+    return build.factory()(args);
+  }).then(function(m) {
+    if (nThreads > 0) {
+      m.wasm_setNumThreads(nThreads);
+    }
+    m.simd = build.simd;
+    m.threads = (nThreads > 0) ? nThreads : 1;
+    m.wasmModule = compiledModule;
+    return m;
+  });
+}
+
+/**
+ * Compile the build that catirt_load would load with the same options, without instantiating it
+ *
+ * @param {Object} [options] - simd, threads, and locateFile options as for catirt_load
+ *
+ * @return {Promise} resolves to the WebAssembly.Module (for the wasmModule option of catirt_load)
+ */
+function compile(options = {}) {
+  const {simd = 'auto', threads = 0, locateFile} = options;
+  const nThreads = (threads === true) ? hardwareThreads() : Math.max(0, Math.floor(Number(threads) || 0));
+
+  return compileBuild(selectBuild(simd, nThreads).name, locateFile).then(function(mod) {
+    if (mod === null) {
+      throw new Error('catirt_load.compile requires the fs module to read the .wasm file');
+    }
+    return mod;
+  });
+}
+
+/**
+ * Start a pool of worker threads, each with its own module instance (Node only, see catirt-pool.js)
+ *
+ * @param {Object} [options] - size, max_queue, and simd options of the pool
+ *
+ * @return {Promise} resolves to the pool once every worker has loaded the module
+ */
+function createPool(options = {}) {
+  return require('./catirt-pool.js').createPool(options);
+}
+
+catirt_load.simdSupported = simdSupported;
+catirt_load.hardwareThreads = hardwareThreads;
+catirt_load.compile = compile;
+catirt_load.createPool = createPool;
+
+module.exports = catirt_load;
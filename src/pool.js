@@ -0,0 +1,504 @@
+'use strict';
+
+//
+// catIrt-js worker thread pool (copied to dist/catirt-pool.js by `npm run build`)
+//
+// Each worker thread holds its own instance of the module, instantiated from one compiled
+// WebAssembly.Module, and its own copy of the registered item banks. The pooled functions
+// return Promises of the same results as the synchronous API; calls wait in a bounded queue
+// for the next free worker, and CAT sessions stay on the worker that holds their state.
+//
+const {Worker, isMainThread, parentPort, workerData} = require('worker_threads');
+const catirt_load = require('./catirt.js');
+
+// functions of the JS API callable through the pool
+const FUNCTIONS = [
+  'wleEst_brm_one', 'wleEst_grm_one', 'wleEst_brm_batch', 'wleEst_grm_batch',
+  'eapEst_brm_batch', 'eapEst_grm_batch',
+  'FI_brm_expected_one', 'FI_brm_expected_one_modified', 'FI_grm_expected_one',
+  'termGLR_one', 'termGLR_batch', 'itChoose'
+];
+
+// CatSession methods callable through a pooled session
+const SESSION_METHODS = ['addResponse', 'estimate', 'nextItem', 'serialize', 'size', 'theta', 'info', 'sem', 'items'];
+
+// delay before replacing a worker that failed to load (ms), doubled per consecutive failure up to RESPAWN_MAX_DELAY
+const RESPAWN_DELAY = 100;
+const RESPAWN_MAX_DELAY = 30000;
+
+/**
+ * Test whether an error is an abort of the module instance (a trap, or an Emscripten abort()
+ * such as a failed allocation), after which the instance cannot be used again
+ */
+function isAbort(e) {
+  return (e instanceof WebAssembly.RuntimeError) || (e instanceof Error && e.message.startsWith('Aborted('));
+}
+
+/**
+ * Test whether a value is a bank reference of pool.bank(name)
+ */
+function isBankRef(value) {
+  return typeof value === 'object' && value !== null && typeof value.catirt_bank === 'string';
+}
+
+/**
+ * Worker thread: serve calls against this thread's module instance and banks
+ */
+function serve() {
+  const banks = {};     // name -> ItemBank
+  const sessions = {};  // id -> CatSession
+
+  const bankOf = function(ref) {
+    if (!(ref.catirt_bank in banks)) {
+      throw new Error(`catirt pool unknown bank "${ref.catirt_bank}"`);
+    }
+    return banks[ref.catirt_bank];
+  };
+
+  // bank references as arguments, or as properties of an options argument (e.g. phase1_params)
+  const resolve = function(arg) {
+    if (isBankRef(arg)) {
+      return bankOf(arg);
+    }
+    if (typeof arg === 'object' && arg !== null && Object.getPrototypeOf(arg) === Object.prototype) {
+      const out = {};
+      for (const key of Object.keys(arg)) {
+        out[key] = isBankRef(arg[key]) ? bankOf(arg[key]) : arg[key];
+      }
+      return out;
+    }
+    return arg;
+  };
+
+  const ops = {
+    call: function(m, msg) {
+      if (!FUNCTIONS.includes(msg.fn)) {
+        throw new Error(`catirt pool unsupported function "${msg.fn}"`);
+      }
+      return m[msg.fn](...msg.args.map(resolve));
+    },
+    addBank: function(m, msg) {
+      const bank = (msg.source instanceof Uint8Array) ? m.loadItemBank(msg.source, resolve(msg.options))
+                                                      : m.createItemBank(msg.source, msg.model, resolve(msg.options));
+      if (bank.error) {
+        return bank;
+      }
+      if (msg.name in banks) {
+        banks[msg.name].delete();
+      }
+      banks[msg.name] = bank;
+      return null;
+    },
+    deleteBank: function(m, msg) {
+      if (msg.name in banks) {
+        banks[msg.name].delete();
+        delete banks[msg.name];
+      }
+      return null;
+    },
+    createSession: function(m, msg) {
+      const bank = bankOf(msg.bank);
+      const session = (msg.blob !== null) ? m.restoreCatSession(bank, msg.blob) : m.createCatSession(bank, msg.options);
+      if (session.error) {
+        return session;
+      }
+      sessions[msg.session] = session;
+      return null;
+    },
+    session: function(m, msg) {
+      const session = sessions[msg.session];
+      if (session === undefined) {
+        throw new Error('catirt pool unknown session');
+      }
+      if (msg.method === 'delete') {
+        session.delete();
+        delete sessions[msg.session];
+        return null;
+      }
+      if (!SESSION_METHODS.includes(msg.method)) {
+        throw new Error(`catirt pool unsupported session method "${msg.method}"`);
+      }
+      return session[msg.method](...msg.args);
+    }
+  };
+
+  catirt_load({simd: workerData.simd, wasmModule: workerData.wasmModule}).then(function(m) {
+    parentPort.on('message', function(msg) {
+      let reply;
+      try {
+        reply = {id: msg.id, result: ops[msg.op](m, msg)};
+      } catch (e) {
+        reply = {id: msg.id, error: (e instanceof Error) ? e.message : String(e), aborted: isAbort(e)};
+      }
+      parentPort.postMessage(reply);
+    });
+    parentPort.postMessage({ready: true});
+  }, function(e) {
+    parentPort.postMessage({ready: false, error: e.message});
+  });
+}
+
+/**
+ * Worker index of an affinity key (FNV-1a hash of its string form)
+ */
+function keyIndex(key, n) {
+  const s = String(key);
+  let h = 0x811c9dc5;
+  for (let i = 0; i < s.length; i++) {
+    h = Math.imul(h ^ s.charCodeAt(i), 0x01000193);
+  }
+  return (h >>> 0) % n;
+}
+
+/**
+ * Start a pool of worker threads, each with its own catIrt-js module instance
+ *
+ * The module is compiled once and shared by the workers (see catirt_load wasmModule). Item
+ * banks are registered by name on every worker with pool.addBank() and passed to the pooled
+ * functions as pool.bank(name):
+ *
+ *   const pool = await catirt_load.createPool({size: 8});
+ *   await pool.addBank('p1', items, 'brm', {info_table: true});   // or a Uint8Array from bank.serialize()
+ *   const est = await pool.wleEst_brm_one(resp, pool.bank('p1'));
+ *   const next = await pool.itChoose(pool.bank('p1'), 'brm', 'UW-FI', 'theta', {cat_theta: est.theta, exclude});
+ *
+ * Every function of the JS API that scores or selects (wleEst_*_one, wleEst_*_batch,
+ * eapEst_*_batch, FI_*_expected_one, termGLR_one, termGLR_batch, itChoose) has a pooled version
+ * returning a Promise of the same result. Calls go to the next free worker, or always to the
+ * same worker with pool.call(name, args, {key}). A CAT session lives on one worker, and all
+ * of its steps run there:
+ *
+ *   const session = await pool.createSession(pool.bank('p1'));   // or pool.restoreSession(bank, blob)
+ *   await session.addResponse(index, value);
+ *   const est = await session.estimate();
+ *   await session.delete();
+ *
+ * At most max_queue calls wait for a worker; beyond that calls are rejected with a "queue is
+ * full" Error, so callers can shed load instead of queueing without bound. A worker that exits,
+ * or whose module instance aborts during a call, is replaced (with the registered banks); its
+ * queued calls are rejected and its sessions lost. A replacement that fails to load is retried
+ * with an exponential backoff (RESPAWN_DELAY up to RESPAWN_MAX_DELAY ms), while calls for that
+ * worker wait for it.
+ *
+ * options defaults:
+ *  {
+ *      size: hardware threads,  // number of worker threads
+ *      max_queue: 1024,         // calls waiting for a worker before new calls are rejected
+ *      simd: 'auto'             // build of the workers (see catirt_load)
+ *  }
+ *
+ * @param options Options object (see description above)
+ *
+ * @return {Promise} resolves to the pool once every worker has loaded the module - close with pool.close()
+ */
+function createPool(options = {}) {
+  const defaults = {
+    size: catirt_load.hardwareThreads(),
+    max_queue: 1024,
+    simd: 'auto'
+  };
+  options = Object.assign({}, defaults, options);
+
+  if (!(Number.isInteger(options.size) && options.size > 0)) {
+    return Promise.reject(new Error('catirt pool size must be a positive integer'));
+  }
+  if (!(Number.isInteger(options.max_queue) && options.max_queue >= 0)) {
+    return Promise.reject(new Error('catirt pool max_queue must be a non-negative integer'));
+  }
+
+  const simd = (options.simd === 'auto') ? catirt_load.simdSupported() : Boolean(options.simd);
+  const workers = [];     // {thread, task (in flight or null), queue (tasks for this worker only), sessions}
+  const shared = [];      // tasks for any worker
+  const banks = [];       // addBank messages, replayed on replacement workers
+  const failures = [];    // consecutive workers of each index that failed to load
+  const timers = new Set();  // pending delayed replacements
+  let waiting = 0;        // queued tasks, excluding those in flight
+  let nextId = 1;
+  let closed = false;
+  let wasmModule = null;
+
+  const failAll = function(tasks, error) {
+    for (const task of tasks) {
+      task.reject(error);
+    }
+  };
+
+  // hand queued tasks to idle workers, their own queue first
+  const pump = function() {
+    for (const w of workers) {
+      while (w.task === null && w.ready) {
+        const task = (w.queue.length > 0) ? w.queue.shift() : shared.shift();
+        if (task === undefined) {
+          break;
+        }
+        waiting--;
+        try {
+          w.thread.postMessage(task.msg);
+          w.task = task;
+        } catch (e) {
+          // e.g. an ItemBank object instead of pool.bank(name)
+          task.reject(new Error('catirt pool arguments must be cloneable, pass item banks as pool.bank(name)'));
+        }
+      }
+    }
+  };
+
+  // queue a message for worker index (or any worker if null); admin messages skip the queue limit
+  const submit = function(msg, index, admin) {
+    if (closed) {
+      return Promise.reject(new Error('catirt pool is closed'));
+    }
+    if (!admin && waiting >= options.max_queue) {
+      return Promise.reject(new Error('catirt pool queue is full'));
+    }
+    return new Promise(function(resolve, reject) {
+      msg.id = nextId++;
+      const task = {msg, resolve, reject};
+      if (index === null) {
+        shared.push(task);
+      } else {
+        workers[index].queue.push(task);
+      }
+      waiting++;
+      pump();
+    });
+  };
+
+  const spawn = function(index) {
+    const w = {thread: null, task: null, queue: [], sessions: new Set(), ready: false, loaded: false};
+    let started;
+    const starting = new Promise(function(resolve, reject) {
+      started = {resolve, reject};
+    });
+
+    w.thread = new Worker(__filename, {workerData: {catirt_pool: true, simd, wasmModule}});
+    w.thread.on('message', function(msg) {
+      if (msg.ready !== undefined) {
+        if (msg.ready) {
+          w.ready = true;
+          w.loaded = true;
+          failures[index] = 0;
+          started.resolve();
+          pump();
+        } else {
+          started.reject(new Error(msg.error));
+        }
+        return;
+      }
+      const task = w.task;
+      w.task = null;
+      if (msg.error !== undefined) {
+        task.reject(new Error(msg.error));
+      } else {
+        task.resolve(msg.result);
+      }
+      if (msg.aborted) {
+        // the instance is unusable after an abort: stop sending it calls and replace the worker (see 'exit')
+        w.ready = false;
+        w.thread.terminate();
+        return;
+      }
+      pump();
+    });
+    w.thread.on('error', function(e) {
+      started.reject(e);
+      if (w.task !== null) {
+        w.task.reject(e);
+        w.task = null;
+      }
+    });
+    w.thread.on('exit', function() {
+      if (closed || workers[index] !== w) {
+        return;
+      }
+      // replace the worker: its queued calls and sessions are lost, its banks are registered again
+      w.ready = false;
+      w.sessions.clear();
+      waiting -= w.queue.length;
+      failAll(w.queue.splice(0), new Error('catirt pool worker exited'));
+      if (w.task !== null) {
+        w.task.reject(new Error('catirt pool worker exited'));
+        w.task = null;
+      }
+      if (!w.loaded) {
+        failures[index]++;
+      }
+
+      // a worker that failed to load is replaced after a delay, calls for it queue on w meanwhile
+      const replace = function() {
+        const replacement = spawn(index);
+        const queued = w.queue.splice(0);
+        workers[index] = replacement.worker;
+        for (const msg of banks) {
+          submit(Object.assign({}, msg), index, true).catch(function() {});
+        }
+        replacement.worker.queue.push(...queued);
+        replacement.starting.catch(function() {});
+      };
+      if (failures[index] === 0) {
+        replace();
+      } else {
+        const timer = setTimeout(function() {
+          timers.delete(timer);
+          replace();
+        }, Math.min(RESPAWN_MAX_DELAY, RESPAWN_DELAY * 2 ** (failures[index] - 1)));
+        timers.add(timer);
+      }
+    });
+
+    return {worker: w, starting};
+  };
+
+  const makeSession = function(index, id) {
+    const call = function(method, args) {
+      if (!workers[index].sessions.has(id)) {
+        return Promise.reject(new Error('catirt pool session is closed or lost'));
+      }
+      return submit({op: 'session', session: id, method, args}, index, false);
+    };
+    const session = {
+      delete: function() {
+        return call('delete', []).then(function(result) {
+          workers[index].sessions.delete(id);
+          return result;
+        });
+      }
+    };
+    for (const method of SESSION_METHODS) {
+      session[method] = (...args) => call(method, args);
+    }
+    return session;
+  };
+
+  // sessions go to the worker holding the fewest
+  const openSession = function(bank, opts, blob) {
+    let index = 0;
+    for (let i = 1; i < workers.length; i++) {
+      if (workers[i].sessions.size < workers[index].sessions.size) {
+        index = i;
+      }
+    }
+    const id = nextId++;
+    workers[index].sessions.add(id);
+    return submit({op: 'createSession', session: id, bank, options: opts, blob}, index, false).then(function(res) {
+      if (res !== null) {
+        workers[index].sessions.delete(id);
+        return res;
+      }
+      return makeSession(index, id);
+    }, function(e) {
+      workers[index].sessions.delete(id);
+      throw e;
+    });
+  };
+
+  const pool = {
+    size: options.size,
+
+    // reference to a registered bank, for the arguments of pooled calls
+    bank: function(name) {
+      return {catirt_bank: name};
+    },
+
+    // register a bank on every worker: items and model as createItemBank, or a Uint8Array for loadItemBank; resolves to null or
+    // {error}, and a bank that fails on any worker is left registered on none (or as it was before)
+    addBank: function(name, source, model, opts = {}) {
+      if (ArrayBuffer.isView(source) && !(source instanceof Uint8Array)) {
+        source = new Uint8Array(source.buffer, source.byteOffset, source.byteLength);
+      }
+      const msg = {op: 'addBank', name, source, model, options: opts};
+      return Promise.allSettled(workers.map((w, i) => submit(Object.assign({}, msg), i, true))).then(function(res) {
+        const failed = res.find(r => (r.status === 'rejected' || r.value !== null));
+        const at = banks.findIndex(b => b.name === name);
+        if (!failed) {
+          if (at >= 0) {
+            banks.splice(at, 1);
+          }
+          banks.push(msg);
+          return null;
+        }
+
+        // the workers that took the bank go back to the previous registration (or none), like the others
+        const undo = (at >= 0 ? banks[at] : {op: 'deleteBank', name});
+        return Promise.all(res.map((r, i) => (r.status === 'fulfilled' && r.value === null) ?
+          submit(Object.assign({}, undo), i, true).catch(function() {}) : null)).then(function() {
+          if (failed.status === 'rejected') {
+            throw failed.reason;
+          }
+          return failed.value;
+        });
+      });
+    },
+
+    deleteBank: function(name) {
+      const at = banks.findIndex(b => b.name === name);
+      if (at >= 0) {
+        banks.splice(at, 1);
+      }
+      return Promise.all(workers.map((w, i) => submit({op: 'deleteBank', name}, i, true))).then(() => null);
+    },
+
+    // call a pooled function by name; with {key}, calls of the same key always run on the same worker
+    call: function(fn, args, opts = {}) {
+      const index = (opts.key === undefined || opts.key === null) ? null : keyIndex(opts.key, workers.length);
+      return submit({op: 'call', fn, args}, index, false);
+    },
+
+    createSession: function(bank, opts = {}) {
+      return openSession(bank, opts, null);
+    },
+
+    restoreSession: function(bank, blob) {
+      return openSession(bank, {}, (blob instanceof ArrayBuffer) ? new Uint8Array(blob) : blob);
+    },
+
+    // number of calls queued or running
+    pending: function() {
+      return waiting + workers.filter(w => w.task !== null).length;
+    },
+
+    // terminate the workers; calls not finished are rejected
+    close: function() {
+      closed = true;
+      waiting = 0;
+      for (const timer of timers) {
+        clearTimeout(timer);
+      }
+      timers.clear();
+      failAll(shared.splice(0), new Error('catirt pool is closed'));
+      for (const w of workers) {
+        failAll(w.queue.splice(0), new Error('catirt pool is closed'));
+        if (w.task !== null) {
+          w.task.reject(new Error('catirt pool is closed'));
+          w.task = null;
+        }
+      }
+      return Promise.all(workers.map(w => w.thread.terminate())).then(() => null);
+    }
+  };
+
+  for (const fn of FUNCTIONS) {
+    pool[fn] = (...args) => pool.call(fn, args);
+  }
+
+  return catirt_load.compile({simd}).then(function(mod) {
+    wasmModule = mod;
+    const started = [];
+    for (let i = 0; i < options.size; i++) {
+      failures.push(0);
+      const s = spawn(i);
+      workers.push(s.worker);
+      started.push(s.starting);
+    }
+    return Promise.all(started).then(() => pool, function(e) {
+      pool.close();
+      throw e;
+    });
+  });
+}
+
+if (!isMainThread && workerData && workerData.catirt_pool) {
+  serve();
+}
+
+module.exports = {createPool};
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include "quadtable.h"
+#include "catirt_kernels.h"
+#include "catirt_parallel.h"
+#include "workspace.h"
+
+/**MDJAVADOC_SKIP
+ * Log-probability of category c of item j (0 = incorrect and 1 = correct for BRM, 0 to K - 1 for
+ * GRM categories 1 to K), floored at QuadTable::LOG_FLOOR - NaN for disordered GRM boundaries
+ */
+static inline double category_loglik(double theta, const Eigen::Ref<const ArrayXXd>& params, int j, ModelType model, int c)
+{
+  double ll = (model == ModelType::BRM) ? brm_loglik_item(theta, params(j, 0), params(j, 1), params(j, 2), c)
+                                        : grm_loglik_item(theta, params, j, c + 1);
+
+  return std::isnan(ll) ? NAN : std::max(ll, QuadTable::LOG_FLOOR);
+}
+
+/**MDJAVADOC_SKIP
+ * KL term p * (log p - s) of one category at the ability estimate (0 for p = 0)
+ */
+static inline double kl_term(double p, double s)
+{
+  return p > 0 ? p * (log(p) - s) : 0.0;
+}
+
+/**MDJAVADOC_SKIP
+ * Tabulate the log-probability of the response categories of the items at the quadrature nodes
+ *
+ * @param params      Parameters for M items (M x 3 for BRM, M x K for GRM)
+ * @param model       ModelType::BRM or ModelType::GRM
+ * @param nodes       Ability points (Q)
+ * @param used        K * M flags of the columns to fill (the others are left unset)
+ *
+ * @return Q x (K * M) table: column c * M + j holds log P(category c of item j) at every node,
+ *         category 0 = incorrect and 1 = correct for BRM, 0 to K - 1 for GRM categories 1 to K
+ *         (NaN for the items with disordered GRM boundaries)
+ */
+ArrayXXd loglik_table(const Eigen::Ref<const ArrayXXd>& params, ModelType model, const Eigen::Ref<const ArrayXd>& nodes,
+                      const std::vector<uint8_t>& used)
+{
+  const int M = params.rows();
+  const int Q = nodes.size();
+  ArrayXXd table(Q, used.size());
+
+  // columns are independent: split them across threads
+  parallel_for(used.size(), row_grain(Q), [&](int begin, int end) {
+    for (int col = begin; col < end; col++) {
+      if (!used[col]) {
+        continue;
+      }
+      for (int q = 0; q < Q; q++) {
+        table(q, col) = category_loglik(nodes(q), params, col % M, model, col / M);
+      }
+    }
+  });
+  return table;
+}
+
+/**MDJAVADOC_SKIP
+ * Tabulate the category log-probabilities and expected information of M items at the quadrature nodes
+ *
+ * @param params      Parameters for M items (M x 3 matrix for BRM, M x K matrix for GRM)
+ * @param model       ModelType::BRM or ModelType::GRM
+ * @param quad        Nodes and prior weights (see quadrature())
+ */
+QuadTable::QuadTable(const Eigen::Ref<const ArrayXXd>& params, ModelType model, const Quadrature& quad)
+  : params_(params), model_(model), quad_(quad)
+{
+  ArrayXXd none(0, 0);
+  const int Q = quad.nodes.size();
+
+  if (Q == 0 || quad.weights.size() != Q || !quad.nodes.isFinite().all() || !quad.weights.isFinite().all()) {
+    throw "QuadTable quadrature nodes and weights must be finite and of the same length";
+  }
+
+  n_cat_ = (model == ModelType::BRM) ? 2 : params.cols();
+  logp_ = loglik_table(params, model, quad.nodes, std::vector<uint8_t>(n_cat_ * params.rows(), 1));
+  info_ = (model == ModelType::BRM) ? FI_brm(params, quad.nodes, FIType::EXPECTED, none).item
+                                    : FI_grm(params, quad.nodes, FIType::EXPECTED, none).item;
+}
+
+/**MDJAVADOC_SKIP
+ * Posterior weights at the nodes of one examinee
+ *
+ * @param resp        Responses to all M items: 0/1 (BRM) or 1 to K (GRM), NaN if not administered
+ * @param weights     Output: posterior weights (size Q) summing to 1 - the prior weights without responses
+ */
+void QuadTable::posterior(const Eigen::Ref<const ArrayXd>& resp, Eigen::Ref<ArrayXd> weights) const
+{
+  const int M = size();
+  const int first = (model_ == ModelType::BRM ? 0 : 1);   // response of category 0
+
+  if (resp.size() != M) {
+    throw "QuadTable posterior response length must match number of items";
+  }
+
+  // log-likelihood at the nodes: one table column per answered item
+  weights.setZero();
+  for (int j = 0; j < M; j++) {
+    double u = resp(j);
+    if (std::isnan(u)) {
+      continue;
+    }
+    if (!(u >= first && u < first + n_cat_ && u == floor(u))) {
+      throw "QuadTable posterior responses must be 0 or 1 (BRM) or categories 1 to K (GRM)";
+    }
+    weights += logp_.col(((int)u - first) * M + j);
+  }
+
+  weights = (weights - weights.maxCoeff()).exp() * quad_.weights;
+  weights /= weights.sum();
+}
+
+/**MDJAVADOC_SKIP
+ * Posterior-weighted selection criterion of every item
+ *
+ * PW_FI is one (M x Q) matrix-vector product; PW_KL is one ((K * M) x Q) product plus the K
+ * category probabilities of each item at theta.
+ *
+ * @param select      SelectType::PW_FI or SelectType::PW_KL
+ * @param theta       Ability estimate (PW_KL only)
+ * @param weights     Posterior weights at the nodes (size Q, see posterior())
+ * @param exclude     Exclusion mask (size M, non-zero to skip an item), or empty
+ * @param out         Output: criterion of each item (size M), NaN for excluded items
+ */
+void QuadTable::criterion(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& weights, const std::vector<uint8_t>& exclude,
+                          Eigen::Ref<ArrayXd> out) const
+{
+  const int M = size();
+
+  if (weights.size() != nodes()) {
+    throw "QuadTable criterion weights length must match number of nodes";
+  }
+
+  if (select == SelectType::PW_FI) {
+    out.matrix().noalias() = info_.matrix().transpose() * weights.matrix();
+  } else {
+    if (!std::isfinite(theta)) {
+      throw "QuadTable PW-KL theta must be finite";
+    }
+
+    // posterior mean of log P at the nodes for every item category
+    auto sums = Workspace::local().vector(Scratch::NODE_SUMS, n_cat_ * M);
+    sums.matrix().noalias() = logp_.matrix().transpose() * weights.matrix();
+
+    // sum_k P_k (log P_k - sums_k) at theta, from one exponential per boundary
+    for (int j = 0; j < M; j++) {
+      double kl = 0;
+      if (model_ == ModelType::BRM) {
+        BRM_Point pt = brm_point(theta, params_(j, 0), params_(j, 1), params_(j, 2));
+        kl = kl_term(pt.q, sums(j)) + kl_term(pt.p, sums(M + j));
+      } else {
+        double upper = 1;   // P(X >= c + 1), the upper boundary of category c + 1
+        for (int c = 0; c < n_cat_; c++) {
+          double lower = (c < n_cat_ - 1) ? grm_boundary(theta, params_(j, 0), params_(j, c + 1)).p : 0.0;
+          kl += kl_term(upper - lower, sums(c * M + j));
+          upper = lower;
+        }
+      }
+      out(j) = kl;
+    }
+  }
+
+  for (size_t j = 0; j < exclude.size(); j++) {
+    if (exclude[j]) {
+      out(j) = NAN;
+    }
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef CATIRT_QUADTABLE_H
+#define CATIRT_QUADTABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "catirt.h"
+
+// item selection criteria answered from a QuadTable
+enum class SelectType {
+    PW_FI,      // posterior-weighted expected Fisher information
+    PW_KL       // posterior-weighted Kullback-Leibler information at the ability estimate
+};
+
+/*
+ * Category log-probabilities and expected information of a bank tabulated at the nodes of a
+ * fixed quadrature (see quadrature() in catirt.h), computed once per bank.
+ *
+ * The posterior of an examinee at the nodes is the prior weights times the exponential of a
+ * sum of table columns (one per answered item), and each selection criterion is then a
+ * matrix-vector product of the resident item x node table with the posterior weights:
+ *
+ *   PW-FI_j = sum_q w_q I_j(theta_q)
+ *   PW-KL_j = sum_q w_q sum_k P_jk(theta) [log P_jk(theta) - log P_jk(theta_q)]
+ *           = sum_k P_jk(theta) log P_jk(theta) - sum_k P_jk(theta) (sum_q w_q log P_jk(theta_q))
+ *
+ * Log-probabilities are floored at LOG_FLOOR, so a category of probability 0 at a node adds a
+ * large but finite penalty.
+ */
+class QuadTable
+{
+public:
+    QuadTable() {}
+    QuadTable(const Eigen::Ref<const ArrayXXd>& params, ModelType model, const Quadrature& quad);
+
+    int size() const { return (int)params_.rows(); }
+    int nodes() const { return (int)quad_.nodes.size(); }
+    const Quadrature& quad() const { return quad_; }
+    size_t bytes() const { return (info_.size() + logp_.size()) * sizeof(double); }
+
+    // posterior weights at the nodes (size Q, summing to 1) of full-length responses (NaN if not administered)
+    void posterior(const Eigen::Ref<const ArrayXd>& resp, Eigen::Ref<ArrayXd> weights) const;
+
+    // selection criterion of every item (size M) for posterior weights, NaN for excluded items
+    void criterion(SelectType select, double theta, const Eigen::Ref<const ArrayXd>& weights, const std::vector<uint8_t>& exclude,
+                   Eigen::Ref<ArrayXd> out) const;
+
+    // floor of the tabulated log-probabilities (about the log of the smallest double)
+    static constexpr double LOG_FLOOR = -745.0;
+
+private:
+    ArrayXXd params_;              // item parameters (M x K), for the probabilities at theta
+    ModelType model_ = ModelType::BRM;
+    int n_cat_ = 0;                // number of response categories (2 for BRM)
+    Quadrature quad_;              // nodes and prior weights
+    ArrayXXd info_;                // expected information (Q x M), each item contiguous
+    ArrayXXd logp_;                // category log-probabilities (Q x (K * M)), column c * M + j
+};
+
+ArrayXXd loglik_table(const Eigen::Ref<const ArrayXXd>& params, ModelType model, const Eigen::Ref<const ArrayXd>& nodes,
+                      const std::vector<uint8_t>& used);
+
+#endif // CATIRT_QUADTABLE_H
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include "simulate.h"
+#include "catirt_kernels.h"
+#include "catirt_parallel.h"
+
+/**MDJAVADOC_SKIP
+ * Seed of simulee i: splitmix64 of (seed, i), so neighbouring simulees get unrelated streams
+ */
+static uint64_t simulee_seed(uint64_t seed, uint64_t i)
+{
+  uint64_t z = seed + (i + 1) * 0x9e3779b97f4a7c15ULL;
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**MDJAVADOC_SKIP
+ * Uniform [0, 1) from the top 53 bits (the same on every standard library)
+ */
+static double uniform(std::mt19937_64& rng)
+{
+  return (rng() >> 11) * 0x1.0p-53;
+}
+
+/**MDJAVADOC_SKIP
+ * Draw the response of a simulee to one item
+ *
+ * @param theta       True ability
+ * @param params      Parameters for M items (M x 3 for BRM, M x K for GRM)
+ * @param j           Item row in params
+ * @param model       ModelType::BRM or ModelType::GRM
+ * @param rng         Generator of the simulee
+ *
+ * @return 0 or 1 (BRM), or category 1 to K (GRM)
+ */
+static double simulate_response(double theta, const ArrayXXd& params, int j, ModelType model, std::mt19937_64& rng)
+{
+  double u = uniform(rng);
+
+  if (model == ModelType::BRM) {
+    return (u < brm_point(theta, params(j, 0), params(j, 1), params(j, 2)).p) ? 1 : 0;
+  }
+
+  // the boundaries P(X >= k + 1) decrease with k: the category is 1 + the number of them above u
+  int cat = 1;
+  for (int k = 1; k < params.cols(); k++) {
+    if (u < grm_boundary(theta, params(j, 0), params(j, k)).p) {
+      cat++;
+    }
+  }
+  return cat;
+}
+
+/**MDJAVADOC_SKIP
+ * Simulate computerized adaptive tests of many simulees against a resident item bank
+ *
+ * Each simulee starts at config.start_theta and, until a stopping rule is met, is given the
+ * most informative item (UW-FI, or UW-FI-Modified with config.phase1; randomesque among the
+ * config.n_select best) not administered yet, answers it with a response drawn from the model
+ * at its true ability, and is re-scored by WLE. After min_items, the test ends when the
+ * standard error reaches max_sem or termGLR classifies the simulee; it always ends at
+ * max_items or when the bank is exhausted.
+ *
+ * Simulees are split across threads (see setNumThreads). Each has its own generator seeded
+ * from (config.seed, index), so results do not depend on the number of threads.
+ *
+ * A two-phase design (e.g. MOCCA) is two calls: the phase 1 estimates of the first call are
+ * the config.phase1_theta of the second.
+ *
+ * @param bank        Item bank (BRM or GRM); its own generator and info table settings are used as is
+ * @param true_theta  True abilities of N simulees
+ * @param config      Selection, scoring, and termination settings
+ *
+ * @return Sim_Result with the final estimate, test length, classification, and stopping reason of each simulee
+ */
+Sim_Result simulateCat(const ItemBank& bank, const Eigen::Ref<const ArrayXd>& true_theta, const Sim_Config& config)
+{
+  const int N = true_theta.size();
+  const int M = bank.size();
+  const int max_items = std::min(config.max_items, M);
+  const bool classify = config.bounds.size() > 0;
+  Sim_Result result;
+  std::mutex exposure_lock;
+
+  //
+  // Check arguments
+  //
+  if (!true_theta.isFinite().all()) {
+    throw "simulateCat infinite or non-numeric true abilities provided";
+  }
+  if (config.max_items < 1 || config.min_items < 1 || config.min_items > config.max_items) {
+    throw "simulateCat min_items and max_items must satisfy 1 <= min_items <= max_items";
+  }
+  if (config.n_select < 1) {
+    throw "simulateCat n_select must be positive";
+  }
+  if (!(config.range(0) < 0 && config.range(1) > 0)) {
+    throw "simulateCat unsupported range provided";
+  }
+  if (config.phase1 && config.phase1_theta.size() != N) {
+    throw "simulateCat number of phase 1 abilities must match number of simulees";
+  }
+  if (classify && !config.bounds.isFinite().all()) {
+    throw "simulateCat infinite or non-numeric bounds provided";
+  }
+
+  result.theta.resize(N);
+  result.info.resize(N);
+  result.sem.resize(N);
+  result.length.resize(N);
+  result.category = ArrayXi::Constant(N, -1);
+  result.stop.resize(N);
+  result.exposure = ArrayXi::Zero(M);
+
+  // simulees are independent: split them across threads, with the test state reused within a chunk
+  parallel_for(N, 16, [&](int begin, int end) {
+      ArrayXXd resp(1, max_items);                          // responses of the current simulee
+      ArrayXXd params(max_items, bank.params().cols());     // parameters of its administered items
+      std::vector<uint8_t> mask(M);                         // its administered items
+      ArrayXi exposure = ArrayXi::Zero(M);
+      Choose_Result choice;
+      std::mt19937_64 rng;
+
+      for (int i = begin; i < end; i++) {
+          double theta = config.start_theta;
+          double info = NAN;
+          double sem = NAN;
+          StopReason stop = StopReason::MAX_ITEMS;
+          int n = 0;
+
+          rng.seed(simulee_seed(config.seed, i));
+          std::fill(mask.begin(), mask.end(), 0);
+
+          while (true) {
+              if (n == max_items) {
+                  stop = (max_items < config.max_items) ? StopReason::BANK : StopReason::MAX_ITEMS;
+                  break;
+              }
+
+              if (config.phase1) {
+                  bank.itChoose_modified(theta, *config.phase1, config.phase1_theta(i), mask, config.n_select, 1, rng, choice);
+              } else {
+                  bank.itChoose(theta, mask, config.n_select, 1, rng, choice);
+              }
+              if (choice.items.empty()) {
+                  stop = StopReason::BANK;
+                  break;
+              }
+
+              int j = choice.items[0];
+              resp(0, n) = simulate_response(true_theta(i), bank.params(), j, bank.model(), rng);
+              params.row(n) = bank.params().row(j);
+              mask[j] = 1;
+              exposure(j)++;
+              n++;
+
+              WLE_Root root = wle_root(resp.leftCols(n), params.topRows(n), config.range, bank.model(), config.solver,
+                                       (n > 1 ? theta : NAN));
+              theta = root.root;
+              info = root.info;
+              sem = sqrt((root.info + root.corr * root.corr) / (root.info * root.info));
+
+              if (n < config.min_items) {
+                  continue;
+              }
+              if (config.max_sem > 0 && sem <= config.max_sem) {
+                  stop = StopReason::SEM;
+                  break;
+              }
+              if (classify) {
+                  GLR_Result glr = termGLR(resp.leftCols(n), params.topRows(n), bank.model(), config.range, config.bounds,
+                                           config.delta, config.alpha, config.beta);
+                  result.category(i) = glr.category(0);
+                  if (glr.category(0) >= 0) {
+                      stop = StopReason::GLR;
+                      break;
+                  }
+              }
+          }
+
+          result.theta(i) = theta;
+          result.info(i) = info;
+          result.sem(i) = sem;
+          result.length(i) = n;
+          result.stop(i) = (int)stop;
+      }
+
+      std::lock_guard<std::mutex> lock(exposure_lock);
+      result.exposure += exposure;
+  });
+
+  return result;
+}
@@ -0,0 +1,56 @@
+#ifndef CATIRT_SIMULATE_H
+#define CATIRT_SIMULATE_H
+
+#include <cstdint>
+#include "catirt.h"
+#include "itembank.h"
+
+// why a simulated CAT ended
+enum class StopReason {
+    MAX_ITEMS,  // max_items administered
+    SEM,        // standard error at or below max_sem
+    GLR,        // classified by termGLR
+    BANK        // no items left to administer
+};
+
+/*
+ * CAT design of simulateCat(): selection, scoring, and termination
+ */
+struct Sim_Config
+{
+    RowVector2d range = RowVector2d(-4.5, 4.5);  // range of ability estimates
+    double start_theta = 0;                      // ability of the first selection
+    int min_items = 1;                           // no termination before min_items
+    int max_items = 40;                          // test length limit
+    double max_sem = 0;                          // stop once sem <= max_sem (0 to disable)
+    int n_select = 1;                            // randomesque: pick from the n_select most informative items
+    SolverType solver = SolverType::BRENT;       // WLE solver (NEWTON starts from the last estimate)
+
+    ArrayXd bounds;                              // termGLR classification bounds (empty to disable)
+    double delta = 0.1;                          // termGLR indifference region
+    double alpha = 0.05;                         // termGLR type I error
+    double beta = 0.05;                          // termGLR type II error
+
+    const ItemBank *phase1 = nullptr;            // UW-FI-Modified selection against this phase 1 bank, or null for UW-FI
+    ArrayXd phase1_theta;                        // phase 1 ability of each simulee (with phase1)
+
+    uint64_t seed = 0;                           // responses and picks of simulee i depend only on (seed, i)
+};
+
+/*
+ * Per-simulee summaries of simulateCat()
+ */
+struct Sim_Result
+{
+    ArrayXd theta;      // final ability estimate (N)
+    ArrayXd info;       // observed test information at theta
+    ArrayXd sem;        // standard error of theta
+    ArrayXi length;     // number of items administered
+    ArrayXi category;   // termGLR classification, -1 if not classified (or no bounds)
+    ArrayXi stop;       // StopReason of each simulee
+    ArrayXi exposure;   // number of simulees each bank item was administered to (M)
+};
+
+Sim_Result simulateCat(const ItemBank& bank, const Eigen::Ref<const ArrayXd>& true_theta, const Sim_Config& config);
+
+#endif // CATIRT_SIMULATE_H
@@ -0,0 +1,31 @@
+#include "workspace.h"
+
+/**MDJAVADOC_SKIP
+ * Workspace of the calling thread
+ *
+ * @return thread_local Workspace, created on first use
+ */
+Workspace& Workspace::local()
+{
+  static thread_local Workspace ws;
+  return ws;
+}
+
+/**MDJAVADOC_SKIP
+ * Grow a buffer to at least n doubles (to 1.5x the request, so slowly growing sizes settle)
+ *
+ * @param slot        Buffer slot
+ * @param n           Number of doubles needed
+ *
+ * @return start of the buffer
+ */
+double *Workspace::reserve(Scratch slot, size_t n)
+{
+  std::vector<double>& buf = buffers_[(int)slot];
+
+  if (buf.size() < n) {
+    buf.resize(n + n / 2);
+    growths_++;
+  }
+  return buf.data();
+}
@@ -0,0 +1,74 @@
+#ifndef CATIRT_WORKSPACE_H
+#define CATIRT_WORKSPACE_H
+
+#include <vector>
+#include "catirt.h"
+
+//
+// Grow-only scratch buffers for the scoring and selection paths.
+//
+// Each buffer is addressed by a slot, so functions that call each other never share memory.
+// A buffer grows to the largest size requested so far and is never shrunk or freed, so once
+// a workload has been seen, steady-state calls (a CAT step, the rows of a batch) make no heap
+// allocations for their intermediates.
+//
+// Workspace::local() is the workspace of the calling thread. The single-person, ItemBank, and
+// CatSession paths run on the calling thread and keep theirs across calls; the rows of a batch
+// run on the calling thread and the persistent workers of the thread pool (see parallel_run),
+// which each keep their own workspace for as long as the pool keeps them.
+//
+
+enum class Scratch {
+    RESP,       // responses of one person (1 x M)
+    PARAMS,     // parameters of the administered items (M x K)
+    ITEMS,      // indices of the administered items
+    INFO,       // expected information of the bank items (M)
+    LOGLIK,     // log-likelihood grid of termGLR, or at the quadrature nodes of eapEst
+    CANDIDATES, // candidate items of ItemBank selection
+    POSTERIOR,  // posterior weights at the quadrature nodes
+    NODE_SUMS,  // posterior-weighted sums of the QuadTable log-probabilities
+    COUNT
+};
+
+class Workspace
+{
+public:
+    // buffer of at least rows x cols doubles (column-major), contents unspecified
+    Eigen::Map<ArrayXXd> matrix(Scratch slot, int rows, int cols)
+    {
+        return Eigen::Map<ArrayXXd>(reserve(slot, (size_t)rows * cols), rows, cols);
+    }
+
+    // buffer of at least n doubles, contents unspecified
+    Eigen::Map<ArrayXd> vector(Scratch slot, int n)
+    {
+        return Eigen::Map<ArrayXd>(reserve(slot, n), n);
+    }
+
+    // empty index list with room for at least n indices
+    std::vector<int>& indices(Scratch slot, int n)
+    {
+        std::vector<int>& v = indices_[(int)slot];
+
+        if ((int)v.capacity() < n) {
+            v.reserve(n);
+            growths_++;
+        }
+        v.clear();
+        return v;
+    }
+
+    // number of times a buffer had to grow (0 in the steady state)
+    long growths() const { return growths_; }
+
+    static Workspace& local();
+
+private:
+    double *reserve(Scratch slot, size_t n);
+
+    std::vector<double> buffers_[(int)Scratch::COUNT];
+    std::vector<int> indices_[(int)Scratch::COUNT];
+    long growths_ = 0;
+};
+
+#endif // CATIRT_WORKSPACE_H
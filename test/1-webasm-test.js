@@ -39,6 +39,66 @@ describe('catIrt webasm', function () {
   });
 
   // define test suite
+  describe('Matrix:', function () {
+    it('Matrix.fromTypedArray(arr, rows, cols) and toTypedArray()', function () {
+      const flat = Float64Array.from([1, 2, 3, 4, 5, NaN]);
+      const m = catirtlib.Matrix.fromTypedArray(flat, 2, 3);
+
+      assert.strictEqual(m.rows(), 2);
+      assert.strictEqual(m.cols(), 3);
+      assert.strictEqual(m.get(0, 2), 3);
+      assert.strictEqual(m.get(1, 0), 4);
+      assert.strictEqual(format(catirtlib.MatrixToArray(m)), format([[1, 2, 3], [4, 5, NaN]]));
+      assert.strictEqual(format(Array.from(m.toTypedArray())), format(Array.from(flat)));
+
+      // wasm heap cleanup
+      m.delete();
+    });
+
+    it('Matrix.fromPointer(ptr, rows, cols)', function () {
+      const ptr = catirtlib._malloc(6 * 8);
+      catirtlib.HEAPF64.set([1, 2, 3, 4, 5, 6], ptr / 8);
+      const m = catirtlib.Matrix.fromPointer(ptr, 3, 2);
+      catirtlib._free(ptr);
+
+      assert.strictEqual(format(catirtlib.MatrixToArray(m)), format([[1, 2], [3, 4], [5, 6]]));
+
+      // wasm heap cleanup
+      m.delete();
+    });
+
+    it('MatrixFromArray(itemparams) matches Matrix.fromVector', function () {
+      const v2d = new catirtlib.Vector2d();
+      for (const row of itemparams) {
+        const v = new catirtlib.Vector();
+        row.forEach(x => v.push_back(x));
+        v2d.push_back(v);
+        v.delete();
+      }
+      const a = catirtlib.Matrix.fromVector(v2d);
+      const b = catirtlib.MatrixFromArray(itemparams);
+
+      assert.deepStrictEqual(catirtlib.MatrixToArray(b), catirtlib.MatrixToArray(a));
+
+      // wasm heap cleanup
+      v2d.delete();
+      a.delete();
+      b.delete();
+    });
+
+    it('MatrixFromArray() keeps null as NaN and rejects other non-numbers', function () {
+      const m = catirtlib.MatrixFromArray([[1, null], [NaN, 4]]);
+      assert.strictEqual(format(catirtlib.MatrixToArray(m)), format([[1, NaN], [NaN, 4]]));
+      m.delete();
+
+      for (const bad of ['1', undefined, {}, Infinity, -Infinity]) {
+        assert.throws(() => catirtlib.MatrixFromArray([[1, 2], [3, bad]]),
+          {message: 'All the elements must be finite numbers, NaN, or null'});
+      }
+      assert.throws(() => catirtlib.MatrixFromArray([[1, 2], [3]]), {message: 'All the rows must have the same size'});
+    });
+  });
+
   describe('wasm_p_brm:', function () {
     it('wasm_p_brm(theta, params)', function () {
       // expected values from R equivalent: `catIrt::p.brm(theta, params)`
@@ -819,4 +879,161 @@ describe('catIrt webasm', function () {
       res.sem.delete();
     });
   });
+
+  describe('wasm_getStats:', function () {
+    it('counts kernel calls, root finder iterations, bytes copied, and allocations', function () {
+      catirtlib.wasm_resetStats();
+      const zero = catirtlib.wasm_getStats();
+      assert.strictEqual(zero.enabled, true);
+      assert.strictEqual(zero.timers, false);
+      assert.strictEqual(zero.wle_calls, 0);
+      assert.strictEqual(zero.allocs, 0);
+      assert.ok(zero.heap_bytes > 0);
+
+      const mResp = catirtlib.MatrixFromArray(uresp);
+      const mParams = catirtlib.MatrixFromArray(itemparams);
+      const mRange = catirtlib.MatrixFromArray([range]);
+      const res = catirtlib.wasm_wleEst(mResp, mParams, mRange, catirtlib.ModelType.BRM);
+      const stats = catirtlib.wasm_getStats();
+
+      // wasm heap cleanup
+      mResp.delete();
+      mParams.delete();
+      mRange.delete();
+      res.theta.delete();
+      res.info.delete();
+      res.sem.delete();
+
+      assert.strictEqual(stats.wle_calls, 1);
+      assert.strictEqual(stats.wle_ns, 0);
+      assert.strictEqual(stats.uniroot_calls, uresp.length);
+      assert.ok(stats.uniroot_iterations >= uresp.length);
+      assert.strictEqual(stats.uniroot_maxit, 0);
+      assert.strictEqual(stats.bytes_in, 8 * (uresp.length * uresp[0].length + itemparams.length * 3 + 2));
+      assert.strictEqual(stats.bytes_out, 8 * 3 * uresp.length);
+      assert.ok(stats.allocs >= 4);
+      assert.ok(stats.bytes_allocated >= stats.bytes_in + stats.bytes_out);
+
+      catirtlib.wasm_resetStats();
+      assert.strictEqual(catirtlib.wasm_getStats().bytes_in, 0);
+    });
+  });
+
+  describe('catirt_load build variants:', function () {
+    it('scalar and SIMD builds agree', function () {
+      if (!catirt_load.simdSupported || !catirt_load.simdSupported()) {
+        this.skip();
+      }
+
+      return Promise.all([catirt_load({simd: false}), catirt_load({simd: true})]).then(function(mods) {
+        const [scalar, simd] = mods;
+        assert.strictEqual(scalar.simd, false);
+        assert.strictEqual(simd.simd, true);
+
+        const run = function(m) {
+          const mParams = m.MatrixFromArray(itemparams);
+          const mTheta = m.MatrixFromArray([theta]);
+          const mResp = new m.Matrix(0, 0);
+          const p = m.wasm_p_brm(mTheta, mParams);
+          const fi = m.wasm_FI_brm(mParams, mTheta, m.FIType.EXPECTED, mResp);
+          const out = {p: m.MatrixToArray(p), info: m.MatrixToArray(fi.item)};
+
+          // wasm heap cleanup
+          mParams.delete();
+          mTheta.delete();
+          mResp.delete();
+          p.delete();
+          fi.item.delete();
+          fi.test.delete();
+          fi.sem.delete();
+          return out;
+        };
+
+        const a = run(scalar);
+        const b = run(simd);
+        assert.strictEqual(format(b.p, 12), format(a.p, 12));
+        assert.strictEqual(format(b.info, 12), format(a.info, 12));
+      });
+    });
+
+    it('compiles each build once and instantiates a shared wasmModule', function () {
+      return catirt_load({simd: false}).then(function(first) {
+        assert.ok(first.wasmModule instanceof WebAssembly.Module);
+
+        return Promise.all([
+          catirt_load({simd: false}),
+          catirt_load({simd: false, wasmModule: first.wasmModule}),
+          catirt_load.compile({simd: false})
+        ]).then(function(res) {
+          const [again, shared, compiled] = res;
+          assert.strictEqual(again.wasmModule, first.wasmModule);
+          assert.strictEqual(shared.wasmModule, first.wasmModule);
+          assert.strictEqual(compiled, first.wasmModule);
+
+          // separate instances with their own memory
+          const a = first.createItemBank(items, 'brm');
+          const b = shared.createItemBank(items, 'brm');
+          assert.strictEqual(format(shared.wleEst_brm_one(uresp[0], b, range)), format(first.wleEst_brm_one(uresp[0], a, range)));
+          a.delete();
+          b.delete();
+        });
+      });
+    });
+
+    it('rejects an invalid or mismatched wasmModule', function () {
+      return catirt_load({wasmModule: new Uint8Array(8)}).then(function() {
+        assert.fail('expected a rejection');
+      }, function(err) {
+        assert.strictEqual(err.message, 'catirt_load wasmModule option must be a WebAssembly.Module');
+      }).then(function() {
+        if (typeof SharedArrayBuffer === 'undefined') {
+          return null;
+        }
+        return catirt_load.compile({simd: false}).then(function(scalar) {
+          return catirt_load({threads: 2, wasmModule: scalar});
+        }).then(function() {
+          assert.fail('expected a rejection');
+        }, function(err) {
+          assert.strictEqual(err.message, 'catirt_load wasmModule was not compiled from the catirt-threads build');
+        });
+      });
+    });
+
+    it('threaded build matches the serial wasm_wleEst exactly', function () {
+      if (typeof SharedArrayBuffer === 'undefined') {
+        this.skip();
+      }
+
+      // enough people to split across threads
+      const bigresp = [];
+      for (let i = 0; i < 200; i++) {
+        bigresp.push(uresp[i % 2].map((u, j) => ((i >> j) & 1) ? u : 1 - u));
+      }
+
+      return Promise.all([catirt_load({simd: true}), catirt_load({threads: 4})]).then(function(mods) {
+        const [serial, threaded] = mods;
+        assert.strictEqual(threaded.threads, 4);
+        assert.strictEqual(threaded.wasm_getNumThreads(), 4);
+
+        const run = function(m) {
+          const mResp = m.MatrixFromArray(bigresp);
+          const mParams = m.MatrixFromArray(itemparams);
+          const mRange = m.MatrixFromArray([range]);
+          const res = m.wasm_wleEst(mResp, mParams, mRange, m.ModelType.BRM);
+          const out = {theta: m.VectorToArray(res.theta), sem: m.VectorToArray(res.sem)};
+
+          // wasm heap cleanup
+          mResp.delete();
+          mParams.delete();
+          mRange.delete();
+          res.theta.delete();
+          res.info.delete();
+          res.sem.delete();
+          return out;
+        };
+
+        assert.deepStrictEqual(run(threaded), run(serial));
+      });
+    });
+  });
 });
@@ -157,6 +157,25 @@ describe('catIrt JS additions', function () {
       const res = catirtlib.wleEst_brm_one(uresp[0], itemparams.slice(1, 2), range);
       assert.strictEqual(format(res), format(expected));
     });
+
+    it('wleEst_brm_one(uresp, params, range, null, {solver: "newton"}) matches brent', function () {
+      for (const resp of uresp.slice(0, 4)) {
+        const brent = catirtlib.wleEst_brm_one(resp, itemparams, range);
+        const newton = catirtlib.wleEst_brm_one(resp, itemparams, range, null, {solver: 'newton'});
+        const warm = catirtlib.wleEst_brm_one(resp, itemparams, range, null, {solver: 'newton', start: brent.theta + 0.3});
+        assert.ok(Math.abs(newton.theta - brent.theta) <= 1e-4);
+        assert.ok(Math.abs(newton.sem - brent.sem) <= 1e-4);
+        assert.ok(Math.abs(warm.theta - newton.theta) <= 1e-6);
+      }
+    });
+
+    it('invalid solver options', function () {
+      let res = catirtlib.wleEst_brm_one(uresp[0], itemparams, range, null, {solver: 'secant'});
+      assert.strictEqual(format(res), format({error: 'invalid solver option'}));
+
+      res = catirtlib.wleEst_brm_one(uresp[0], itemparams, range, null, {solver: 'newton', start: NaN});
+      assert.strictEqual(format(res), format({error: 'invalid start option'}));
+    });
   });
 
   describe('wleEst_grm_one:', function () {
@@ -170,6 +189,15 @@ describe('catIrt JS additions', function () {
       assert.strictEqual(format(res), format(expected));
     });
 
+    it('wleEst_grm_one(uresp_grm, params, range, null, {solver: "newton"}) matches brent', function () {
+      for (const resp of uresp_grm) {
+        const brent = catirtlib.wleEst_grm_one(resp, itemparams, range);
+        const newton = catirtlib.wleEst_grm_one(resp, itemparams, range, null, {solver: 'newton', start: 0.0});
+        assert.ok(Math.abs(newton.theta - brent.theta) <= 1e-4);
+        assert.ok(Math.abs(newton.sem - brent.sem) <= 1e-4);
+      }
+    });
+
     it('invalid response: non-array or empty', function () {
       const expected = {
         error: 'response must be a non-empty array'
@@ -215,6 +243,141 @@ describe('catIrt JS additions', function () {
     });
   });
 
+  describe('wleEst_brm_batch:', function () {
+    it('wleEst_brm_batch(uresp, params, range) matches wleEst_brm_one per row', function () {
+      const res = catirtlib.wleEst_brm_batch(uresp, itemparams, range);
+      assert.ok(res.theta instanceof Float64Array && res.theta.length === uresp.length);
+      for (let i = 0; i < uresp.length; i++) {
+        const one = catirtlib.wleEst_brm_one(uresp[i], itemparams, range);
+        assert.strictEqual(format({theta: res.theta[i], info: res.info[i], sem: res.sem[i]}), format(one));
+      }
+    });
+
+    it('wleEst_brm_batch(flat, params, range, {mask}) skips masked responses', function () {
+      const flat = Float64Array.from([1, 1, 1, 0, 0, 0, 0, 1, 0, 1]);
+      const mask = [1, 1, 1, 1, 1, 0, 1, 0, 1, 1];
+      const res = catirtlib.wleEst_brm_batch(flat, itemparams, range, {mask: mask});
+      assert.strictEqual(format(res.theta[0]), format(0.02317778));
+      assert.strictEqual(format(res.theta[1]), format(catirtlib.wleEst_brm_one([NaN, 0, NaN, 0, 1], itemparams, range).theta));
+    });
+
+    it('wleEst_brm_batch scores a batch larger than the initial 16 MB heap', function () {
+      this.timeout(30000);
+      // 60000 people x 40 items of doubles is 19.2 MB, copied into the module before scoring
+      const N = 60000;
+      const params40 = [].concat(...Array(8).fill(itemparams));
+      const flat = new Float64Array(N * 40).fill(NaN);
+      for (let i = 0; i < N; i += 1000) {
+        for (let j = 0; j < 40; j++) {
+          flat[i * 40 + j] = uresp[(i / 1000) % 2][j % 5];
+        }
+      }
+
+      const res = catirtlib.wleEst_brm_batch(flat, params40, range);
+      assert.ok(!res.error, res.error);
+      assert.strictEqual(res.theta.length, N);
+      for (let i = 0; i < 2; i++) {
+        const one = catirtlib.wleEst_brm_one(Array.from(flat.subarray(i * 1000 * 40, (i * 1000 + 1) * 40)), params40, range);
+        assert.strictEqual(format(res.theta[i * 1000]), format(one.theta));
+      }
+      assert.strictEqual(res.theta[1], 0);
+      assert.ok(Number.isNaN(res.sem[1]));
+    });
+
+    it('wleEst_grm_batch(uresp_grm, params, range, {solver: "newton"}) matches brent', function () {
+      const brent = catirtlib.wleEst_grm_batch(uresp_grm, itemparams, range);
+      const newton = catirtlib.wleEst_grm_batch(uresp_grm, itemparams, range, {solver: 'newton', start: brent.theta});
+      for (let i = 0; i < uresp_grm.length; i++) {
+        assert.ok(Math.abs(newton.theta[i] - brent.theta[i]) <= 1e-4);
+      }
+    });
+
+    it('invalid batch arguments', function () {
+      let res = catirtlib.wleEst_brm_batch([[1, 0]], itemparams, range);
+      assert.strictEqual(format(res), format({error: 'response must be a 2D array or Float64Array with one column per item'}));
+
+      res = catirtlib.wleEst_brm_batch(uresp, itemparams, range, {mask: [1, 0]});
+      assert.strictEqual(format(res), format({error: 'mask must have one entry per response'}));
+
+      res = catirtlib.wleEst_brm_batch(uresp, itemparams, range, {start: [0]});
+      assert.strictEqual(format(res), format({error: 'start must have one entry per person'}));
+
+      res = catirtlib.wleEst_brm_batch(uresp, itemparams, range, {solver: 'secant'});
+      assert.strictEqual(format(res), format({error: 'invalid solver option'}));
+    });
+  });
+
+  describe('eapEst_brm_batch:', function () {
+    // posterior mean and sd of a N(0, 1) prior by the trapezoid rule on a fine grid
+    function eap_dense(resp, params) {
+      let s0 = 0, s1 = 0, s2 = 0;
+      for (let x = -8; x <= 8; x += 0.001) {
+        let w = Math.exp(-0.5 * x * x);
+        resp.forEach((u, j) => {
+          if (!Number.isNaN(u)) {
+            const [a, b, c] = params[j];
+            const p = c + (1 - c) / (1 + Math.exp(-a * (x - b)));
+            w *= (u === 1 ? p : 1 - p);
+          }
+        });
+        s0 += w;
+        s1 += w * x;
+        s2 += w * x * x;
+      }
+      return {theta: s1 / s0, sem: Math.sqrt(s2 / s0 - (s1 / s0) ** 2)};
+    }
+
+    it('eapEst_brm_batch(resp, params) matches a dense grid', function () {
+      const res = catirtlib.eapEst_brm_batch(uresp, itemparams, {points: 61});
+      for (let i = 0; i < 4; i++) {
+        const expected = eap_dense(uresp[i], itemparams);
+        assert.ok(Math.abs(res.theta[i] - expected.theta) < 1e-5);
+        assert.ok(Math.abs(res.sem[i] - expected.sem) < 1e-5);
+        assert.ok(Math.abs(res.info[i] - 1 / (res.sem[i] * res.sem[i])) < 1e-9);
+      }
+      // no responses: the prior
+      assert.ok(Math.abs(res.theta[4]) < 1e-12);
+      assert.ok(Math.abs(res.sem[4] - 1) < 1e-12);
+    });
+
+    it('eapEst_brm_batch(resp, params, {quad: "equal", prior}) accepts any prior', function () {
+      const normal = catirtlib.eapEst_brm_batch(uresp, itemparams, {quad: 'equal', points: 121, prior: {mean: 0.5, sd: 2}});
+      const fn = catirtlib.eapEst_brm_batch(uresp, itemparams, {quad: 'equal', points: 121, prior: x => Math.exp(-0.5 * ((x - 0.5) / 2) ** 2)});
+      const nodes = Array.from({length: 121}, (e, k) => -6 + 0.1 * k);
+      const table = catirtlib.eapEst_brm_batch(uresp, itemparams, {prior: {nodes: nodes, weights: nodes.map(x => Math.exp(-0.5 * ((x - 0.5) / 2) ** 2))}});
+      for (let i = 0; i < uresp.length; i++) {
+        assert.ok(Math.abs(fn.theta[i] - normal.theta[i]) < 1e-9);
+        assert.ok(Math.abs(table.theta[i] - normal.theta[i]) < 1e-9);
+      }
+    });
+
+    it('eapEst_grm_batch(flat, bank) matches params', function () {
+      const bank = catirtlib.createItemBank(items, 'grm');
+      const res = catirtlib.eapEst_grm_batch(Float64Array.from(uresp_grm.flat()), bank);
+      const expected = catirtlib.eapEst_grm_batch(uresp_grm, itemparams);
+      bank.delete();
+      assert.deepStrictEqual(Array.from(res.theta), Array.from(expected.theta));
+      assert.ok(expected.theta[1] > expected.theta[0]);
+    });
+
+    it('invalid eapEst_brm_batch arguments', function () {
+      let res = catirtlib.eapEst_brm_batch([[1, 0]], itemparams);
+      assert.strictEqual(format(res), format({error: 'response must be a 2D array or Float64Array with one column per item'}));
+
+      res = catirtlib.eapEst_brm_batch([[1, 0, 2, 0, 1]], itemparams);
+      assert.strictEqual(format(res), format({error: 'responses must be 0, 1, or NaN'}));
+
+      res = catirtlib.eapEst_brm_batch(uresp, itemparams, {quad: 'simpson'});
+      assert.strictEqual(format(res), format({error: 'invalid quad option'}));
+
+      res = catirtlib.eapEst_brm_batch(uresp, itemparams, {prior: {mean: 0, sd: 0}});
+      assert.strictEqual(format(res), format({error: 'invalid prior option'}));
+
+      res = catirtlib.eapEst_brm_batch(uresp, itemparams, {prior: x => 1});
+      assert.strictEqual(format(res), format({error: 'a prior function needs equally spaced nodes (quad: "equal")'}));
+    });
+  });
+
   describe('FI_brm_expected_one:', function () {
     it('FI_brm_expected_one(params, theta[0])', function () {
       const expected = {
@@ -359,6 +522,53 @@ describe('catIrt JS additions', function () {
       res = catirtlib.itChoose([{params:[1]}], 'grm', 'UW-FI', 'theta', {cat_theta: 0.0});
       assert.strictEqual(format(res), format(expected));
     });
+
+    // posterior-weighted information of the 3PL items of from_items given cat_par/cat_resp, by direct summation
+    function pw_fi(from_items, cat_par, cat_resp) {
+      const prob = ([a, b, c], x) => c + (1 - c) / (1 + Math.exp(-a * (x - b)));
+      const nodes = Array.from({length: 33}, (e, q) => -4.5 + 9 * q / 32);
+      let post = nodes.map(x => Math.exp(-0.5 * x * x) * cat_par.reduce((l, par, j) => l * (cat_resp[j] ? prob(par, x) : 1 - prob(par, x)), 1));
+      const total = post.reduce((a, b) => a + b);
+      post = post.map(w => w / total);
+      return from_items.map(item => {
+        const [a, b, c] = item.params;
+        return nodes.reduce((sum, x, q) => {
+          const p = prob(item.params, x);
+          return sum + post[q] * a * a * ((p - c) / (1 - c)) ** 2 * (1 - p) / p;
+        }, 0);
+      });
+    }
+
+    it('itChoose(items, "brm", "PW-FI", "theta", {cat_par, cat_resp})', function () {
+      const expected = pw_fi(items.slice(2), itemparams.slice(0, 2), [1, 0]);
+      const best = expected.indexOf(Math.max(...expected));
+      const res = catirtlib.itChoose(items.slice(2), 'brm', 'PW-FI', 'theta', {cat_par: itemparams.slice(0, 2), cat_resp: [1, 0], n_select: 1});
+      assert.strictEqual(res.items[0].id, items[2 + best].id);
+      assert.ok(Math.abs(res.items[0].info - expected[best]) < 1e-9);
+    });
+
+    it('itChoose(bank, "brm", "PW-KL", "theta", {cat_resp}) matches item arrays', function () {
+      const bank = catirtlib.createItemBank(items, 'brm', {quad_table: true});
+      const res = catirtlib.itChoose(bank, 'brm', 'PW-KL', 'theta', {cat_theta: 0.5, cat_resp: [1, 0, NaN, NaN, NaN], n_select: 3, numb: 3});
+      const arr = catirtlib.itChoose(items.slice(2), 'brm', 'PW-KL', 'theta', {cat_theta: 0.5, cat_par: itemparams.slice(0, 2), cat_resp: [1, 0], n_select: 3, numb: 3});
+      bank.delete();
+
+      assert.strictEqual(res.items.length, 3);
+      assert.ok(res.items.every(item => item.index >= 2 && item.info > 0));
+      const byId = Object.fromEntries(arr.items.map(item => [item.id, item.info]));
+      res.items.forEach(item => assert.ok(Math.abs(item.info - byId[item.id]) < 1e-12));
+    });
+
+    it('invalid posterior-weighted options', function () {
+      let res = catirtlib.itChoose(items, 'brm', 'UW-FI', 'theta', {cat_par: itemparams, cat_resp: [1, 0, 1, 0, 1]});
+      assert.strictEqual(format(res), format({error: 'non-null "cat_par" not used'}));
+
+      res = catirtlib.itChoose(items.slice(2), 'brm', 'PW-FI', 'theta', {cat_par: itemparams.slice(0, 2), cat_resp: [1]});
+      assert.strictEqual(format(res), format({error: '"cat_resp" must have one response per "cat_par" item'}));
+
+      res = catirtlib.itChoose(items, 'brm', 'PW-FI', 'theta', {quad: 1});
+      assert.strictEqual(format(res), format({error: '"quad" must be an integer from 2 to 1000'}));
+    });
   });
 
   describe('termGLR_one:', function () {
@@ -403,5 +613,334 @@ describe('catIrt JS additions', function () {
       const res = catirtlib.termGLR_one(itemparams, uresp[4], 'brm', {categories:[0,1], bounds:[0], delta:0.5, alpha:0.1, beta:0.1});
       assert.strictEqual(format(res), format(expected));
     });
+
+    it('termGLR_batch(params, uresp, "brm", options) matches termGLR_one per row', function () {
+      const options = {categories:[0,1], bounds:[0], delta:0.5, alpha:0.1, beta:0.1};
+      const res = catirtlib.termGLR_batch(itemparams, uresp, 'brm', options);
+      assert.strictEqual(res.category.length, uresp.length);
+      for (let i = 0; i < uresp.length; i++) {
+        const one = catirtlib.termGLR_one(itemparams, uresp[i], 'brm', options);
+        assert.strictEqual(format({category: res.category[i], likratio: res.likratio[i]}), format(one));
+      }
+    });
+
+    it('termGLR_batch(params, uresp_grm, "grm", options)', function () {
+      const res = catirtlib.termGLR_batch(itemparams, uresp_grm, 'grm', {categories:[0,1,2], delta:0.5, alpha:0.1, beta:0.1});
+      assert.deepStrictEqual(res.category, [1, null]);
+      assert.strictEqual(res.likratio.length, 4);
+    });
+
+    it('invalid termGLR_batch arguments', function () {
+      let res = catirtlib.termGLR_batch(itemparams, [[1, 0]], 'brm');
+      assert.strictEqual(format(res), format({error: 'resp must be a 2D array or Float64Array with one column per item'}));
+
+      res = catirtlib.termGLR_batch(itemparams, uresp, 'brm', {bounds: [0, 1]});
+      assert.strictEqual(format(res), format({error: 'invalid bounds option'}));
+    });
+  });
+
+  describe('ItemBank:', function () {
+    let bank_brm = null;
+    let bank_grm = null;
+
+    before('creating item banks', function () {
+      bank_brm = catirtlib.createItemBank(items, 'brm');
+      bank_grm = catirtlib.createItemBank(items, 'grm');
+    });
+
+    after('deleting item banks', function () {
+      bank_brm.delete();
+      bank_grm.delete();
+    });
+
+    it('createItemBank(items, "brm")', function () {
+      assert.strictEqual(bank_brm.size(), 5);
+      assert.strictEqual(bank_brm.categories(), 2);
+      assert.strictEqual(bank_brm.id(3), 'item4');
+      assert.strictEqual(bank_grm.categories(), 3);
+    });
+
+    it('invalid items: non-array or bad params', function () {
+      let res = catirtlib.createItemBank([], 'brm');
+      assert.strictEqual(format(res), format({error: 'items must be a non-empty array'}));
+
+      res = catirtlib.createItemBank([{id: 'a', params: [1, 0]}], 'brm');
+      assert.strictEqual(format(res), format({error: 'params must have length 3 for brm model'}));
+
+      res = catirtlib.createItemBank([{id: 'a', params: [1, 0, 0]}, {id: 'b', params: [1, NaN, 0]}], 'brm');
+      assert.strictEqual(format(res), format({error: 'params must be finite numbers of the same length for every item'}));
+    });
+
+    it('wleEst_brm_one(resp, bank) matches wleEst_brm_one(resp, params)', function () {
+      const expected = {
+        theta: 0.02317778,
+        info: 3.341271,
+        sem: 0.5543441
+      };
+      let res = catirtlib.wleEst_brm_one(uresp[0], bank_brm, range);
+      assert.strictEqual(format(res), format(expected));
+
+      // only administered items, by index
+      const resp = [NaN, 1, NaN, 0, 0];
+      res = catirtlib.wleEst_brm_one([1, 0, 0], bank_brm, range, [1, 3, 4]);
+      assert.strictEqual(format(res), format(catirtlib.wleEst_brm_one(resp, itemparams, range)));
+      res = catirtlib.wleEst_brm_one(resp, bank_brm, range);
+      assert.strictEqual(format(res), format(catirtlib.wleEst_brm_one(resp, itemparams, range)));
+
+      // nothing administered
+      res = catirtlib.wleEst_brm_one(uresp[4], bank_brm, range);
+      assert.strictEqual(format(res), format({theta: 0, info: NaN, sem: NaN}));
+
+      // warm-started newton solver
+      res = catirtlib.wleEst_brm_one(uresp[0], bank_brm, range, null, {solver: 'newton', start: 0.5});
+      assert.ok(Math.abs(res.theta - expected.theta) <= 1e-4);
+      assert.ok(Math.abs(res.sem - expected.sem) <= 1e-4);
+    });
+
+    it('wleEst_brm_batch(uresp, bank) matches wleEst_brm_batch(uresp, params)', function () {
+      const res = catirtlib.wleEst_brm_batch(uresp, bank_brm, range);
+      assert.strictEqual(format(res), format(catirtlib.wleEst_brm_batch(uresp, itemparams, range)));
+
+      assert.strictEqual(format(catirtlib.wleEst_grm_batch(uresp, bank_brm, range)), format({error: 'item bank model must be grm'}));
+    });
+
+    it('termGLR_one(bank, resp, "brm") matches termGLR_one(params, resp, "brm")', function () {
+      const options = {categories:[0,1], bounds:[0], delta:0.5, alpha:0.1, beta:0.1};
+      for (const resp of uresp) {
+        const res = catirtlib.termGLR_one(bank_brm, resp, 'brm', options);
+        assert.strictEqual(format(res), format(catirtlib.termGLR_one(itemparams, resp, 'brm', options)));
+      }
+    });
+
+    it('wleEst_grm_one(resp, bank) matches wleEst_grm_one(resp, params)', function () {
+      const expected = {
+        theta: -0.3175944,
+        info: 6.011785,
+        sem: 0.4098758
+      };
+      const res = catirtlib.wleEst_grm_one(uresp_grm[0], bank_grm, range);
+      assert.strictEqual(format(res), format(expected));
+    });
+
+    it('invalid response: length or model mismatch', function () {
+      let res = catirtlib.wleEst_brm_one([1, 0], bank_brm, range);
+      assert.strictEqual(format(res), format({error: 'length of response must match size of item bank'}));
+
+      res = catirtlib.wleEst_grm_one(uresp_grm[0], bank_brm, range);
+      assert.strictEqual(format(res), format({error: 'item bank model must be grm'}));
+    });
+
+    it('FI_brm_expected_one(bank, theta[0], exclude)', function () {
+      const expected = {
+        item: [0.4144132, NaN, 0.1230584, 0.02053748, NaN],
+        test: 0.4144132 + 0.1230584 + 0.02053748,
+        sem: 1 / Math.sqrt(0.4144132 + 0.1230584 + 0.02053748)
+      };
+      let res = catirtlib.FI_brm_expected_one(bank_brm, theta[0], [1, 4]);
+      assert.strictEqual(format({item: Array.from(res.item), test: res.test, sem: res.sem}), format(expected));
+
+      // same exclusions as a mask
+      res = catirtlib.FI_brm_expected_one(bank_brm, theta[0], [false, true, false, false, true]);
+      assert.strictEqual(format({item: Array.from(res.item), test: res.test, sem: res.sem}), format(expected));
+    });
+
+    it('FI_grm_expected_one(bank, theta[0])', function () {
+      const expected = {
+        item: [0.5979150, 0.5026771, 0.3045263, 0.1180620, 0.09919267],
+        test: 1.622373,
+        sem: 0.7850994
+      };
+      const res = catirtlib.FI_grm_expected_one(bank_grm, theta[0]);
+      assert.strictEqual(format({item: Array.from(res.item), test: res.test, sem: res.sem}), format(expected));
+    });
+
+    it('itChoose(bank, "brm", "UW-FI", "theta", {cat_theta=0.0, exclude})', function () {
+      let res = catirtlib.itChoose(bank_brm, 'brm', 'UW-FI', 'theta', {cat_theta: 0.0});
+      assert.strictEqual(format(res), format({items: [{id: 'item2', params: [3.02, -0.38, 0.12], info: 1.41394, index: 1}]}));
+
+      res = catirtlib.itChoose(bank_brm, 'brm', 'UW-FI', 'theta', {cat_theta: 0.0, exclude: [1]});
+      assert.strictEqual(format(res), format({items: [{id: 'item3', params: [1.9, -0.1, 0.12], info: 0.7160209, index: 2}]}));
+    });
+
+    it('itChoose(bank, "brm", "UW-FI-Modified", "theta", {cat_theta=0.0, phase1_params=bank, phase1_est_theta=0.0})', function () {
+      const res = catirtlib.itChoose(bank_brm, 'brm', 'UW-FI-Modified', 'theta', {cat_theta: 0.0, phase1_params: bank_brm, phase1_est_theta: 0.0});
+      assert.strictEqual(format(res), format({items: [{id: 'item4', params: [2.06, 0.41, 0.12], info: 0.3777282, index: 3}]}));
+    });
+
+    it('itChoose(bank, "grm", "UW-FI", "theta", {cat_theta=2.0, exclude})', function () {
+      const res = catirtlib.itChoose(bank_grm, 'grm', 'UW-FI', 'theta', {cat_theta: 2.0, exclude: [4]});
+      assert.strictEqual(format(res), format({items: [{id: 'item1', params: [1.55, -1.88, 0.12], info: 0.1172978, index: 0}]}));
+    });
+
+    it('itChoose(bank, "brm", "UW-FI", "theta", {cat_theta=0.0, n_select=3, numb=2, seed})', function () {
+      const first = catirtlib.itChoose(bank_brm, 'brm', 'UW-FI', 'theta', {cat_theta: 0.0, n_select: 3, numb: 2, seed: 7});
+      const again = catirtlib.itChoose(bank_brm, 'brm', 'UW-FI', 'theta', {cat_theta: 0.0, n_select: 3, numb: 2, seed: 7});
+      assert.strictEqual(format(again), format(first));
+      assert.strictEqual(first.items.length, 2);
+      for (const item of first.items) {
+        assert.ok([0, 1, 2].includes(item.index));
+      }
+
+      const res = catirtlib.itChoose(bank_brm, 'brm', 'UW-FI', 'theta', {cat_theta: 0.0, n_select: 3, numb: 2, exclude: [0, 1, 2, 4]});
+      assert.strictEqual(format(res), format({items: [{id: 'item4', params: [2.06, 0.41, 0.12], info: 0.613692, index: 3}]}));
+    });
+
+    it('createCatSession(bank): addResponse, estimate, nextItem', function () {
+      const session = catirtlib.createCatSession(bank_brm);
+
+      assert.strictEqual(format(session.estimate()), format({theta: 0, info: NaN, sem: NaN}));
+      assert.strictEqual(session.nextItem(1, 1).items[0], 1);
+
+      for (let i = 0; i < items.length; i++) {
+        assert.strictEqual(session.addResponse(i, uresp[0][i]), null);
+      }
+      const est = session.estimate();
+      assert.ok(Math.abs(est.theta - 0.02317778) <= 1e-4);
+      assert.ok(Math.abs(est.sem - 0.5543441) <= 1e-4);
+      assert.strictEqual(session.nextItem(1, 1).items.length, 0);
+
+      assert.strictEqual(format(session.addResponse(0, 1)), format({error: 'CatSession item already administered'}));
+      assert.strictEqual(format(session.nextItem(0, 1)), format({error: 'n_select and numb must be positive'}));
+      session.delete();
+    });
+
+    it('restoreCatSession(bank, session.serialize()) resumes a session', function () {
+      const session = catirtlib.createCatSession(bank_brm, {range: [-3, 3]});
+      session.addResponse(3, 0);
+      session.addResponse(1, 1);
+      const est = session.estimate();
+
+      const blob = session.serialize();
+      assert.ok(blob instanceof Uint8Array);
+      assert.strictEqual(blob.length, 64 + 2 * 3);
+
+      const resumed = catirtlib.restoreCatSession(bank_brm, blob);
+      assert.deepStrictEqual(Array.from(resumed.items()), [3, 1]);
+      assert.strictEqual(format(resumed.estimate()), format(est));
+      assert.strictEqual(resumed.nextItem(1, 1).items[0], session.nextItem(1, 1).items[0]);
+
+      let res = catirtlib.restoreCatSession(bank_grm, blob);
+      assert.strictEqual(format(res), format({error: 'CatSession deserialize item bank mismatch'}));
+      const other = catirtlib.createItemBank(items.map(item => ({id: item.id, params: [item.params[0] + 0.1, item.params[1], item.params[2]]})), 'brm');
+      res = catirtlib.restoreCatSession(other, blob);
+      assert.strictEqual(format(res), format({error: 'CatSession deserialize item bank mismatch'}));
+      other.delete();
+      res = catirtlib.restoreCatSession(bank_brm, blob.slice(0, 20));
+      assert.strictEqual(format(res), format({error: 'CatSession deserialize not a serialized session'}));
+      res = catirtlib.createCatSession(bank_brm, {range: [0, 3]});
+      assert.strictEqual(format(res), format({error: 'invalid range option'}));
+
+      session.delete();
+      resumed.delete();
+    });
+
+    it('createItemBank(items, model, {info_table: true}) interpolates within tol', function () {
+      const tab_brm = catirtlib.createItemBank(items, 'brm', {info_table: true, tol: 1e-6, phase1_params: bank_brm, phase1_est_theta: 0.0});
+      const tab_grm = catirtlib.createItemBank(items, 'grm', {info_table: true, interp: 'linear', tol: 1e-4});
+
+      assert.ok(tab_brm.hasInfoTable());
+      assert.ok(tab_brm.infoTableError() <= 1e-6);
+      assert.ok(!bank_brm.hasInfoTable());
+
+      for (const th of [-4.9, -1.3, 0.0, 0.777, 3.2]) {
+        const exact = catirtlib.FI_brm_expected_one(bank_brm, th).item;
+        const approx = catirtlib.FI_brm_expected_one(tab_brm, th).item;
+        const exact_grm = catirtlib.FI_grm_expected_one(bank_grm, th).item;
+        const approx_grm = catirtlib.FI_grm_expected_one(tab_grm, th).item;
+        for (let i = 0; i < items.length; i++) {
+          assert.ok(Math.abs(approx[i] - exact[i]) <= 1e-6);
+          assert.ok(Math.abs(approx_grm[i] - exact_grm[i]) <= 1e-4);
+        }
+      }
+
+      // same selections as the exact bank
+      let res = catirtlib.itChoose(tab_brm, 'brm', 'UW-FI', 'theta', {cat_theta: 0.0, exclude: [1]});
+      assert.strictEqual(format(res, 4), format({items: [{id: 'item3', params: [1.9, -0.1, 0.12], info: 0.7160209, index: 2}]}, 4));
+      res = catirtlib.itChoose(tab_brm, 'brm', 'UW-FI-Modified', 'theta', {cat_theta: 0.0, phase1_params: bank_brm, phase1_est_theta: 0.0});
+      assert.strictEqual(format(res, 4), format({items: [{id: 'item4', params: [2.06, 0.41, 0.12], info: 0.3777282, index: 3}]}, 4));
+
+      tab_brm.delete();
+      tab_grm.delete();
+    });
+
+    it('createItemBank(items, model, {precision: \'float32\'}) stays within the float budget', function () {
+      const f32_brm = catirtlib.createItemBank(items, 'brm', {precision: 'float32'});
+      const f32_grm = catirtlib.createItemBank(items, 'grm', {precision: 'float32', info_table: true});
+
+      assert.strictEqual(f32_brm.precision(), catirtlib.Precision.FLOAT32);
+      assert.strictEqual(bank_brm.precision(), catirtlib.Precision.FLOAT64);
+
+      for (const th of [-4.9, -1.3, 0.0, 0.777, 3.2]) {
+        const exact = catirtlib.FI_brm_expected_one(bank_brm, th).item;
+        const approx = catirtlib.FI_brm_expected_one(f32_brm, th).item;
+        const exact_grm = catirtlib.FI_grm_expected_one(bank_grm, th).item;
+        const approx_grm = catirtlib.FI_grm_expected_one(f32_grm, th).item;
+        for (let i = 0; i < items.length; i++) {
+          assert.ok(Math.abs(approx[i] - exact[i]) <= 1e-5);
+          assert.ok(Math.abs(approx_grm[i] - exact_grm[i]) <= 1e-5);
+        }
+      }
+
+      // scoring is unaffected
+      const resp = [1, 1, 1, 0, 0];
+      assert.strictEqual(format(catirtlib.wleEst_brm_one(resp, f32_brm, range)), format(catirtlib.wleEst_brm_one(resp, bank_brm, range)));
+
+      f32_brm.delete();
+      f32_grm.delete();
+    });
+
+    it('loadItemBank(bank.serialize()) round-trips the bank', function () {
+      const tab_grm = catirtlib.createItemBank(items, 'grm', {info_table: true, precision: 'float32'});
+      const blob = tab_grm.serialize();
+      assert.ok(blob instanceof Uint8Array);
+
+      const loaded = catirtlib.loadItemBank(blob);
+      assert.strictEqual(loaded.size(), 5);
+      assert.strictEqual(loaded.model(), catirtlib.ModelType.GRM);
+      assert.strictEqual(loaded.id(3), 'item4');
+      assert.strictEqual(loaded.precision(), catirtlib.Precision.FLOAT32);
+      assert.ok(loaded.hasInfoTable());
+      assert.deepStrictEqual(loaded.items.map(item => item.params), items.map(item => item.params));
+      assert.deepStrictEqual(catirtlib.FI_grm_expected_one(loaded, 0.777).item, catirtlib.FI_grm_expected_one(tab_grm, 0.777).item);
+      assert.deepStrictEqual(loaded.serialize(), blob);
+
+      const chosen = catirtlib.itChoose(loaded, 'grm', 'UW-FI', 'theta', {cat_theta: -1.3, exclude: [0]});
+      assert.strictEqual(chosen.items[0].id, catirtlib.itChoose(tab_grm, 'grm', 'UW-FI', 'theta', {cat_theta: -1.3, exclude: [0]}).items[0].id);
+
+      // the blob is copied once into the module, and the items are read from the bank rather than the blob
+      catirtlib.wasm_resetStats();
+      const scratch = blob.slice();
+      const reloaded = catirtlib.loadItemBank(scratch);
+      assert.strictEqual(catirtlib.wasm_getStats().bytes_in, blob.length);
+      scratch.fill(0);
+      assert.deepStrictEqual(reloaded.items.map(item => item.params), items.map(item => item.params));
+      assert.deepStrictEqual(Array.from(reloaded.params()), items.flatMap(item => item.params));
+      reloaded.delete();
+
+      // an ArrayBuffer works too, and errors leave nothing allocated
+      const copy = catirtlib.loadItemBank(blob.slice().buffer);
+      assert.strictEqual(copy.id(0), 'item1');
+      blob[4] = 99;
+      assert.strictEqual(format(catirtlib.loadItemBank(blob)), format({error: 'ItemBank deserialize unsupported version'}));
+      assert.strictEqual(format(catirtlib.loadItemBank([1, 2, 3])), format({error: 'blob must be a Uint8Array'}));
+
+      tab_grm.delete();
+      loaded.delete();
+      copy.delete();
+    });
+
+    it('invalid info table options', function () {
+      let res = catirtlib.createItemBank(items, 'brm', {info_table: true, interp: 'quintic'});
+      assert.strictEqual(format(res), format({error: 'invalid interp option'}));
+
+      res = catirtlib.createItemBank(items, 'brm', {precision: 'float16'});
+      assert.strictEqual(format(res), format({error: 'invalid precision option'}));
+
+      res = catirtlib.createItemBank(items, 'brm', {info_table: true, tol: 0});
+      assert.strictEqual(format(res), format({error: 'invalid tol option'}));
+
+      res = catirtlib.createItemBank(items, 'brm', {phase1_params: bank_brm});
+      assert.strictEqual(format(res), format({error: 'phase1_params and phase1_est_theta must both be null or both be set'}));
+    });
   });
 });
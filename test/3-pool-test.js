@@ -0,0 +1,168 @@
+'use strict';
+const catirt_load = require('../dist/catirt');
+const mathjs = require('mathjs');
+const assert = require('assert').strict;
+let catirtlib = {};
+let pool = null;
+
+// helper function for converting values to a fixed precision string for simple comparison
+function format(a, precision=6) {
+  return mathjs.format(a, {precision});
+}
+
+describe('catIrt worker pool', function () {
+  // setup data
+  const range = [-4.5, 4.5];
+  const uresp = [
+      [1, 1, 1, 0, 0],
+      [0, 0, 1, 0, 1]
+  ];
+  const items = [
+    {id: 'item1', params: [1.55,-1.88,0.12]},
+    {id: 'item2', params: [3.02,-0.38,0.12]},
+    {id: 'item3', params: [1.9,-0.1,0.12]},
+    {id: 'item4', params: [2.06,0.41,0.12]},
+    {id: 'item5', params: [1.48,0.72,0.12]}
+  ];
+  const itemparams = items.map(item => item.params);
+
+  // load wasm and start the pool (asynchronous)
+  before('loading catirtlib wasm module and pool', function() {
+    return catirt_load().then(function(Module) {
+      catirtlib = Module;
+      return catirt_load.createPool({size: 2});
+    }).then(function(p) {
+      pool = p;
+      return pool.addBank('brm', items, 'brm');
+    }).then(function(res) {
+      assert.strictEqual(res, null);
+    });
+  });
+
+  after('closing the pool', function() {
+    return pool.close();
+  });
+
+  describe('pooled functions:', function () {
+    it('match the synchronous API', function () {
+      const bank = catirtlib.createItemBank(items, 'brm');
+      const opts = {cat_theta: 0.3, exclude: [0, 2]};
+
+      return Promise.all([
+        pool.wleEst_brm_one(uresp[0], itemparams, range),
+        pool.wleEst_brm_one(uresp[1], pool.bank('brm'), range),
+        pool.itChoose(pool.bank('brm'), 'brm', 'UW-FI', 'theta', opts),
+        pool.termGLR_one(itemparams, uresp[0], 'brm', {categories: [0, 1], delta: 0.5})
+      ]).then(function(res) {
+        assert.strictEqual(format(res[0]), format(catirtlib.wleEst_brm_one(uresp[0], itemparams, range)));
+        assert.strictEqual(format(res[1]), format(catirtlib.wleEst_brm_one(uresp[1], bank, range)));
+        assert.deepStrictEqual(res[2].items.map(item => item.index), catirtlib.itChoose(bank, 'brm', 'UW-FI', 'theta', opts).items.map(item => item.index));
+        assert.deepStrictEqual(res[3], catirtlib.termGLR_one(itemparams, uresp[0], 'brm', {categories: [0, 1], delta: 0.5}));
+        bank.delete();
+      });
+    });
+
+    it('spreads a burst over the workers and keeps keyed calls on one worker', function () {
+      const burst = [];
+      for (let i = 0; i < 20; i++) {
+        burst.push(pool.call('wleEst_brm_one', [uresp[i % 2], pool.bank('brm'), range], {key: (i < 10 ? 'a' : null)}));
+      }
+      return Promise.all(burst).then(function(res) {
+        for (let i = 0; i < 20; i++) {
+          assert.strictEqual(format(res[i]), format(res[i % 2]));
+        }
+        assert.strictEqual(pool.pending(), 0);
+      });
+    });
+
+    it('banks load from the binary format', function () {
+      const bank = catirtlib.createItemBank(items, 'grm', {info_table: true});
+      return pool.addBank('grm', bank.serialize()).then(function(res) {
+        assert.strictEqual(res, null);
+        return pool.FI_grm_expected_one(pool.bank('grm'), 0.777);
+      }).then(function(res) {
+        assert.deepStrictEqual(res.item, catirtlib.FI_grm_expected_one(bank, 0.777).item);
+        bank.delete();
+        return pool.deleteBank('grm');
+      });
+    });
+
+    it('invalid banks and functions', function () {
+      return pool.addBank('bad', [], 'brm').then(function(res) {
+        assert.strictEqual(format(res), format({error: 'items must be a non-empty array'}));
+        return pool.wleEst_brm_one(uresp[0], pool.bank('bad'), range);
+      }).then(function() {
+        assert.fail('expected a rejection');
+      }, function(err) {
+        assert.strictEqual(err.message, 'catirt pool unknown bank "bad"');
+        return pool.call('MatrixFromArray', [[[1]]]);
+      }).then(function() {
+        assert.fail('expected a rejection');
+      }, function(err) {
+        assert.strictEqual(err.message, 'catirt pool unsupported function "MatrixFromArray"');
+      });
+    });
+  });
+
+  describe('pooled sessions:', function () {
+    it('createSession: steps run on the worker holding the session', function () {
+      const bank = catirtlib.createItemBank(items, 'brm');
+      const local = catirtlib.createCatSession(bank);
+      let session = null;
+
+      return pool.createSession(pool.bank('brm')).then(function(s) {
+        session = s;
+        let steps = Promise.resolve(null);
+        for (let i = 0; i < items.length; i++) {
+          local.addResponse(i, uresp[0][i]);
+          steps = steps.then(() => session.addResponse(i, uresp[0][i]));
+        }
+        return steps;
+      }).then(function(res) {
+        assert.strictEqual(res, null);
+        return Promise.all([session.estimate(), session.serialize()]);
+      }).then(function(res) {
+        assert.strictEqual(format(res[0]), format(local.estimate()));
+        assert.deepStrictEqual(res[1], local.serialize());
+        return pool.restoreSession(pool.bank('brm'), res[1]);
+      }).then(function(resumed) {
+        return resumed.items().then(function(res) {
+          assert.deepStrictEqual(Array.from(res), [0, 1, 2, 3, 4]);
+          return resumed.delete();
+        });
+      }).then(function() {
+        return session.delete();
+      }).then(function() {
+        return session.estimate();
+      }).then(function() {
+        assert.fail('expected a rejection');
+      }, function(err) {
+        assert.strictEqual(err.message, 'catirt pool session is closed or lost');
+        local.delete();
+        bank.delete();
+      });
+    });
+  });
+
+  describe('backpressure:', function () {
+    it('rejects calls beyond max_queue', function () {
+      return catirt_load.createPool({size: 1, max_queue: 1}).then(function(small) {
+        return small.addBank('brm', items, 'brm').then(function() {
+          const calls = [0, 1, 2].map(i => small.wleEst_brm_one(uresp[i % 2], small.bank('brm'), range).then(() => 'ok', err => err.message));
+          return Promise.all(calls);
+        }).then(function(res) {
+          assert.deepStrictEqual(res, ['ok', 'ok', 'catirt pool queue is full']);
+          return small.close();
+        });
+      });
+    });
+
+    it('invalid pool options', function () {
+      return catirt_load.createPool({size: 0}).then(function() {
+        assert.fail('expected a rejection');
+      }, function(err) {
+        assert.strictEqual(err.message, 'catirt pool size must be a positive integer');
+      });
+    });
+  });
+});
@@ -0,0 +1,385 @@
+// Native microbenchmarks for the catirt core kernels
+//
+// Sweeps people x items x categories: the MOCCA test length and bank (40 and 360 BRM items)
+// and larger synthetic banks, with GRM at 3 and 5 categories. Item parameters and responses are
+// drawn from fixed seeds (mt19937_64 with its own uniform mapping, so native and WASM builds see
+// the same data). Results are written as JSON: median and min ns/op over the timed batches,
+// ns per person-item, and heap allocations (malloc calls, all threads) per op.
+//
+// build: cmake -S . -B build -DCATIRT_BUILD_BENCH=ON && cmake --build build
+// run:   ./build/catirt_bench [--quick] [--filter text] [--min-time ms] [--threads n] [--out file]
+// wasm:  npm run bench:wasm (this file compiled with emcc and run under node)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "catirt.h"
+#include "itembank.h"
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/heap.h>
+#endif
+
+#ifndef CATIRT_VERSION
+#define CATIRT_VERSION "unknown"
+#endif
+
+static const uint64_t SEED = 20240611;
+static const int BATCHES = 5;
+
+//
+// malloc counter: replaces malloc() and forwards to the C library allocator
+//
+static std::atomic<long> mallocs{0};
+
+#if defined(__EMSCRIPTEN__)
+#define CATIRT_BENCH_ALLOCS 1
+extern "C" void *malloc(size_t n)
+{
+  mallocs.fetch_add(1, std::memory_order_relaxed);
+  return emscripten_builtin_malloc(n);
+}
+#elif defined(__GLIBC__)
+#define CATIRT_BENCH_ALLOCS 1
+extern "C" void *__libc_malloc(size_t n);
+extern "C" void *malloc(size_t n)
+{
+  mallocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(n);
+}
+#else
+#define CATIRT_BENCH_ALLOCS 0
+#endif
+
+// results are summed into sink so the kernels cannot be optimized away
+static volatile double sink = 0;
+
+//
+// synthetic data
+//
+
+// uniform [0, 1) from the top 53 bits (std::uniform_real_distribution differs between libraries)
+static double uniform(std::mt19937_64& rng)
+{
+  return (rng() >> 11) * 0x1.0p-53;
+}
+
+// M items: a ~ U(0.4, 2.5); BRM b ~ U(-3, 3), c ~ U(0, 0.25); GRM K-1 increasing boundaries from U(-2.5, -1.5)
+static ArrayXXd make_params(ModelType model, int M, int K)
+{
+  std::mt19937_64 rng(SEED + 1000 * M + K);
+  ArrayXXd params(M, model == ModelType::BRM ? 3 : K);
+
+  for (int j = 0; j < M; j++) {
+    params(j, 0) = 0.4 + 2.1 * uniform(rng);
+    if (model == ModelType::BRM) {
+      params(j, 1) = -3 + 6 * uniform(rng);
+      params(j, 2) = 0.25 * uniform(rng);
+    } else {
+      double b = -2.5 + uniform(rng);
+      for (int k = 1; k < K; k++) {
+        params(j, k) = b;
+        b += 0.3 + uniform(rng);
+      }
+    }
+  }
+  return params;
+}
+
+// N abilities ~ U(-2.5, 2.5)
+static ArrayXd make_theta(int N)
+{
+  std::mt19937_64 rng(SEED + 7 * N);
+  ArrayXd theta(N);
+
+  for (int i = 0; i < N; i++) {
+    theta(i) = -2.5 + 5 * uniform(rng);
+  }
+  return theta;
+}
+
+// N x M responses simulated from the model at theta (0/1 for BRM, 1..K for GRM)
+static ArrayXXd make_resp(ModelType model, const ArrayXd& theta, const ArrayXXd& params, int K)
+{
+  std::mt19937_64 rng(SEED + 31 * theta.size() + params.rows());
+  const int N = (int)theta.size(), M = (int)params.rows();
+  ArrayXXd resp(N, M);
+
+  if (model == ModelType::BRM) {
+    ArrayXXd p = p_brm(theta, params);
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < M; j++) {
+        resp(i, j) = uniform(rng) < p(i, j) ? 1 : 0;
+      }
+    }
+  } else {
+    // p_grm rows are person-major blocks of K categories
+    ArrayXXd p = p_grm(theta, params);
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < M; j++) {
+        double u = uniform(rng), cum = 0;
+        int k = 0;
+        while (k < K - 1 && (cum += p(i * K + k, j)) <= u) {
+          k++;
+        }
+        resp(i, j) = k + 1;
+      }
+    }
+  }
+  return resp;
+}
+
+//
+// cases
+//
+struct Case
+{
+  std::string kernel;
+  std::string model;
+  int people;
+  int items;
+  int categories;
+  std::function<double()> run;
+};
+
+struct Timing
+{
+  double median_ns;
+  double min_ns;
+  double allocs;  // malloc calls per op, NaN if not counted
+  long reps;      // ops per timed batch
+};
+
+static double batch_seconds(const Case& c, long reps)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  double s = 0;
+
+  for (long r = 0; r < reps; r++) {
+    s += c.run();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  sink = sink + s;
+  return std::chrono::duration<double>(t1 - t0).count();
+}
+
+// one warm-up op, then enough ops per batch for min_time / BATCHES, timed BATCHES times
+static Timing measure(const Case& c, double min_time)
+{
+  Timing t;
+  const double batch_time = min_time / BATCHES;
+  long reps = 1;
+  double secs = batch_seconds(c, 1);
+
+  while (secs < batch_time && reps < (1L << 30)) {
+    reps = secs > 0 ? std::max(reps * 2, (long)(reps * 1.2 * batch_time / secs)) : reps * 10;
+    secs = batch_seconds(c, reps);
+  }
+
+  std::vector<double> ns;
+  long before = mallocs.load();
+  for (int b = 0; b < BATCHES; b++) {
+    ns.push_back(1e9 * batch_seconds(c, reps) / reps);
+  }
+  long after = mallocs.load();
+
+  std::sort(ns.begin(), ns.end());
+  t.median_ns = ns[BATCHES / 2];
+  t.min_ns = ns[0];
+  t.allocs = CATIRT_BENCH_ALLOCS ? (double)(after - before) / (reps * BATCHES) : NAN;
+  t.reps = reps;
+  return t;
+}
+
+static const RowVector2d RANGE(-4.5, 4.5);
+
+// kernels of one model at people x items (x categories)
+static void add_cases(std::vector<Case>& cases, ModelType model, int N, int M, int K)
+{
+  const bool brm = model == ModelType::BRM;
+  const std::string name = brm ? "brm" : "grm";
+  auto theta = std::make_shared<ArrayXd>(make_theta(N));
+  auto params = std::make_shared<ArrayXXd>(make_params(model, M, K));
+  auto resp = std::make_shared<ArrayXXd>(make_resp(model, *theta, *params, K));
+  auto lder1 = brm ? lder1_brm : lder1_grm;
+  auto quad = std::make_shared<Quadrature>(quadrature(QuadType::GAUSS_HERMITE, 41));
+
+  auto add = [&](const char *kernel, std::function<double()> run) {
+    cases.push_back(Case{kernel, name, N, M, K, run});
+  };
+
+  if (brm) {
+    add("p", [=]() { return p_brm(*theta, *params)(0, 0); });
+    add("pder1", [=]() { return pder1_brm(*theta, *params)(0, 0); });
+    add("pder2", [=]() { return pder2_brm(*theta, *params)(0, 0); });
+    add("lder2", [=]() { return lder2_brm(*resp, *theta, *params)(0, 0); });
+    add("logLik", [=]() { return logLik_brm(*resp, *theta, *params)(0); });
+    add("FI_expected", [=]() { return FI_brm(*params, *theta, FIType::EXPECTED, ArrayXXd()).test(0); });
+    add("FI_observed", [=]() { return FI_brm(*params, *theta, FIType::OBSERVED, *resp).test(0); });
+  } else {
+    add("p", [=]() { return p_grm(*theta, *params)(0, 0); });
+    add("pder1", [=]() { return pder1_grm(*theta, *params)(0, 0); });
+    add("pder2", [=]() { return pder2_grm(*theta, *params)(0, 0); });
+    add("lder2", [=]() { return lder2_grm(*resp, *theta, *params)(0, 0); });
+    add("logLik", [=]() { return logLik_grm(*resp, *theta, *params)(0); });
+    add("FI_expected", [=]() { return FI_grm(*params, *theta, FIType::EXPECTED, ArrayXXd()).test(0); });
+    add("FI_observed", [=]() { return FI_grm(*params, *theta, FIType::OBSERVED, *resp).test(0); });
+  }
+  add("lder1_wle", [=]() { return lder1(*resp, *theta, *params, LderType::WLE)(0); });
+
+  // root finding and item selection are per person
+  if (N == 1) {
+    add("uniroot_lder1", [=]() { return uniroot_lder1(lder1, RANGE, *resp, *params, LderType::WLE).root; });
+
+    // selection from a bank in which the first 20 items (at most half) were answered
+    auto bank = std::make_shared<ItemBank>(*params, model);
+    auto answered = std::make_shared<ArrayXd>(ArrayXd::Constant(M, NAN));
+    auto exclude = std::make_shared<std::vector<uint8_t>>(M, 0);
+    for (int j = 0; j < std::min(20, M / 2); j++) {
+      (*answered)(j) = (*resp)(0, j);
+      (*exclude)[j] = 1;
+    }
+    bank->buildQuadTable(quadrature(QuadType::EQUAL, 33, 0, 1, RowVector2d(-4, 4)));
+    bank->seed(SEED);
+    auto choice = std::make_shared<Choose_Result>();
+    add("itChoose_uwfi", [=]() { bank->itChoose(0.1, *exclude, 1, 1, *choice); return (double)choice->items[0]; });
+    add("itChoose_pwfi", [=]() { bank->itChoose_posterior(SelectType::PW_FI, 0.1, *answered, *exclude, 1, 1, *choice); return (double)choice->items[0]; });
+    add("itChoose_pwkl", [=]() { bank->itChoose_posterior(SelectType::PW_KL, 0.1, *answered, *exclude, 1, 1, *choice); return (double)choice->items[0]; });
+
+    // cold start of a bank with an info table: tabulating it vs loading the binary format
+    ItemBank tab(*params, model);
+    tab.buildInfoTable();
+    auto blob = std::make_shared<std::vector<uint8_t>>(tab.serialize());
+    add("bank_build", [=]() { ItemBank b(*params, model); b.buildInfoTable(); return b.infoTableError(); });
+    add("bank_deserialize", [=]() { ItemBank b; b.deserialize(blob->data(), blob->size()); return b.infoTableError(); });
+  }
+  add("wleEst_brent", [=]() { return wleEst(*resp, *params, RANGE, model).theta(0); });
+
+  // Newton from the estimates off by 0.3, as from the previous estimate of a CAT step (the Brent
+  // search for 3PL and GRM items, so also on the BRM items without guessing, where it is kept)
+  auto start = std::make_shared<ArrayXd>(wleEst(*resp, *params, RANGE, model).theta + 0.3);
+  add("wleEst_newton_warm", [=]() { return wleEst(*resp, *params, RANGE, model, SolverType::NEWTON, *start).theta(0); });
+  if (model == ModelType::BRM) {
+    auto params_2pl = std::make_shared<ArrayXXd>(*params);
+    params_2pl->col(2) = 0;
+    auto start_2pl = std::make_shared<ArrayXd>(wleEst(*resp, *params_2pl, RANGE, model).theta + 0.3);
+    add("wleEst_brent_2pl", [=]() { return wleEst(*resp, *params_2pl, RANGE, model).theta(0); });
+    add("wleEst_newton_warm_2pl", [=]() { return wleEst(*resp, *params_2pl, RANGE, model, SolverType::NEWTON, *start_2pl).theta(0); });
+  }
+  add("eapEst_gh41", [=]() { return eapEst(*resp, *params, model, *quad).theta(0); });
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage: catirt_bench [--quick] [--filter text] [--min-time ms] [--threads n] [--out file]\n"
+                  "  --quick      smaller sweep and 50 ms per case\n"
+                  "  --filter     only cases whose name (kernel/model/NxMxK) contains text\n"
+                  "  --min-time   timed milliseconds per case (default 250)\n"
+                  "  --threads    setNumThreads(n) for the batch kernels\n"
+                  "  --out        write the JSON to file instead of stdout\n");
+}
+
+int main(int argc, char **argv)
+{
+  bool quick = false;
+  double min_time = 0.25;
+  const char *filter = nullptr;
+  const char *out = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+
+    if (!strcmp(argv[i], "--quick")) {
+      quick = true;
+      min_time = 0.05;
+    } else if (!strcmp(argv[i], "--filter") && has_value) {
+      filter = argv[++i];
+    } else if (!strcmp(argv[i], "--min-time") && has_value) {
+      min_time = atof(argv[++i]) / 1000;
+    } else if (!strcmp(argv[i], "--threads") && has_value) {
+      setNumThreads(atoi(argv[++i]));
+    } else if (!strcmp(argv[i], "--out") && has_value) {
+      out = argv[++i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  // people x items: one person (a CAT step) to a scoring batch; a CAT test, the MOCCA bank, a large bank
+  const std::vector<int> people = quick ? std::vector<int>{1, 100} : std::vector<int>{1, 100, 1000};
+  const std::vector<int> items = quick ? std::vector<int>{40, 360} : std::vector<int>{40, 360, 2000};
+  const std::vector<int> categories = quick ? std::vector<int>{3} : std::vector<int>{3, 5};
+
+  std::vector<Case> cases;
+  for (int N : people) {
+    for (int M : items) {
+      add_cases(cases, ModelType::BRM, N, M, 2);
+      for (int K : categories) {
+        add_cases(cases, ModelType::GRM, N, M, K);
+      }
+    }
+  }
+
+  FILE *f = out ? fopen(out, "w") : stdout;
+  if (!f) {
+    fprintf(stderr, "catirt_bench: cannot write %s\n", out);
+    return 1;
+  }
+
+#if defined(CATIRT_SIMD) || defined(__wasm_simd128__)
+  const bool simd = true;
+#else
+  const bool simd = false;
+#endif
+#ifdef __EMSCRIPTEN__
+  const char *platform = "wasm";
+#else
+  const char *platform = "native";
+#endif
+
+  fprintf(f, "{\n  \"schema\": \"catirt-bench/1\",\n  \"version\": \"%s\",\n", CATIRT_VERSION);
+  fprintf(f, "  \"build\": {\"platform\": \"%s\", \"simd\": %s, \"threads\": %d, \"allocs_counted\": %s},\n",
+          platform, simd ? "true" : "false", getNumThreads(), CATIRT_BENCH_ALLOCS ? "true" : "false");
+  fprintf(f, "  \"seed\": %llu,\n  \"min_time_ms\": %g,\n  \"results\": [", (unsigned long long)SEED, min_time * 1000);
+
+  int n = 0;
+  for (const Case& c : cases) {
+    char label[128];
+    snprintf(label, sizeof(label), "%s/%s/%dx%dx%d", c.kernel.c_str(), c.model.c_str(), c.people, c.items, c.categories);
+    if (filter && !strstr(label, filter)) {
+      continue;
+    }
+
+    Timing t = measure(c, min_time);
+    char allocs[32];
+    if (std::isnan(t.allocs)) {
+      snprintf(allocs, sizeof(allocs), "null");
+    } else {
+      snprintf(allocs, sizeof(allocs), "%.2f", t.allocs);
+    }
+
+    fprintf(f, "%s\n    {\"name\": \"%s\", \"kernel\": \"%s\", \"model\": \"%s\", \"people\": %d, \"items\": %d, \"categories\": %d, "
+               "\"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f, \"ns_per_item\": %.3f, \"allocs_per_op\": %s, \"reps\": %ld}",
+            n++ ? "," : "", label, c.kernel.c_str(), c.model.c_str(), c.people, c.items, c.categories,
+            t.median_ns, t.min_ns, t.median_ns / ((double)c.people * c.items), allocs, t.reps);
+    fflush(f);
+    if (out) {
+      fprintf(stderr, "%-32s %12.0f ns/op %8s allocs/op\n", label, t.median_ns, allocs);
+    }
+  }
+  fprintf(f, "\n  ]\n}\n");
+
+  if (out) {
+    fclose(f);
+  }
+  return 0;
+}
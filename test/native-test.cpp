@@ -0,0 +1,1101 @@
+// Native unit tests for the catirt core library
+//
+// Expected values match the R equivalents used by 1-webasm-test.js
+//
+// run via: cmake -S . -B build && cmake --build build && ctest --test-dir build
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "catirt.h"
+#include "itembank.h"
+#include "catsession.h"
+#include "simulate.h"
+#include "catirt_kernels.h"
+#include "catirt_parallel.h"
+#include "workspace.h"
+
+static int failures = 0;
+
+//
+// malloc counter (as in native-bench.cpp): replaces malloc() and forwards to the C library allocator
+//
+static std::atomic<long> mallocs{0};
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define CATIRT_TEST_ALLOCS 1
+extern "C" void *__libc_malloc(size_t n);
+extern "C" void *malloc(size_t n)
+{
+  mallocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(n);
+}
+#else
+#define CATIRT_TEST_ALLOCS 0
+#endif
+
+// heap allocations made by a second run of f (the first warms the workspaces)
+template <typename F>
+static long allocs(F &&f)
+{
+  f();
+  long before = mallocs.load();
+  f();
+  return mallocs.load() - before;
+}
+
+// compare to 7 significant digits; NaN only matches NaN
+static void check(const char *name, double actual, double expected, double rel_tol=2e-6)
+{
+  bool ok;
+
+  if (std::isnan(expected)) {
+    ok = std::isnan(actual);
+  } else {
+    ok = fabs(actual - expected) <= rel_tol * std::max(fabs(expected), 1e-3);
+  }
+
+  if (!ok) {
+    printf("FAIL %s: expected %.9g, actual %.9g\n", name, expected, actual);
+    failures++;
+  }
+}
+
+int main()
+{
+  // setup data
+  const RowVector2d range(-4.5, 4.5);
+  ArrayXd theta(2);
+  ArrayXXd params(5, 3);
+  ArrayXXd uresp(2, 5);
+  ArrayXXd uresp_grm(2, 5);
+  ArrayXXd none(0, 0);
+
+  theta << -1.3, 1.3;
+  params << 1.55, -1.88, 0.12,
+            3.02, -0.38, 0.12,
+            1.9,  -0.1,  0.12,
+            2.06,  0.41, 0.12,
+            1.48,  0.72, 0.12;
+  uresp << 1, 1, 1, 0, 0,
+           0, 0, 1, 0, 1;
+  uresp_grm << 1, 2, 1, 3, 1,
+               2, 1, 3, 3, 2;
+
+  // p_brm, pder1_brm, pder2_brm
+  ArrayXXd m = p_brm(theta, params);
+  check("p_brm[0,0]", m(0, 0), 0.7454547);
+  check("p_brm[1,4]", m(1, 4), 0.7380471);
+  m = pder1_brm(theta, params);
+  check("pder1_brm[1,3]", m(1, 3), 0.21542517);
+  m = pder2_brm(theta, params);
+  check("pder2_brm[0,1]", m(0, 1), 0.39034545);
+  check("pder2_brm[1,4]", m(1, 4), -0.16306764);
+
+  // p_grm, pder1_grm, pder2_grm
+  m = p_grm(theta, params);
+  check("p_grm[4,4]", m(4, 4), -0.14917190);
+  m = pder1_grm(theta, params);
+  check("pder1_grm[5,2]", m(5, 2), 0.16495372);
+  m = pder2_grm(theta, params);
+  check("pder2_grm[1,0]", m(1, 0), -0.38078685);
+
+  // fixed-K GRM kernels (K = 2 .. GRM_MAX_FIXED_K) match the runtime-K fallback
+  {
+    ArrayXXd p4(2, 4), p7(2, 7);
+    p4 << 1.2, -1.0, 0.1, 1.3,
+          0.8, -0.4, 0.5, 2.0;
+    p7 << 1.2, -2.0, -1.0, -0.2, 0.4, 1.1, 1.9,
+          0.8, -1.5, -0.9, 0.0, 0.3, 1.0, 2.4;
+    GRM_Point sel, sel_dyn;
+    double info, h, info_dyn, h_dyn;
+
+    grm_item_sums<4>(0.3, p4, 1, 2, sel, info, h);
+    grm_item_sums<Eigen::Dynamic>(0.3, p4, 1, 2, sel_dyn, info_dyn, h_dyn);
+    check("grm_item_sums fixed K info", info, info_dyn, 0);
+    check("grm_item_sums fixed K pder1", sel.pder1, sel_dyn.pder1, 0);
+    check("grm_wle_item fixed K h_d1", grm_wle_item<4>(0.3, p4, 0, 3).h_d1, grm_wle_item(0.3, p4, 0, 3).h_d1, 0);
+
+    ArrayXXd P7 = p_grm(theta, p7);
+    check("p_grm K=7 categories sum to 1", P7.block(7, 1, 7, 1).sum(), 1, 1e-12);
+    check("pder1_grm K=7 derivatives sum to 0", pder1_grm(theta, p7).block(0, 0, 7, 1).sum(), 0, 1e-9);
+    check("sel_prm K=7", sel_prm(P7, uresp_grm.leftCols(2), 7)(1, 0), P7(7 + 1, 0), 0);
+  }
+
+  // lder1_brm, lder1_grm
+  ArrayXd v = lder1_brm(uresp, theta, params, LderType::MLE);
+  check("lder1_brm MLE[0]", v(0), 1.797812);
+  check("lder1_brm MLE[1]", v(1), -5.838820);
+  v = lder1_brm(uresp, theta, params, LderType::WLE);
+  check("lder1_brm WLE[0]", v(0), 2.067604);
+  check("lder1_brm WLE[1]", v(1), -6.474561);
+  v = lder1_grm(uresp_grm, theta, params, LderType::MLE);
+  check("lder1_grm MLE[0]", v(0), 3.408681);
+  check("lder1_grm MLE[1]", v(1), -4.796249);
+  v = lder1_grm(uresp_grm, theta, params, LderType::WLE);
+  check("lder1_grm WLE[0]", v(0), 4.048207);
+  check("lder1_grm WLE[1]", v(1), -5.598181);
+
+  // lder2_brm, lder2_grm
+  m = lder2_brm(uresp, theta, params);
+  check("lder2_brm[0,1]", m(0, 1), 1.54763399);
+  check("lder2_brm[1,3]", m(1, 3), -0.5042907);
+  m = lder2_grm(uresp_grm, theta, params);
+  check("lder2_grm[0,0]", m(0, 0), -0.4939227);
+  check("lder2_grm[1,4]", m(1, 4), -0.73490795);
+
+  // logLik_brm, logLik_grm
+  v = logLik_brm(uresp, theta, params);
+  check("logLik_brm[0]", v(0), -3.992064);
+  check("logLik_brm[1]", v(1), -12.744254);
+  v = logLik_brm(uresp.row(0), theta, params);
+  check("logLik_brm(u[0], theta)[1]", v(1), -3.520212);
+  v = logLik_grm(uresp_grm, theta, params);
+  check("logLik_grm[0]", v(0), -7.466321);
+  check("logLik_grm[1]", v(1), NAN);
+  v = logLik_grm(uresp_grm.row(0), theta, params);
+  check("logLik_grm(u[0], theta)[1]", v(1), -12.8073);
+
+  // streaming logLik: missing responses skipped, stable far from the item difficulty
+  {
+    ArrayXXd u_missing = uresp.row(0);
+    u_missing(0, 1) = NAN;
+    std::vector<int> sel = {0, 2, 3, 4};
+    ArrayXXd u_sub = uresp(Eigen::seqN(0, 1), sel);
+    ArrayXXd params_sub = params(sel, Eigen::all);
+    v = logLik_brm(u_missing, theta, params);
+    check("logLik_brm missing[0]", v(0), logLik_brm(u_sub, theta, params_sub)(0), 1e-12);
+    u_missing = uresp_grm.row(0);
+    u_missing(0, 1) = NAN;
+    u_sub = uresp_grm(Eigen::seqN(0, 1), sel);
+    v = logLik_grm(u_missing, theta, params);
+    check("logLik_grm missing[1]", v(1), logLik_grm(u_sub, theta, params_sub)(1), 1e-12);
+
+    ArrayXd far(1);
+    far << 50;
+    v = logLik_brm(ArrayXXd::Zero(1, 1), far, params.topRows(1));
+    check("logLik_brm far incorrect", v(0), log(0.88) - 1.55 * 51.88);
+  }
+
+  // FI_brm, FI_brm_modified_expected, FI_grm
+  FI_Result fi = FI_brm(params, theta, FIType::EXPECTED, none);
+  check("FI_brm EXPECTED item[0,0]", fi.item(0, 0), 0.4144132);
+  check("FI_brm EXPECTED test[1]", fi.test(1), 1.076034);
+  check("FI_brm EXPECTED sem[0]", fi.sem(0), 1.1665896);
+  fi = FI_brm(params, theta, FIType::OBSERVED, uresp);
+  check("FI_brm OBSERVED test[0]", fi.test(0), -1.535149);
+  check("FI_brm OBSERVED sem[0]", fi.sem(0), NAN);
+  check("FI_brm OBSERVED sem[1]", fi.sem(1), 0.9425437);
+  fi = FI_brm_modified_expected(params, theta, params, theta);
+  check("FI_brm_modified_expected item[1,0]", fi.item(1, 0), 9.518886e-05);
+  check("FI_brm_modified_expected test[0]", fi.test(0), 0.3679936);
+  fi = FI_grm(params, theta, FIType::EXPECTED, none);
+  check("FI_grm EXPECTED item[0,0]", fi.item(0, 0), 0.5979150);
+  check("FI_grm EXPECTED test[1]", fi.test(1), 1.420467);
+  fi = FI_grm(params, theta, FIType::OBSERVED, uresp_grm);
+  check("FI_grm OBSERVED test[0]", fi.test(0), 1.726979);
+  check("FI_grm OBSERVED test[1]", fi.test(1), 1.723618);
+
+  // uniroot_lder1
+  Uniroot_Result ur = uniroot_lder1(&lder1_brm, range, uresp.row(0), params, LderType::WLE);
+  check("uniroot_lder1 BRM[0] root", ur.root, 0.02317778);
+  check("uniroot_lder1 BRM[0] iter", ur.iter, 9);
+  ur = uniroot_lder1(&lder1_brm, range, uresp.row(1), params, LderType::WLE);
+  check("uniroot_lder1 BRM[1] root", ur.root, -2.286811);
+  check("uniroot_lder1 BRM[1] iter", ur.iter, 10);
+  ur = uniroot_lder1(&lder1_grm, range, uresp_grm.row(0), params, LderType::WLE);
+  check("uniroot_lder1 GRM[0] root", ur.root, -0.3175944);
+  check("uniroot_lder1 GRM[0] iter", ur.iter, 7);
+  ur = uniroot_lder1(&lder1_grm, range, uresp_grm.row(1), params, LderType::WLE);
+  check("uniroot_lder1 GRM[1] root", ur.root, -0.04421021);
+  check("uniroot_lder1 GRM[1] iter", ur.iter, 6);
+
+  // wleEst
+  Est_Result est = wleEst(uresp, params, range, ModelType::BRM);
+  check("wleEst BRM theta[0]", est.theta(0), 0.02317778);
+  check("wleEst BRM info[0]", est.info(0), 3.341271);
+  check("wleEst BRM sem[0]", est.sem(0), 0.5543441);
+  check("wleEst BRM theta[1]", est.theta(1), -2.28681109);
+  check("wleEst BRM info[1]", est.info(1), 0.1233062);
+  check("wleEst BRM sem[1]", est.sem(1), 3.5023960);
+  est = wleEst(uresp_grm, params, range, ModelType::GRM);
+  check("wleEst GRM theta[0]", est.theta(0), -0.3175944);
+  check("wleEst GRM info[0]", est.info(0), 6.011785);
+  check("wleEst GRM sem[0]", est.sem(0), 0.4098758);
+  check("wleEst GRM theta[1]", est.theta(1), -0.04421021);
+  check("wleEst GRM info[1]", est.info(1), 5.352786);
+  check("wleEst GRM sem[1]", est.sem(1), 0.4322895);
+
+  // Newton WLE solver: without a start, and for 3PL and GRM items, it is the Brent search;
+  // warm-started on 2PL items it finds the same root within tolerance in under half the passes
+  // over the items, and leaves scores with several roots to the Brent search
+  {
+    Est_Result brent = wleEst(uresp, params, range, ModelType::BRM);
+    Est_Result newton = wleEst(uresp, params, range, ModelType::BRM, SolverType::NEWTON, ArrayXd());
+    check("wleEst NEWTON cold BRM theta", (newton.theta == brent.theta).all(), 1, 0);
+    check("wleEst NEWTON cold BRM sem", (newton.sem == brent.sem).all(), 1, 0);
+
+    ArrayXd start(2);
+    start << 0.5, -2.0;
+    newton = wleEst(uresp, params, range, ModelType::BRM, SolverType::NEWTON, start);
+    check("wleEst NEWTON warm BRM theta", (newton.theta - brent.theta).abs().maxCoeff() <= 1e-4, 1, 0);
+    check("wleEst NEWTON warm BRM sem", (newton.sem - brent.sem).abs().maxCoeff() <= 1e-4, 1, 0);
+    brent = wleEst(uresp_grm, params, range, ModelType::GRM);
+    newton = wleEst(uresp_grm, params, range, ModelType::GRM, SolverType::NEWTON, brent.theta + 0.3);
+    check("wleEst NEWTON warm GRM theta", (newton.theta - brent.theta).abs().maxCoeff() <= 1e-4, 1, 0);
+    check("wleEst NEWTON warm GRM sem", (newton.sem - brent.sem).abs().maxCoeff() <= 1e-4, 1, 0);
+
+    // 3PL and GRM items: the Brent root from any start
+    for (int i = 0; i < 2; i++) {
+      for (ModelType type : {ModelType::BRM, ModelType::GRM}) {
+        const ArrayXXd& r = (type == ModelType::BRM ? uresp : uresp_grm);
+        WLE_Root b = wle_root(r.row(i), params, range, type, SolverType::BRENT, NAN);
+        WLE_Root cold = newton_wle(r.row(i), params, range, type);
+
+        check("newton_wle cold iter", cold.iter, b.iter, 0);
+        for (double start : {-3.0, -1.0, -0.85, 0.0, 1.0, 3.0}) {
+          check("newton_wle 3PL/GRM warm root", newton_wle(r.row(i), params, range, type, start).root, b.root, 0);
+        }
+      }
+    }
+
+    // 2PL bank of 40 items: passes over the items are Newton iter + 1 and one for the single root
+    // check; Brent 2 bracket ends + iter + 1 for the information
+    {
+      const int M = 40;
+      ArrayXXd params2pl(M, 3), r(2, M);
+      unsigned int seed = 4242;
+      auto unif = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) & 0xffff) / 65536.0; };
+
+      for (int j = 0; j < M; j++) {
+        params2pl.row(j) << 0.8 + 1.5 * unif(), -2.5 + 5 * unif(), 0;
+      }
+      for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < M; j++) {
+          r(i, j) = (unif() < 1 / (1 + exp(-params2pl(j, 0) * ((i ? 1.1 : -0.7) - params2pl(j, 1)))));
+        }
+      }
+      for (int i = 0; i < 2; i++) {
+        WLE_Root b = wle_root(r.row(i), params2pl, range, ModelType::BRM, SolverType::BRENT, NAN);
+        WLE_Root above = newton_wle(r.row(i), params2pl, range, ModelType::BRM, b.root + 0.3);
+        WLE_Root below = newton_wle(r.row(i), params2pl, range, ModelType::BRM, b.root - 0.3);
+        WLE_Root far = newton_wle(r.row(i), params2pl, range, ModelType::BRM, b.root - 2);
+
+        check("newton_wle 2PL warm root (above)", above.root, b.root, 1e-4);
+        check("newton_wle 2PL warm root (below)", below.root, b.root, 1e-4);
+        check("newton_wle 2PL far start root", far.root, b.root, 1e-4);
+        check("newton_wle warm passes (above)", 2 * (above.iter + 2) <= b.iter + 3, 1, 0);
+        check("newton_wle warm passes (below)", 2 * (below.iter + 2) <= b.iter + 3, 1, 0);
+      }
+    }
+
+    // scores with 3 roots: a start at any of them gives the Brent root (-1.352 for 2PL, -2.287 for 3PL)
+    {
+      ArrayXXd params2pl(3, 3), r(1, 3);
+      params2pl << 2.43,  0.35, 0,
+                   1.98, -2.36, 0,
+                   2.47, -1.96, 0;
+      r << 0, 1, 1;
+      WLE_Root b = wle_root(r, params2pl, range, ModelType::BRM, SolverType::BRENT, NAN);
+      check("newton_wle 2PL multiple roots brent", b.root, -1.3521, 1e-3);
+      for (double start : {-1.35, -0.7, -0.16}) {
+        check("newton_wle 2PL multiple roots", newton_wle(r, params2pl, range, ModelType::BRM, start).root, b.root, 0);
+      }
+
+      b = wle_root(uresp.row(1), params, range, ModelType::BRM, SolverType::BRENT, NAN);
+      check("newton_wle 3PL multiple roots brent", b.root, -2.2868, 1e-3);
+      for (double start : {-2.29, -1.2, -0.85}) {
+        check("newton_wle 3PL multiple roots", newton_wle(uresp.row(1), params, range, ModelType::BRM, start).root, b.root, 0);
+      }
+    }
+
+    // root (1.394) outside range: capped at the range end, as the Brent path
+    const RowVector2d narrow(-1, 1);
+    ArrayXXd all_correct = ArrayXXd::Ones(1, 5);
+    brent = wleEst(all_correct, params, narrow, ModelType::BRM);
+    WLE_Root root = newton_wle(all_correct, params, narrow, ModelType::BRM);
+    check("newton_wle capped root", root.root, brent.theta(0), 0);
+    check("newton_wle capped info", root.info, brent.info(0));
+    root = newton_wle(all_correct, params, narrow, ModelType::BRM, 0.0);
+    check("newton_wle start capped root", root.root, brent.theta(0), 0);
+  }
+
+  // wleEst_ragged: each row scored on its own administered items
+  {
+    ArrayXXd ragged(3, 5);
+    ragged << 1, NAN, 1, 0, NAN,
+              0, 0, 1, 0, 1,
+              NAN, NAN, NAN, NAN, NAN;
+    std::vector<uint8_t> mask = {1, 1, 1, 1, 1,
+                                 1, 1, 1, 0, 0,
+                                 1, 1, 1, 1, 1};
+    std::vector<int> sel0 = {0, 2, 3};
+    ArrayXXd resp0 = ragged(Eigen::seqN(0, 1), sel0);
+    ArrayXXd params0 = params(sel0, Eigen::all);
+    ArrayXXd resp1 = uresp.block(1, 0, 1, 3);
+    ArrayXXd params1 = params.topRows(3);
+
+    Est_Result ragged_est = wleEst_ragged(ragged, params, range, ModelType::BRM, mask);
+    Est_Result one = wleEst(resp0, params0, range, ModelType::BRM);
+    check("wleEst_ragged BRM theta[0]", ragged_est.theta(0), one.theta(0), 0);
+    check("wleEst_ragged BRM sem[0]", ragged_est.sem(0), one.sem(0), 0);
+    one = wleEst(resp1, params1, range, ModelType::BRM);
+    check("wleEst_ragged BRM masked theta[1]", ragged_est.theta(1), one.theta(0), 0);
+    check("wleEst_ragged BRM empty theta[2]", ragged_est.theta(2), 0, 0);
+    check("wleEst_ragged BRM empty sem[2]", ragged_est.sem(2), NAN);
+
+    // no mask, Newton solver: full rows match wleEst
+    ragged_est = wleEst_ragged(uresp_grm, params, range, ModelType::GRM, {}, SolverType::NEWTON);
+    est = wleEst(uresp_grm, params, range, ModelType::GRM);
+    check("wleEst_ragged GRM NEWTON theta", (ragged_est.theta - est.theta).abs().maxCoeff() <= 1e-4, 1, 0);
+  }
+
+  // termGLR: same classifications and ratios as the dense grid of termGLR_one
+  {
+    ArrayXXd glr_resp(5, 5);
+    ArrayXd bound(1), bounds_grm(2);
+    glr_resp << 1, 1, 1, 0, 0,
+                0, 0, 1, 0, 1,
+                0, 0, 0, 0, 0,
+                1, 1, 1, 1, 1,
+                NAN, NAN, NAN, NAN, NAN;
+    bound << 0;
+    bounds_grm << -1, 1;
+
+    GLR_Result glr = termGLR(glr_resp, params, ModelType::BRM, range, bound, 0.5, 0.1, 0.1);
+    check("termGLR BRM category[0]", glr.category(0), -1, 0);
+    check("termGLR BRM likratio[0]", glr.likratio(0, 0), 0.372872);
+    check("termGLR BRM category[1]", glr.category(1), 0, 0);
+    check("termGLR BRM likratio[1]", glr.likratio(1, 0), -3.97605);
+    check("termGLR BRM likratio[2]", glr.likratio(2, 0), -9.24777);
+    check("termGLR BRM category[3]", glr.category(3), 1, 0);
+    check("termGLR BRM likratio[3]", glr.likratio(3, 0), 4.58967);
+    check("termGLR BRM category[4]", glr.category(4), -1, 0);
+    check("termGLR BRM likratio[4]", glr.likratio(4, 0), NAN);
+
+    glr = termGLR(uresp_grm, params, ModelType::GRM, range, bounds_grm, 0.5, 0.1, 0.1);
+    check("termGLR GRM category[0]", glr.category(0), 1, 0);
+    check("termGLR GRM category[1]", glr.category(1), -1, 0);
+
+    // dense grid maximum on each side (the JS grid accumulates -0.5 to just below -0.5)
+    ArrayXd grid = ArrayXd::LinSpaced(901, -4.5, 4.5);
+    ArrayXd ll = logLik_brm(glr_resp.row(1), grid, params);
+    ArrayXd ll_lower = ll.head(401);
+    glr = termGLR(glr_resp.row(1), params, ModelType::BRM, range, bound, 0.5, 0.1, 0.1);
+    check("termGLR BRM dense likratio", glr.likratio(0, 0), ll.tail(400).maxCoeff() - ll_lower.maxCoeff(), 1e-9);
+  }
+
+  // ItemBank
+  {
+    ItemBank bank(params, ModelType::BRM, {"item1", "item2", "item3", "item4", "item5"});
+    ItemBank bank_grm(params, ModelType::GRM);
+    ArrayXd resp(5);
+
+    check("ItemBank size", bank.size(), 5);
+    check("ItemBank GRM categories", bank_grm.categories(), 3);
+    check("ItemBank id", bank.id(3) == "item4", 1, 0);
+
+    Est_Result best = bank.wleEst(uresp.row(0).transpose(), range);
+    check("ItemBank wleEst BRM theta", best.theta(0), 0.02317778);
+    best = bank.wleEst_ragged(uresp, range, {});
+    check("ItemBank wleEst_ragged BRM theta[1]", best.theta(1), -2.28681109);
+    check("ItemBank wleEst BRM sem", best.sem(0), 0.5543441);
+    best = bank_grm.wleEst(uresp_grm.row(0).transpose(), range);
+    check("ItemBank wleEst GRM theta", best.theta(0), -0.3175944);
+
+    // not administered items are skipped, and match the gathered params path
+    resp << NAN, 1, NAN, 0, 0;
+    ArrayXXd sub(3, 3);
+    sub << params.row(1), params.row(3), params.row(4);
+    ArrayXXd sub_resp(1, 3);
+    sub_resp << 1, 0, 0;
+    est = wleEst(sub_resp, sub, range, ModelType::BRM);
+    best = bank.wleEst(resp, range);
+    check("ItemBank wleEst NaN theta", best.theta(0), est.theta(0), 0);
+    check("ItemBank wleEst NaN info", best.info(0), est.info(0), 0);
+    resp.setConstant(NAN);
+    best = bank.wleEst(resp, range);
+    check("ItemBank wleEst empty theta", best.theta(0), 0);
+    check("ItemBank wleEst empty sem", best.sem(0), NAN);
+
+    ArrayXd binfo = bank.FI_expected(-1.3, {0, 1, 0, 0, 1});
+    check("ItemBank FI_expected[0]", binfo(0), 0.4144132);
+    check("ItemBank FI_expected[1]", binfo(1), NAN);
+    check("ItemBank FI_expected[3]", binfo(3), 0.02053748);
+    binfo = bank_grm.FI_expected(-1.3, {});
+    check("ItemBank GRM FI_expected[4]", binfo(4), 0.09919267);
+    binfo = bank.FI_modified_expected(0.0, bank, 0.0, {});
+    check("ItemBank FI_modified_expected[3]", binfo(3), 0.3777282);
+
+    // top-k selection skips excluded items, ties broken by lowest index
+    Choose_Result chosen = bank.itChoose(0.0, {0, 1, 0, 0, 0}, 1, 1);
+    check("ItemBank itChoose item", chosen.items[0], 2, 0);
+    check("ItemBank itChoose info", chosen.info[0], 0.7160209);
+    chosen = bank.itChoose(0.0, {}, 5, 5);
+    check("ItemBank itChoose all items", chosen.items.size(), 5, 0);
+    chosen = bank.itChoose(0.0, {1, 1, 1, 0, 1}, 3, 2);
+    check("ItemBank itChoose fewer candidates", chosen.items.size(), 1, 0);
+    check("ItemBank itChoose fewer candidates item", chosen.items[0], 3, 0);
+    chosen = bank.itChoose_modified(0.0, bank, 0.0, {}, 1, 1);
+    check("ItemBank itChoose_modified item", chosen.items[0], 3, 0);
+
+    // the same seed gives the same random picks
+    bank.seed(42);
+    Choose_Result pick1 = bank.itChoose(0.0, {}, 4, 3);
+    bank.seed(42);
+    Choose_Result pick2 = bank.itChoose(0.0, {}, 4, 3);
+    check("ItemBank itChoose seed", pick1.items == pick2.items, 1, 0);
+  }
+
+  // CatSession: incremental responses, estimates, selection, and serialized state
+  {
+    ItemBank bank(params, ModelType::BRM);
+    CatSession session(bank, range);
+    Est_Result sest = session.estimate();
+
+    check("CatSession empty theta", sest.theta(0), 0);
+    check("CatSession empty sem", sest.sem(0), NAN);
+    check("CatSession first item", session.nextItem().items[0], 1, 0);
+
+    for (int j = 0; j < 5; j++) {
+      session.addResponse(j, uresp(0, j));
+      sest = session.estimate();
+    }
+    est = wleEst(uresp.row(0), params, range, ModelType::BRM);
+    check("CatSession theta", fabs(sest.theta(0) - est.theta(0)) <= 1e-4, 1, 0);
+    check("CatSession sem", fabs(sest.sem(0) - est.sem(0)) <= 1e-4, 1, 0);
+    check("CatSession no items left", session.nextItem().items.size(), 0, 0);
+    check("CatSession already administered", session.checkResponse(2, 1) != nullptr, 1, 0);
+
+    CatSession partial(bank, range);
+    partial.addResponse(3, 0);
+    partial.addResponse(1, 1);
+    std::vector<uint8_t> blob = partial.serialize();
+    check("CatSession serialize size", blob.size(), CatSession::SERIAL_HEADER + 2 * 3, 0);
+
+    CatSession resumed(bank, range);
+    resumed.deserialize(blob);
+    check("CatSession resumed items", resumed.items() == partial.items(), 1, 0);
+    check("CatSession resumed theta", resumed.estimate().theta(0), partial.estimate().theta(0), 0);
+    check("CatSession resumed next item", resumed.nextItem().items[0], partial.nextItem().items[0], 0);
+
+    // same size and model, different parameters
+    ArrayXXd shifted = params;
+    shifted(2, 1) += 0.25;
+    ItemBank other(shifted, ModelType::BRM);
+    CatSession elsewhere(other, range);
+    check("ItemBank fingerprint differs", bank.fingerprint() != other.fingerprint(), 1, 0);
+    check("ItemBank fingerprint repeatable", bank.fingerprint() == ItemBank(params, ModelType::BRM).fingerprint(), 1, 0);
+    check("CatSession deserialize other bank", elsewhere.tryDeserialize(blob) != nullptr, 1, 0);
+
+    blob[CatSession::SERIAL_HEADER] = 7;  // item index beyond the bank
+    check("CatSession deserialize bad item", resumed.tryDeserialize(blob) != nullptr, 1, 0);
+    check("CatSession deserialize unchanged", resumed.size(), 2, 0);
+    blob.pop_back();
+    check("CatSession deserialize bad length", resumed.tryDeserialize(blob) != nullptr, 1, 0);
+  }
+
+  // CatSession estimates match a one-shot wleEst of the same history at every step: exactly on
+  // 3PL banks (whose scores can have several roots, e.g. row 1 of uresp), within tolerance on 2PL
+  {
+    const int M = 14;
+    unsigned int seed = 99;
+    auto unif = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) & 0xffff) / 65536.0; };
+    int mismatches = 0;
+
+    for (int b = 0; b < 40; b++) {
+      const bool guessing = (b % 2 == 0);
+      ArrayXXd bparams(M, 3);
+      ArrayXXd answers(1, M);
+      const double truth = -2.5 + 5 * unif();
+
+      for (int j = 0; j < M; j++) {
+        bparams.row(j) << 0.6 + 1.8 * unif(), -2.5 + 5 * unif(), (guessing ? 0.15 + 0.15 * unif() : 0);
+        const double p = bparams(j, 2) + (1 - bparams(j, 2)) / (1 + exp(-bparams(j, 0) * (truth - bparams(j, 1))));
+        answers(0, j) = (unif() < p);
+      }
+      ItemBank bbank(bparams, ModelType::BRM);
+      CatSession steps(bbank, range);
+      for (int n = 1; n <= M; n++) {
+        steps.addResponse(n - 1, answers(0, n - 1));
+        double theta = steps.estimate().theta(0);
+        double once = wleEst(answers.leftCols(n), bparams.topRows(n), range, ModelType::BRM).theta(0);
+        mismatches += (guessing ? theta != once : fabs(theta - once) > 1e-4);
+      }
+    }
+    check("CatSession estimates match wleEst", mismatches, 0, 0);
+
+    ItemBank bank(params, ModelType::BRM);
+    CatSession session(bank, range);
+    for (int j = 0; j < 5; j++) {
+      session.addResponse(j, uresp(1, j));
+      check("CatSession multiple roots estimate", session.estimate().theta(0),
+            wleEst(uresp.row(1).head(j + 1), params.topRows(j + 1), range, ModelType::BRM).theta(0), 0);
+    }
+  }
+
+  // InfoTable: interpolated expected information within the error bound
+  {
+    ItemBank bank(params, ModelType::BRM);
+    ItemBank bank_grm(params, ModelType::GRM);
+    ItemBank tab(params, ModelType::BRM);
+    ItemBank tab_lin(params, ModelType::BRM);
+    ItemBank tab_grm(params, ModelType::GRM);
+    double err = 0, err_lin = 0, err_grm = 0, err_mod = 0;
+
+    tab.buildInfoTable(InterpType::CUBIC, 1e-6);
+    tab_lin.buildInfoTable(InterpType::LINEAR, 1e-4);
+    tab_grm.buildInfoTable(InterpType::CUBIC, 1e-6);
+    tab.setPhase1(bank, 0.3);
+
+    for (double th = -6; th <= 6; th += 0.0137) {
+      err = std::max(err, (tab.FI_expected(th, {}) - bank.FI_expected(th, {})).abs().maxCoeff());
+      err_lin = std::max(err_lin, (tab_lin.FI_expected(th, {}) - bank.FI_expected(th, {})).abs().maxCoeff());
+      err_grm = std::max(err_grm, (tab_grm.FI_expected(th, {}) - bank_grm.FI_expected(th, {})).abs().maxCoeff());
+      err_mod = std::max(err_mod, (tab.FI_modified_expected(th, bank, 0.3, {}) - bank.FI_modified_expected(th, bank, 0.3, {})).abs().maxCoeff());
+    }
+    check("InfoTable BRM cubic error bound", err <= 1e-6, 1, 0);
+    check("InfoTable BRM linear error bound", err_lin <= 1e-4, 1, 0);
+    check("InfoTable GRM cubic error bound", err_grm <= 1e-6, 1, 0);
+    check("InfoTable BRM modified error bound", err_mod <= 1e-6, 1, 0);
+    check("InfoTable reported error", tab.infoTableError() <= 1e-6, 1, 0);
+    check("InfoTable FI_expected[0]", tab.FI_expected(-1.3, {0, 1, 0, 0, 1})(0), 0.4144132, 1e-5);
+    check("InfoTable FI_expected[1]", tab.FI_expected(-1.3, {0, 1, 0, 0, 1})(1), NAN);
+  }
+
+  // Precision::FLOAT32: selection information within the documented budget of the double path
+  {
+    ItemBank bank(params, ModelType::BRM);
+    ItemBank bank_grm(params, ModelType::GRM);
+    ItemBank f32(params, ModelType::BRM);
+    ItemBank f32_grm(params, ModelType::GRM);
+    ItemBank f32_tab(params, ModelType::BRM);
+    double err = 0, err_grm = 0, err_mod = 0, err_tab = 0;
+
+    f32.setPrecision(Precision::FLOAT32);
+    f32_grm.setPrecision(Precision::FLOAT32);
+    f32_tab.buildInfoTable(InterpType::CUBIC, 1e-6);
+    f32_tab.setPrecision(Precision::FLOAT32);
+
+    for (double th = -6; th <= 6; th += 0.0137) {
+      err = std::max(err, (f32.FI_expected(th, {}) - bank.FI_expected(th, {})).abs().maxCoeff());
+      err_grm = std::max(err_grm, (f32_grm.FI_expected(th, {}) - bank_grm.FI_expected(th, {})).abs().maxCoeff());
+      err_mod = std::max(err_mod, (f32.FI_modified_expected(th, f32, 0.3, {}) - bank.FI_modified_expected(th, bank, 0.3, {})).abs().maxCoeff());
+      err_tab = std::max(err_tab, (f32_tab.FI_expected(th, {}) - bank.FI_expected(th, {})).abs().maxCoeff());
+    }
+    check("FLOAT32 BRM information budget", err <= ItemBank::FLOAT32_INFO_ERROR, 1, 0);
+    check("FLOAT32 GRM information budget", err_grm <= ItemBank::FLOAT32_INFO_ERROR, 1, 0);
+    check("FLOAT32 BRM modified information budget", err_mod <= ItemBank::FLOAT32_INFO_ERROR, 1, 0);
+    check("FLOAT32 table rebuilt as float", f32_tab.hasInfoTable() && f32_tab.infoTableError() <= 1e-6, 1, 0);
+    check("FLOAT32 table information budget", err_tab <= ItemBank::FLOAT32_INFO_ERROR, 1, 0);
+
+    // the public InfoTable overloads on a float table
+    InfoTable table(params, ModelType::BRM, InterpType::CUBIC, 1e-6, -5.0, 5.0, 0.05, Precision::FLOAT32);
+    ArrayXd table_info = table.info(-1.3, {0, 1, 0, 0, 0}, ArrayXd());
+    check("FLOAT32 InfoTable info size", table_info.size(), 5, 0);
+    check("FLOAT32 InfoTable info[0]", fabs(table_info(0) - bank.FI_expected(-1.3, {})(0)) <= ItemBank::FLOAT32_INFO_ERROR, 1, 0);
+    check("FLOAT32 InfoTable info[1]", table_info(1), NAN);
+    check("FLOAT32 InfoTable outside grid", fabs(table.info(6.0, {}, ArrayXd())(4) - bank.FI_expected(6.0, {})(4)) <= 1e-12, 1, 0);
+    check("FLOAT32 itChoose item", f32.itChoose(-1.3, {}, 1, 1).items[0], bank.itChoose(-1.3, {}, 1, 1).items[0], 0);
+    check("FLOAT32 scoring stays double", f32.wleEst(uresp.row(0).transpose(), range).theta(0), bank.wleEst(uresp.row(0).transpose(), range).theta(0), 0);
+  }
+
+  // Workspace: once warm, CAT steps and selection make no heap allocations, and batch scoring
+  // allocates only its results, however many rows it has
+  if (CATIRT_TEST_ALLOCS) {
+    const int M = 200;
+    ArrayXXd big(M, 3);
+    for (int j = 0; j < M; j++) {
+      big.row(j) << 0.8 + 0.01 * (j % 50), -3 + 6.0 * j / M, 0.1;
+    }
+    ItemBank bank(big, ModelType::BRM);
+    ArrayXXd rows = ArrayXXd::Constant(100, M, NAN);
+    ArrayXXd full(100, 40), full_grm(100, 40);
+    std::vector<uint8_t> exclude(M, 0);
+    Choose_Result chosen;
+
+    for (int i = 0; i < 100; i++) {
+      for (int j = (i % 7); j < M; j += 7) {
+        rows(i, j) = (i + j / 7) % 2;
+      }
+      for (int j = 0; j < 40; j++) {
+        full(i, j) = (i * 3 + j) % 5 < 2;
+        full_grm(i, j) = 1 + (i + j) % 3;
+      }
+    }
+    for (int j = 0; j < M; j += 7) {
+      exclude[j] = 1;
+    }
+
+    // session storage has grown to 32 items after 17 responses: later steps reuse it
+    CatSession session(bank, range);
+    for (int k = 0; k < 20; k++) {
+      session.addResponse(session.nextItem().items[0], k % 2);
+    }
+    long mallocs_before = mallocs.load();
+    for (int k = 20; k < 30; k++) {
+      session.addResponse(session.nextItem().items[0], k % 2);
+      session.estimate();
+    }
+    check("CatSession steps mallocs", mallocs.load() - mallocs_before, 0, 0);
+    check("ItemBank itChoose mallocs", allocs([&]() { bank.itChoose(session.theta(), exclude, 5, 2, chosen); }), 0, 0);
+    check("Workspace itChoose reused result", chosen.items.size(), 2, 0);
+
+    setNumThreads(1);
+    ArrayXXd params40 = big.topRows(40), params40_grm(40, 3);
+    for (int j = 0; j < 40; j++) {
+      params40_grm.row(j) << params40(j, 0), params40(j, 1) / 2, params40(j, 1) / 2 + 1;
+    }
+    auto batch = [&](const ArrayXXd& resp, ModelType type, SolverType solver) {
+      return allocs([&]() { wleEst(resp, (type == ModelType::BRM ? params40 : params40_grm), range, type, solver, ArrayXd()); });
+    };
+    check("wleEst BRM mallocs per row", batch(full, ModelType::BRM, SolverType::BRENT), batch(full.topRows(1), ModelType::BRM, SolverType::BRENT), 0);
+    check("wleEst GRM mallocs per row", batch(full_grm, ModelType::GRM, SolverType::NEWTON), batch(full_grm.topRows(1), ModelType::GRM, SolverType::NEWTON), 0);
+    check("wleEst_ragged mallocs per row",
+          allocs([&]() { wleEst_ragged(rows, big, range, ModelType::BRM, {}, SolverType::BRENT); }),
+          allocs([&]() { wleEst_ragged(rows.topRows(1), big, range, ModelType::BRM, {}, SolverType::BRENT); }), 0);
+    ArrayXd one_item = ArrayXd::Constant(M, NAN);
+    ArrayXd many_items = rows.row(1).transpose();
+    one_item(3) = 1;
+    check("ItemBank wleEst mallocs per item",
+          allocs([&]() { bank.wleEst(many_items, range); }),
+          allocs([&]() { bank.wleEst(one_item, range); }), 0);
+    setNumThreads(0);
+  }
+
+  // performance counters (all 0 unless built with -DCATIRT_STATS=ON, times 0 unless -DCATIRT_STAT_TIMERS=ON)
+  {
+    resetStats();
+    wleEst(uresp, params, range, ModelType::BRM);
+    newton_wle(uresp.row(0), params, range, ModelType::BRM, 0.5);
+    FI_brm(params, theta, FIType::OBSERVED, uresp);
+
+    check("statName", std::string(statName(Stat::UNIROOT_MAXIT)) == "uniroot_maxit", 1, 0);
+    check("statName COUNT", std::string(statName(Stat::COUNT)).empty(), 1, 0);
+    if (statsEnabled()) {
+      check("stats wle calls", getStat(Stat::WLE_CALLS), 1, 0);
+      check("stats uniroot calls (Newton on 3PL items included)", getStat(Stat::UNIROOT_CALLS), 3, 0);
+      check("stats uniroot iterations", getStat(Stat::UNIROOT_ITERATIONS) >= 2, 1, 0);
+      check("stats uniroot maxit", getStat(Stat::UNIROOT_MAXIT), 0, 0);
+      check("stats newton calls", getStat(Stat::NEWTON_CALLS), 1, 0);
+      check("stats newton fallbacks (3PL items)", getStat(Stat::NEWTON_FALLBACKS), 1, 0);
+      check("stats FI calls (nested lder2 not counted)", getStat(Stat::FI_CALLS), 1, 0);
+      check("stats loglik calls", getStat(Stat::LOGLIK_CALLS), 0, 0);
+      check("stats wle time (timers only)", getStat(Stat::WLE_NS) > 0, statTimersEnabled(), 0);
+    } else {
+      check("stats disabled wle calls", getStat(Stat::WLE_CALLS), 0, 0);
+      check("stats disabled timers", statTimersEnabled(), 0, 0);
+    }
+    resetStats();
+    check("stats reset", getStat(Stat::WLE_CALLS), 0, 0);
+  }
+
+  // simulateCat
+  {
+    const int N = 300, M = 60;
+    ArrayXXd bparams(M, 3), gparams(M, 3);
+    ArrayXd truth(N);
+    unsigned int seed = 777;
+    auto unif = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) & 0xffff) / 65536.0; };
+
+    for (int j = 0; j < M; j++) {
+      bparams.row(j) << 0.8 + 1.5 * unif(), -2.5 + 5 * unif(), 0.15 * unif();
+      gparams(j, 0) = 0.8 + 1.5 * unif();
+      gparams(j, 1) = -2 + 1.5 * unif();
+      gparams(j, 2) = gparams(j, 1) + 0.5 + 1.5 * unif();
+    }
+    for (int i = 0; i < N; i++) {
+      truth(i) = -2 + 4 * unif();
+    }
+    ItemBank bbank(bparams, ModelType::BRM), gbank(gparams, ModelType::GRM);
+
+    Sim_Config cfg;
+    cfg.max_items = 30;
+    cfg.min_items = 5;
+    cfg.max_sem = 0.4;
+    cfg.n_select = 3;
+    cfg.seed = 42;
+
+    setNumThreads(1);
+    Sim_Result s1 = simulateCat(bbank, truth, cfg);
+    setNumThreads(4);
+    Sim_Result s4 = simulateCat(bbank, truth, cfg);
+    setNumThreads(0);
+
+    check("simulateCat threads theta", (s4.theta == s1.theta).all(), 1, 0);
+    check("simulateCat threads length", (s4.length == s1.length).all(), 1, 0);
+    check("simulateCat threads exposure", (s4.exposure == s1.exposure).all(), 1, 0);
+    check("simulateCat exposure total", s1.exposure.sum(), s1.length.sum(), 0);
+    check("simulateCat length bounds", (s1.length >= 5 && s1.length <= 30).all(), 1, 0);
+    check("simulateCat stop by sem", ((s1.stop != (int)StopReason::SEM) || (s1.sem <= 0.4)).all(), 1, 0);
+    check("simulateCat stop by max_items", ((s1.stop != (int)StopReason::MAX_ITEMS) || (s1.length == 30)).all(), 1, 0);
+    check("simulateCat recovers theta", (s1.theta - truth).abs().mean() < 0.45, 1, 0);
+
+    check("simulateCat default solver", cfg.solver == SolverType::BRENT, 1, 0);
+    Sim_Config ncfg = cfg;
+    ncfg.solver = SolverType::NEWTON;
+    Sim_Result sn = simulateCat(bbank, truth, ncfg);
+    check("simulateCat newton solver", (sn.theta - s1.theta).abs().maxCoeff(), 0, 1e-4);
+    check("simulateCat newton solver length", (sn.length == s1.length).all(), 1, 0);
+
+    cfg.seed = 43;
+    Sim_Result other = simulateCat(bbank, truth, cfg);
+    check("simulateCat seed changes responses", (other.theta != s1.theta).any(), 1, 0);
+
+    // fixed length GRM test through the whole bank
+    Sim_Config gcfg;
+    gcfg.max_items = 100;
+    Sim_Result g = simulateCat(gbank, truth.head(20), gcfg);
+    check("simulateCat GRM bank exhausted", (g.stop == (int)StopReason::BANK && g.length == M).all(), 1, 0);
+    check("simulateCat GRM exposure", (g.exposure == 20).all(), 1, 0);
+
+    // classification at 0 with termGLR
+    Sim_Config ccfg;
+    ccfg.bounds = ArrayXd::Constant(1, 0.0);
+    ccfg.min_items = 3;
+    Sim_Result c = simulateCat(bbank, truth, ccfg);
+    int correct = 0, classified = 0;
+    for (int i = 0; i < N; i++) {
+      if (c.stop(i) == (int)StopReason::GLR) {
+        classified++;
+        correct += (c.category(i) == (truth(i) > 0 ? 1 : 0));
+      }
+    }
+    check("simulateCat GLR classified", classified > N / 2, 1, 0);
+    check("simulateCat GLR accuracy", correct > 0.85 * classified, 1, 0);
+  }
+
+  // eapEst against a dense grid
+  {
+    const int N = 50, M = 12;
+    ArrayXXd bparams(M, 3), gparams(M, 4), bresp(N, M), gresp(N, M);
+    unsigned int seed = 2024;
+    auto unif = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) & 0xffff) / 65536.0; };
+
+    for (int j = 0; j < M; j++) {
+      bparams.row(j) << 0.8 + unif(), -2 + 4 * unif(), 0.2 * unif();
+      gparams(j, 0) = 0.8 + unif();
+      gparams(j, 1) = -2 + unif();
+      gparams(j, 2) = gparams(j, 1) + 0.5 + unif();
+      gparams(j, 3) = gparams(j, 2) + 0.5 + unif();
+    }
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < M; j++) {
+        bresp(i, j) = (unif() < 0.5) ? 1 : 0;
+        gresp(i, j) = 1 + (int)(4 * unif());
+      }
+    }
+    bresp(0, 3) = gresp(0, 5) = NAN;
+    bresp.row(1).setConstant(NAN);
+
+    Quadrature gh = quadrature(QuadType::GAUSS_HERMITE, 7, 0.5, 2);
+    check("quadrature GH weights", gh.weights.sum(), 1, 1e-12);
+    check("quadrature GH mean", (gh.weights * gh.nodes).sum(), 0.5, 1e-12);
+    check("quadrature GH variance", (gh.weights * (gh.nodes - 0.5).square()).sum(), 4, 1e-12);
+    check("quadrature GH kurtosis", (gh.weights * (gh.nodes - 0.5).pow(4)).sum(), 48, 1e-12);
+
+    // posterior moments by the trapezoid rule on a fine grid
+    ArrayXd grid = ArrayXd::LinSpaced(16001, -8, 8);
+    ArrayXd prior = (-0.5 * grid.square()).exp();
+    auto dense = [&](const ArrayXXd& resp, const ArrayXXd& params, ModelType type, int i, double& mean, double& sd) {
+      std::vector<int> items;
+      for (int j = 0; j < M; j++) {
+        if (!std::isnan(resp(i, j))) {
+          items.push_back(j);
+        }
+      }
+      ArrayXXd u(grid.size(), items.size()), p(items.size(), params.cols());
+      for (size_t k = 0; k < items.size(); k++) {
+        u.col(k).setConstant(resp(i, items[k]));
+        p.row(k) = params.row(items[k]);
+      }
+      ArrayXd ll = (type == ModelType::BRM) ? logLik_brm(u, grid, p) : logLik_grm(u, grid, p);
+      ArrayXd post = prior * ll.exp();
+      mean = (post * grid).sum() / post.sum();
+      sd = sqrt((post * (grid - mean).square()).sum() / post.sum());
+    };
+
+    Quadrature quad = quadrature(QuadType::GAUSS_HERMITE, 61);
+    Est_Result best = eapEst(bresp, bparams, ModelType::BRM, quad);
+    Est_Result gest = eapEst(gresp, gparams, ModelType::GRM, quad);
+    for (int i : {0, 2, 17}) {
+      double mean, sd;
+      dense(bresp, bparams, ModelType::BRM, i, mean, sd);
+      check("eapEst BRM theta", best.theta(i), mean, 1e-5);
+      check("eapEst BRM sem", best.sem(i), sd, 1e-5);
+      dense(gresp, gparams, ModelType::GRM, i, mean, sd);
+      check("eapEst GRM theta", gest.theta(i), mean, 1e-5);
+      check("eapEst GRM sem", gest.sem(i), sd, 1e-5);
+    }
+    check("eapEst info", best.info(2), 1 / (best.sem(2) * best.sem(2)), 1e-12);
+    check("eapEst no responses theta", best.theta(1) + 1, 1, 1e-12);
+    check("eapEst no responses sem", best.sem(1), 1, 1e-12);
+
+    // equally spaced nodes and a user prior give the same estimates as the dense grid
+    Est_Result equal = eapEst(bresp, bparams, ModelType::BRM, quadrature(QuadType::EQUAL, 161, 0, 1, RowVector2d(-8, 8)));
+    Est_Result user = eapEst(bresp, bparams, ModelType::BRM, quadrature(grid, prior));
+    check("eapEst EQUAL theta", equal.theta(17), best.theta(17), 1e-6);
+    check("eapEst user prior theta", user.theta(17), best.theta(17), 1e-6);
+
+    // the node buffers are workspace slots: they grow for a larger quadrature, then are reused
+    setNumThreads(1);
+    const Quadrature wide = quadrature(QuadType::EQUAL, 40001, 0, 1, RowVector2d(-8, 8));
+    long growths = Workspace::local().growths();
+    eapEst(bresp, bparams, ModelType::BRM, wide);
+    check("eapEst workspace grows", Workspace::local().growths() > growths, 1, 0);
+    growths = Workspace::local().growths();
+    eapEst(bresp, bparams, ModelType::BRM, wide);
+    check("eapEst workspace reused", Workspace::local().growths(), growths, 0);
+    setNumThreads(0);
+
+    try {
+      ArrayXXd bad = bresp;
+      bad(3, 3) = 2;
+      eapEst(bad, bparams, ModelType::BRM, quad);
+      check("eapEst invalid response throws", 0, 1, 0);
+    } catch (const char *) {
+    }
+  }
+
+  // posterior-weighted selection from quadrature tables
+  {
+    const int M = 30;
+    ArrayXXd bparams(M, 3), gparams(M, 3);
+    unsigned int seed = 99;
+    auto unif = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) & 0xffff) / 65536.0; };
+
+    for (int j = 0; j < M; j++) {
+      bparams.row(j) << 0.8 + unif(), -2 + 4 * unif(), 0.2 * unif();
+      gparams(j, 0) = 0.8 + unif();
+      gparams(j, 1) = -2 + 1.5 * unif();
+      gparams(j, 2) = gparams(j, 1) + 0.5 + 1.5 * unif();
+    }
+    ArrayXd bresp = ArrayXd::Constant(M, NAN), gresp = ArrayXd::Constant(M, NAN);
+    for (int j = 0; j < 8; j++) {
+      bresp(3 * j) = j % 2;
+      gresp(3 * j) = 1 + j % 3;
+    }
+    std::vector<uint8_t> exclude(M, 0);
+    for (int j = 0; j < 8; j++) {
+      exclude[3 * j] = 1;
+    }
+
+    Quadrature quad = quadrature(QuadType::EQUAL, 33, 0, 1, RowVector2d(-4, 4));
+    ItemBank bbank(bparams, ModelType::BRM), gbank(gparams, ModelType::GRM);
+    bbank.buildQuadTable(quad);
+    gbank.buildQuadTable(quad);
+
+    ArrayXd w = bbank.posterior(bresp);
+    ArrayXXd bresp_row = bresp.transpose();
+    check("posterior weights", w.sum(), 1, 1e-12);
+    check("posterior mean matches eapEst", (w * quad.nodes).sum(), eapEst(bresp_row, bparams, ModelType::BRM, quad).theta(0), 1e-10);
+    check("posterior without responses", (bbank.posterior(ArrayXd::Constant(M, NAN)) - quad.weights).abs().maxCoeff() + 1, 1, 1e-12);
+
+    // brute force criteria: information and category log-probabilities at each node
+    auto logp = [](const ArrayXXd& params, ModelType type, int j, int cat, double theta) {
+      ArrayXXd u = ArrayXXd::Constant(1, 1, cat);
+      ArrayXd t = ArrayXd::Constant(1, theta);
+      return (type == ModelType::BRM) ? logLik_brm(u, t, params.row(j))(0) : logLik_grm(u, t, params.row(j))(0);
+    };
+    auto brute = [&](const ItemBank& bank, const ArrayXd& resp, SelectType select, double theta, ArrayXd& crit) {
+      const ArrayXXd& params = bank.params();
+      const int first = (bank.model() == ModelType::BRM ? 0 : 1);
+      ArrayXd post = bank.posterior(resp);
+      ArrayXXd info = (bank.model() == ModelType::BRM) ? FI_brm(params, quad.nodes, FIType::EXPECTED, ArrayXXd()).item
+                                                       : FI_grm(params, quad.nodes, FIType::EXPECTED, ArrayXXd()).item;
+      crit.resize(M);
+      for (int j = 0; j < M; j++) {
+        crit(j) = 0;
+        for (int q = 0; q < quad.nodes.size(); q++) {
+          if (select == SelectType::PW_FI) {
+            crit(j) += post(q) * info(q, j);
+          } else {
+            for (int c = first; c < first + bank.categories(); c++) {
+              double lp = logp(params, bank.model(), j, c, theta);
+              crit(j) += post(q) * exp(lp) * (lp - logp(params, bank.model(), j, c, quad.nodes(q)));
+            }
+          }
+        }
+      }
+    };
+
+    for (SelectType select : {SelectType::PW_FI, SelectType::PW_KL}) {
+      const char *name = (select == SelectType::PW_FI ? "PW-FI" : "PW-KL");
+      for (const ItemBank *bank : {&bbank, &gbank}) {
+        const ArrayXd& resp = (bank == &bbank ? bresp : gresp);
+        ArrayXd crit;
+        brute(*bank, resp, select, 0.3, crit);
+
+        Choose_Result all = const_cast<ItemBank *>(bank)->itChoose_posterior(select, 0.3, resp, std::vector<uint8_t>(), M, M);
+        double err = 0;
+        for (size_t k = 0; k < all.items.size(); k++) {
+          err = std::max(err, fabs(all.info[k] - crit(all.items[k])));
+        }
+        check((std::string(name) + " criterion").c_str(), err, 0, 1e-9);
+
+        Choose_Result best = const_cast<ItemBank *>(bank)->itChoose_posterior(select, 0.3, resp, exclude, 1, 1);
+        for (int j = 0; j < M; j++) {
+          if (exclude[j]) {
+            crit(j) = -1;
+          }
+        }
+        int argmax;
+        crit.maxCoeff(&argmax);
+        check((std::string(name) + " best item").c_str(), best.items[0], argmax, 0);
+      }
+    }
+
+    try {
+      ItemBank plain(bparams, ModelType::BRM);
+      plain.itChoose_posterior(SelectType::PW_FI, 0, bresp, exclude, 1, 1);
+      check("itChoose_posterior without table throws", 0, 1, 0);
+    } catch (const char *) {
+    }
+  }
+
+  // binary item bank format: parameters, ids, precision, and info table round-trip exactly
+  {
+    ItemBank bank(params, ModelType::BRM, {"item1", "item2", "item3", "item4", "item5"});
+    ItemBank bank_grm(params, ModelType::GRM);
+    ItemBank loaded, loaded_grm;
+
+    bank.buildInfoTable(InterpType::CUBIC, 1e-6);
+    bank.setPrecision(Precision::FLOAT32);
+
+    std::vector<uint8_t> blob = bank.serialize();
+    std::vector<uint8_t> blob_grm = bank_grm.serialize();
+    loaded.deserialize(blob.data(), blob.size());
+    loaded_grm.deserialize(blob_grm.data(), blob_grm.size());
+
+    bool same = true;
+    for (double th = -6; th <= 6; th += 0.0137) {
+      same = same && (loaded.FI_expected(th, {}) == bank.FI_expected(th, {})).all();
+    }
+    check("binary bank size without ids or table", blob_grm.size(), ItemBank::BINARY_HEADER + 5 * 3 * 8, 0);
+    check("binary bank params", (loaded.params() == bank.params()).all(), 1, 0);
+    check("binary bank fingerprint", loaded.fingerprint() == bank.fingerprint(), 1, 0);
+    check("binary bank id", loaded.id(3) == "item4", 1, 0);
+    check("binary bank GRM", loaded_grm.model() == ModelType::GRM && loaded_grm.categories() == 3 && loaded_grm.id(0).empty(), 1, 0);
+    check("binary bank precision", loaded.precision() == Precision::FLOAT32, 1, 0);
+    check("binary bank info table", loaded.hasInfoTable() && loaded.infoTableError() == bank.infoTableError(), 1, 0);
+    check("binary bank table information", same, 1, 0);
+    check("binary bank reserialized", loaded.serialize() == blob, 1, 0);
+
+    std::vector<uint8_t> shifted(blob.size() + 1);
+    ItemBank unaligned;
+    memcpy(shifted.data() + 1, blob.data(), blob.size());
+    unaligned.deserialize(shifted.data() + 1, blob.size());
+    check("binary bank unaligned", unaligned.serialize() == blob, 1, 0);
+
+    const char *path = "catirt-native-test.catb";
+    FILE *file = fopen(path, "wb");
+    ItemBank mapped;
+    fwrite(blob.data(), 1, blob.size(), file);
+    fclose(file);
+    mapped.deserializeFile(path);
+    remove(path);
+    check("binary bank file", mapped.serialize() == blob, 1, 0);
+
+    blob[4] = ItemBank::BINARY_VERSION + 1;
+    check("binary bank bad version", loaded.tryDeserialize(blob.data(), blob.size()) != nullptr, 1, 0);
+    blob[4] = ItemBank::BINARY_VERSION;
+    check("binary bank truncated", loaded.tryDeserialize(blob.data(), blob.size() - 8) != nullptr, 1, 0);
+    blob[ItemBank::BINARY_HEADER + 7] = 0xff;  // first parameter NaN
+    check("binary bank non-finite params", loaded.tryDeserialize(blob.data(), blob.size()) != nullptr, 1, 0);
+    check("binary bank unchanged on error", loaded.size() == 5 && loaded.id(3) == "item4" && loaded.hasInfoTable(), 1, 0);
+  }
+
+  // threaded rows match the serial path exactly
+  {
+    const int N = 400, M = 40;
+    ArrayXXd bparams(M, 3), gparams(M, 3), bresp(N, M), gresp(N, M);
+    ArrayXd btheta(N);
+    unsigned int seed = 12345;
+    auto unif = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) & 0xffff) / 65536.0; };
+
+    for (int j = 0; j < M; j++) {
+      bparams.row(j) << 0.8 + unif(), -2.5 + 5 * unif(), 0.2 * unif();
+      gparams(j, 0) = 0.8 + unif();
+      gparams(j, 1) = -2 + 1.5 * unif();
+      gparams(j, 2) = gparams(j, 1) + 0.5 + 1.5 * unif();
+    }
+    for (int i = 0; i < N; i++) {
+      btheta(i) = -3 + 6 * unif();
+      for (int j = 0; j < M; j++) {
+        bresp(i, j) = (unif() < 0.5) ? 1 : 0;
+        gresp(i, j) = 1 + (int)(3 * unif());
+      }
+    }
+
+    setNumThreads(1);
+    Est_Result b1 = wleEst(bresp, bparams, range, ModelType::BRM);
+    Est_Result g1 = wleEst(gresp, gparams, range, ModelType::GRM);
+    FI_Result fb1 = FI_brm(bparams, btheta, FIType::EXPECTED, none);
+    FI_Result fg1 = FI_grm(gparams, btheta, FIType::EXPECTED, none);
+    Est_Result e1 = eapEst(gresp, gparams, ModelType::GRM, quadrature(QuadType::GAUSS_HERMITE, 41));
+
+    setNumThreads(4);
+    Est_Result b4 = wleEst(bresp, bparams, range, ModelType::BRM);
+    Est_Result g4 = wleEst(gresp, gparams, range, ModelType::GRM);
+    FI_Result fb4 = FI_brm(bparams, btheta, FIType::EXPECTED, none);
+    FI_Result fg4 = FI_grm(gparams, btheta, FIType::EXPECTED, none);
+    Est_Result e4 = eapEst(gresp, gparams, ModelType::GRM, quadrature(QuadType::GAUSS_HERMITE, 41));
+    setNumThreads(0);
+
+    check("threads wleEst BRM theta", (b4.theta == b1.theta).all(), 1, 0);
+    check("threads wleEst BRM sem", (b4.sem == b1.sem).all(), 1, 0);
+    check("threads wleEst GRM theta", (g4.theta == g1.theta).all(), 1, 0);
+    check("threads wleEst GRM sem", (g4.sem == g1.sem).all(), 1, 0);
+    check("threads FI_brm item", (fb4.item == fb1.item).all(), 1, 0);
+    check("threads FI_grm item", (fg4.item == fg1.item).all(), 1, 0);
+    check("threads eapEst GRM theta", (e4.theta == e1.theta).all(), 1, 0);
+  }
+
+#if CATIRT_THREADS
+  // thread pool: the same workers run every call, keeping their workspaces
+  {
+    auto chunk_growths = []() {
+      std::atomic<int> started(0);
+      std::atomic<long> growths(0);
+
+      // each chunk waits for the others to start, so all four run on different threads
+      parallel_for(4, 1, [&](int begin, int end) {
+        started++;
+        for (int spin = 0; started < 4 && spin < 10000000; spin++) {
+          std::this_thread::yield();
+        }
+        long before = Workspace::local().growths();
+        Workspace::local().vector(Scratch::RESP, 100000);
+        growths += Workspace::local().growths() - before;
+      });
+      return growths.load();
+    };
+    bool rethrown = false;
+
+    setNumThreads(4);
+    chunk_growths();
+    check("thread pool workers keep their workspaces", chunk_growths(), 0, 0);
+    try {
+      parallel_for(4, 1, [](int begin, int end) {
+        if (begin == 2) {
+          throw "chunk failed";
+        }
+      });
+    } catch (const char *error) {
+      rethrown = (std::string(error) == "chunk failed");
+    }
+    check("thread pool rethrows chunk exceptions", rethrown, 1, 0);
+    setNumThreads(0);
+  }
+#endif
+
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}